@@ -2,11 +2,15 @@
  * File: AirlineGraph.cpp
  * ----------------------
  * This program initializes the graph for the airline example and then
- * prints the adjacency lists for each of the cities.
+ * prints the adjacency lists for each of the cities. If a file name is
+ * given on the command line, the flights are read from that file, one
+ * per line in the form "city1,city2,miles", instead of using the
+ * built-in data.
  */
 
 #include <iostream>
 #include <string>
+#include "graphloader.h"
 #include "graphtypes.h"
 #include "set.h"
 using namespace std;
@@ -21,9 +25,13 @@ void addArc(SimpleGraph & g, Node *n1, Node *n2, double cost);
 
 /* Main program */
 
-int main() {
+int main(int argc, char *argv[]) {
     SimpleGraph airline;
-    initAirlineGraph(airline);
+    if (argc > 1) {
+        loadEdgeList(argv[1], airline, true);
+    } else {
+        initAirlineGraph(airline);
+    }
     printAdjacencyLists(airline);
     return 0;
 }
@@ -54,7 +62,8 @@ void printAdjacencyLists(SimpleGraph & g) {
  * ---------------------------------
  * Initializes the airline graph to hold some flight data.
  * In a real application, the program would almost certainly read this
- * information from a data file.
+ * information from a data file, as main does using loadEdgeList when
+ * it is given a file name.
  */
 
 void initAirlineGraph(SimpleGraph & airline) {
@@ -0,0 +1,203 @@
+/*
+ * File: ArenaBenchmark.cpp
+ * ------------------------
+ * This program measures the one-shot use of formulas, in which each line
+ * of input is parsed, evaluated once and thrown away, as the interpreter
+ * does. It runs the same lines twice: once building each tree with new
+ * and deleting it, and once building the trees in an ExpressionArena that
+ * is cleared before each line. The program replaces the global operator
+ * new to count the allocations each method makes, and it checks that
+ * both methods compute the same values. The command line may give the
+ * number of lines.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include "arena.h"
+#include "exp.h"
+#include "parser.h"
+#include "random.h"
+#include "timer.h"
+#include "tokenscanner.h"
+#include "vector.h"
+using namespace std;
+
+/* Constants */
+
+const int DEFAULT_LINES = 1000000;
+
+const string INPUTS[] = {
+    "x", "rate", "total", "price", "quantity", "discount", "tax", "y2"
+};
+const int N_INPUTS = sizeof INPUTS / sizeof INPUTS[0];
+const string RESULTS[] = { "result", "subtotal", "z" };
+const int N_RESULTS = sizeof RESULTS / sizeof RESULTS[0];
+const string OPERATORS = "+-*";
+
+/* Global variables */
+
+long allocationCount = 0;           // Calls to operator new so far
+
+/* Function prototypes */
+
+string makeLine();
+long runWithNew(const Vector<string> & lines, double & ms);
+long runWithArena(const Vector<string> & lines, double & ms);
+void initContext(EvaluationContext & context);
+void report(string method, int nLines, long nAllocations, double ms);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    int nLines = (argc > 1) ? atoi(argv[1]) : DEFAULT_LINES;
+    Vector<string> lines;
+    for (int i = 0; i < nLines; i++) {
+        lines.add(makeLine());
+    }
+    double newMs, arenaMs;
+    long before = allocationCount;
+    long newSum = runWithNew(lines, newMs);
+    long newAllocations = allocationCount - before;
+    before = allocationCount;
+    long arenaSum = runWithArena(lines, arenaMs);
+    long arenaAllocations = allocationCount - before;
+    report("new and delete", nLines, newAllocations, newMs);
+    report("ExpressionArena", nLines, arenaAllocations, arenaMs);
+    cout << "Speedup: " << newMs / arenaMs << "x" << endl;
+    if (newSum != arenaSum) {
+        cout << "Results differ" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Function: makeLine
+ * Usage: string line = makeLine();
+ * --------------------------------
+ * Returns an assignment of a formula over the inputs to one of the result
+ * variables. The inputs are small and there are at most five terms, so
+ * no formula overflows.
+ */
+
+string makeLine() {
+    string line = RESULTS[randomInteger(0, N_RESULTS - 1)] + " = ";
+    int nTerms = randomInteger(1, 5);
+    for (int i = 0; i < nTerms; i++) {
+        if (i > 0) {
+            line += " ";
+            line += OPERATORS[randomInteger(0, OPERATORS.length() - 1)];
+            line += " ";
+        }
+        if (randomChance(0.6)) {
+            line += INPUTS[randomInteger(0, N_INPUTS - 1)];
+        } else {
+            line += to_string(randomInteger(0, 99));
+        }
+    }
+    return line;
+}
+
+/*
+ * Function: runWithNew
+ * Usage: long sum = runWithNew(lines, ms);
+ * ----------------------------------------
+ * Parses and evaluates each line, deleting each tree after it is used,
+ * and returns the sum of the values. The elapsed time is stored in ms.
+ */
+
+long runWithNew(const Vector<string> & lines, double & ms) {
+    EvaluationContext context;
+    initContext(context);
+    TokenScanner scanner;
+    scanner.ignoreWhitespace();
+    scanner.scanNumbers();
+    long sum = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < lines.size(); i++) {
+        scanner.borrowInput(lines[i]);
+        Expression *exp = parseExp(scanner);
+        sum += exp->eval(context);
+        delete exp;
+    }
+    ms = elapsedMs(start);
+    return sum;
+}
+
+/*
+ * Function: runWithArena
+ * Usage: long sum = runWithArena(lines, ms);
+ * ------------------------------------------
+ * Does the same work as runWithNew, building the trees in an arena.
+ */
+
+long runWithArena(const Vector<string> & lines, double & ms) {
+    EvaluationContext context;
+    initContext(context);
+    TokenScanner scanner;
+    scanner.ignoreWhitespace();
+    scanner.scanNumbers();
+    ExpressionArena arena;
+    long sum = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < lines.size(); i++) {
+        arena.clear();
+        scanner.borrowInput(lines[i]);
+        Expression *exp = parseExp(scanner, &arena);
+        sum += exp->eval(context);
+    }
+    ms = elapsedMs(start);
+    return sum;
+}
+
+/*
+ * Function: initContext
+ * Usage: initContext(context);
+ * ----------------------------
+ * Gives every input a small value.
+ */
+
+void initContext(EvaluationContext & context) {
+    for (int k = 0; k < N_INPUTS; k++) {
+        context.setValue(INPUTS[k], k + 2);
+    }
+}
+
+/*
+ * Function: report
+ * Usage: report(method, nLines, nAllocations, ms);
+ * ------------------------------------------------
+ * Displays the time per line and allocation count of one method.
+ */
+
+void report(string method, int nLines, long nAllocations, double ms) {
+    cout << method << ": " << nLines << " lines in " << ms << " ms ("
+         << 1e6 * ms / nLines << " ns per line), " << nAllocations
+         << " allocations" << endl;
+}
+
+/*
+ * Implementation notes: operator new and operator delete
+ * ------------------------------------------------------
+ * These replacements for the global allocation functions count the
+ * allocations made by the whole program and otherwise behave like the
+ * standard versions.
+ */
+
+void *operator new(size_t size) {
+    allocationCount++;
+    void *ptr = malloc((size == 0) ? 1 : size);
+    if (ptr == NULL) throw bad_alloc();
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t size) noexcept {
+    free(ptr);
+}
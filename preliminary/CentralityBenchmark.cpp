@@ -0,0 +1,131 @@
+/*
+ * File: CentralityBenchmark.cpp
+ * -----------------------------
+ * This program times the kernels in centrality.h on a random graph with
+ * a million nodes, or on an edge-list file given on the command line.
+ * It runs PageRank in single and double precision with one thread and
+ * with every processor, compares the two precisions, and then estimates
+ * betweenness centrality from a sample of sources.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "centrality.h"
+#include "compactgraph.h"
+#include "graphloader.h"
+#include "interner.h"
+#include "random.h"
+#include "strlib.h" // From Stanford libraries
+#include "timer.h"
+#include "vector.h"
+using namespace std;
+
+/* Constants */
+
+const int N_NODES = 1000000;
+const int ARCS_PER_NODE = 8;
+const int N_SAMPLES = 32;
+
+/* Function prototypes */
+
+void buildRandomGraph(CompactGraph & g);
+template <typename RealType>
+void timePageRank(const CompactGraph & g, Vector<RealType> & ranks,
+                  string label, int nThreads);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    CompactGraph g;
+    if (argc > 1) {
+        loadEdgeList(argv[1], g);
+    } else {
+        buildRandomGraph(g);
+    }
+    int maxThreads = thread::hardware_concurrency();
+    if (maxThreads < 1) maxThreads = 1;
+    cout << g.size() << " nodes, " << g.getArcCount() << " arcs, "
+         << maxThreads << " processors" << endl;
+
+    Vector<int> inDegree, outDegree;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    degreeCentrality(g, inDegree, outDegree);
+    cout << "Degree: " << elapsedMs(start) << " ms" << endl;
+
+    Vector<double> ranks;
+    Vector<float> floatRanks;
+    timePageRank(g, ranks, "double", 1);
+    timePageRank(g, ranks, "double", maxThreads);
+    timePageRank(g, floatRanks, "float", 1);
+    timePageRank(g, floatRanks, "float", maxThreads);
+    double maxDiff = 0;
+    int top = 0;
+    for (int v = 0; v < g.size(); v++) {
+        maxDiff = max(maxDiff, fabs(ranks[v] - floatRanks[v]));
+        if (ranks[v] > ranks[top]) top = v;
+    }
+    cout << "Largest float/double difference: " << maxDiff << endl;
+    cout << "Highest rank: " << g.getName(top) << " (" << ranks[top]
+         << ", in-degree " << inDegree[top] << ")" << endl;
+
+    Vector<double> scores;
+    for (int nThreads = 1; ; nThreads = maxThreads) {
+        start = chrono::steady_clock::now();
+        betweennessCentrality(g, scores, false, N_SAMPLES, nThreads);
+        cout << "Betweenness from " << N_SAMPLES << " sources, " << nThreads
+             << " threads: " << elapsedMs(start) << " ms" << endl;
+        if (nThreads == maxThreads) break;
+    }
+    return 0;
+}
+
+/*
+ * Function: buildRandomGraph
+ * Usage: buildRandomGraph(g);
+ * ---------------------------
+ * Builds a graph whose arcs favor low-numbered finishes, which gives the
+ * in-degrees the skewed distribution typical of real link graphs.
+ */
+
+void buildRandomGraph(CompactGraph & g) {
+    StringInterner names;
+    for (int i = 0; i < N_NODES; i++) {
+        names.intern(integerToString(i));
+    }
+    int nArcs = N_NODES * ARCS_PER_NODE;
+    int *starts = new int[nArcs];
+    int *finishes = new int[nArcs];
+    double *costs = new double[nArcs];
+    for (int a = 0; a < nArcs; a++) {
+        double r = randomReal(0, 1);
+        starts[a] = a / ARCS_PER_NODE;
+        finishes[a] = (int) (N_NODES * r * r * r);
+        costs[a] = 1;
+    }
+    g.build(names, nArcs, starts, finishes, costs);
+    delete[] starts;
+    delete[] finishes;
+    delete[] costs;
+}
+
+/*
+ * Function: timePageRank
+ * Usage: timePageRank(g, ranks, label, nThreads);
+ * -----------------------------------------------
+ * Runs pageRank with the default settings and reports the time taken.
+ */
+
+template <typename RealType>
+void timePageRank(const CompactGraph & g, Vector<RealType> & ranks,
+                  string label, int nThreads) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int iterations = pageRank(g, ranks, DEFAULT_DAMPING, DEFAULT_TOLERANCE,
+                              DEFAULT_MAX_ITERATIONS, nThreads);
+    double ms = elapsedMs(start);
+    cout << "PageRank (" << label << ", " << nThreads << " threads): "
+         << ms << " ms, " << iterations << " iterations, "
+         << ms / iterations << " ms each" << endl;
+}
@@ -0,0 +1,175 @@
+/*
+ * File: ClassifyBenchmark.cpp
+ * ---------------------------
+ * This program compares the table-driven character classification in
+ * TokenScanner, which finds the end of a run of whitespace or of letters
+ * and digits 16 bytes at a time, with the loop the scanner used before,
+ * which called isspace and isalnum on one character at a time. The old
+ * loop is reproduced here as scanWithCtype. Both are run on two inputs:
+ * one dominated by long identifiers and long stretches of whitespace,
+ * and one of short formulas. The program checks that both methods find
+ * the same tokens. The command line may give the size of each input in
+ * megabytes.
+ */
+
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include "random.h"
+#include "timer.h"
+#include "tokenscanner.h"
+using namespace std;
+
+/* Constants */
+
+const int DEFAULT_MEGABYTES = 16;
+const string WHITESPACE = " \t\n";
+const string LETTERS = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_";
+
+/* Function prototypes */
+
+string makeLongRuns(long nBytes);
+string makeFormulas(long nBytes);
+long scanWithCtype(string_view text, long & checksum);
+long scanWithTable(string_view text, long & checksum);
+void compare(string name, const string & text);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    int megabytes = (argc > 1) ? atoi(argv[1]) : DEFAULT_MEGABYTES;
+    long nBytes = (long) megabytes << 20;
+    compare("Long identifiers and whitespace", makeLongRuns(nBytes));
+    compare("Short formulas", makeFormulas(nBytes));
+    return 0;
+}
+
+/*
+ * Function: compare
+ * Usage: compare(name, text);
+ * ---------------------------
+ * Times both methods on the text and displays the results.
+ */
+
+void compare(string name, const string & text) {
+    long ctypeSum, tableSum;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    long nCtype = scanWithCtype(text, ctypeSum);
+    double ctypeMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    long nTable = scanWithTable(text, tableSum);
+    double tableMs = elapsedMs(start);
+    cout << name << " (" << text.length() << " bytes, " << nTable
+         << " tokens)" << endl;
+    cout << "  isspace/isalnum loop: " << ctypeMs << " ms ("
+         << text.length() / ctypeMs / 1000 << " MB/sec)" << endl;
+    cout << "  table and vectors: " << tableMs << " ms ("
+         << text.length() / tableMs / 1000 << " MB/sec), "
+         << ctypeMs / tableMs << "x faster" << endl;
+    if (nCtype != nTable || ctypeSum != tableSum) {
+        cout << "  Token streams differ" << endl;
+    }
+}
+
+/*
+ * Function: makeLongRuns
+ * Usage: string text = makeLongRuns(nBytes);
+ * ------------------------------------------
+ * Returns text made of identifiers of 8 to 64 characters separated by
+ * runs of 4 to 64 whitespace characters, with an occasional operator.
+ */
+
+string makeLongRuns(long nBytes) {
+    string text;
+    text.reserve(nBytes + 200);
+    while ((long) text.length() < nBytes) {
+        int length = randomInteger(8, 64);
+        for (int i = 0; i < length; i++) {
+            char ch = LETTERS[randomInteger(0, 51)];
+            if (i > 0 && randomChance(0.1)) ch = '0' + randomInteger(0, 9);
+            text += ch;
+        }
+        if (randomChance(0.2)) text += " +";
+        length = randomInteger(4, 64);
+        for (int i = 0; i < length; i++) {
+            text += WHITESPACE[randomInteger(0, WHITESPACE.length() - 1)];
+        }
+    }
+    return text;
+}
+
+/*
+ * Function: makeFormulas
+ * Usage: string text = makeFormulas(nBytes);
+ * ------------------------------------------
+ * Returns text made of short assignment statements, one per line.
+ */
+
+string makeFormulas(long nBytes) {
+    string text;
+    text.reserve(nBytes + 200);
+    while ((long) text.length() < nBytes) {
+        text += "total = price * (1 + rate) - discount / ";
+        text += to_string(randomInteger(1, 9999));
+        text += "\n";
+    }
+    return text;
+}
+
+/*
+ * Function: scanWithCtype
+ * Usage: long nTokens = scanWithCtype(text, checksum);
+ * ----------------------------------------------------
+ * Divides the text into tokens with the character loop that TokenScanner
+ * used before, ignoring whitespace, and returns the number of tokens. The
+ * checksum combines the lengths and first characters of the tokens.
+ */
+
+long scanWithCtype(string_view text, long & checksum) {
+    long nTokens = 0;
+    checksum = 0;
+    int cp = 0;
+    int length = text.length();
+    while (true) {
+        while (cp < length && isspace(text[cp])) {
+            cp++;
+        }
+        if (cp >= length) break;
+        int start = cp;
+        if (isalnum(text[cp])) {
+            while (cp < length && isalnum(text[cp])) {
+                cp++;
+            }
+        } else {
+            cp++;
+        }
+        checksum += (cp - start) * 31 + text[start];
+        nTokens++;
+    }
+    return nTokens;
+}
+
+/*
+ * Function: scanWithTable
+ * Usage: long nTokens = scanWithTable(text, checksum);
+ * ----------------------------------------------------
+ * Does the same work as scanWithCtype using TokenScanner::readToken.
+ */
+
+long scanWithTable(string_view text, long & checksum) {
+    TokenScanner scanner;
+    scanner.ignoreWhitespace();
+    scanner.borrowInput(text);
+    long nTokens = 0;
+    checksum = 0;
+    while (true) {
+        Token token = scanner.readToken();
+        if (token.type == END_OF_INPUT) break;
+        checksum += token.text.length() * 31 + token.text[0];
+        nTokens++;
+    }
+    return nTokens;
+}
@@ -0,0 +1,195 @@
+/*
+ * File: ColumnarBenchmark.cpp
+ * ---------------------------
+ * This program applies several formulas to a table of random integer
+ * columns and compares three ways of computing the result column: walking
+ * the expression tree once per row, running the bytecode once per row,
+ * and evaluating the whole table with ColumnarProgram, first on one
+ * thread and then on one thread per processor. The program checks that
+ * every method produces the same column. The first row of the table
+ * divides the most negative int by -1, which must wrap around rather
+ * than trap. The command line may give the number of rows.
+ */
+
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "bytecode.h"
+#include "columnar.h"
+#include "exp.h"
+#include "parser.h"
+#include "random.h"
+#include "timer.h"
+#include "tokenscanner.h"
+using namespace std;
+
+/* Constants */
+
+const int DEFAULT_ROWS = 4000000;
+
+const string FORMULAS[] = {
+    "a + b",
+    "(a + b) * (c - d) / (e + 1) + a * b - c",
+    "y = (a * 3 + b * 5 - c * 7) / (d * d + 1) + (e - a) * (e + b) - 42",
+    "t / (e + 1) + t * t - d * (t = a + b - c)",
+    "a / (b * 2 - 1) - c",
+};
+const int N_FORMULAS = sizeof FORMULAS / sizeof FORMULAS[0];
+const string INPUTS[] = { "a", "b", "c", "d", "e" };
+const int N_INPUTS = sizeof INPUTS / sizeof INPUTS[0];
+
+/* Function prototypes */
+
+void timeTree(Expression *exp, int32_t **table, int nRows, int32_t *result,
+              double & ms);
+void timeBytecode(BytecodeProgram & program, int32_t **table, int nRows,
+                  int32_t *result, double & ms);
+void timeColumnar(ColumnarProgram & program, int32_t **table, int nRows,
+                  int nThreads, int32_t *result, double & ms);
+bool sameColumn(const int32_t *c1, const int32_t *c2, int nRows);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    int nRows = (argc > 1) ? atoi(argv[1]) : DEFAULT_ROWS;
+    int32_t *table[N_INPUTS];
+    for (int k = 0; k < N_INPUTS; k++) {
+        table[k] = new int32_t[nRows];
+        for (int i = 0; i < nRows; i++) {
+            table[k][i] = randomInteger(0, 999);
+        }
+    }
+    if (nRows > 0) {
+        table[0][0] = INT_MIN;
+        table[1][0] = 0;
+    }
+    int32_t *expected = new int32_t[nRows];
+    int32_t *result = new int32_t[nRows];
+    bool ok = true;
+    for (int f = 0; f < N_FORMULAS; f++) {
+        TokenScanner scanner;
+        scanner.ignoreWhitespace();
+        scanner.scanNumbers();
+        scanner.setInput(FORMULAS[f]);
+        Expression *exp = parseExp(scanner);
+        BytecodeProgram bytecode(exp);
+        ColumnarProgram columnar(exp);
+        double treeMs, vmMs, oneMs, allMs;
+        timeTree(exp, table, nRows, expected, treeMs);
+        timeBytecode(bytecode, table, nRows, result, vmMs);
+        bool same = sameColumn(expected, result, nRows);
+        timeColumnar(columnar, table, nRows, 1, result, oneMs);
+        same = same && sameColumn(expected, result, nRows);
+        timeColumnar(columnar, table, nRows, 0, result, allMs);
+        same = same && sameColumn(expected, result, nRows);
+        cout << FORMULAS[f] << endl;
+        cout << "  tree: " << treeMs << " ms (" << 1e6 * treeMs / nRows
+             << " ns per row)" << endl;
+        cout << "  bytecode: " << vmMs << " ms (" << 1e6 * vmMs / nRows
+             << " ns per row)" << endl;
+        cout << "  columnar, 1 thread: " << oneMs << " ms ("
+             << 1e6 * oneMs / nRows << " ns per row), " << treeMs / oneMs
+             << "x faster than the tree" << endl;
+        cout << "  columnar, all threads: " << allMs << " ms ("
+             << 1e6 * allMs / nRows << " ns per row)" << endl;
+        if (!same) {
+            cout << "  Results differ" << endl;
+            ok = false;
+        }
+        delete exp;
+    }
+    for (int k = 0; k < N_INPUTS; k++) {
+        delete[] table[k];
+    }
+    delete[] expected;
+    delete[] result;
+    return ok ? 0 : 1;
+}
+
+/*
+ * Function: timeTree
+ * Usage: timeTree(exp, table, nRows, result, ms);
+ * -----------------------------------------------
+ * Evaluates the tree once for each row of the table, setting the inputs
+ * by slot, and stores the values in result. The elapsed time is stored
+ * in ms.
+ */
+
+void timeTree(Expression *exp, int32_t **table, int nRows, int32_t *result,
+              double & ms) {
+    EvaluationContext context;
+    int inputSlots[N_INPUTS];
+    for (int k = 0; k < N_INPUTS; k++) {
+        inputSlots[k] = context.getSlot(INPUTS[k]);
+    }
+    exp->bind(context);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < nRows; i++) {
+        for (int k = 0; k < N_INPUTS; k++) {
+            context.setValue(inputSlots[k], table[k][i]);
+        }
+        result[i] = exp->eval(context);
+    }
+    ms = elapsedMs(start);
+}
+
+/*
+ * Function: timeBytecode
+ * Usage: timeBytecode(program, table, nRows, result, ms);
+ * -------------------------------------------------------
+ * Does the same work as timeTree using the bytecode program.
+ */
+
+void timeBytecode(BytecodeProgram & program, int32_t **table, int nRows,
+                  int32_t *result, double & ms) {
+    int *slots = new int[program.getSlotCount()];
+    int inputSlots[N_INPUTS];
+    for (int k = 0; k < N_INPUTS; k++) {
+        inputSlots[k] = program.getSlot(INPUTS[k]);
+    }
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < nRows; i++) {
+        for (int k = 0; k < N_INPUTS; k++) {
+            if (inputSlots[k] >= 0) slots[inputSlots[k]] = table[k][i];
+        }
+        result[i] = program.execute(slots);
+    }
+    ms = elapsedMs(start);
+    delete[] slots;
+}
+
+/*
+ * Function: timeColumnar
+ * Usage: timeColumnar(program, table, nRows, nThreads, result, ms);
+ * -----------------------------------------------------------------
+ * Binds the columns the program reads to the table and evaluates every
+ * row with the specified number of threads.
+ */
+
+void timeColumnar(ColumnarProgram & program, int32_t **table, int nRows,
+                  int nThreads, int32_t *result, double & ms) {
+    for (int k = 0; k < N_INPUTS; k++) {
+        int column = program.getColumn(INPUTS[k]);
+        if (column >= 0) program.bindColumn(column, table[k]);
+    }
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    program.evaluate(result, nRows, nThreads);
+    ms = elapsedMs(start);
+}
+
+/*
+ * Function: sameColumn
+ * Usage: if (sameColumn(c1, c2, nRows)) . . .
+ * -------------------------------------------
+ * Returns true if the two columns hold the same values.
+ */
+
+bool sameColumn(const int32_t *c1, const int32_t *c2, int nRows) {
+    for (int i = 0; i < nRows; i++) {
+        if (c1[i] != c2[i]) return false;
+    }
+    return true;
+}
@@ -0,0 +1,115 @@
+/*
+ * File: CompactGraphUnitTest.cpp
+ * ------------------------------
+ * This file contains a unit test of the CompactGraph class that checks
+ * the CSR layout produced by build and makes sure that a graph written
+ * by save comes back unchanged from load.
+ */
+
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include "compactgraph.h"
+#include "interner.h"
+using namespace std;
+
+/* Function prototypes */
+
+void buildAirlineGraph(CompactGraph & g);
+void assertSameGraph(CompactGraph & g1, CompactGraph & g2);
+
+/* Constants */
+
+const string SNAPSHOT_FILE = "CompactGraphUnitTest.bin";
+
+int main() {
+    CompactGraph g;
+    assert(g.size() == 0);                          // A new graph is empty
+    assert(g.getArcCount() == 0);
+    assert(g.getNodeId("Boston") == -1);
+    buildAirlineGraph(g);
+    assert(g.size() == 6);                          // Six cities
+    assert(g.getArcCount() == 8);                   // Four two-way flights
+    int atlanta = g.getNodeId("Atlanta");
+    assert(atlanta == 0);                           // First name seen
+    assert(g.getName(atlanta) == "Atlanta");
+    assert(g.getArcEnd(atlanta) - g.getArcBegin(atlanta) == 2);
+    int a = g.getArcBegin(atlanta);
+    assert(g.getName(g.getFinish(a)) == "Chicago"); // Input order is kept
+    assert(g.getCost(a) == 599);
+    assert(g.getName(g.getFinish(a + 1)) == "Dallas");
+    assert(g.getNodeId("Seattle") == -1);           // Missing names fail
+    assert(g.getNodeId("") == -1);
+
+    g.save(SNAPSHOT_FILE);                          // Round trip a graph
+    CompactGraph copy;
+    copy.load(SNAPSHOT_FILE);
+    assertSameGraph(g, copy);
+    copy.load(SNAPSHOT_FILE);                       // Reload over a snapshot
+    assertSameGraph(g, copy);
+    copy.clear();
+    assert(copy.size() == 0);
+
+    CompactGraph empty;                             // Round trip an empty
+    empty.save(SNAPSHOT_FILE);                      //  graph
+    copy.load(SNAPSHOT_FILE);
+    assert(copy.size() == 0);
+    assert(copy.getArcCount() == 0);
+    assert(copy.getNodeId("Atlanta") == -1);
+
+    g.save(SNAPSHOT_FILE);                          // A rebuilt graph can
+    buildAirlineGraph(copy);                        //  replace a loaded one
+    assertSameGraph(g, copy);
+    remove(SNAPSHOT_FILE.c_str());
+    cout << "CompactGraph unit test succeeded" << endl;
+    return 0;
+}
+
+/*
+ * Function: buildAirlineGraph
+ * Usage: buildAirlineGraph(g);
+ * ----------------------------
+ * Builds a small piece of the airline graph from AirlineGraph.cpp.
+ */
+
+void buildAirlineGraph(CompactGraph & g) {
+    string flights[][2] = {
+        { "Atlanta", "Chicago" }, { "Atlanta", "Dallas" },
+        { "Boston", "New York" }, { "Chicago", "Denver" }
+    };
+    double miles[] = { 599, 725, 191, 907 };
+    StringInterner names;
+    int starts[8], finishes[8];
+    double costs[8];
+    for (int i = 0; i < 4; i++) {
+        int c1 = names.intern(flights[i][0]);
+        int c2 = names.intern(flights[i][1]);
+        starts[2 * i] = finishes[2 * i + 1] = c1;
+        finishes[2 * i] = starts[2 * i + 1] = c2;
+        costs[2 * i] = costs[2 * i + 1] = miles[i];
+    }
+    g.build(names, 8, starts, finishes, costs);
+}
+
+/*
+ * Function: assertSameGraph
+ * Usage: assertSameGraph(g1, g2);
+ * -------------------------------
+ * Checks that the two graphs have the same nodes, names and arcs.
+ */
+
+void assertSameGraph(CompactGraph & g1, CompactGraph & g2) {
+    assert(g1.size() == g2.size());
+    assert(g1.getArcCount() == g2.getArcCount());
+    for (int n = 0; n < g1.size(); n++) {
+        assert(g1.getName(n) == g2.getName(n));
+        assert(g2.getNodeId(g1.getName(n)) == n);
+        assert(g1.getArcBegin(n) == g2.getArcBegin(n));
+        assert(g1.getArcEnd(n) == g2.getArcEnd(n));
+    }
+    for (int a = 0; a < g1.getArcCount(); a++) {
+        assert(g1.getFinish(a) == g2.getFinish(a));
+        assert(g1.getCost(a) == g2.getCost(a));
+    }
+}
@@ -0,0 +1,207 @@
+/*
+ * File: DistanceQueries.cpp
+ * -------------------------
+ * This program exercises the DistanceOracle class on a random graph or
+ * on an edge-list file given on the command line. It checks a sample of
+ * oracle answers against a plain Dijkstra search, measures the latency
+ * of a query against the sub-millisecond target, and then repeats the
+ * check after a series of arc changes that the oracle must absorb
+ * incrementally.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+#include "distanceoracle.h"
+#include "graphloader.h"
+#include "graphtypes.h"
+#include "random.h"
+#include "strlib.h" // From Stanford libraries
+#include "timer.h"
+#include "vector.h"
+using namespace std;
+
+/* Constants */
+
+const int N_NODES = 20000;
+const int N_ARCS = 100000;
+const int N_CHECKS = 100;
+const int N_QUERIES = 10000;
+const int N_CHANGES = 200;
+const double TARGET_MS = 1.0;
+
+/* Function prototypes */
+
+void buildRandomGraph(SimpleGraph & g);
+double dijkstra(SimpleGraph & g, Node *start, Node *finish);
+int checkOracle(DistanceOracle & oracle, SimpleGraph & g,
+                Vector<Node *> & nodes);
+void changeArcs(DistanceOracle & oracle, SimpleGraph & g,
+                Vector<Node *> & nodes);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    SimpleGraph g;
+    if (argc > 1) {
+        loadEdgeList(argv[1], g, true);
+    } else {
+        buildRandomGraph(g);
+    }
+    Vector<Node *> nodes;
+    for (Node *node : g.nodes) {
+        nodes.add(node);
+    }
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    DistanceOracle oracle(g);
+    cout << "Preprocessing: " << elapsedMs(start) << " ms for "
+         << oracle.getLandmarkCount() << " landmarks" << endl;
+    int errors = checkOracle(oracle, g, nodes);
+    long settled = 0;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < N_QUERIES; i++) {
+        Node *n1 = nodes[randomInteger(0, nodes.size() - 1)];
+        Node *n2 = nodes[randomInteger(0, nodes.size() - 1)];
+        oracle.getDistance(n1, n2);
+        settled += oracle.getSettledCount();
+    }
+    double ms = elapsedMs(start) / N_QUERIES;
+    cout << "Queries: " << ms << " ms each (target " << TARGET_MS
+         << " ms, " << ((ms < TARGET_MS) ? "met" : "missed") << "), "
+         << settled / N_QUERIES << " nodes settled on average" << endl;
+    start = chrono::steady_clock::now();
+    changeArcs(oracle, g, nodes);
+    cout << "Updates: " << elapsedMs(start) * 1000 / N_CHANGES
+         << " us each" << endl;
+    errors += checkOracle(oracle, g, nodes);
+    cout << errors << " mismatches with Dijkstra" << endl;
+    return (errors == 0) ? 0 : 1;
+}
+
+/*
+ * Function: buildRandomGraph
+ * Usage: buildRandomGraph(g);
+ * ---------------------------
+ * Creates a random graph in which each arc has a partner in the
+ * opposite direction with the same cost, like the airline graph.
+ */
+
+void buildRandomGraph(SimpleGraph & g) {
+    Vector<Node *> nodes;
+    for (int i = 0; i < N_NODES; i++) {
+        Node *node = new Node;
+        node->name = "n" + integerToString(i);
+        g.nodes.add(node);
+        g.nodeMap[node->name] = node;
+        nodes.add(node);
+    }
+    for (int i = 0; i < N_ARCS / 2; i++) {
+        Node *n1 = nodes[randomInteger(0, N_NODES - 1)];
+        Node *n2 = nodes[randomInteger(0, N_NODES - 1)];
+        double cost = randomInteger(1, 1000);
+        for (int dir = 0; dir < 2; dir++) {
+            Arc *arc = new Arc;
+            arc->start = (dir == 0) ? n1 : n2;
+            arc->finish = (dir == 0) ? n2 : n1;
+            arc->cost = cost;
+            g.arcs.add(arc);
+            arc->start->arcs.add(arc);
+        }
+    }
+}
+
+/*
+ * Function: dijkstra
+ * Usage: double d = dijkstra(g, start, finish);
+ * ---------------------------------------------
+ * Computes the shortest distance from start to finish from scratch.
+ */
+
+double dijkstra(SimpleGraph & g, Node *start, Node *finish) {
+    typedef pair<double,Node *> Entry;
+    priority_queue<Entry,vector<Entry>,greater<Entry> > heap;
+    Map<Node *,double> dist;
+    dist.put(start, 0);
+    heap.push(Entry(0, start));
+    while (!heap.empty()) {
+        double d = heap.top().first;
+        Node *node = heap.top().second;
+        heap.pop();
+        if (node == finish) return d;
+        if (d > dist.get(node)) continue;
+        for (Arc *arc : node->arcs) {
+            double nd = d + arc->cost;
+            if (!dist.containsKey(arc->finish) || nd < dist.get(arc->finish)) {
+                dist.put(arc->finish, nd);
+                heap.push(Entry(nd, arc->finish));
+            }
+        }
+    }
+    return numeric_limits<double>::infinity();
+}
+
+/*
+ * Function: checkOracle
+ * Usage: int errors = checkOracle(oracle, g, nodes);
+ * --------------------------------------------------
+ * Compares the oracle with Dijkstra on random pairs of nodes and returns
+ * the number of disagreements.
+ */
+
+int checkOracle(DistanceOracle & oracle, SimpleGraph & g,
+                Vector<Node *> & nodes) {
+    int errors = 0;
+    for (int i = 0; i < N_CHECKS; i++) {
+        Node *n1 = nodes[randomInteger(0, nodes.size() - 1)];
+        Node *n2 = nodes[randomInteger(0, nodes.size() - 1)];
+        double expected = dijkstra(g, n1, n2);
+        double actual = oracle.getDistance(n1, n2);
+        if (expected != actual && fabs(expected - actual) > 1e-9) errors++;
+    }
+    return errors;
+}
+
+/*
+ * Function: changeArcs
+ * Usage: changeArcs(oracle, g, nodes);
+ * ------------------------------------
+ * Applies a mix of cost changes, removals and additions through the
+ * oracle so that it has to repair its landmark trees.
+ */
+
+void changeArcs(DistanceOracle & oracle, SimpleGraph & g,
+                Vector<Node *> & nodes) {
+    Vector<Arc *> arcs;
+    for (Arc *arc : g.arcs) {
+        arcs.add(arc);
+    }
+    for (int i = 0; i < N_CHANGES; i++) {
+        int k = randomInteger(0, arcs.size() - 1);
+        int last = nodes.size() - 1;
+        switch (i % 4) {
+            case 0:
+                oracle.setCost(arcs[k], arcs[k]->cost * 3);
+                break;
+            case 1:
+                oracle.setCost(arcs[k], arcs[k]->cost / 2);
+                break;
+            case 2:
+                oracle.removeArc(arcs[k]);
+                arcs[k] = arcs[arcs.size() - 1];
+                arcs.remove(arcs.size() - 1);
+                break;
+            case 3:
+                arcs.add(oracle.addArc(nodes[randomInteger(0, last)],
+                                       nodes[randomInteger(0, last)],
+                                       randomInteger(1, 1000)));
+                break;
+        }
+    }
+}
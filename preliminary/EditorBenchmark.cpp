@@ -0,0 +1,201 @@
+/*
+ * File: EditorBenchmark.cpp
+ * -------------------------
+ * This program times an editing session on a large EditorBuffer. It
+ * loads the text one character at a time, as the editor would, and then
+ * makes a series of small edits spread through the whole buffer, moving
+ * the cursor character by character between them. Finally it jumps to
+ * each end and reads the text back. Before timing anything, the program
+ * checks the buffer against a string on a run of random commands. The
+ * command line may give the size of the text in megabytes, which is
+ * 100 by default, and the name of a file to load instead of generated
+ * text.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include "buffer.h"
+#include "random.h"
+#include "timer.h"
+using namespace std;
+
+/* Constants */
+
+const int DEFAULT_MEGABYTES = 100;
+const int N_CHECK_COMMANDS = 100000;
+const int N_EDITS = 1000;
+const int EDIT_DISTANCE = 1000;
+const string INSERTION = "#edit#";
+
+/* Function prototypes */
+
+bool checkAgainstString();
+long loadText(EditorBuffer & buffer, long nBytes, string filename);
+long editThroughout(EditorBuffer & buffer, long length);
+char generatedChar(long i);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    int megabytes = (argc > 1) ? atoi(argv[1]) : DEFAULT_MEGABYTES;
+    string filename = (argc > 2) ? argv[2] : "";
+    bool ok = checkAgainstString();
+    if (!ok) cout << "Random commands: buffer and string differ" << endl;
+    EditorBuffer buffer;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    long length = loadText(buffer, megabytes * 1048576L, filename);
+    double ms = elapsedMs(start);
+    cout << "Load " << length << " characters: " << ms << " ms ("
+         << 1e6 * ms / length << " ns each)" << endl;
+    buffer.moveCursorToStart();
+    start = chrono::steady_clock::now();
+    long expected = editThroughout(buffer, length);
+    ms = elapsedMs(start);
+    cout << N_EDITS << " edits, " << EDIT_DISTANCE
+         << " cursor moves apart: " << ms << " ms" << endl;
+    start = chrono::steady_clock::now();
+    buffer.moveCursorToStart();
+    buffer.moveCursorToEnd();
+    cout << "Jump to start and end: " << elapsedMs(start) << " ms" << endl;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    cout << "Peak resident memory: " << usage.ru_maxrss / 1024 << " MB"
+         << endl;
+    start = chrono::steady_clock::now();
+    string text = buffer.getText();
+    cout << "getText: " << elapsedMs(start) << " ms" << endl;
+    long nMarks = 0;
+    for (size_t i = text.find(INSERTION); i != string::npos;
+                i = text.find(INSERTION, i + 1)) {
+        nMarks++;
+    }
+    if ((long) text.length() != expected || buffer.getCursor() != expected
+            || (filename == "" && nMarks != N_EDITS)) {
+        cout << "Edited text is wrong" << endl;
+        ok = false;
+    }
+    cout << (ok ? "All checks passed" : "CHECKS FAILED") << endl;
+    return ok ? 0 : 1;
+}
+
+/*
+ * Function: checkAgainstString
+ * Usage: if (checkAgainstString()) . . .
+ * --------------------------------------
+ * Applies the same random commands to an EditorBuffer and to a string
+ * with a separate cursor index, and returns true if the text and the
+ * cursor agree after every command.
+ */
+
+bool checkAgainstString() {
+    EditorBuffer buffer;
+    string str;
+    int cursor = 0;
+    for (int i = 0; i < N_CHECK_COMMANDS; i++) {
+        int command = randomInteger(0, 9);
+        if (command < 4) {
+            char ch = char('a' + randomInteger(0, 25));
+            buffer.insertCharacter(ch);
+            str.insert(str.begin() + cursor++, ch);
+        } else if (command < 6) {
+            buffer.deleteCharacter();
+            if (cursor < (int) str.length()) str.erase(cursor, 1);
+        } else if (command < 7) {
+            buffer.moveCursorForward();
+            if (cursor < (int) str.length()) cursor++;
+        } else if (command < 8) {
+            buffer.moveCursorBackward();
+            if (cursor > 0) cursor--;
+        } else if (randomChance(0.01)) {
+            buffer.moveCursorToStart();
+            cursor = 0;
+        } else if (randomChance(0.01)) {
+            buffer.moveCursorToEnd();
+            cursor = str.length();
+        }
+        if (buffer.getCursor() != cursor) return false;
+        if (i % 1000 == 0 && buffer.getText() != str) return false;
+    }
+    return buffer.getText() == str;
+}
+
+/*
+ * Function: loadText
+ * Usage: long length = loadText(buffer, nBytes, filename);
+ * --------------------------------------------------------
+ * Inserts the contents of the named file into the buffer, or nBytes of
+ * generated text if the filename is empty, and returns the number of
+ * characters inserted.
+ */
+
+long loadText(EditorBuffer & buffer, long nBytes, string filename) {
+    if (filename == "") {
+        for (long i = 0; i < nBytes; i++) {
+            buffer.insertCharacter(generatedChar(i));
+        }
+        return nBytes;
+    }
+    ifstream infile(filename.c_str(), ios::binary);
+    if (infile.fail()) {
+        cerr << "Can't open " << filename << endl;
+        exit(1);
+    }
+    long length = 0;
+    char ch;
+    while (infile.get(ch)) {
+        buffer.insertCharacter(ch);
+        length++;
+    }
+    return length;
+}
+
+/*
+ * Function: editThroughout
+ * Usage: long length = editThroughout(buffer, length);
+ * ----------------------------------------------------
+ * Starting with the cursor at the beginning, makes N_EDITS edits spaced
+ * evenly through the buffer, each of which inserts INSERTION and deletes
+ * one character. Between edits, the cursor moves forward one character
+ * at a time, except that every other edit first steps back over
+ * EDIT_DISTANCE characters and forward again. Returns the new length.
+ */
+
+long editThroughout(EditorBuffer & buffer, long length) {
+    long spacing = length / N_EDITS;
+    for (int e = 0; e < N_EDITS; e++) {
+        if (e % 2 == 1) {
+            for (int i = 0; i < EDIT_DISTANCE; i++) {
+                buffer.moveCursorBackward();
+            }
+            for (int i = 0; i < EDIT_DISTANCE; i++) {
+                buffer.moveCursorForward();
+            }
+        }
+        for (long i = 0; i < spacing - 1; i++) {
+            buffer.moveCursorForward();
+        }
+        for (int i = 0; i < (int) INSERTION.length(); i++) {
+            buffer.insertCharacter(INSERTION[i]);
+        }
+        buffer.deleteCharacter();
+    }
+    return length + N_EDITS * ((long) INSERTION.length() - 1);
+}
+
+/*
+ * Function: generatedChar
+ * Usage: char ch = generatedChar(i);
+ * ----------------------------------
+ * Returns character i of the generated text, which consists of lines of
+ * letters and spaces and contains no '#' characters.
+ */
+
+char generatedChar(long i) {
+    if (i % 72 == 71) return '\n';
+    if (i % 7 == 6) return ' ';
+    return char('a' + (i * 2654435761L >> 7) % 26);
+}
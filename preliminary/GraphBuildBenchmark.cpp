@@ -0,0 +1,241 @@
+/*
+ * File: GraphBuildBenchmark.cpp
+ * -----------------------------
+ * This program measures how long it takes to build and clear a large
+ * random graph, comparing a SimpleGraph whose nodes and arcs are each
+ * allocated with new against a Graph that takes them from its pools.
+ * The program also counts every call to operator new so that the
+ * difference in allocation traffic is visible alongside the times, and
+ * it compares looking up the nodes of the pooled graph by name against
+ * looking them up by their interned identifiers. Each clear is timed
+ * together with the allocator's cleanup afterward, as settleHeap
+ * explains.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#include "graph.h"
+#include "graphtypes.h"
+#include "random.h"
+#include "strlib.h" // From Stanford libraries
+#include "timer.h"
+#include "vector.h"
+using namespace std;
+
+/* Constants */
+
+const int DEFAULT_NODES = 100000;
+const int DEFAULT_ARCS = 1000000;
+
+/*
+ * Global counter: nAllocations
+ * ----------------------------
+ * The replacement operator new below increments this counter on every
+ * allocation made anywhere in the program.
+ */
+
+long nAllocations = 0;
+
+void *operator new(size_t size) {
+    nAllocations++;
+    void *ptr = malloc(size == 0 ? 1 : size);
+    if (ptr == NULL) throw bad_alloc();
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t size) noexcept {
+    free(ptr);
+}
+
+/* Function prototypes */
+
+void buildSimpleGraph(SimpleGraph & g, Vector<string> & names,
+                      Vector<int> & ends);
+void clearSimpleGraph(SimpleGraph & g);
+void buildPooledGraph(Graph<Node,Arc> & g, Vector<string> & names,
+                      Vector<int> & ends);
+void timeLookups(Graph<Node,Arc> & g, Vector<string> & names,
+                 Vector<int> & ends);
+void settleHeap();
+void report(string label, double buildMs, double clearMs, long allocs);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    int nNodes = (argc > 1) ? atoi(argv[1]) : DEFAULT_NODES;
+    int nArcs = (argc > 2) ? atoi(argv[2]) : DEFAULT_ARCS;
+    Vector<string> names;
+    for (int i = 0; i < nNodes; i++) {
+        names.add("n" + integerToString(i));
+    }
+    Vector<int> ends;
+    for (int i = 0; i < 2 * nArcs; i++) {
+        ends.add(randomInteger(0, nNodes - 1));
+    }
+    cout << nNodes << " nodes, " << nArcs << " arcs" << endl;
+
+    SimpleGraph simple;
+    long before = nAllocations;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    buildSimpleGraph(simple, names, ends);
+    double buildMs = elapsedMs(start);
+    long allocs = nAllocations - before;
+    start = chrono::steady_clock::now();
+    clearSimpleGraph(simple);
+    settleHeap();
+    report("new per object", buildMs, elapsedMs(start), allocs);
+
+    Graph<Node,Arc> pooled;
+    before = nAllocations;
+    start = chrono::steady_clock::now();
+    buildPooledGraph(pooled, names, ends);
+    buildMs = elapsedMs(start);
+    allocs = nAllocations - before;
+    timeLookups(pooled, names, ends);
+    start = chrono::steady_clock::now();
+    pooled.clear();
+    settleHeap();
+    report("pooled graph", buildMs, elapsedMs(start), allocs);
+    return 0;
+}
+
+/*
+ * Function: buildSimpleGraph
+ * Usage: buildSimpleGraph(g, names, ends);
+ * ----------------------------------------
+ * Builds the test graph in the style of AirlineGraph.cpp, allocating
+ * each node and arc separately.
+ */
+
+void buildSimpleGraph(SimpleGraph & g, Vector<string> & names,
+                      Vector<int> & ends) {
+    Vector<Node *> byIndex;
+    for (int i = 0; i < names.size(); i++) {
+        Node *node = new Node;
+        node->name = names[i];
+        g.nodes.add(node);
+        g.nodeMap[node->name] = node;
+        byIndex.add(node);
+    }
+    for (int i = 0; i < ends.size(); i += 2) {
+        Arc *arc = new Arc;
+        arc->start = byIndex[ends[i]];
+        arc->finish = byIndex[ends[i + 1]];
+        arc->cost = 1;
+        g.arcs.add(arc);
+        arc->start->arcs.add(arc);
+    }
+}
+
+/*
+ * Function: clearSimpleGraph
+ * Usage: clearSimpleGraph(g);
+ * ---------------------------
+ * Frees every node and arc in g one at a time.
+ */
+
+void clearSimpleGraph(SimpleGraph & g) {
+    for (Node *node : g.nodes) {
+        delete node;
+    }
+    for (Arc *arc : g.arcs) {
+        delete arc;
+    }
+    g.nodes.clear();
+    g.arcs.clear();
+    g.nodeMap.clear();
+}
+
+/*
+ * Function: buildPooledGraph
+ * Usage: buildPooledGraph(g, names, ends);
+ * ----------------------------------------
+ * Builds the same graph using the Graph class, whose addNode and addArc
+ * methods allocate from the graph's pools.
+ */
+
+void buildPooledGraph(Graph<Node,Arc> & g, Vector<string> & names,
+                      Vector<int> & ends) {
+    Vector<Node *> byIndex;
+    for (int i = 0; i < names.size(); i++) {
+        byIndex.add(g.addNode(names[i]));
+    }
+    for (int i = 0; i < ends.size(); i += 2) {
+        Arc *arc = g.addArc(byIndex[ends[i]], byIndex[ends[i + 1]]);
+        arc->cost = 1;
+    }
+}
+
+/*
+ * Function: timeLookups
+ * Usage: timeLookups(g, names, ends);
+ * -----------------------------------
+ * Looks up the endpoints of every arc, first by name and then by
+ * identifier, and reports the time for each. The names are passed as
+ * string_view, so neither loop copies a string.
+ */
+
+void timeLookups(Graph<Node,Arc> & g, Vector<string> & names,
+                 Vector<int> & ends) {
+    Vector<int> ids;
+    for (int i = 0; i < names.size(); i++) {
+        ids.add(g.getNodeId(names[i]));
+    }
+    long found = 0;
+    long before = nAllocations;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < ends.size(); i++) {
+        if (g.getNode(names[ends[i]]) != NULL) found++;
+    }
+    double nameMs = elapsedMs(start);
+    long allocs = nAllocations - before;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < ends.size(); i++) {
+        if (g.getNode(ids[ends[i]]) != NULL) found++;
+    }
+    double idMs = elapsedMs(start);
+    cout << ends.size() << " lookups: by name " << nameMs << " ms ("
+         << allocs << " allocations), by identifier " << idMs << " ms"
+         << endl;
+    if (found != 2L * ends.size()) cout << "Lookup failed" << endl;
+}
+
+/*
+ * Function: settleHeap
+ * Usage: settleHeap();
+ * --------------------
+ * Makes the C library finish the bookkeeping for the blocks that have
+ * just been freed. The glibc allocator postpones merging small freed
+ * blocks until a large block is freed or requested, so without this
+ * call the cost lands in whichever clear first frees a large chunk,
+ * or after the timing stops, rather than in the clear that did the
+ * freeing. Elsewhere the function does nothing.
+ */
+
+void settleHeap() {
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+}
+
+/*
+ * Function: report
+ * Usage: report(label, buildMs, clearMs, allocs);
+ * -----------------------------------------------
+ * Displays one line of the benchmark results.
+ */
+
+void report(string label, double buildMs, double clearMs, long allocs) {
+    cout << label << ": build " << buildMs << " ms, clear " << clearMs
+         << " ms, " << allocs << " allocations" << endl;
+}
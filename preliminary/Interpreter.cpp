@@ -3,37 +3,89 @@
  * ---------------------
  * This program simulates the top level of an expression interpreter. The
  * program reads an expression, evaluates it, and then displays the result.
+ * The trees are kept in a ParseCache, so a line that has been typed
+ * before is evaluated without scanning or parsing it again, which
+ * matters when the same few expressions arrive over and over. If the
+ * command line names a file, the program instead runs the file as a
+ * batch script, optionally with the number of threads given after the
+ * name, and displays the result of each line in order.
  */
 
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <string>
 #include "error.h"
 #include "exp.h"
-#include "parser.h" // From Stanford libraries
-#include "tokenscanner.h"
+#include "parsecache.h"
+#include "script.h"
 using namespace std;
 
-int main() {
+/* Function prototypes */
+
+void runInteractive();
+void runBatch(string filename, int nThreads);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    if (argc > 1) {
+        runBatch(argv[1], (argc > 2) ? atoi(argv[2]) : 0);
+    } else {
+        runInteractive();
+    }
+    return 0;
+}
+
+/*
+ * Function: runInteractive
+ * Usage: runInteractive();
+ * ------------------------
+ * Reads, evaluates and displays one line at a time until the user types
+ * "quit".
+ */
+
+void runInteractive() {
     EvaluationContext context;
-    TokenScanner scanner;
-    Expression *exp;
-    scanner.ignoreWhitespace();
-    scanner.scanNumbers();
+    ParseCache cache;
     while (true) {
-        exp = NULL;
         try {
             string line;
             cout << "=> ";
             getline(cin, line);
             if (line == "quit") break;
-            scanner.setInput(line);
-            Expression *exp = parseExp(scanner);
+            Expression *exp = cache.get(line);
             int value = exp->eval(context);
             cout << value << endl;
         } catch (ErrorException ex) {
             cerr << "Error: " << ex.getMessage() << endl;
         }
-        if (exp != NULL) delete exp;
     }
-    return 0;
-}
\ No newline at end of file
+}
+
+/*
+ * Function: runBatch
+ * Usage: runBatch(filename, nThreads);
+ * ------------------------------------
+ * Runs the statements in the named file as a Script, which parses the
+ * statements and evaluates independent ones in parallel on nThreads
+ * threads, or on one thread per processor if nThreads is 0. The results
+ * are displayed in the order of the statements in the file, exactly as
+ * the interactive loop would display them.
+ */
+
+void runBatch(string filename, int nThreads) {
+    ifstream infile(filename.c_str());
+    if (infile.fail()) error("Can't open " + filename);
+    EvaluationContext context;
+    Script script(context);
+    script.read(infile, nThreads);
+    script.run(nThreads);
+    for (int i = 0; i < script.size(); i++) {
+        if (script.hasError(i)) {
+            cerr << "Error: " << script.getError(i) << endl;
+        } else {
+            cout << script.getValue(i) << endl;
+        }
+    }
+}
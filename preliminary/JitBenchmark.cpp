@@ -0,0 +1,295 @@
+/*
+ * File: JitBenchmark.cpp
+ * ----------------------
+ * This program compares three ways of evaluating the same formula many
+ * times with changing inputs: walking the expression tree with eval,
+ * running the bytecode, and running the machine code produced by
+ * NativeProgram. A fourth run takes the program for the formula from a
+ * JitCache and evaluates it in an EvaluationContext, as an interpreter
+ * would, which adds the cost of copying the variables in and out of the
+ * context. The program also reports the cost of finding the formula in
+ * the cache by its text, which is paid once for each program a client
+ * looks up. The program checks that all the methods give the same
+ * results, including on the divisions that overflow or divide by zero.
+ * The command line may give the number of evaluations.
+ */
+
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "bytecode.h"
+#include "error.h"
+#include "exp.h"
+#include "jit.h"
+#include "parser.h"
+#include "timer.h"
+#include "tokenscanner.h"
+using namespace std;
+
+/* Constants */
+
+const int DEFAULT_EVALUATIONS = 5000000;
+
+const string FORMULAS[] = {
+    "a + b",
+    "(a + b) * (c - d) / (e + 1) + a * b - c",
+    "y = (a * 3 + b * 5 - c * 7) / (d * d + 1) + (e - a) * (e + b) - 42",
+    "x / (d + 1) + (c - x) * (x = x + 1) - x * (x = a + b)",
+};
+const int N_FORMULAS = sizeof FORMULAS / sizeof FORMULAS[0];
+const string INPUTS[] = { "a", "b", "c", "d", "e" };
+const int N_INPUTS = sizeof INPUTS / sizeof INPUTS[0];
+const string DIVISIONS[] = { "a / b", "a / (b * 1)" };
+const int N_DIVISIONS = sizeof DIVISIONS / sizeof DIVISIONS[0];
+const int DIVISION_INPUTS[][2] = {
+    { INT_MIN, -1 }, { INT_MAX, -1 }, { -7, 2 }, { 7, -1 }, { 5, 0 }
+};
+const int N_DIVISION_INPUTS = sizeof DIVISION_INPUTS
+                            / sizeof DIVISION_INPUTS[0];
+
+/* Function prototypes */
+
+long timeTree(Expression *exp, int n, double & ms);
+template <typename ProgramType>
+long timeProgram(ProgramType & program, int n, double & ms);
+long timeCache(JitCache & cache, const string & text, int n, double & ms);
+double timeCacheHit(JitCache & cache, const string & text, int n);
+int inputValue(int input, int i);
+bool checkDivisions();
+string treeOutcome(Expression *exp, int a, int b);
+template <typename ProgramType>
+string programOutcome(ProgramType & program, int a, int b);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : DEFAULT_EVALUATIONS;
+    JitCache cache;
+    bool ok = true;
+    for (int f = 0; f < N_FORMULAS; f++) {
+        TokenScanner scanner;
+        scanner.ignoreWhitespace();
+        scanner.scanNumbers();
+        scanner.setInput(FORMULAS[f]);
+        Expression *exp = parseExp(scanner);
+        BytecodeProgram bytecode(exp);
+        NativeProgram native(exp);
+        double treeMs, vmMs, nativeMs, cacheMs;
+        long treeSum = timeTree(exp, n, treeMs);
+        long vmSum = timeProgram(bytecode, n, vmMs);
+        long nativeSum = timeProgram(native, n, nativeMs);
+        long cacheSum = timeCache(cache, FORMULAS[f], n, cacheMs);
+        double hitMs = timeCacheHit(cache, FORMULAS[f], n);
+        cout << FORMULAS[f] << endl;
+        cout << "  tree: " << treeMs << " ms (" << 1e6 * treeMs / n
+             << " ns each)" << endl;
+        cout << "  bytecode: " << vmMs << " ms (" << 1e6 * vmMs / n
+             << " ns each)" << endl;
+        cout << "  " << (native.isNative() ? "native" : "fallback") << ": "
+             << nativeMs << " ms (" << 1e6 * nativeMs / n << " ns each), "
+             << treeMs / nativeMs << "x faster than the tree" << endl;
+        cout << "  through the cache: " << cacheMs << " ms ("
+             << 1e6 * cacheMs / n << " ns each), " << treeMs / cacheMs
+             << "x faster than the tree" << endl;
+        cout << "  cache hit: " << 1e6 * hitMs / n << " ns" << endl;
+        if (treeSum != vmSum || nativeSum != vmSum || cacheSum != vmSum) {
+            cout << "  Results differ" << endl;
+            ok = false;
+        }
+        delete exp;
+    }
+    if (!checkDivisions()) ok = false;
+    return ok ? 0 : 1;
+}
+
+/*
+ * Function: timeTree
+ * Usage: long sum = timeTree(exp, n, ms);
+ * ---------------------------------------
+ * Evaluates the tree n times, setting the inputs by slot before each
+ * evaluation, and returns the sum of the results. The elapsed time is
+ * stored in ms.
+ */
+
+long timeTree(Expression *exp, int n, double & ms) {
+    EvaluationContext context;
+    int inputSlots[N_INPUTS];
+    for (int k = 0; k < N_INPUTS; k++) {
+        inputSlots[k] = context.getSlot(INPUTS[k]);
+    }
+    exp->bind(context);
+    long sum = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < N_INPUTS; k++) {
+            context.setValue(inputSlots[k], inputValue(k, i));
+        }
+        sum += exp->eval(context);
+    }
+    ms = elapsedMs(start);
+    return sum;
+}
+
+/*
+ * Function: timeProgram
+ * Usage: long sum = timeProgram(program, n, ms);
+ * ----------------------------------------------
+ * Does the same work as timeTree using a BytecodeProgram or a
+ * NativeProgram, which share the same interface.
+ */
+
+template <typename ProgramType>
+long timeProgram(ProgramType & program, int n, double & ms) {
+    int *slots = new int[program.getSlotCount()];
+    int inputSlots[N_INPUTS];
+    for (int k = 0; k < N_INPUTS; k++) {
+        inputSlots[k] = program.getSlot(INPUTS[k]);
+    }
+    long sum = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < N_INPUTS; k++) {
+            if (inputSlots[k] >= 0) slots[inputSlots[k]] = inputValue(k, i);
+        }
+        sum += program.execute(slots);
+    }
+    ms = elapsedMs(start);
+    delete[] slots;
+    return sum;
+}
+
+/*
+ * Function: timeCache
+ * Usage: long sum = timeCache(cache, text, n, ms);
+ * ------------------------------------------------
+ * Does the same work as timeTree, but evaluates the program that the
+ * cache holds for the text in the context.
+ */
+
+long timeCache(JitCache & cache, const string & text, int n, double & ms) {
+    EvaluationContext context;
+    int inputSlots[N_INPUTS];
+    for (int k = 0; k < N_INPUTS; k++) {
+        inputSlots[k] = context.getSlot(INPUTS[k]);
+    }
+    NativeProgram *program = cache.get(text);
+    long sum = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < N_INPUTS; k++) {
+            context.setValue(inputSlots[k], inputValue(k, i));
+        }
+        sum += program->eval(context);
+    }
+    ms = elapsedMs(start);
+    return sum;
+}
+
+/*
+ * Function: timeCacheHit
+ * Usage: double ms = timeCacheHit(cache, text, n);
+ * ------------------------------------------------
+ * Looks the text up in the cache n times and returns the elapsed time.
+ * The text must already be in the cache.
+ */
+
+double timeCacheHit(JitCache & cache, const string & text, int n) {
+    NativeProgram *last = NULL;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        NativeProgram *program = cache.get(text);
+        if (program != last && last != NULL) error("The cache changed");
+        last = program;
+    }
+    return elapsedMs(start);
+}
+
+/*
+ * Function: inputValue
+ * Usage: int value = inputValue(input, i);
+ * ----------------------------------------
+ * Returns the value of the specified input on evaluation i. The values
+ * are small, so that no formula overflows.
+ */
+
+int inputValue(int input, int i) {
+    return (i * (2 * input + 1) + input) % 1000;
+}
+
+/*
+ * Function: checkDivisions
+ * Usage: if (checkDivisions()) . . .
+ * ----------------------------------
+ * Evaluates each formula in DIVISIONS on the pairs of inputs in
+ * DIVISION_INPUTS with the tree, the bytecode and the native code, and
+ * returns true if all three give the same value or the same error. The
+ * pairs include the most negative int divided by -1, which the machine
+ * instruction for division cannot compute.
+ */
+
+bool checkDivisions() {
+    bool ok = true;
+    for (int f = 0; f < N_DIVISIONS; f++) {
+        TokenScanner scanner;
+        scanner.ignoreWhitespace();
+        scanner.scanNumbers();
+        scanner.setInput(DIVISIONS[f]);
+        Expression *exp = parseExp(scanner);
+        BytecodeProgram bytecode(exp);
+        NativeProgram native(exp);
+        for (int i = 0; i < N_DIVISION_INPUTS; i++) {
+            int a = DIVISION_INPUTS[i][0];
+            int b = DIVISION_INPUTS[i][1];
+            string tree = treeOutcome(exp, a, b);
+            if (programOutcome(bytecode, a, b) != tree
+                    || programOutcome(native, a, b) != tree) {
+                cout << DIVISIONS[f] << " with a = " << a << ", b = " << b
+                     << ": results differ" << endl;
+                ok = false;
+            }
+        }
+        delete exp;
+    }
+    cout << "Division checks " << (ok ? "passed" : "FAILED") << endl;
+    return ok;
+}
+
+/*
+ * Function: treeOutcome
+ * Usage: string outcome = treeOutcome(exp, a, b);
+ * -----------------------------------------------
+ * Evaluates the tree with the specified values of a and b and returns
+ * the value as a string or the message of the error.
+ */
+
+string treeOutcome(Expression *exp, int a, int b) {
+    EvaluationContext context;
+    context.setValue("a", a);
+    context.setValue("b", b);
+    try {
+        return to_string(exp->eval(context));
+    } catch (ErrorException & ex) {
+        return ex.getMessage();
+    }
+}
+
+/*
+ * Function: programOutcome
+ * Usage: string outcome = programOutcome(program, a, b);
+ * ------------------------------------------------------
+ * Does the same for a BytecodeProgram or a NativeProgram.
+ */
+
+template <typename ProgramType>
+string programOutcome(ProgramType & program, int a, int b) {
+    int slots[2];
+    slots[program.getSlot("a")] = a;
+    slots[program.getSlot("b")] = b;
+    try {
+        return to_string(program.execute(slots));
+    } catch (ErrorException & ex) {
+        return ex.getMessage();
+    }
+}
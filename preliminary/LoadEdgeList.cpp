@@ -0,0 +1,29 @@
+/*
+ * File: LoadEdgeList.cpp
+ * ----------------------
+ * This program loads an edge-list file into a CompactGraph and reports
+ * the size of the graph along with the load throughput. The optional
+ * second argument sets the number of parsing threads.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "compactgraph.h"
+#include "graphloader.h"
+using namespace std;
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        cerr << "Usage: LoadEdgeList file [threads]" << endl;
+        return 1;
+    }
+    int nThreads = (argc > 2) ? atoi(argv[2]) : 0;
+    CompactGraph g;
+    LoadStats stats = loadEdgeList(argv[1], g, nThreads);
+    cout << g.size() << " nodes, " << g.getArcCount() << " arcs" << endl;
+    cout << stats.bytes << " bytes in " << stats.seconds * 1000 << " ms using "
+         << stats.nThreads << " threads" << endl;
+    cout << getThroughput(stats) << " MB/s" << endl;
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * File: MSTBenchmark.cpp
+ * ----------------------
+ * This program times the three minimum spanning tree algorithms in
+ * mst.h on a random graph with a million edges, or on an edge-list file
+ * given on the command line, and checks that they choose the same tree.
+ * It then times Boruvka's algorithm with increasing numbers of threads.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "compactgraph.h"
+#include "graphloader.h"
+#include "mst.h"
+#include "random.h"
+#include "timer.h"
+#include "vector.h"
+using namespace std;
+
+/* Constants */
+
+const int N_NODES = 250000;
+const int N_EDGES = 1000000;
+
+/* Function prototypes */
+
+void buildRandomEdges(int nNodes, int nEdges, Vector<WeightedEdge> & edges);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    int nNodes;
+    Vector<WeightedEdge> edges;
+    if (argc > 1) {
+        CompactGraph g;
+        loadEdgeList(argv[1], g);
+        nNodes = g.size();
+        getEdges(g, edges);
+    } else {
+        nNodes = N_NODES;
+        buildRandomEdges(N_NODES, N_EDGES, edges);
+    }
+    cout << nNodes << " nodes, " << edges.size() << " edges" << endl;
+    string names[] = { "Kruskal", "Prim", "Boruvka" };
+    MSTAlgorithm algorithms[] = { KRUSKAL, PRIM, BORUVKA };
+    Vector<int> expected;
+    bool agree = true;
+    for (int i = 0; i < 3; i++) {
+        Vector<int> tree;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        double total = runMSTAlgorithm(algorithms[i], nNodes, edges, tree);
+        double ms = elapsedMs(start);
+        cout << names[i] << ": " << ms << " ms, " << tree.size()
+             << " edges, total cost " << total << endl;
+        Vector<int> chosen(edges.size(), 0);
+        for (int j = 0; j < tree.size(); j++) {
+            chosen[tree[j]] = 1;
+        }
+        if (i == 0) {
+            expected = tree;
+        } else if (tree.size() != expected.size()) {
+            agree = false;
+        } else {
+            for (int j = 0; j < expected.size(); j++) {
+                if (!chosen[expected[j]]) agree = false;
+            }
+        }
+    }
+    cout << (agree ? "All three trees agree" : "Trees differ!") << endl;
+    int maxThreads = thread::hardware_concurrency();
+    for (int nThreads = 1; nThreads <= maxThreads; nThreads *= 2) {
+        Vector<int> tree;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        boruvkaMST(nNodes, edges, tree, nThreads);
+        cout << "Boruvka with " << nThreads << " threads: "
+             << elapsedMs(start) << " ms" << endl;
+    }
+    return agree ? 0 : 1;
+}
+
+/*
+ * Function: buildRandomEdges
+ * Usage: buildRandomEdges(nNodes, nEdges, edges);
+ * -----------------------------------------------
+ * Creates a random graph whose first nNodes - 1 edges form a random tree,
+ * which makes sure the graph is connected. The costs are small integers,
+ * so there are many ties for the algorithms to break in the same way.
+ */
+
+void buildRandomEdges(int nNodes, int nEdges, Vector<WeightedEdge> & edges) {
+    for (int i = 0; i < nEdges; i++) {
+        WeightedEdge edge;
+        if (i < nNodes - 1) {
+            edge.u = i + 1;
+            edge.v = randomInteger(0, i);
+        } else {
+            edge.u = randomInteger(0, nNodes - 1);
+            edge.v = randomInteger(0, nNodes - 1);
+        }
+        edge.cost = randomInteger(1, 10000);
+        edges.add(edge);
+    }
+}
@@ -0,0 +1,179 @@
+/*
+ * File: OptimizerBenchmark.cpp
+ * ----------------------------
+ * This program measures the effect of ExpressionOptimizer on a few
+ * formulas of the kind users write, which repeat subexpressions and
+ * spell out constant arithmetic. For each formula, it reports the number
+ * of operations one evaluation performs before and after optimization
+ * and the time taken by many evaluations with changing inputs, and it
+ * checks that the two versions agree. It also checks a few formulas
+ * whose assignments and errors the optimizer must not discard. The
+ * command line may give the number of evaluations.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "error.h"
+#include "exp.h"
+#include "optimizer.h"
+#include "parser.h"
+#include "set.h"
+#include "timer.h"
+#include "tokenscanner.h"
+using namespace std;
+
+/* Constants */
+
+const int DEFAULT_EVALUATIONS = 2000000;
+
+const string FORMULAS[] = {
+    "t = p * q * (100 + 8) / 100 + p * q * 0 + s * 1 - (0 + 0)",
+    "(a + b) * (a + b) + (a + b) * (c - d) + (c - d) * (d - c + 1)",
+    "d * 60 * 60 * 24 + h * 60 * 60 + m * 60 + s + 0",
+    "(a * b + c) / (a * b + 1) + (b * a + c) * (c + b * a)",
+};
+const int N_FORMULAS = sizeof FORMULAS / sizeof FORMULAS[0];
+const string INPUTS[] = { "a", "b", "c", "d", "h", "m", "p", "q", "s" };
+const int N_INPUTS = sizeof INPUTS / sizeof INPUTS[0];
+const string SIDE_EFFECTS[] = {
+    "4 * (0 * (b = 1))",
+    "4 * (0 * (1 / a))",
+};
+const int N_SIDE_EFFECTS = sizeof SIDE_EFFECTS / sizeof SIDE_EFFECTS[0];
+
+/* Function prototypes */
+
+int countOperations(Expression *exp);
+void collectOperations(Expression *exp, Set<Expression *> & seen);
+long timeEvaluations(Expression *exp, int n, double & ms);
+string evaluateOnce(Expression *exp);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : DEFAULT_EVALUATIONS;
+    ExpressionOptimizer optimizer;
+    bool ok = true;
+    for (int f = 0; f < N_FORMULAS; f++) {
+        TokenScanner scanner;
+        scanner.ignoreWhitespace();
+        scanner.scanNumbers();
+        scanner.setInput(FORMULAS[f]);
+        Expression *exp = parseExp(scanner);
+        Expression *opt = optimizer.optimize(exp);
+        double treeMs, optMs;
+        long treeSum = timeEvaluations(exp, n, treeMs);
+        long optSum = timeEvaluations(opt, n, optMs);
+        cout << FORMULAS[f] << endl;
+        cout << "  optimized: " << opt->toString() << endl;
+        cout << "  operations per evaluation: " << countOperations(exp)
+             << " -> " << countOperations(opt) << endl;
+        cout << "  time: " << treeMs << " ms -> " << optMs << " ms ("
+             << treeMs / optMs << "x faster)" << endl;
+        if (treeSum != optSum) {
+            cout << "  Results differ" << endl;
+            ok = false;
+        }
+        delete exp;
+    }
+    for (int f = 0; f < N_SIDE_EFFECTS; f++) {
+        TokenScanner scanner;
+        scanner.ignoreWhitespace();
+        scanner.scanNumbers();
+        scanner.setInput(SIDE_EFFECTS[f]);
+        Expression *exp = parseExp(scanner);
+        Expression *opt = optimizer.optimize(exp);
+        string expected = evaluateOnce(exp);
+        string actual = evaluateOnce(opt);
+        cout << SIDE_EFFECTS[f] << endl;
+        cout << "  optimized: " << opt->toString() << endl;
+        cout << "  outcome: " << actual << endl;
+        if (actual != expected) {
+            cout << "  The tree gives " << expected << endl;
+            ok = false;
+        }
+        delete exp;
+    }
+    return ok ? 0 : 1;
+}
+
+/*
+ * Function: countOperations
+ * Usage: int n = countOperations(exp);
+ * ------------------------------------
+ * Returns the number of operators that one evaluation of exp applies.
+ * A node reached along more than one path is counted once, since an
+ * optimized expression evaluates such a node only once.
+ */
+
+int countOperations(Expression *exp) {
+    Set<Expression *> seen;
+    collectOperations(exp, seen);
+    return seen.size();
+}
+
+/*
+ * Function: collectOperations
+ * Usage: collectOperations(exp, seen);
+ * ------------------------------------
+ * Adds every compound node in exp to the set seen.
+ */
+
+void collectOperations(Expression *exp, Set<Expression *> & seen) {
+    if (exp->getType() != COMPOUND || seen.contains(exp)) return;
+    seen.add(exp);
+    collectOperations(exp->getLHS(), seen);
+    collectOperations(exp->getRHS(), seen);
+}
+
+/*
+ * Function: timeEvaluations
+ * Usage: long sum = timeEvaluations(exp, n, ms);
+ * ----------------------------------------------
+ * Evaluates exp n times, setting the inputs by slot before each
+ * evaluation, and returns the sum of the results. The elapsed time is
+ * stored in ms.
+ */
+
+long timeEvaluations(Expression *exp, int n, double & ms) {
+    EvaluationContext context;
+    int slots[N_INPUTS];
+    for (int k = 0; k < N_INPUTS; k++) {
+        slots[k] = context.getSlot(INPUTS[k]);
+    }
+    exp->bind(context);
+    long sum = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < N_INPUTS; k++) {
+            context.setValue(slots[k], (i * (k + 3) + k) % 100 + 1);
+        }
+        sum += exp->eval(context);
+    }
+    ms = elapsedMs(start);
+    return sum;
+}
+
+/*
+ * Function: evaluateOnce
+ * Usage: string outcome = evaluateOnce(exp);
+ * ------------------------------------------
+ * Evaluates exp in a context where a and b are both 0 and returns a
+ * description of the outcome, which is either the value together with
+ * the final value of b or the message of the error.
+ */
+
+string evaluateOnce(Expression *exp) {
+    EvaluationContext context;
+    context.setValue("a", 0);
+    context.setValue("b", 0);
+    try {
+        int value = exp->eval(context);
+        return "value " + to_string(value) + ", b = "
+             + to_string(context.getValue("b"));
+    } catch (ErrorException & ex) {
+        return ex.getMessage();
+    }
+}
@@ -0,0 +1,225 @@
+/*
+ * File: ParseCacheBenchmark.cpp
+ * -----------------------------
+ * This program measures ParseCache on traffic like the interpreter sees
+ * in practice: a few hundred distinct formulas make up 99 percent of the
+ * lines, and the rest are one-off assignments to the inputs. It
+ * evaluates the same lines four ways: parsing every line into an arena,
+ * as the interpreter did before it had a cache, and through a cache
+ * that is large enough, too small for all the formulas, and large enough
+ * and optimizing. The program reports the time and hit rate of each and
+ * checks that all four give the same results. The command line may give
+ * the number of lines.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "arena.h"
+#include "error.h"
+#include "exp.h"
+#include "parsecache.h"
+#include "parser.h"
+#include "random.h"
+#include "timer.h"
+#include "tokenscanner.h"
+#include "vector.h"
+using namespace std;
+
+/* Constants */
+
+const int DEFAULT_LINES = 1000000;
+const int N_FORMULAS = 300;
+const int N_TARGETS = 50;           // Variables the formulas assign
+const double ONE_OFF_CHANCE = 0.01; // Fraction of lines seen only once
+const long SMALL_BUDGET = 65536;    // Holds about a third of the formulas
+const string INPUTS[] = { "a", "b", "c", "d", "e" };
+const int N_INPUTS = sizeof INPUTS / sizeof INPUTS[0];
+
+/* Function prototypes */
+
+void makeLines(int nLines, Vector<string> & lines);
+string makeFormula();
+string randomInput();
+void runParsing(const Vector<string> & lines, Vector<string> & results,
+                double & ms);
+void runCache(const Vector<string> & lines, ParseCache & cache,
+              Vector<string> & results, double & ms);
+void report(string label, double ms, const ParseCache & cache);
+bool sameResults(const Vector<string> & r1, const Vector<string> & r2);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    int nLines = (argc > 1) ? atoi(argv[1]) : DEFAULT_LINES;
+    Vector<string> lines;
+    makeLines(nLines, lines);
+    Vector<string> expected, large, small, optimized;
+    double parseMs, largeMs, smallMs, optimizedMs;
+    ParseCache largeCache;
+    ParseCache smallCache(SMALL_BUDGET);
+    ParseCache optimizingCache(1 << 20, true);
+    runParsing(lines, expected, parseMs);
+    runCache(lines, largeCache, large, largeMs);
+    runCache(lines, smallCache, small, smallMs);
+    runCache(lines, optimizingCache, optimized, optimizedMs);
+    cout << lines.size() << " lines, " << N_FORMULAS
+         << " distinct formulas" << endl;
+    cout << "  parsing every line: " << parseMs << " ms" << endl;
+    report("cache", largeMs, largeCache);
+    report("small cache", smallMs, smallCache);
+    report("optimizing cache", optimizedMs, optimizingCache);
+    if (!sameResults(large, expected) || !sameResults(small, expected)
+            || !sameResults(optimized, expected)) {
+        cout << "Results differ" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Function: makeLines
+ * Usage: makeLines(nLines, lines);
+ * --------------------------------
+ * Fills lines with nLines lines of traffic. The lines start by giving
+ * every variable a value; after that, each line is either one of the
+ * formulas or, rarely, a new assignment to an input.
+ */
+
+void makeLines(int nLines, Vector<string> & lines) {
+    Vector<string> formulas;
+    for (int i = 0; i < N_FORMULAS; i++) {
+        formulas.add(makeFormula());
+    }
+    for (int k = 0; k < N_INPUTS; k++) {
+        lines.add(INPUTS[k] + " = " + to_string(randomInteger(1, 99)));
+    }
+    for (int k = 0; k < N_TARGETS; k++) {
+        lines.add("v" + to_string(k) + " = " + to_string(k));
+    }
+    while (lines.size() < nLines) {
+        if (randomChance(ONE_OFF_CHANCE)) {
+            lines.add(randomInput() + " = "
+                      + to_string(randomInteger(1, 100000)));
+        } else {
+            lines.add(formulas[randomInteger(0, N_FORMULAS - 1)]);
+        }
+    }
+}
+
+/*
+ * Function: makeFormula
+ * Usage: string text = makeFormula();
+ * -----------------------------------
+ * Returns a random formula over the inputs and the assigned variables.
+ * About a third of the formulas assign their value to a variable. The
+ * divisors are always positive, and the values are kept in range by
+ * dividing the assigned variables each time they are read.
+ */
+
+string makeFormula() {
+    string text = randomInput() + " * " + to_string(randomInteger(1, 9))
+                + " + " + randomInput() + " / (" + randomInput() + " + "
+                + to_string(randomInteger(1, 9)) + ") - (v"
+                + to_string(randomInteger(0, N_TARGETS - 1)) + " / 16 + "
+                + randomInput() + ") * " + to_string(randomInteger(1, 9));
+    if (randomChance(0.33)) {
+        text = "v" + to_string(randomInteger(0, N_TARGETS - 1)) + " = "
+             + text;
+    }
+    return text;
+}
+
+/*
+ * Function: randomInput
+ * Usage: string name = randomInput();
+ * -----------------------------------
+ * Returns the name of a randomly chosen input.
+ */
+
+string randomInput() {
+    return INPUTS[randomInteger(0, N_INPUTS - 1)];
+}
+
+/*
+ * Function: runParsing
+ * Usage: runParsing(lines, results, ms);
+ * --------------------------------------
+ * Parses and evaluates each line in turn with a tree built in an arena,
+ * storing the value or error message of each line in results and the
+ * elapsed time in ms.
+ */
+
+void runParsing(const Vector<string> & lines, Vector<string> & results,
+                double & ms) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    EvaluationContext context;
+    TokenScanner scanner;
+    ExpressionArena arena;
+    scanner.ignoreWhitespace();
+    scanner.scanNumbers();
+    for (int i = 0; i < lines.size(); i++) {
+        arena.clear();
+        try {
+            scanner.borrowInput(lines[i]);
+            Expression *exp = parseExp(scanner, &arena);
+            results.add(to_string(exp->eval(context)));
+        } catch (ErrorException & ex) {
+            results.add("Error: " + ex.getMessage());
+        }
+    }
+    ms = elapsedMs(start);
+}
+
+/*
+ * Function: runCache
+ * Usage: runCache(lines, cache, results, ms);
+ * -------------------------------------------
+ * Does the same work as runParsing, taking the trees from cache.
+ */
+
+void runCache(const Vector<string> & lines, ParseCache & cache,
+              Vector<string> & results, double & ms) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    EvaluationContext context;
+    for (int i = 0; i < lines.size(); i++) {
+        try {
+            results.add(to_string(cache.get(lines[i])->eval(context)));
+        } catch (ErrorException & ex) {
+            results.add("Error: " + ex.getMessage());
+        }
+    }
+    ms = elapsedMs(start);
+}
+
+/*
+ * Function: report
+ * Usage: report(label, ms, cache);
+ * --------------------------------
+ * Displays the time taken with a cache, its hit rate, and the memory
+ * its trees use at the end.
+ */
+
+void report(string label, double ms, const ParseCache & cache) {
+    long nGets = cache.getHitCount() + cache.getMissCount();
+    cout << "  " << label << ": " << ms << " ms, "
+         << 100.0 * cache.getHitCount() / nGets << "% hits, "
+         << cache.size() << " trees in " << cache.getBytesUsed()
+         << " bytes" << endl;
+}
+
+/*
+ * Function: sameResults
+ * Usage: if (sameResults(r1, r2)) . . .
+ * -------------------------------------
+ * Returns true if the two runs produced the same results.
+ */
+
+bool sameResults(const Vector<string> & r1, const Vector<string> & r2) {
+    if (r1.size() != r2.size()) return false;
+    for (int i = 0; i < r1.size(); i++) {
+        if (r1[i] != r2[i]) return false;
+    }
+    return true;
+}
@@ -0,0 +1,191 @@
+/*
+ * File: PartitionedPageRank.cpp
+ * -----------------------------
+ * This program partitions a graph with both streaming heuristics, reports
+ * how many arcs each one cuts, and then runs PageRank as a vertex program
+ * with one thread per part. It checks the result against a sequential
+ * computation of the same iteration. The graph is read from an edge-list
+ * file named on the command line or, if there is none, built at random.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "bsp.h"
+#include "compactgraph.h"
+#include "graphloader.h"
+#include "interner.h"
+#include "partition.h"
+#include "random.h"
+#include "strlib.h" // From Stanford libraries
+#include "timer.h"
+#include "vector.h"
+using namespace std;
+
+/* Constants */
+
+const int N_NODES = 200000;
+const int ARCS_PER_NODE = 8;
+const int N_ITERATIONS = 20;
+const double DAMPING = 0.85;
+
+/*
+ * Class: PageRankProgram
+ * ----------------------
+ * This vertex program computes PageRank. In each superstep after the
+ * first, a node sets its rank from the sum of the shares it received,
+ * and in every superstep it sends its rank, divided evenly, along each
+ * of its arcs. Since only the sum of the shares matters, the program
+ * uses addition as its combiner.
+ */
+
+class PageRankProgram : public VertexProgram<double,double> {
+
+public:
+
+    PageRankProgram(int nNodes) {
+        this->nNodes = nNodes;
+    }
+
+    double getInitialValue(int node) const {
+        return 1.0 / nNodes;
+    }
+
+    void compute(VertexContext<double,double> & vertex) const {
+        if (vertex.getSuperstep() > 0) {
+            double sum = 0;
+            for (int i = 0; i < vertex.getMessageCount(); i++) {
+                sum += vertex.getMessage(i);
+            }
+            vertex.setValue((1 - DAMPING) / nNodes + DAMPING * sum);
+        }
+        int degree = vertex.getArcCount();
+        if (degree > 0) vertex.sendToNeighbors(vertex.getValue() / degree);
+    }
+
+    bool hasCombiner() const {
+        return true;
+    }
+
+    double combine(const double & m1, const double & m2) const {
+        return m1 + m2;
+    }
+
+private:
+
+    int nNodes;
+
+};
+
+/* Function prototypes */
+
+void buildRandomGraph(CompactGraph & g);
+void sequentialPageRank(const CompactGraph & g, Vector<double> & rank);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    CompactGraph g;
+    if (argc > 1) {
+        loadEdgeList(argv[1], g);
+    } else {
+        buildRandomGraph(g);
+    }
+    int k = thread::hardware_concurrency();
+    if (k < 2) k = 2;
+    cout << g.size() << " nodes, " << g.getArcCount() << " arcs, "
+         << k << " parts" << endl;
+    string names[] = { "LDG", "Fennel" };
+    PartitionMethod methods[] = { LDG, FENNEL };
+    for (int i = 0; i < 2; i++) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        GraphPartition partition(g, k, methods[i]);
+        double ms = elapsedMs(start);
+        int largest = 0;
+        for (int p = 0; p < k; p++) {
+            int size = partition.getSubgraph(p).nodes.size();
+            if (size > largest) largest = size;
+        }
+        cout << names[i] << ": " << ms << " ms, "
+             << 100.0 * partition.getCutArcCount() / g.getArcCount()
+             << "% of arcs cut, largest part " << largest << " nodes"
+             << endl;
+    }
+    GraphPartition partition(g, k);
+    PageRankProgram program(g.size());
+    Vector<double> ranks;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int steps = runVertexProgram(partition, program, ranks, N_ITERATIONS + 1);
+    cout << "Vertex program: " << steps << " supersteps in "
+         << elapsedMs(start) << " ms" << endl;
+    Vector<double> expected;
+    start = chrono::steady_clock::now();
+    sequentialPageRank(g, expected);
+    cout << "Sequential:     " << elapsedMs(start) << " ms" << endl;
+    double maxError = 0;
+    for (int v = 0; v < g.size(); v++) {
+        maxError = max(maxError, fabs(ranks[v] - expected[v]));
+    }
+    cout << "Largest difference: " << maxError << endl;
+    return (maxError < 1e-12) ? 0 : 1;
+}
+
+/*
+ * Function: buildRandomGraph
+ * Usage: buildRandomGraph(g);
+ * ---------------------------
+ * Builds a graph in which most arcs lead to nearby node numbers, which
+ * gives the partitioners some locality to discover, and the rest lead
+ * anywhere.
+ */
+
+void buildRandomGraph(CompactGraph & g) {
+    StringInterner names;
+    for (int i = 0; i < N_NODES; i++) {
+        names.intern(integerToString(i));
+    }
+    int nArcs = N_NODES * ARCS_PER_NODE;
+    int *starts = new int[nArcs];
+    int *finishes = new int[nArcs];
+    double *costs = new double[nArcs];
+    for (int a = 0; a < nArcs; a++) {
+        int v = a / ARCS_PER_NODE;
+        starts[a] = v;
+        if (randomChance(0.8)) {
+            finishes[a] = (v + randomInteger(1, 100)) % N_NODES;
+        } else {
+            finishes[a] = randomInteger(0, N_NODES - 1);
+        }
+        costs[a] = 1;
+    }
+    g.build(names, nArcs, starts, finishes, costs);
+    delete[] starts;
+    delete[] finishes;
+    delete[] costs;
+}
+
+/*
+ * Function: sequentialPageRank
+ * Usage: sequentialPageRank(g, rank);
+ * -----------------------------------
+ * Runs the same iteration as PageRankProgram on a single thread.
+ */
+
+void sequentialPageRank(const CompactGraph & g, Vector<double> & rank) {
+    int n = g.size();
+    rank = Vector<double>(n, 1.0 / n);
+    for (int iter = 0; iter < N_ITERATIONS; iter++) {
+        Vector<double> sum(n, 0.0);
+        for (int v = 0; v < n; v++) {
+            int degree = g.getArcEnd(v) - g.getArcBegin(v);
+            for (int a = g.getArcBegin(v); a < g.getArcEnd(v); a++) {
+                sum[g.getFinish(a)] += rank[v] / degree;
+            }
+        }
+        for (int v = 0; v < n; v++) {
+            rank[v] = (1 - DAMPING) / n + DAMPING * sum[v];
+        }
+    }
+}
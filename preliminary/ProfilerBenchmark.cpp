@@ -0,0 +1,107 @@
+/*
+ * File: ProfilerBenchmark.cpp
+ * ---------------------------
+ * This program shows what EvalProfiler reports and what it costs. It
+ * evaluates a mix of formulas, a few of which are much more expensive
+ * than the rest, first without the profiler and then with it running.
+ * It displays the summary and writes the folded stacks to a file that
+ * flame-graph tools can read, in which the expensive formulas stand out.
+ * The program must be compiled with EVAL_PROFILE defined, as in
+ *
+ *      g++ -DEVAL_PROFILE ProfilerBenchmark.cpp profiler.cpp exp.cpp . . .
+ *
+ * The command line may give the number of evaluations and the name of
+ * the output file.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "error.h"
+#include "exp.h"
+#include "parsecache.h"
+#include "profiler.h"
+#include "random.h"
+#include "timer.h"
+#include "vector.h"
+using namespace std;
+
+/* Constants */
+
+const int DEFAULT_EVALUATIONS = 200000;
+const string DEFAULT_OUTPUT = "eval.folded";
+const string FORMULAS[] = {
+    "a + b",
+    "a * 3 - c",
+    "total = total / 2 + a",
+    "(a + b) * (a + b) / (c + 1) + (a + b) * (a + b) / (d + 1)",
+    "a * b * c * d / (a + b + c + d) - (a * b + c * d) / (a + 1)"
+};
+const int N_FORMULAS = sizeof FORMULAS / sizeof FORMULAS[0];
+
+/* Function prototypes */
+
+long evaluateAll(const Vector<int> & choices, ParseCache & cache);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    if (!EvalProfiler::isAvailable()) {
+        cerr << "Compile with -DEVAL_PROFILE to enable profiling" << endl;
+        return 1;
+    }
+    int nEvaluations = (argc > 1) ? atoi(argv[1]) : DEFAULT_EVALUATIONS;
+    string filename = (argc > 2) ? argv[2] : DEFAULT_OUTPUT;
+    Vector<int> choices;
+    for (int i = 0; i < nEvaluations; i++) {
+        choices.add(randomInteger(0, N_FORMULAS - 1));
+    }
+    ParseCache cache;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    long plain = evaluateAll(choices, cache);
+    double plainMs = elapsedMs(start);
+    EvalProfiler profiler;
+    start = chrono::steady_clock::now();
+    profiler.start();
+    long profiled = evaluateAll(choices, cache);
+    profiler.stop();
+    double profiledMs = elapsedMs(start);
+    cout << nEvaluations << " evaluations" << endl;
+    cout << "  without the profiler: " << plainMs << " ms" << endl;
+    cout << "  with the profiler: " << profiledMs << " ms" << endl;
+    profiler.writeSummary(cout);
+    ofstream outfile(filename.c_str());
+    profiler.writeFoldedStacks(outfile);
+    cout << "Folded stacks written to " << filename << endl;
+    if (plain != profiled) {
+        cout << "Results differ" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Function: evaluateAll
+ * Usage: long sum = evaluateAll(choices, cache);
+ * ----------------------------------------------
+ * Evaluates the formulas in the order given by choices, using trees from
+ * the cache in a context where every input is defined, and returns the
+ * sum of the values. The cache outlives the call so that the profiler
+ * can still name the trees when it writes the folded stacks.
+ */
+
+long evaluateAll(const Vector<int> & choices, ParseCache & cache) {
+    EvaluationContext context;
+    context.setValue("a", 7);
+    context.setValue("b", 11);
+    context.setValue("c", 13);
+    context.setValue("d", 17);
+    context.setValue("total", 0);
+    long sum = 0;
+    for (int i = 0; i < choices.size(); i++) {
+        sum += cache.get(FORMULAS[choices[i]])->eval(context);
+    }
+    return sum;
+}
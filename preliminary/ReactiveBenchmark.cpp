@@ -0,0 +1,227 @@
+/*
+ * File: ReactiveBenchmark.cpp
+ * ---------------------------
+ * This program builds a sheet like a large spreadsheet: a few hundred
+ * inputs and many formulas, each of which reads an input and perhaps a
+ * formula defined shortly before it. It then changes one input at a
+ * time, first recomputing every formula in order after each change, as
+ * a program without dependency tracking would, and then letting a
+ * ReactiveContext evaluate only the formulas that depend on the change.
+ * The program reports the time and the number of formulas evaluated by
+ * each and checks that they end with the same values. The command line
+ * may give the number of formulas and the number of changes.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "error.h"
+#include "exp.h"
+#include "parser.h"
+#include "random.h"
+#include "reactive.h"
+#include "timer.h"
+#include "tokenscanner.h"
+#include "vector.h"
+using namespace std;
+
+/* Constants */
+
+const int DEFAULT_FORMULAS = 20000;
+const int DEFAULT_CHANGES = 1000;
+const int N_INPUTS = 500;
+const int NEIGHBORHOOD = 20;        // How far back a formula may look
+const double CHAIN_CHANCE = 0.5;    // Fraction of formulas that read one
+
+/* Type for one change to an input */
+
+struct Change {
+    int input;
+    int value;
+};
+
+/* Function prototypes */
+
+void makeFormulas(int nFormulas, Vector<string> & formulas);
+string inputName(int i);
+string formulaName(int i);
+Expression *parseFormula(const string & text);
+void runNaive(const Vector<string> & formulas, const Vector<Change> & changes,
+              Vector<int> & results, long & nEvaluations, double & ms);
+void runReactive(const Vector<string> & formulas,
+                 const Vector<Change> & changes,
+                 Vector<int> & results, long & nEvaluations, double & ms);
+bool sameResults(const Vector<int> & r1, const Vector<int> & r2);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    int nFormulas = (argc > 1) ? atoi(argv[1]) : DEFAULT_FORMULAS;
+    int nChanges = (argc > 2) ? atoi(argv[2]) : DEFAULT_CHANGES;
+    Vector<string> formulas;
+    makeFormulas(nFormulas, formulas);
+    Vector<Change> changes;
+    for (int i = 0; i < nChanges; i++) {
+        Change change;
+        change.input = randomInteger(0, N_INPUTS - 1);
+        change.value = randomInteger(1, 99);
+        changes.add(change);
+    }
+    Vector<int> expected, results;
+    long naiveCount, reactiveCount;
+    double naiveMs, reactiveMs;
+    runNaive(formulas, changes, expected, naiveCount, naiveMs);
+    runReactive(formulas, changes, results, reactiveCount, reactiveMs);
+    cout << nFormulas << " formulas, " << nChanges << " changes" << endl;
+    cout << "  recomputing everything: " << naiveMs << " ms, "
+         << naiveCount << " evaluations" << endl;
+    cout << "  ReactiveContext: " << reactiveMs << " ms, "
+         << reactiveCount << " evaluations ("
+         << naiveMs / reactiveMs << "x faster)" << endl;
+    if (!sameResults(results, expected)) {
+        cout << "Results differ" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Function: makeFormulas
+ * Usage: makeFormulas(nFormulas, formulas);
+ * -----------------------------------------
+ * Fills formulas with the text of nFormulas formulas. Formula i reads an
+ * input and, half the time, one of the formulas just before it, so that
+ * a change spreads along chains the way it does through a column of
+ * running totals. The divisions keep the values small, and also make
+ * many changes stop spreading when a value comes out the same.
+ */
+
+void makeFormulas(int nFormulas, Vector<string> & formulas) {
+    for (int i = 0; i < nFormulas; i++) {
+        string text = inputName(randomInteger(0, N_INPUTS - 1)) + " * "
+                    + to_string(randomInteger(1, 9));
+        if (i > 0 && randomChance(CHAIN_CHANCE)) {
+            int back = randomInteger(1, min(i, NEIGHBORHOOD));
+            text += " + " + formulaName(i - back) + " / "
+                  + to_string(randomInteger(2, 5));
+        }
+        formulas.add(text);
+    }
+}
+
+/*
+ * Functions: inputName, formulaName
+ * Usage: string name = inputName(i);
+ *        string name = formulaName(i);
+ * ------------------------------------
+ * Return the names of input i and formula i.
+ */
+
+string inputName(int i) {
+    return "in" + to_string(i);
+}
+
+string formulaName(int i) {
+    return "f" + to_string(i);
+}
+
+/*
+ * Function: parseFormula
+ * Usage: Expression *exp = parseFormula(text);
+ * --------------------------------------------
+ * Parses the text of a formula into a tree on the heap.
+ */
+
+Expression *parseFormula(const string & text) {
+    TokenScanner scanner;
+    scanner.ignoreWhitespace();
+    scanner.scanNumbers();
+    scanner.setInput(text);
+    return parseExp(scanner);
+}
+
+/*
+ * Function: runNaive
+ * Usage: runNaive(formulas, changes, results, nEvaluations, ms);
+ * --------------------------------------------------------------
+ * Sets the inputs, makes each change in turn, and evaluates every
+ * formula in order after each one, storing the final values in results.
+ * The trees are bound to the context before the clock starts, so that
+ * only the evaluations are timed.
+ */
+
+void runNaive(const Vector<string> & formulas, const Vector<Change> & changes,
+              Vector<int> & results, long & nEvaluations, double & ms) {
+    EvaluationContext context;
+    Vector<Expression *> exps;
+    Vector<int> slots;
+    for (int i = 0; i < N_INPUTS; i++) {
+        context.setValue(inputName(i), 1);
+    }
+    for (int i = 0; i < formulas.size(); i++) {
+        Expression *exp = parseFormula(formulas[i]);
+        exp->bind(context);
+        exps.add(exp);
+        slots.add(context.getSlot(formulaName(i)));
+    }
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    nEvaluations = 0;
+    for (int k = 0; k < changes.size(); k++) {
+        context.setValue(inputName(changes[k].input), changes[k].value);
+        for (int i = 0; i < exps.size(); i++) {
+            context.setValue(slots[i], exps[i]->eval(context));
+            nEvaluations++;
+        }
+    }
+    ms = elapsedMs(start);
+    for (int i = 0; i < exps.size(); i++) {
+        results.add(context.getValue(slots[i]));
+        delete exps[i];
+    }
+}
+
+/*
+ * Function: runReactive
+ * Usage: runReactive(formulas, changes, results, nEvaluations, ms);
+ * -----------------------------------------------------------------
+ * Does the same work as runNaive with a ReactiveContext. Only the
+ * changes are timed, and only the evaluations they cause are counted.
+ */
+
+void runReactive(const Vector<string> & formulas,
+                 const Vector<Change> & changes,
+                 Vector<int> & results, long & nEvaluations, double & ms) {
+    ReactiveContext sheet;
+    for (int i = 0; i < N_INPUTS; i++) {
+        sheet.setValue(inputName(i), 1);
+    }
+    for (int i = 0; i < formulas.size(); i++) {
+        sheet.defineFormula(formulaName(i), parseFormula(formulas[i]));
+    }
+    long nBefore = sheet.getEvaluationCount();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int k = 0; k < changes.size(); k++) {
+        sheet.setValue(inputName(changes[k].input), changes[k].value);
+    }
+    ms = elapsedMs(start);
+    nEvaluations = sheet.getEvaluationCount() - nBefore;
+    for (int i = 0; i < formulas.size(); i++) {
+        results.add(sheet.getValue(formulaName(i)));
+    }
+}
+
+/*
+ * Function: sameResults
+ * Usage: if (sameResults(r1, r2)) . . .
+ * -------------------------------------
+ * Returns true if the two runs produced the same values.
+ */
+
+bool sameResults(const Vector<int> & r1, const Vector<int> & r2) {
+    if (r1.size() != r2.size()) return false;
+    for (int i = 0; i < r1.size(); i++) {
+        if (r1[i] != r2[i]) return false;
+    }
+    return true;
+}
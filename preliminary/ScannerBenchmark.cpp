@@ -0,0 +1,189 @@
+/*
+ * File: ScannerBenchmark.cpp
+ * --------------------------
+ * This program measures how fast TokenScanner divides a large file of
+ * formulas into tokens, first with setInput and nextToken, which copy
+ * the input and allocate a string for every token, and then with
+ * borrowInput and readToken, which return views of the input. The
+ * program replaces the global operator new to count the allocations
+ * each method makes, and it checks that both methods see the same
+ * tokens. The command line may give the size of the input in megabytes.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include "random.h"
+#include "timer.h"
+#include "tokenscanner.h"
+using namespace std;
+
+/* Constants */
+
+const int DEFAULT_MEGABYTES = 16;
+
+const string NAMES[] = {
+    "x", "rate", "total", "price", "quantity", "discount", "tax", "y2"
+};
+const int N_NAMES = sizeof NAMES / sizeof NAMES[0];
+const string OPERATORS = "+-*/";
+
+/* Global variables */
+
+long allocationCount = 0;           // Calls to operator new so far
+
+/* Function prototypes */
+
+string makeInput(long nBytes);
+long scanStrings(const string & text, long & checksum, double & ms);
+long scanViews(const string & text, long & checksum, double & ms);
+void report(string method, long nTokens, long nAllocations, double ms,
+            long nBytes);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    int megabytes = (argc > 1) ? atoi(argv[1]) : DEFAULT_MEGABYTES;
+    string text = makeInput((long) megabytes << 20);
+    long stringSum, viewSum;
+    double stringMs, viewMs;
+    long before = allocationCount;
+    long nStrings = scanStrings(text, stringSum, stringMs);
+    long stringAllocations = allocationCount - before;
+    before = allocationCount;
+    long nViews = scanViews(text, viewSum, viewMs);
+    long viewAllocations = allocationCount - before;
+    cout << "Input: " << text.length() << " bytes" << endl;
+    report("setInput and nextToken", nStrings, stringAllocations, stringMs,
+           text.length());
+    report("borrowInput and readToken", nViews, viewAllocations, viewMs,
+           text.length());
+    cout << "Speedup: " << stringMs / viewMs << "x" << endl;
+    if (nStrings != nViews || stringSum != viewSum) {
+        cout << "Token streams differ" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Function: makeInput
+ * Usage: string text = makeInput(nBytes);
+ * ---------------------------------------
+ * Returns a string of at least nBytes characters containing assignment
+ * statements, one per line, built from random names and numbers.
+ */
+
+string makeInput(long nBytes) {
+    string text;
+    text.reserve(nBytes + 200);
+    while ((long) text.length() < nBytes) {
+        text += NAMES[randomInteger(0, N_NAMES - 1)] + " = ";
+        int nTerms = randomInteger(1, 6);
+        for (int i = 0; i < nTerms; i++) {
+            if (i > 0) {
+                text += " ";
+                text += OPERATORS[randomInteger(0, OPERATORS.length() - 1)];
+                text += " ";
+            }
+            if (randomChance(0.5)) {
+                text += NAMES[randomInteger(0, N_NAMES - 1)];
+            } else {
+                text += to_string(randomInteger(0, 99999));
+            }
+        }
+        text += "\n";
+    }
+    return text;
+}
+
+/*
+ * Function: scanStrings
+ * Usage: long nTokens = scanStrings(text, checksum, ms);
+ * ------------------------------------------------------
+ * Scans the text with setInput and nextToken and returns the number of
+ * tokens. The checksum combines the lengths of the tokens and their
+ * first characters, so that the two methods can be compared.
+ */
+
+long scanStrings(const string & text, long & checksum, double & ms) {
+    TokenScanner scanner;
+    scanner.ignoreWhitespace();
+    scanner.scanNumbers();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    scanner.setInput(text);
+    long nTokens = 0;
+    checksum = 0;
+    while (scanner.hasMoreTokens()) {
+        string token = scanner.nextToken();
+        checksum += token.length() * 31 + token[0];
+        nTokens++;
+    }
+    ms = elapsedMs(start);
+    return nTokens;
+}
+
+/*
+ * Function: scanViews
+ * Usage: long nTokens = scanViews(text, checksum, ms);
+ * ----------------------------------------------------
+ * Does the same work as scanStrings with borrowInput and readToken.
+ */
+
+long scanViews(const string & text, long & checksum, double & ms) {
+    TokenScanner scanner;
+    scanner.ignoreWhitespace();
+    scanner.scanNumbers();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    scanner.borrowInput(text);
+    long nTokens = 0;
+    checksum = 0;
+    while (true) {
+        Token token = scanner.readToken();
+        if (token.type == END_OF_INPUT) break;
+        checksum += token.text.length() * 31 + token.text[0];
+        nTokens++;
+    }
+    ms = elapsedMs(start);
+    return nTokens;
+}
+
+/*
+ * Function: report
+ * Usage: report(method, nTokens, nAllocations, ms, nBytes);
+ * ---------------------------------------------------------
+ * Displays the throughput and allocation count of one method.
+ */
+
+void report(string method, long nTokens, long nAllocations, double ms,
+            long nBytes) {
+    cout << method << ": " << nTokens << " tokens in " << ms << " ms" << endl;
+    cout << "  " << nTokens / ms / 1000 << " million tokens/sec, "
+         << nBytes / ms / 1000 << " MB/sec, " << nAllocations
+         << " allocations" << endl;
+}
+
+/*
+ * Implementation notes: operator new and operator delete
+ * ------------------------------------------------------
+ * These replacements for the global allocation functions count the
+ * allocations made by the whole program and otherwise behave like the
+ * standard versions.
+ */
+
+void *operator new(size_t size) {
+    allocationCount++;
+    void *ptr = malloc((size == 0) ? 1 : size);
+    if (ptr == NULL) throw bad_alloc();
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t size) noexcept {
+    free(ptr);
+}
@@ -0,0 +1,199 @@
+/*
+ * File: ScriptBenchmark.cpp
+ * -------------------------
+ * This program generates a script like the large generated scripts the
+ * batch interpreter is meant for: a few inputs followed by many
+ * statements, most of which compute a new variable from the inputs and a
+ * few of which combine variables computed earlier. It runs the script
+ * as the interactive loop would, one line at a time, and then as a
+ * Script, first on one thread and then on one thread per processor. For
+ * the Script, the program reports the time to read the statements and
+ * the time to run them, and compares their sum with the interactive
+ * loop, which does all of its work in one pass. The program checks that
+ * all three give the same results. The command line may give the number
+ * of statements.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "arena.h"
+#include "error.h"
+#include "exp.h"
+#include "parser.h"
+#include "random.h"
+#include "script.h"
+#include "timer.h"
+#include "tokenscanner.h"
+#include "vector.h"
+using namespace std;
+
+/* Constants */
+
+const int DEFAULT_STATEMENTS = 1000000;
+const double COMBINE_CHANCE = 0.05; // Fraction of statements that combine
+const string INPUTS[] = { "a", "b", "c", "d", "e" };
+const int N_INPUTS = sizeof INPUTS / sizeof INPUTS[0];
+
+/* Function prototypes */
+
+string makeScript(int nStatements);
+void runByLine(const string & text, Vector<string> & results, double & ms);
+void runScript(const string & text, int nThreads, Vector<string> & results,
+               double & readMs, double & runMs, int & nLevels);
+void reportScript(string label, double readMs, double runMs, double lineMs);
+bool sameResults(const Vector<string> & r1, const Vector<string> & r2);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    int nStatements = (argc > 1) ? atoi(argv[1]) : DEFAULT_STATEMENTS;
+    string text = makeScript(nStatements);
+    Vector<string> expected, oneResults, allResults;
+    double lineMs, oneReadMs, oneRunMs, allReadMs, allRunMs;
+    int nLevels;
+    runByLine(text, expected, lineMs);
+    runScript(text, 1, oneResults, oneReadMs, oneRunMs, nLevels);
+    runScript(text, 0, allResults, allReadMs, allRunMs, nLevels);
+    int nThreads = thread::hardware_concurrency();
+    cout << expected.size() << " statements in " << nLevels << " levels"
+         << endl;
+    cout << "  one line at a time: " << lineMs << " ms" << endl;
+    reportScript("Script on 1 thread", oneReadMs, oneRunMs, lineMs);
+    reportScript("Script on " + to_string(nThreads) + " threads",
+                 allReadMs, allRunMs, lineMs);
+    if (!sameResults(oneResults, expected)
+            || !sameResults(allResults, expected)) {
+        cout << "Results differ" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Function: makeScript
+ * Usage: string text = makeScript(nStatements);
+ * ---------------------------------------------
+ * Returns a script that assigns the inputs and then computes nStatements
+ * new variables, each from the inputs or, occasionally, from variables
+ * computed earlier. Every tenth variable is reassigned rather than new.
+ * The values stay small, so that no statement overflows.
+ */
+
+string makeScript(int nStatements) {
+    ostringstream out;
+    for (int k = 0; k < N_INPUTS; k++) {
+        out << INPUTS[k] << " = " << randomInteger(1, 99) << endl;
+    }
+    for (int i = 0; i < nStatements; i++) {
+        int target = (i % 10 == 9) ? randomInteger(0, i) : i;
+        out << "v" << target << " = ";
+        if (i > 0 && randomChance(COMBINE_CHANCE)) {
+            out << "v" << randomInteger(0, i - 1) << " / 3 + v"
+                << randomInteger(0, i - 1) << " / 7";
+        } else {
+            out << INPUTS[randomInteger(0, N_INPUTS - 1)] << " * "
+                << randomInteger(1, 9) << " + "
+                << INPUTS[randomInteger(0, N_INPUTS - 1)] << " / ("
+                << INPUTS[randomInteger(0, N_INPUTS - 1)] << " - "
+                << randomInteger(0, 99) << ")";
+        }
+        out << endl;
+    }
+    return out.str();
+}
+
+/*
+ * Function: runByLine
+ * Usage: runByLine(text, results, ms);
+ * ------------------------------------
+ * Parses and evaluates each line of the script in turn, as the
+ * interactive loop does, and stores the value or error message of each
+ * line in results. The elapsed time is stored in ms.
+ */
+
+void runByLine(const string & text, Vector<string> & results, double & ms) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    EvaluationContext context;
+    TokenScanner scanner;
+    ExpressionArena arena;
+    scanner.ignoreWhitespace();
+    scanner.scanNumbers();
+    istringstream infile(text);
+    string line;
+    while (getline(infile, line)) {
+        arena.clear();
+        try {
+            scanner.borrowInput(line);
+            Expression *exp = parseExp(scanner, &arena);
+            results.add(to_string(exp->eval(context)));
+        } catch (ErrorException & ex) {
+            results.add("Error: " + ex.getMessage());
+        }
+    }
+    ms = elapsedMs(start);
+}
+
+/*
+ * Function: runScript
+ * Usage: runScript(text, nThreads, results, readMs, runMs, nLevels);
+ * -----------------------------------------------------------------
+ * Does the same work as runByLine with a Script that reads and runs on
+ * nThreads threads, storing the time to read the script in readMs, the
+ * time to run it in runMs, and the number of levels in nLevels.
+ */
+
+void runScript(const string & text, int nThreads, Vector<string> & results,
+               double & readMs, double & runMs, int & nLevels) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    istringstream infile(text);
+    EvaluationContext context;
+    Script script(context);
+    script.read(infile, nThreads);
+    readMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    script.run(nThreads);
+    runMs = elapsedMs(start);
+    for (int i = 0; i < script.size(); i++) {
+        if (script.hasError(i)) {
+            results.add("Error: " + script.getError(i));
+        } else {
+            results.add(to_string(script.getValue(i)));
+        }
+    }
+    nLevels = script.getLevelCount();
+}
+
+/*
+ * Function: reportScript
+ * Usage: reportScript(label, readMs, runMs, lineMs);
+ * --------------------------------------------------
+ * Prints the times for one run of a Script, from reading the text to
+ * the end of the run, and compares the total with the time lineMs that
+ * the interactive loop takes.
+ */
+
+void reportScript(string label, double readMs, double runMs, double lineMs) {
+    double totalMs = readMs + runMs;
+    cout << "  " << label << ": " << readMs << " ms reading + " << runMs
+         << " ms running = " << totalMs << " ms (" << lineMs / totalMs
+         << "x faster than one line at a time)" << endl;
+}
+
+/*
+ * Function: sameResults
+ * Usage: if (sameResults(r1, r2)) . . .
+ * -------------------------------------
+ * Returns true if the two runs produced the same results.
+ */
+
+bool sameResults(const Vector<string> & r1, const Vector<string> & r2) {
+    if (r1.size() != r2.size()) return false;
+    for (int i = 0; i < r1.size(); i++) {
+        if (r1[i] != r2[i]) return false;
+    }
+    return true;
+}
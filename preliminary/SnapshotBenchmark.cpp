@@ -0,0 +1,74 @@
+/*
+ * File: SnapshotBenchmark.cpp
+ * ---------------------------
+ * This program compares the time it takes to make a graph ready for
+ * queries from an edge-list text file and from a binary snapshot. It
+ * loads the text file, writes a snapshot next to it, and then times
+ * loading each one followed by a first query.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "compactgraph.h"
+#include "graphloader.h"
+#include "timer.h"
+using namespace std;
+
+/* Function prototypes */
+
+int firstQuery(CompactGraph & g, string name);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        cerr << "Usage: SnapshotBenchmark edgelist [snapshot]" << endl;
+        return 1;
+    }
+    string textFile = argv[1];
+    string snapshotFile = (argc > 2) ? argv[2] : textFile + ".snapshot";
+    CompactGraph text;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    loadEdgeList(textFile, text);
+    if (text.size() == 0) {
+        cerr << textFile << " contains no nodes" << endl;
+        return 1;
+    }
+    string name(text.getName(text.size() - 1));
+    int degree = firstQuery(text, name);
+    double textMs = elapsedMs(start);
+    text.save(snapshotFile);
+
+    CompactGraph binary;
+    start = chrono::steady_clock::now();
+    binary.load(snapshotFile);
+    int snapshotDegree = firstQuery(binary, name);
+    double snapshotMs = elapsedMs(start);
+    if (snapshotDegree != degree) cerr << "Query results differ!" << endl;
+
+    cout << text.size() << " nodes, " << text.getArcCount() << " arcs"
+         << endl;
+    cout << "text edge list:  " << textMs << " ms to first query" << endl;
+    cout << "binary snapshot: " << snapshotMs << " ms to first query" << endl;
+    return 0;
+}
+
+/*
+ * Function: firstQuery
+ * Usage: int degree = firstQuery(g, name);
+ * ----------------------------------------
+ * Looks up a node by name and returns the sum of its out-degree and
+ * the out-degrees of its neighbors, which touches every part of the
+ * data structure at least once.
+ */
+
+int firstQuery(CompactGraph & g, string name) {
+    int node = g.getNodeId(name);
+    int total = 0;
+    for (int a = g.getArcBegin(node); a < g.getArcEnd(node); a++) {
+        int finish = g.getFinish(a);
+        total += 1 + g.getArcEnd(finish) - g.getArcBegin(finish);
+    }
+    return total;
+}
@@ -0,0 +1,190 @@
+/*
+ * File: StreamScannerBenchmark.cpp
+ * --------------------------------
+ * This program writes a large file of formulas and divides it into
+ * tokens in four ways: streaming from a file descriptor, streaming from
+ * an ifstream, mapping the file with MappedFile and borrowing the mapped
+ * characters, and reading the whole file into a string. After each one
+ * it reports the peak resident memory of the process, which shows that
+ * the streaming methods need only their fixed window however large the
+ * file is. The methods that hold the whole file run last, since the peak
+ * can only grow. The program checks that every method sees the same
+ * tokens. The command line may give the size of the file in megabytes.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+#include "error.h"
+#include "mappedfile.h"
+#include "random.h"
+#include "timer.h"
+#include "tokenscanner.h"
+using namespace std;
+
+/* Constants */
+
+const int DEFAULT_MEGABYTES = 256;
+const string FILENAME = "StreamScannerBenchmark.tmp";
+
+const string NAMES[] = {
+    "x", "rate", "total", "price", "quantity", "discount", "tax", "y2"
+};
+const int N_NAMES = sizeof NAMES / sizeof NAMES[0];
+const string OPERATORS = "+-*/";
+
+/* Function prototypes */
+
+void writeInput(string filename, long nBytes);
+long scanTokens(TokenScanner & scanner, long & checksum);
+void report(string method, long nTokens, double ms, long nBytes);
+long peakMegabytes();
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    int megabytes = (argc > 1) ? atoi(argv[1]) : DEFAULT_MEGABYTES;
+    long nBytes = (long) megabytes << 20;
+    writeInput(FILENAME, nBytes);
+    cout << "Input: " << nBytes << " bytes, peak memory "
+         << peakMegabytes() << " MB" << endl;
+    long counts[4], sums[4];
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int fd = open(FILENAME.c_str(), O_RDONLY);
+    if (fd < 0) error("Can't open " + FILENAME);
+    {
+        TokenScanner scanner;
+        scanner.setInputDescriptor(fd);
+        counts[0] = scanTokens(scanner, sums[0]);
+    }
+    close(fd);
+    report("setInputDescriptor", counts[0], elapsedMs(start), nBytes);
+    start = chrono::steady_clock::now();
+    {
+        ifstream infile(FILENAME.c_str());
+        TokenScanner scanner;
+        scanner.setInput(infile);
+        counts[1] = scanTokens(scanner, sums[1]);
+    }
+    report("setInput(istream)", counts[1], elapsedMs(start), nBytes);
+    start = chrono::steady_clock::now();
+    {
+        MappedFile file(FILENAME);
+        TokenScanner scanner;
+        scanner.borrowInput(string_view(file.getData(), file.size()));
+        counts[2] = scanTokens(scanner, sums[2]);
+    }
+    report("MappedFile and borrowInput", counts[2], elapsedMs(start), nBytes);
+    start = chrono::steady_clock::now();
+    {
+        ifstream infile(FILENAME.c_str());
+        ostringstream contents;
+        contents << infile.rdbuf();
+        TokenScanner scanner;
+        scanner.setInput(contents.str());
+        counts[3] = scanTokens(scanner, sums[3]);
+    }
+    report("whole file and setInput", counts[3], elapsedMs(start), nBytes);
+    remove(FILENAME.c_str());
+    for (int i = 1; i < 4; i++) {
+        if (counts[i] != counts[0] || sums[i] != sums[0]) {
+            cout << "Token streams differ" << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Function: writeInput
+ * Usage: writeInput(filename, nBytes);
+ * ------------------------------------
+ * Writes a file of at least nBytes characters containing assignment
+ * statements, one per line, built from random names and numbers. The
+ * file is written a line at a time, so that the program never holds it
+ * in memory.
+ */
+
+void writeInput(string filename, long nBytes) {
+    ofstream outfile(filename.c_str());
+    if (outfile.fail()) error("Can't write " + filename);
+    long length = 0;
+    while (length < nBytes) {
+        string line = NAMES[randomInteger(0, N_NAMES - 1)] + " = ";
+        int nTerms = randomInteger(1, 6);
+        for (int i = 0; i < nTerms; i++) {
+            if (i > 0) {
+                line += " ";
+                line += OPERATORS[randomInteger(0, OPERATORS.length() - 1)];
+                line += " ";
+            }
+            if (randomChance(0.5)) {
+                line += NAMES[randomInteger(0, N_NAMES - 1)];
+            } else if (randomChance(0.5)) {
+                line += to_string(randomInteger(0, 99999));
+            } else {
+                line += to_string(randomInteger(0, 999)) + ".5e-3";
+            }
+        }
+        line += "\n";
+        outfile << line;
+        length += line.length();
+    }
+}
+
+/*
+ * Function: scanTokens
+ * Usage: long nTokens = scanTokens(scanner, checksum);
+ * ----------------------------------------------------
+ * Reads every token from the scanner and returns the number of tokens.
+ * The checksum combines the lengths of the tokens and their first
+ * characters, so that the methods can be compared.
+ */
+
+long scanTokens(TokenScanner & scanner, long & checksum) {
+    scanner.ignoreWhitespace();
+    scanner.scanNumbers();
+    long nTokens = 0;
+    checksum = 0;
+    while (true) {
+        Token token = scanner.readToken();
+        if (token.type == END_OF_INPUT) break;
+        checksum += token.text.length() * 31 + token.text[0];
+        nTokens++;
+    }
+    return nTokens;
+}
+
+/*
+ * Function: report
+ * Usage: report(method, nTokens, ms, nBytes);
+ * -------------------------------------------
+ * Displays the throughput of one method and the peak memory so far.
+ */
+
+void report(string method, long nTokens, double ms, long nBytes) {
+    cout << method << ": " << nTokens << " tokens in " << ms << " ms" << endl;
+    cout << "  " << nTokens / ms / 1000 << " million tokens/sec, "
+         << nBytes / ms / 1000 << " MB/sec, peak memory "
+         << peakMegabytes() << " MB" << endl;
+}
+
+/*
+ * Function: peakMegabytes
+ * Usage: long mb = peakMegabytes();
+ * ---------------------------------
+ * Returns the peak resident memory of the process in megabytes.
+ */
+
+long peakMegabytes() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024;
+}
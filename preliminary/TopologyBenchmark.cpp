@@ -0,0 +1,277 @@
+/*
+ * File: TopologyBenchmark.cpp
+ * ---------------------------
+ * This program times the functions in topology.h on a random dependency
+ * graph and checks their results. Every node depends on the next one, so
+ * the graph contains a path through all of its nodes, which would
+ * overflow the call stack of any recursive search. The program first
+ * runs on the graph as built, which has no cycles, and then adds some
+ * arcs that lead backward and runs again. The command line may give the
+ * number of nodes and the number of arcs per node; the default graph has
+ * a million nodes and ten million arcs, and "10000000 10" gives a graph
+ * with a hundred million arcs.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include "compactgraph.h"
+#include "interner.h"
+#include "random.h"
+#include "strlib.h" // From Stanford libraries
+#include "timer.h"
+#include "topology.h"
+#include "vector.h"
+using namespace std;
+
+/* Constants */
+
+const int DEFAULT_NODES = 1000000;
+const int DEFAULT_ARCS_PER_NODE = 10;
+const int WINDOW = 1000;            // Longest jump made by a random arc
+const int BACK_ARC_FRACTION = 1000; // One node in this many gets a back arc
+
+/* Function prototypes */
+
+void buildDependencyGraph(CompactGraph & g, int nNodes, int arcsPerNode,
+                          bool addBackArcs);
+bool runTests(const CompactGraph & g, bool acyclic);
+bool checkOrder(const CompactGraph & g, const Vector<int> & order);
+bool checkComponents(const CompactGraph & g, const Vector<int> & component,
+                     int count);
+bool sameDivision(const Vector<int> & c1, const Vector<int> & c2, int count);
+bool checkCycle(const CompactGraph & g, const Vector<int> & cycle);
+void report(string label, double ms, const TraversalStats & stats);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    int nNodes = (argc > 1) ? atoi(argv[1]) : DEFAULT_NODES;
+    int arcsPerNode = (argc > 2) ? atoi(argv[2]) : DEFAULT_ARCS_PER_NODE;
+    bool ok = true;
+    for (int pass = 0; pass < 2; pass++) {
+        CompactGraph g;
+        buildDependencyGraph(g, nNodes, arcsPerNode, pass == 1);
+        long graphBytes = (long) (g.size() + 1) * sizeof(int)
+                        + (long) g.getArcCount() * (sizeof(int)
+                                                    + sizeof(double));
+        cout << g.size() << " nodes, " << g.getArcCount() << " arcs, "
+             << graphBytes / (1024 * 1024) << " MB"
+             << ((pass == 0) ? ", no cycles" : ", with back arcs") << endl;
+        if (!runTests(g, pass == 0)) ok = false;
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    cout << "Peak resident memory: " << usage.ru_maxrss / 1024 << " MB"
+         << endl;
+    cout << (ok ? "All checks passed" : "CHECKS FAILED") << endl;
+    return ok ? 0 : 1;
+}
+
+/*
+ * Function: buildDependencyGraph
+ * Usage: buildDependencyGraph(g, nNodes, arcsPerNode, addBackArcs);
+ * -----------------------------------------------------------------
+ * Builds a graph in which each node has an arc to the next node and the
+ * rest of its arcs to random nodes a short way ahead of it. If
+ * addBackArcs is true, a few nodes also get an arc to a node a short way
+ * behind, which creates cycles.
+ */
+
+void buildDependencyGraph(CompactGraph & g, int nNodes, int arcsPerNode,
+                          bool addBackArcs) {
+    StringInterner names;
+    for (int i = 0; i < nNodes; i++) {
+        names.intern(integerToString(i));
+    }
+    int maxArcs = nNodes * arcsPerNode + nNodes / BACK_ARC_FRACTION;
+    int *starts = new int[maxArcs];
+    int *finishes = new int[maxArcs];
+    double *costs = new double[maxArcs];
+    int nArcs = 0;
+    for (int v = 0; v < nNodes - 1; v++) {
+        starts[nArcs] = v;
+        finishes[nArcs++] = v + 1;
+        for (int i = 1; i < arcsPerNode; i++) {
+            int w = v + randomInteger(1, WINDOW);
+            if (w >= nNodes) w = nNodes - 1;
+            starts[nArcs] = v;
+            finishes[nArcs++] = w;
+        }
+        if (addBackArcs && v % BACK_ARC_FRACTION == BACK_ARC_FRACTION - 1) {
+            int w = v - randomInteger(1, WINDOW);
+            starts[nArcs] = v;
+            finishes[nArcs++] = (w < 0) ? 0 : w;
+        }
+    }
+    for (int a = 0; a < nArcs; a++) {
+        costs[a] = 1;
+    }
+    g.build(names, nArcs, starts, finishes, costs);
+    delete[] starts;
+    delete[] finishes;
+    delete[] costs;
+}
+
+/*
+ * Function: runTests
+ * Usage: bool ok = runTests(g, acyclic);
+ * --------------------------------------
+ * Runs each function in topology.h on g, reports its time and memory,
+ * and checks the results. The acyclic parameter indicates whether g is
+ * known to have no cycles.
+ */
+
+bool runTests(const CompactGraph & g, bool acyclic) {
+    bool ok = true;
+    TraversalStats stats;
+    Vector<int> order;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    bool sorted = topologicalSort(g, order, &stats);
+    report("Kahn topological sort", elapsedMs(start), stats);
+    if (sorted != acyclic || (sorted && !checkOrder(g, order))) {
+        cout << "  Topological sort is wrong" << endl;
+        ok = false;
+    }
+
+    Vector<int> tarjanComponents, kosarajuComponents;
+    start = chrono::steady_clock::now();
+    int nTarjan = stronglyConnectedComponents(g, tarjanComponents, TARJAN,
+                                              &stats);
+    report("Tarjan SCC", elapsedMs(start), stats);
+    start = chrono::steady_clock::now();
+    int nKosaraju = stronglyConnectedComponents(g, kosarajuComponents,
+                                                KOSARAJU, &stats);
+    report("Kosaraju SCC", elapsedMs(start), stats);
+    cout << "  " << nTarjan << " components" << endl;
+    if ((acyclic && nTarjan != g.size()) || nTarjan != nKosaraju
+            || !checkComponents(g, tarjanComponents, nTarjan)
+            || !checkComponents(g, kosarajuComponents, nKosaraju)
+            || !sameDivision(tarjanComponents, kosarajuComponents, nTarjan)) {
+        cout << "  Components are wrong" << endl;
+        ok = false;
+    }
+
+    start = chrono::steady_clock::now();
+    bool cyclic = hasCycle(g);
+    cout << "  hasCycle: " << elapsedMs(start) << " ms" << endl;
+    Vector<int> cycle;
+    start = chrono::steady_clock::now();
+    bool found = findCycle(g, cycle, &stats);
+    report("findCycle", elapsedMs(start), stats);
+    if (found) cout << "  Cycle of " << cycle.size() << " nodes" << endl;
+    if (cyclic == acyclic || found == acyclic
+            || (found && !checkCycle(g, cycle))) {
+        cout << "  Cycle detection is wrong" << endl;
+        ok = false;
+    }
+    return ok;
+}
+
+/*
+ * Function: checkOrder
+ * Usage: if (checkOrder(g, order)) . . .
+ * --------------------------------------
+ * Returns true if order contains every node once and every arc of g
+ * leads forward in it.
+ */
+
+bool checkOrder(const CompactGraph & g, const Vector<int> & order) {
+    if (order.size() != g.size()) return false;
+    int *position = new int[g.size()];
+    for (int v = 0; v < g.size(); v++) {
+        position[v] = -1;
+    }
+    for (int i = 0; i < order.size(); i++) {
+        position[order[i]] = i;
+    }
+    bool ok = true;
+    for (int v = 0; v < g.size() && ok; v++) {
+        for (int a = g.getArcBegin(v); a < g.getArcEnd(v); a++) {
+            if (position[v] < 0 || position[v] >= position[g.getFinish(a)]) {
+                ok = false;
+            }
+        }
+    }
+    delete[] position;
+    return ok;
+}
+
+/*
+ * Function: checkComponents
+ * Usage: if (checkComponents(g, component, count)) . . .
+ * ------------------------------------------------------
+ * Returns true if every component number is in range and no arc leads
+ * from a component to a lower-numbered one.
+ */
+
+bool checkComponents(const CompactGraph & g, const Vector<int> & component,
+                     int count) {
+    for (int v = 0; v < g.size(); v++) {
+        if (component[v] < 0 || component[v] >= count) return false;
+        for (int a = g.getArcBegin(v); a < g.getArcEnd(v); a++) {
+            if (component[g.getFinish(a)] < component[v]) return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Function: sameDivision
+ * Usage: if (sameDivision(c1, c2, count)) . . .
+ * ---------------------------------------------
+ * Returns true if the two numberings put the same nodes together, which
+ * is the case if each number in one always appears with the same number
+ * in the other.
+ */
+
+bool sameDivision(const Vector<int> & c1, const Vector<int> & c2,
+                  int count) {
+    int *match = new int[count];
+    for (int c = 0; c < count; c++) {
+        match[c] = -1;
+    }
+    bool ok = true;
+    for (int v = 0; v < c1.size() && ok; v++) {
+        if (match[c1[v]] < 0) match[c1[v]] = c2[v];
+        if (match[c1[v]] != c2[v]) ok = false;
+    }
+    delete[] match;
+    return ok;
+}
+
+/*
+ * Function: checkCycle
+ * Usage: if (checkCycle(g, cycle)) . . .
+ * --------------------------------------
+ * Returns true if each node of cycle has an arc to the next one and the
+ * last has an arc to the first.
+ */
+
+bool checkCycle(const CompactGraph & g, const Vector<int> & cycle) {
+    for (int i = 0; i < cycle.size(); i++) {
+        int v = cycle[i];
+        int w = cycle[(i + 1) % cycle.size()];
+        bool found = false;
+        for (int a = g.getArcBegin(v); a < g.getArcEnd(v); a++) {
+            if (g.getFinish(a) == w) found = true;
+        }
+        if (!found) return false;
+    }
+    return cycle.size() > 0;
+}
+
+/*
+ * Function: report
+ * Usage: report(label, ms, stats);
+ * --------------------------------
+ * Displays the time and memory use of one function.
+ */
+
+void report(string label, double ms, const TraversalStats & stats) {
+    cout << "  " << label << ": " << ms << " ms, "
+         << stats.workspaceBytes / (1024 * 1024) << " MB workspace, depth "
+         << stats.maxDepth << endl;
+}
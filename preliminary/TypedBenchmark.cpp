@@ -0,0 +1,201 @@
+/*
+ * File: TypedBenchmark.cpp
+ * ------------------------
+ * This program compares the value types that TypedProgram supports with
+ * the int arithmetic of the expression tree and of BytecodeProgram. Each
+ * formula is evaluated many times with inputs large enough that the
+ * products overflow an int, and the program reports the time for each
+ * type and whether the int versions lost the results. The int64_t and
+ * CheckedInt versions must agree. The last formula overflows even 64
+ * bits, which the int64_t version does silently and the CheckedInt
+ * version reports as an error. The command line may give the number of
+ * evaluations.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "bytecode.h"
+#include "checkedint.h"
+#include "error.h"
+#include "exp.h"
+#include "parser.h"
+#include "timer.h"
+#include "tokenscanner.h"
+#include "typedprogram.h"
+using namespace std;
+
+/* Constants */
+
+const int DEFAULT_EVALUATIONS = 5000000;
+
+const string FORMULAS[] = {
+    "a * b + c * d",
+    "(a + b) * (c - d) / (e + 1) + a * b - c",
+    "y = (a * 3 + b * 5 - c * 7) * (d + 1) / (e + 1) - a * e",
+    "a * b * c * d * e",
+};
+const int N_FORMULAS = sizeof FORMULAS / sizeof FORMULAS[0];
+const string INPUTS[] = { "a", "b", "c", "d", "e" };
+const int N_INPUTS = sizeof INPUTS / sizeof INPUTS[0];
+
+/* Function prototypes */
+
+long timeTree(Expression *exp, int n, double & ms);
+long timeBytecode(BytecodeProgram & program, int n, double & ms);
+template <typename ValueType>
+ValueType timeTyped(Expression *exp, int n, double & ms);
+int inputValue(int input, int i);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : DEFAULT_EVALUATIONS;
+    bool ok = true;
+    for (int f = 0; f < N_FORMULAS; f++) {
+        TokenScanner scanner;
+        scanner.ignoreWhitespace();
+        scanner.scanNumbers();
+        scanner.setInput(FORMULAS[f]);
+        Expression *exp = parseExp(scanner);
+        BytecodeProgram program(exp);
+        double treeMs, vmMs, wideMs, realMs, checkedMs;
+        long treeSum = timeTree(exp, n, treeMs);
+        long vmSum = timeBytecode(program, n, vmMs);
+        int64_t wideSum = timeTyped<int64_t>(exp, n, wideMs);
+        double realSum = timeTyped<double>(exp, n, realMs);
+        cout << FORMULAS[f] << endl;
+        cout << "  tree, int: " << treeMs << " ms, sum " << treeSum << endl;
+        cout << "  bytecode, int: " << vmMs << " ms, sum " << vmSum << endl;
+        cout << "  typed, int64_t: " << wideMs << " ms, sum " << wideSum
+             << endl;
+        cout << "  typed, double: " << realMs << " ms, sum " << realSum
+             << endl;
+        try {
+            CheckedInt checkedSum = timeTyped<CheckedInt>(exp, n, checkedMs);
+            cout << "  typed, CheckedInt: " << checkedMs << " ms, sum "
+                 << checkedSum << endl;
+            if (checkedSum != wideSum) {
+                cout << "  Results differ" << endl;
+                ok = false;
+            }
+        } catch (ErrorException & ex) {
+            cout << "  typed, CheckedInt: " << ex.getMessage() << endl;
+        }
+        if (treeSum != vmSum) {
+            cout << "  Results differ" << endl;
+            ok = false;
+        }
+        if (treeSum != wideSum) {
+            cout << "  The int results overflowed" << endl;
+        }
+        delete exp;
+    }
+    return ok ? 0 : 1;
+}
+
+/*
+ * Function: timeTree
+ * Usage: long sum = timeTree(exp, n, ms);
+ * ---------------------------------------
+ * Evaluates the tree n times, changing the inputs by slot each time, and
+ * returns the sum of the results. The elapsed time is stored in ms.
+ */
+
+long timeTree(Expression *exp, int n, double & ms) {
+    EvaluationContext context;
+    int inputSlots[N_INPUTS];
+    for (int k = 0; k < N_INPUTS; k++) {
+        inputSlots[k] = context.getSlot(INPUTS[k]);
+    }
+    exp->bind(context);
+    long sum = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < N_INPUTS; k++) {
+            context.setValue(inputSlots[k], inputValue(k, i));
+        }
+        sum += exp->eval(context);
+    }
+    ms = elapsedMs(start);
+    return sum;
+}
+
+/*
+ * Function: timeBytecode
+ * Usage: long sum = timeBytecode(program, n, ms);
+ * -----------------------------------------------
+ * Does the same work as timeTree using the int bytecode.
+ */
+
+long timeBytecode(BytecodeProgram & program, int n, double & ms) {
+    int *slots = new int[program.getSlotCount()];
+    int inputSlots[N_INPUTS];
+    for (int k = 0; k < N_INPUTS; k++) {
+        inputSlots[k] = program.getSlot(INPUTS[k]);
+    }
+    long sum = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < N_INPUTS; k++) {
+            if (inputSlots[k] >= 0) slots[inputSlots[k]] = inputValue(k, i);
+        }
+        sum += program.execute(slots);
+    }
+    ms = elapsedMs(start);
+    delete[] slots;
+    return sum;
+}
+
+/*
+ * Function: timeTyped
+ * Usage: ValueType sum = timeTyped<ValueType>(exp, n, ms);
+ * --------------------------------------------------------
+ * Does the same work with a TypedProgram for the specified value type,
+ * adding up the results with the arithmetic of that type. Any error in
+ * the arithmetic is passed on to the caller.
+ */
+
+template <typename ValueType>
+ValueType timeTyped(Expression *exp, int n, double & ms) {
+    typedef ValueTraits<ValueType> Traits;
+    TypedProgram<ValueType> program(exp);
+    ValueType *slots = new ValueType[program.getSlotCount()];
+    int inputSlots[N_INPUTS];
+    for (int k = 0; k < N_INPUTS; k++) {
+        inputSlots[k] = program.getSlot(INPUTS[k]);
+    }
+    ValueType sum = ValueType(0);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    try {
+        for (int i = 0; i < n; i++) {
+            for (int k = 0; k < N_INPUTS; k++) {
+                if (inputSlots[k] >= 0) {
+                    slots[inputSlots[k]] = ValueType(inputValue(k, i));
+                }
+            }
+            sum = Traits::add(sum, program.execute(slots));
+        }
+    } catch (...) {
+        delete[] slots;
+        throw;
+    }
+    ms = elapsedMs(start);
+    delete[] slots;
+    return sum;
+}
+
+/*
+ * Function: inputValue
+ * Usage: int value = inputValue(input, i);
+ * ----------------------------------------
+ * Returns the value of the specified input on evaluation i. The values
+ * run up to 100000, so that the product of two of them overflows an int
+ * but the sum of many such products still fits in 64 bits.
+ */
+
+int inputValue(int input, int i) {
+    return (i * (2 * input + 1) + 7919 * input) % 100000 + 1;
+}
@@ -0,0 +1,147 @@
+/*
+ * File: VMBenchmark.cpp
+ * ---------------------
+ * This program compares two ways of evaluating the same formula many
+ * times with changing inputs: walking the expression tree with eval and
+ * running the bytecode produced by BytecodeProgram. The tree is timed
+ * twice, first storing each new input in the EvaluationContext by name,
+ * as the interpreter does, and then storing it by slot; the bytecode
+ * version stores it directly in the variable's slot. The program checks
+ * that all three give the same results. The command line may give the
+ * number of evaluations.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "bytecode.h"
+#include "error.h"
+#include "exp.h"
+#include "parser.h"
+#include "timer.h"
+#include "tokenscanner.h"
+using namespace std;
+
+/* Constants */
+
+const int DEFAULT_EVALUATIONS = 5000000;
+
+const string FORMULAS[] = {
+    "a + b",
+    "(a + b) * (c - d) / (e + 1) + a * b - c",
+    "y = (a * 3 + b * 5 - c * 7) / (d * d + 1) + (e - a) * (e + b) - 42",
+};
+const int N_FORMULAS = sizeof FORMULAS / sizeof FORMULAS[0];
+const string INPUTS[] = { "a", "b", "c", "d", "e" };
+const int N_INPUTS = sizeof INPUTS / sizeof INPUTS[0];
+
+/* Function prototypes */
+
+long timeTree(Expression *exp, int n, bool bySlot, double & ms);
+long timeBytecode(BytecodeProgram & program, int n, double & ms);
+int inputValue(int input, int i);
+
+/* Main program */
+
+int main(int argc, char *argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : DEFAULT_EVALUATIONS;
+    bool ok = true;
+    for (int f = 0; f < N_FORMULAS; f++) {
+        TokenScanner scanner;
+        scanner.ignoreWhitespace();
+        scanner.scanNumbers();
+        scanner.setInput(FORMULAS[f]);
+        Expression *exp = parseExp(scanner);
+        BytecodeProgram program(exp);
+        double treeMs, slotMs, vmMs;
+        long treeSum = timeTree(exp, n, false, treeMs);
+        long slotSum = timeTree(exp, n, true, slotMs);
+        long vmSum = timeBytecode(program, n, vmMs);
+        cout << FORMULAS[f] << endl;
+        cout << "  tree, inputs by name: " << treeMs << " ms ("
+             << 1e6 * treeMs / n << " ns each)" << endl;
+        cout << "  tree, inputs by slot: " << slotMs << " ms ("
+             << 1e6 * slotMs / n << " ns each)" << endl;
+        cout << "  bytecode: " << vmMs << " ms (" << 1e6 * vmMs / n
+             << " ns each), " << slotMs / vmMs << "x faster" << endl;
+        if (treeSum != vmSum || slotSum != vmSum) {
+            cout << "  Results differ" << endl;
+            ok = false;
+        }
+        delete exp;
+    }
+    return ok ? 0 : 1;
+}
+
+/*
+ * Function: timeTree
+ * Usage: long sum = timeTree(exp, n, bySlot, ms);
+ * -----------------------------------------------
+ * Evaluates the tree n times, changing the inputs each time, and returns
+ * the sum of the results. The inputs are set by name unless bySlot is
+ * true, in which case their slots are looked up once, before the loop.
+ * The elapsed time is stored in ms.
+ */
+
+long timeTree(Expression *exp, int n, bool bySlot, double & ms) {
+    EvaluationContext context;
+    int inputSlots[N_INPUTS];
+    for (int k = 0; k < N_INPUTS; k++) {
+        inputSlots[k] = context.getSlot(INPUTS[k]);
+    }
+    exp->bind(context);
+    long sum = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < N_INPUTS; k++) {
+            if (bySlot) {
+                context.setValue(inputSlots[k], inputValue(k, i));
+            } else {
+                context.setValue(INPUTS[k], inputValue(k, i));
+            }
+        }
+        sum += exp->eval(context);
+    }
+    ms = elapsedMs(start);
+    return sum;
+}
+
+/*
+ * Function: timeBytecode
+ * Usage: long sum = timeBytecode(program, n, ms);
+ * -----------------------------------------------
+ * Does the same work as timeTree using the compiled program. The slots
+ * of the inputs are looked up once, before the loop.
+ */
+
+long timeBytecode(BytecodeProgram & program, int n, double & ms) {
+    int *slots = new int[program.getSlotCount()];
+    int inputSlots[N_INPUTS];
+    for (int k = 0; k < N_INPUTS; k++) {
+        inputSlots[k] = program.getSlot(INPUTS[k]);
+    }
+    long sum = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < N_INPUTS; k++) {
+            if (inputSlots[k] >= 0) slots[inputSlots[k]] = inputValue(k, i);
+        }
+        sum += program.execute(slots);
+    }
+    ms = elapsedMs(start);
+    delete[] slots;
+    return sum;
+}
+
+/*
+ * Function: inputValue
+ * Usage: int value = inputValue(input, i);
+ * ----------------------------------------
+ * Returns the value of the specified input on evaluation i. The values
+ * are small, so that no formula overflows.
+ */
+
+int inputValue(int input, int i) {
+    return (i * (2 * input + 1) + input) % 1000;
+}
@@ -0,0 +1,156 @@
+/*
+ * File: arena.cpp
+ * ---------------
+ * This file implements the arena.h interface.
+ */
+
+#include <cstring>
+#include <new>
+#include <string_view>
+#include "arena.h"
+#include "exp.h"
+using namespace std;
+
+/*
+ * Implementation notes: constructor and destructor
+ * ------------------------------------------------
+ * The destructor frees the blocks without calling the destructors of
+ * the nodes, none of which owns any storage outside the arena.
+ */
+
+ExpressionArena::ExpressionArena() {
+    blocks = NULL;
+    nNodes = 0;
+    nBytes = 0;
+    nBlocks = 0;
+}
+
+ExpressionArena::~ExpressionArena() {
+    while (blocks != NULL) {
+        Block *next = blocks->link;
+        ::operator delete(blocks->array);
+        delete blocks;
+        blocks = next;
+    }
+}
+
+/*
+ * Implementation notes: newConstant, newIdentifier, newCompound
+ * -------------------------------------------------------------
+ * Each method constructs the node in memory taken from the arena. The
+ * characters of an identifier are copied just after the node.
+ */
+
+Expression *ExpressionArena::newConstant(int value) {
+    void *mem = allocate(sizeof(ConstantExp), alignof(ConstantExp));
+    nNodes++;
+    return new (mem) ConstantExp(value);
+}
+
+Expression *ExpressionArena::newIdentifier(string_view name) {
+    void *mem = allocate(sizeof(IdentifierExp), alignof(IdentifierExp));
+    char *chars = static_cast<char *>(allocate(name.length(), 1));
+    memcpy(chars, name.data(), name.length());
+    nNodes++;
+    return new (mem) IdentifierExp(chars, name.length());
+}
+
+Expression *ExpressionArena::newCompound(OperatorType op, Expression *lhs,
+                                         Expression *rhs) {
+    void *mem = allocate(sizeof(CompoundExp), alignof(CompoundExp));
+    nNodes++;
+    return new (mem) CompoundExp(op, lhs, rhs);
+}
+
+/*
+ * Implementation notes: clear
+ * ---------------------------
+ * The clear method keeps the largest block and frees the rest. The head
+ * block is usually the largest, since each new block is at least as
+ * large as the one before it, but a request too big for MAX_BLOCK_SIZE
+ * gets a block of its own that may be followed by smaller ones. Once the
+ * nodes of one formula fit in a single block, the loop frees nothing.
+ */
+
+void ExpressionArena::clear() {
+    if (blocks == NULL) return;
+    Block *largest = blocks;
+    for (Block *bp = blocks->link; bp != NULL; bp = bp->link) {
+        if (bp->capacity > largest->capacity) largest = bp;
+    }
+    Block *bp = blocks;
+    while (bp != NULL) {
+        Block *next = bp->link;
+        if (bp != largest) {
+            ::operator delete(bp->array);
+            delete bp;
+        }
+        bp = next;
+    }
+    blocks = largest;
+    blocks->link = NULL;
+    blocks->used = 0;
+    nNodes = 0;
+    nBytes = 0;
+    nBlocks = 1;
+}
+
+int ExpressionArena::size() const {
+    return nNodes;
+}
+
+long ExpressionArena::getBytesUsed() const {
+    return nBytes;
+}
+
+int ExpressionArena::getBlockCount() const {
+    return nBlocks;
+}
+
+/*
+ * Private method: allocate
+ * Usage: void *mem = allocate(size, alignment);
+ * ---------------------------------------------
+ * Returns size bytes from the head block, aligned to a multiple of
+ * alignment, which must be a power of two. A new block is added if the
+ * head block has too little room left.
+ */
+
+void *ExpressionArena::allocate(long size, long alignment) {
+    long offset = 0;
+    if (blocks != NULL) {
+        offset = (blocks->used + alignment - 1) & ~(alignment - 1);
+    }
+    if (blocks == NULL || offset + size > blocks->capacity) {
+        addBlock(size);
+        offset = 0;
+    }
+    nBytes += offset + size - blocks->used;
+    blocks->used = offset + size;
+    return blocks->array + offset;
+}
+
+/*
+ * Private method: addBlock
+ * Usage: addBlock(size);
+ * ----------------------
+ * Allocates a block with room for at least size bytes and pushes it on
+ * the front of the list. Storage from operator new is aligned for any
+ * node.
+ */
+
+void ExpressionArena::addBlock(long size) {
+    long capacity = INITIAL_BLOCK_SIZE;
+    if (blocks != NULL) {
+        capacity = 2 * blocks->capacity;
+        if (capacity > MAX_BLOCK_SIZE) capacity = MAX_BLOCK_SIZE;
+    }
+    if (capacity < size) capacity = size;
+    Block *bp = new Block;
+    bp->array = static_cast<char *>(::operator new(capacity));
+    bp->capacity = capacity;
+    bp->used = 0;
+    bp->link = blocks;
+    blocks = bp;
+    nBlocks++;
+}
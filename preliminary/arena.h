@@ -0,0 +1,155 @@
+/*
+ * File: arena.h
+ * -------------
+ * This interface exports the ExpressionArena class, which allocates the
+ * nodes of expression trees from large blocks of memory that are released
+ * all at once.
+ */
+
+#ifndef _arena_h
+#define _arena_h
+
+#include <cstddef>
+#include <string_view>
+#include "exp.h"
+
+/*
+ * Class: ExpressionArena
+ * ----------------------
+ * This class creates expression nodes by bumping a pointer through a
+ * block of memory, so that building a tree makes no call to the heap in
+ * the usual case. The nodes are never deleted individually; clear
+ * releases every node in the arena at once, without visiting the nodes.
+ * A program that parses and evaluates one formula at a time can keep a
+ * single arena and clear it before each formula:
+ *
+ *      ExpressionArena arena;
+ *      while (. . . another formula . . .) {
+ *          arena.clear();
+ *          Expression *exp = parseExp(scanner, &arena);
+ *          . . . evaluate exp . . .
+ *      }
+ *
+ * The nodes are ordinary Expression objects, so any code that reads a
+ * tree works on one built in an arena. A tree in an arena must never be
+ * passed to delete, and it must not contain nodes created with new.
+ */
+
+class ExpressionArena {
+
+public:
+
+/*
+ * Constructor: ExpressionArena
+ * Usage: ExpressionArena arena;
+ * -----------------------------
+ * Initializes an empty arena. No block is allocated until the first node
+ * is created.
+ */
+
+    ExpressionArena();
+
+/*
+ * Destructor: ~ExpressionArena
+ * ----------------------------
+ * Frees every block held by the arena, which releases all of its nodes.
+ */
+
+    ~ExpressionArena();
+
+/*
+ * Methods: newConstant, newIdentifier, newCompound
+ * Usage: Expression *exp = arena.newConstant(value);
+ *        Expression *exp = arena.newIdentifier(name);
+ *        Expression *exp = arena.newCompound(op, lhs, rhs);
+ * --------------------------------------------------------
+ * Create nodes in the arena that behave exactly like the ones created by
+ * the ConstantExp, IdentifierExp and CompoundExp constructors. The name
+ * of an identifier is copied into the arena, so the characters it came
+ * from need not outlive the call. The operands of a compound node must
+ * belong to the same arena.
+ */
+
+    Expression *newConstant(int value);
+    Expression *newIdentifier(std::string_view name);
+    Expression *newCompound(OperatorType op, Expression *lhs,
+                            Expression *rhs);
+
+/*
+ * Method: clear
+ * Usage: arena.clear();
+ * ---------------------
+ * Releases every node in the arena. No destructor is called and no node
+ * is visited. The largest block is kept for the nodes that follow, so an
+ * arena that is cleared before each formula reaches a steady state in
+ * which clear takes constant time and creating nodes never touches the
+ * heap. The block kept after an unusually long name or formula is as
+ * large as that request, and stays allocated until the arena is deleted.
+ */
+
+    void clear();
+
+/*
+ * Methods: size, getBytesUsed, getBlockCount
+ * Usage: int n = arena.size();
+ *        long bytes = arena.getBytesUsed();
+ *        int n = arena.getBlockCount();
+ * -----------------------------------------
+ * Return the number of nodes in the arena, the number of bytes they and
+ * their names occupy, and the number of blocks the arena holds.
+ */
+
+    int size() const;
+    long getBytesUsed() const;
+    int getBlockCount() const;
+
+/*
+ * Notes on representation
+ * -----------------------
+ * The blocks are kept in a linked list with the most recent block at the
+ * head, which is the only one with free space. Each new block is twice
+ * as large as the one before it, up to MAX_BLOCK_SIZE bytes, or larger
+ * if a single request needs more. Nodes are constructed in place with
+ * placement new. An identifier created here points to a name in the
+ * arena rather than owning a copy on the heap, which is what lets clear
+ * skip the destructors.
+ */
+
+private:
+
+/* Constants */
+
+    static const long INITIAL_BLOCK_SIZE = 4096;
+    static const long MAX_BLOCK_SIZE = 1 << 20;
+
+/* Type for blocks in the list */
+
+    struct Block {
+        char *array;            // The storage in this block
+        long capacity;          // The number of bytes in the block
+        long used;              // The number of bytes in use
+        Block *link;            // The next (older) block
+    };
+
+/* Instance variables */
+
+    Block *blocks;          // The most recently allocated block
+    int nNodes;             // The number of nodes in all blocks
+    long nBytes;            // The number of bytes in use in all blocks
+    int nBlocks;            // The number of blocks in the list
+
+/* Private methods */
+
+    void *allocate(long size, long alignment);
+    void addBlock(long size);
+
+/* Make it illegal to copy arenas */
+
+    ExpressionArena(const ExpressionArena & src) { }
+    ExpressionArena & operator=(const ExpressionArena & src) {
+        return *this;
+    }
+
+};
+
+#endif
@@ -0,0 +1,54 @@
+/*
+ * File: barrier.cpp
+ * -----------------
+ * This file implements the barrier.h interface.
+ */
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include "barrier.h"
+#include "error.h"
+using namespace std;
+
+Barrier::Barrier(int nThreads) {
+    if (nThreads < 1) error("Barrier: Need at least one thread");
+    this->nThreads = nThreads;
+    nWaiting = 0;
+    phase = 0;
+}
+
+void Barrier::wait() {
+    wait(function<void()>());
+}
+
+/*
+ * Implementation notes: wait
+ * --------------------------
+ * Each thread records the phase in which it arrived and sleeps until the
+ * phase number changes. Comparing phase numbers, rather than testing the
+ * count of waiting threads, keeps a fast thread that arrives at the next
+ * use of the barrier from confusing the threads still leaving this one.
+ * The last thread runs the completion function without holding the
+ * lock. Nothing else can touch the barrier meanwhile, since every other
+ * thread is asleep waiting for the phase to change, so the lock is not
+ * needed, and a completion function is free to take locks of its own.
+ */
+
+void Barrier::wait(const function<void()> & completion) {
+    unique_lock<mutex> guard(lock);
+    long arrival = phase;
+    nWaiting++;
+    if (nWaiting == nThreads) {
+        if (completion) {
+            guard.unlock();
+            completion();
+            guard.lock();
+        }
+        nWaiting = 0;
+        phase++;
+        done.notify_all();
+    } else {
+        done.wait(guard, [this, arrival] { return phase != arrival; });
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * File: barrier.h
+ * ---------------
+ * This interface exports the Barrier class, which makes a fixed number
+ * of threads wait for one another.
+ */
+
+#ifndef _barrier_h
+#define _barrier_h
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+/*
+ * Class: Barrier
+ * --------------
+ * A barrier is created for a fixed number of threads. Each thread that
+ * calls wait is blocked until all of them have called it, at which point
+ * they all continue, and the barrier is ready to be used again. If the
+ * last thread to arrive passes a completion function to wait, that
+ * function runs before any thread is released, which gives the threads
+ * a safe place to combine their results between phases.
+ */
+
+class Barrier {
+
+public:
+
+/*
+ * Constructor: Barrier
+ * Usage: Barrier barrier(nThreads);
+ * ---------------------------------
+ * Creates a barrier for the specified number of threads.
+ */
+
+    Barrier(int nThreads);
+
+/*
+ * Method: wait
+ * Usage: barrier.wait();
+ *        barrier.wait(completion);
+ * --------------------------------
+ * Blocks until every thread has called wait. All the threads should pass
+ * the same completion function, because only the last one to arrive
+ * actually calls it. The barrier's lock is not held while it runs.
+ */
+
+    void wait();
+    void wait(const std::function<void()> & completion);
+
+/* Private section */
+
+private:
+
+    std::mutex lock;                // Protects the fields below
+    std::condition_variable done;   // Signaled when a phase ends
+    int nThreads;                   // The number of threads
+    int nWaiting;                   // The number of threads in wait
+    long phase;                     // The number of completed phases
+
+/* Make it illegal to copy barriers */
+
+    Barrier(const Barrier & src) { }
+    Barrier & operator=(const Barrier & src) { return *this; }
+
+};
+
+#endif
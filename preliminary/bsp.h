@@ -0,0 +1,544 @@
+/*
+ * File: bsp.h
+ * -----------
+ * This interface exports a bulk-synchronous engine for vertex programs,
+ * in the style of Google's Pregel, that runs each part of a partitioned
+ * graph on its own thread.
+ */
+
+#ifndef _bsp_h
+#define _bsp_h
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include "barrier.h"
+#include "compactgraph.h"
+#include "error.h"
+#include "partition.h"
+#include "vector.h"
+
+template <typename ValueType,typename MessageType>
+class VertexContext;
+
+template <typename ValueType,typename MessageType>
+class BSPWorker;
+
+/*
+ * Class: VertexProgram<ValueType,MessageType>
+ * -------------------------------------------
+ * This abstract class defines the computation that runs at every node.
+ * The computation proceeds in supersteps. In each superstep, compute is
+ * called once for each active node and can read the messages sent to
+ * that node in the previous superstep, change the node's value, send
+ * messages to other nodes, and vote to halt. A node that has voted to
+ * halt becomes active again if it receives a message, and the program
+ * ends when every node has halted and no messages are in transit, or
+ * when the superstep limit is reached.
+ *
+ * If hasCombiner returns true, messages to the same node are merged with
+ * combine as they are sent, so that each node receives at most one
+ * message per superstep. A combiner is appropriate whenever compute only
+ * needs some commutative and associative function of its messages, such
+ * as their sum or minimum, and it greatly reduces the traffic between
+ * threads. The methods of a program are called from several threads at
+ * once and must therefore not change any shared state.
+ */
+
+template <typename ValueType,typename MessageType>
+class VertexProgram {
+
+public:
+
+    virtual ~VertexProgram() { }
+
+/*
+ * Method: getInitialValue
+ * Usage: ValueType value = program.getInitialValue(node);
+ * -------------------------------------------------------
+ * Returns the value of the node with the given global number before the
+ * first superstep.
+ */
+
+    virtual ValueType getInitialValue(int node) const = 0;
+
+/*
+ * Method: compute
+ * Usage: program.compute(vertex);
+ * -------------------------------
+ * Performs one superstep at the node described by vertex.
+ */
+
+    virtual void compute(VertexContext<ValueType,MessageType> & vertex)
+                                                                  const = 0;
+
+/*
+ * Methods: hasCombiner, combine
+ * Usage: if (program.hasCombiner()) . . .
+ *        MessageType msg = program.combine(m1, m2);
+ * -------------------------------------------------
+ * These methods define the optional combiner described above.
+ */
+
+    virtual bool hasCombiner() const { return false; }
+    virtual MessageType combine(const MessageType & m1,
+                                const MessageType & m2) const { return m1; }
+
+};
+
+/*
+ * Class: VertexContext<ValueType,MessageType>
+ * -------------------------------------------
+ * This class gives compute access to one node. Its arcs are numbered from
+ * 0 to getArcCount() - 1 in the order in which they appear in the graph.
+ */
+
+template <typename ValueType,typename MessageType>
+class VertexContext {
+
+public:
+
+/*
+ * Methods: getNode, getSuperstep
+ * Usage: int node = vertex.getNode();
+ *        int step = vertex.getSuperstep();
+ * ----------------------------------------
+ * Return the global number of the node and the number of the current
+ * superstep, starting at 0.
+ */
+
+    int getNode() const;
+    int getSuperstep() const;
+
+/*
+ * Methods: getValue, setValue
+ * Usage: ValueType value = vertex.getValue();
+ *        vertex.setValue(value);
+ * ------------------------------------------
+ * Read and change the value of the node.
+ */
+
+    const ValueType & getValue() const;
+    void setValue(const ValueType & value);
+
+/*
+ * Methods: getMessageCount, getMessage
+ * Usage: for (int i = 0; i < vertex.getMessageCount(); i++) . . .
+ * ----------------------------------------------------------------
+ * Give access to the messages sent to this node in the previous step.
+ */
+
+    int getMessageCount() const;
+    const MessageType & getMessage(int i) const;
+
+/*
+ * Methods: getArcCount, getArcFinish, getArcCost
+ * Usage: int finish = vertex.getArcFinish(i);
+ * -------------------------------------------
+ * Describe the arcs leaving the node. The finish is a global number.
+ */
+
+    int getArcCount() const;
+    int getArcFinish(int i) const;
+    double getArcCost(int i) const;
+
+/*
+ * Methods: sendAlongArc, sendToNeighbors
+ * Usage: vertex.sendAlongArc(i, msg);
+ *        vertex.sendToNeighbors(msg);
+ * ----------------------------------
+ * Send a message to the finish of arc i or to the finishes of all the
+ * arcs. The messages are delivered at the start of the next superstep.
+ */
+
+    void sendAlongArc(int i, const MessageType & msg);
+    void sendToNeighbors(const MessageType & msg);
+
+/*
+ * Method: voteToHalt
+ * Usage: vertex.voteToHalt();
+ * ---------------------------
+ * Makes the node inactive until it receives another message.
+ */
+
+    void voteToHalt();
+
+/* Private section */
+
+private:
+
+    template <typename V,typename M>
+    friend class BSPWorker;
+
+    VertexContext() { }
+
+    BSPWorker<ValueType,MessageType> *worker;   // The worker running compute
+    int local;                                  // The local node number
+
+};
+
+/*
+ * Function: runVertexProgram
+ * Usage: int steps = runVertexProgram(partition, program, values);
+ *        int steps = runVertexProgram(partition, program, values, max);
+ * ----------------------------------------------------------------------
+ * Runs the program on the partitioned graph, using one thread for each
+ * part, and stores the final value of every node in values, indexed by
+ * global node number. The program stops after at most maxSupersteps
+ * supersteps, and the function returns the number actually run.
+ */
+
+const int DEFAULT_MAX_SUPERSTEPS = 1000;
+
+template <typename ValueType,typename MessageType>
+int runVertexProgram(const GraphPartition & partition,
+                     const VertexProgram<ValueType,MessageType> & program,
+                     Vector<ValueType> & values,
+                     int maxSupersteps = DEFAULT_MAX_SUPERSTEPS);
+
+/* Private section */
+
+/**********************************************************************/
+/* Note: Everything below this point in the file is logically part    */
+/* of the implementation and should not be of interest to clients.    */
+/**********************************************************************/
+
+/*
+ * Implementation notes: BSPShared
+ * -------------------------------
+ * The threads share a matrix of message queues, in which queues[p][q]
+ * holds the messages that part p has sent to nodes owned by part q.
+ * Each queue has exactly one writer, which fills it during a superstep,
+ * and one reader, which empties it after the barrier that ends the
+ * superstep, so the queues need no locks of their own. A message in a
+ * queue carries the local number of its target in the receiving part,
+ * taken from the sender's ghost table.
+ */
+
+template <typename ValueType,typename MessageType>
+struct BSPShared {
+    const GraphPartition *partition;
+    const VertexProgram<ValueType,MessageType> *program;
+    Vector< Vector< Vector< std::pair<int,MessageType> > > > queues;
+    Barrier *barrier;
+    std::atomic<long> nLive;        // Active nodes after this superstep
+    int superstep;                  // The current superstep
+    int maxSupersteps;              // The superstep limit
+    bool finished;                  // True when the program is over
+};
+
+/*
+ * Class: BSPWorker
+ * ----------------
+ * This class holds the state of one part and runs its side of every
+ * superstep. Messages between nodes in the same part go straight into
+ * the inbox for the next superstep. Messages to ghosts are combined per
+ * ghost if the program has a combiner and are then put on the queue for
+ * the part that owns the ghost. With a combiner, each inbox holds at
+ * most one message, so the inboxes are kept as a flat array of slots
+ * rather than as a vector for each node, which avoids any allocation
+ * while messages are sent.
+ */
+
+template <typename ValueType,typename MessageType>
+class BSPWorker {
+
+public:
+
+    BSPWorker(BSPShared<ValueType,MessageType> *shared, int part) {
+        this->shared = shared;
+        this->part = part;
+        sub = &shared->partition->getSubgraph(part);
+        combining = shared->program->hasCombiner();
+        int nLocal = sub->nodes.size();
+        for (int i = 0; i < nLocal; i++) {
+            values.add(shared->program->getInitialValue(sub->nodes[i]));
+        }
+        halted = Vector<bool>(nLocal, false);
+        if (combining) {
+            slots = Vector<MessageType>(nLocal, MessageType());
+            hasSlot = Vector<bool>(nLocal, false);
+            nextSlots = slots;
+            nextHasSlot = hasSlot;
+            ghostSlots = Vector<MessageType>(sub->ghosts.size(), MessageType());
+            ghostHasSlot = Vector<bool>(sub->ghosts.size(), false);
+        } else {
+            inbox = Vector< Vector<MessageType> >(nLocal,
+                                                  Vector<MessageType>());
+            nextInbox = inbox;
+        }
+    }
+
+/*
+ * Method: run
+ * Usage: worker.run();
+ * --------------------
+ * Runs supersteps until the shared state says the program is finished.
+ * Each superstep computes the local nodes, waits for the other parts,
+ * collects the messages they sent, and then waits again while the last
+ * thread to arrive decides whether to continue.
+ */
+
+    void run() {
+        while (true) {
+            computeNodes();
+            shared->barrier->wait();
+            long live = receiveMessages();
+            shared->nLive += live;
+            shared->barrier->wait([this]() {
+                shared->superstep++;
+                shared->finished = shared->nLive == 0
+                                || shared->superstep >= shared->maxSupersteps;
+                shared->nLive = 0;
+            });
+            if (shared->finished) break;
+        }
+    }
+
+    const Vector<ValueType> & getValues() const {
+        return values;
+    }
+
+private:
+
+    template <typename V,typename M>
+    friend class VertexContext;
+
+    BSPShared<ValueType,MessageType> *shared;
+    int part;                                   // The part for this worker
+    const Subgraph *sub;                        // The subgraph for the part
+    bool combining;                             // True if there's a combiner
+    Vector<ValueType> values;                   // The value of each node
+    Vector<bool> halted;                        // True if a node has halted
+    Vector< Vector<MessageType> > inbox;        // Messages for this step
+    Vector< Vector<MessageType> > nextInbox;    // Messages for the next step
+    Vector<MessageType> slots;                  // Combined inbox messages
+    Vector<bool> hasSlot;                       //  and whether each is set,
+    Vector<MessageType> nextSlots;              //  for this step and the
+    Vector<bool> nextHasSlot;                   //  next one
+    Vector<MessageType> ghostSlots;             // Combined ghost messages
+    Vector<bool> ghostHasSlot;                  //  and whether each is set
+
+    int getMessageCount(int i) {
+        if (combining) return hasSlot[i] ? 1 : 0;
+        return inbox[i].size();
+    }
+
+    const MessageType & getMessage(int i, int k) {
+        if (combining) return slots[i];
+        return inbox[i][k];
+    }
+
+    void computeNodes() {
+        VertexContext<ValueType,MessageType> vertex;
+        vertex.worker = this;
+        for (int i = 0; i < values.size(); i++) {
+            if (halted[i] && getMessageCount(i) == 0) continue;
+            halted[i] = false;
+            vertex.local = i;
+            shared->program->compute(vertex);
+            if (combining) {
+                hasSlot[i] = false;
+            } else {
+                inbox[i].clear();
+            }
+        }
+        if (combining) {
+            for (int g = 0; g < ghostHasSlot.size(); g++) {
+                if (ghostHasSlot[g]) {
+                    enqueue(g, ghostSlots[g]);
+                    ghostHasSlot[g] = false;
+                }
+            }
+        }
+    }
+
+    long receiveMessages() {
+        int nParts = shared->partition->getPartCount();
+        for (int p = 0; p < nParts; p++) {
+            Vector< std::pair<int,MessageType> > & queue =
+                shared->queues[p][part];
+            for (int i = 0; i < queue.size(); i++) {
+                deliver(queue[i].first, queue[i].second);
+            }
+            queue.clear();
+        }
+        if (combining) {
+            std::swap(slots, nextSlots);
+            std::swap(hasSlot, nextHasSlot);
+        } else {
+            std::swap(inbox, nextInbox);
+        }
+        long live = 0;
+        for (int i = 0; i < values.size(); i++) {
+            if (!halted[i] || getMessageCount(i) > 0) live++;
+        }
+        return live;
+    }
+
+    void send(int finish, const MessageType & msg) {
+        int nLocal = values.size();
+        if (finish < nLocal) {
+            deliver(finish, msg);
+        } else if (combining) {
+            combineInto(ghostSlots, ghostHasSlot, finish - nLocal, msg);
+        } else {
+            enqueue(finish - nLocal, msg);
+        }
+    }
+
+    void deliver(int i, const MessageType & msg) {
+        if (combining) {
+            combineInto(nextSlots, nextHasSlot, i, msg);
+        } else {
+            nextInbox[i].add(msg);
+        }
+    }
+
+    void combineInto(Vector<MessageType> & slots, Vector<bool> & hasSlot,
+                     int i, const MessageType & msg) {
+        if (hasSlot[i]) {
+            slots[i] = shared->program->combine(slots[i], msg);
+        } else {
+            slots[i] = msg;
+            hasSlot[i] = true;
+        }
+    }
+
+    void enqueue(int g, const MessageType & msg) {
+        shared->queues[part][sub->ghostParts[g]]
+              .add(std::pair<int,MessageType>(sub->ghostLocalIds[g], msg));
+    }
+
+};
+
+/*
+ * Implementation notes: VertexContext
+ * -----------------------------------
+ * The context methods simply read and write the worker's arrays for the
+ * local node, translating arc finishes to global numbers when asked.
+ */
+
+template <typename ValueType,typename MessageType>
+int VertexContext<ValueType,MessageType>::getNode() const {
+    return worker->sub->nodes[local];
+}
+
+template <typename ValueType,typename MessageType>
+int VertexContext<ValueType,MessageType>::getSuperstep() const {
+    return worker->shared->superstep;
+}
+
+template <typename ValueType,typename MessageType>
+const ValueType & VertexContext<ValueType,MessageType>::getValue() const {
+    return worker->values[local];
+}
+
+template <typename ValueType,typename MessageType>
+void VertexContext<ValueType,MessageType>::setValue(const ValueType & value) {
+    worker->values[local] = value;
+}
+
+template <typename ValueType,typename MessageType>
+int VertexContext<ValueType,MessageType>::getMessageCount() const {
+    return worker->getMessageCount(local);
+}
+
+template <typename ValueType,typename MessageType>
+const MessageType &
+VertexContext<ValueType,MessageType>::getMessage(int i) const {
+    return worker->getMessage(local, i);
+}
+
+template <typename ValueType,typename MessageType>
+int VertexContext<ValueType,MessageType>::getArcCount() const {
+    return worker->sub->offsets[local + 1] - worker->sub->offsets[local];
+}
+
+template <typename ValueType,typename MessageType>
+int VertexContext<ValueType,MessageType>::getArcFinish(int i) const {
+    const Subgraph *sub = worker->sub;
+    int finish = sub->finishes[sub->offsets[local] + i];
+    int nLocal = sub->nodes.size();
+    return (finish < nLocal) ? sub->nodes[finish]
+                             : sub->ghosts[finish - nLocal];
+}
+
+template <typename ValueType,typename MessageType>
+double VertexContext<ValueType,MessageType>::getArcCost(int i) const {
+    return worker->sub->costs[worker->sub->offsets[local] + i];
+}
+
+template <typename ValueType,typename MessageType>
+void VertexContext<ValueType,MessageType>::sendAlongArc(int i,
+                                                const MessageType & msg) {
+    worker->send(worker->sub->finishes[worker->sub->offsets[local] + i], msg);
+}
+
+template <typename ValueType,typename MessageType>
+void VertexContext<ValueType,MessageType>::sendToNeighbors(
+                                                const MessageType & msg) {
+    const Subgraph *sub = worker->sub;
+    for (int a = sub->offsets[local]; a < sub->offsets[local + 1]; a++) {
+        worker->send(sub->finishes[a], msg);
+    }
+}
+
+template <typename ValueType,typename MessageType>
+void VertexContext<ValueType,MessageType>::voteToHalt() {
+    worker->halted[local] = true;
+}
+
+/*
+ * Implementation notes: runVertexProgram
+ * --------------------------------------
+ * The calling thread runs the worker for part 0 while new threads run
+ * the others. The values are copied out by global number at the end.
+ */
+
+template <typename ValueType,typename MessageType>
+int runVertexProgram(const GraphPartition & partition,
+                     const VertexProgram<ValueType,MessageType> & program,
+                     Vector<ValueType> & values, int maxSupersteps) {
+    if (maxSupersteps < 1) error("runVertexProgram: Need at least one step");
+    int nParts = partition.getPartCount();
+    BSPShared<ValueType,MessageType> shared;
+    shared.partition = &partition;
+    shared.program = &program;
+    for (int p = 0; p < nParts; p++) {
+        shared.queues.add(Vector< Vector< std::pair<int,MessageType> > >(
+                    nParts, Vector< std::pair<int,MessageType> >()));
+    }
+    Barrier barrier(nParts);
+    shared.barrier = &barrier;
+    shared.nLive = 0;
+    shared.superstep = 0;
+    shared.maxSupersteps = maxSupersteps;
+    shared.finished = false;
+    Vector<BSPWorker<ValueType,MessageType> *> workers;
+    for (int p = 0; p < nParts; p++) {
+        workers.add(new BSPWorker<ValueType,MessageType>(&shared, p));
+    }
+    Vector<std::thread *> threads;
+    for (int p = 1; p < nParts; p++) {
+        threads.add(new std::thread(&BSPWorker<ValueType,MessageType>::run,
+                                    workers[p]));
+    }
+    workers[0]->run();
+    for (int i = 0; i < threads.size(); i++) {
+        threads[i]->join();
+        delete threads[i];
+    }
+    values = Vector<ValueType>(partition.getGraph().size(), ValueType());
+    for (int p = 0; p < nParts; p++) {
+        const Subgraph & sub = partition.getSubgraph(p);
+        const Vector<ValueType> & local = workers[p]->getValues();
+        for (int i = 0; i < sub.nodes.size(); i++) {
+            values[sub.nodes[i]] = local[i];
+        }
+        delete workers[p];
+    }
+    return shared.superstep;
+}
+
+#endif
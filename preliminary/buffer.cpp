@@ -1,10 +1,11 @@
 /*
  * File: buffer.cpp
  * ----------------
- * This file implements the EditorBuffer class using a linked
- * list to represent the buffer.
+ * This file implements the EditorBuffer class using a gap buffer to
+ * represent the buffer.
  */
 
+#include <cstring>
 #include <iostream>
 #include "buffer.h"
 using namespace std;
@@ -12,130 +13,117 @@ using namespace std;
 /*
  * Implementation notes: EditorBuffer constructor
  * ----------------------------------------------
- * The constructor initializes an empty buffer editor represented as
- * a linked list. In this representation, the empty buffer contains
- * a "dummy" cell whose ch field is never used. The constructor
- * allocates this dummy cell and then sets the internal pointers.
+ * The constructor initializes an empty buffer, in which the whole array
+ * is the gap.
  */
 
 EditorBuffer::EditorBuffer() {
-    start = cursor = new Cell;
-    start->link = NULL;
+    capacity = INITIAL_CAPACITY;
+    array = new char[capacity];
+    before = 0;
+    after = capacity;
 }
 
 /*
  * Implementation notes: EditorBuffer destructor
  * ---------------------------------------------
- * The destructor deletes every cell in the buffer. Note that the loop
- * structure is not exactly the standard for loop pattern for processing
- * every cell within a linked list. The complication that forces this
- * change is that the body of the loop can't free the current cell and
- * later have the for loop use the link field of that cell to move to
- * the next one. To avoid this problem, this implementation copies the
- * link pointer before calling delete.
+ * The only heap storage is the array.
  */
 
 EditorBuffer::~EditorBuffer() {
-    Cell *cp = start;
-    while (cp != NULL) {
-        Cell *next = cp->link;
-        delete cp;
-        cp = next;
-    }
+    delete[] array;
 }
 
 /*
  * Implementation notes: moveCursor methods
  * ----------------------------------------
- * The four methods that move the cursor have different time complexities
- * because the structure of a linked list is asymmetrical with respect to
- * moving backward and forward. The moveCursorForward and moveCursorToStart
- * methods operate in constant time. By contrast, the moveCursorBackward
- * and moveCursorToEnd methods each require a loop that runs in linear time.
+ * Moving the cursor forward or backward copies the character that it
+ * passes over to the other side of the gap, which takes constant time.
+ * Jumping to either end moves every character on one side of the cursor
+ * at once, which memmove does far faster than a loop would.
  */
 
 void EditorBuffer::moveCursorForward() {
-    if (cursor->link != NULL) {
-        cursor = cursor->link;
+    if (after < capacity) {
+        array[before++] = array[after++];
     }
 }
 
 void EditorBuffer::moveCursorBackward() {
-    if (cursor != start) {
-        Cell *cp = start;
-        while (cp->link != cursor) {
-            cp = cp->link;
-        }
-        cursor = cp;
+    if (before > 0) {
+        array[--after] = array[--before];
     }
 }
 
 void EditorBuffer::moveCursorToStart() {
-    cursor = start;
+    after -= before;
+    memmove(array + after, array, before);
+    before = 0;
 }
 
 void EditorBuffer::moveCursorToEnd() {
-    while (cursor->link != NULL) {
-        cursor = cursor-> link;
-    }
+    size_t nAfter = capacity - after;
+    memmove(array + before, array + after, nAfter);
+    before += nAfter;
+    after = capacity;
 }
 
 /*
- * Implementation notes: insertCharacter
- * -------------------------------------
- * The steps required to insert a new character are:
- * 
- * 1. Allocate a new cell and put the new character in it.
- * 2. Copy the pointer indicating the rest of the list into the link.
- * 3. Update the link in the current cell to point to the new one.
- * 4. Move the cursor forward over the inserted character.
+ * Implementation notes: insertCharacter and deleteCharacter
+ * ---------------------------------------------------------
+ * Inserting a character stores it at the start of the gap, expanding
+ * the array first if the gap is empty. Deleting the character after the
+ * cursor simply widens the gap to include it.
  */
 
 void EditorBuffer::insertCharacter(char ch) {
-    Cell *cp = new Cell;
-    cp->ch = ch;
-    cp->link = cursor->link;
-    cursor->link = cp;
-    cursor = cp;
+    if (before == after) expandCapacity();
+    array[before++] = ch;
 }
 
-/*
- * Implementation notes: deleteCharacter
- * -------------------------------------
- * The steps necessary to delete the character after the cursor are:
- * 
- * 1. Remove the current cell by pointing to its successor.
- * 2. Free the cell to reclaim the memory.
- */
-
 void EditorBuffer::deleteCharacter() {
-    if (cursor->link != NULL) {
-        Cell *oldCell = cursor->link;
-        cursor->link = cursor->link->link;
-        delete oldCell;
+    if (after < capacity) {
+        after++;
     }
 }
 
 /*
  * Implementation notes: getText and getCursor
  * -------------------------------------------
- * The getText method uses the standard linked-list pattern to loop
- * through the cells in the linked list. The getCursor method counts
- * the characters in the list until it reaches the cursor.
+ * The getText method copies the two blocks of characters on either side
+ * of the gap into a string of the right length. The cursor position is
+ * the number of characters before the gap.
  */
 
 string EditorBuffer::getText() const {
-    string str = "";
-    for (Cell *cp = start->link; cp != NULL; cp = cp->link) {
-        str += cp->ch;
-    }
+    string str;
+    str.reserve(before + capacity - after);
+    str.append(array, before);
+    str.append(array + after, capacity - after);
     return str;
 }
 
-int EditorBuffer::getCursor() const {
-    int nChars = 0;
-    for (Cell *cp = start; cp != cursor; cp = cp->link) {
-        nChars++;
-    }
-    return nChars;
-}
\ No newline at end of file
+long EditorBuffer::getCursor() const {
+    return before;
+}
+
+/*
+ * Private method: expandCapacity
+ * Usage: expandCapacity();
+ * ------------------------
+ * Doubles the capacity of the array, copying the characters before the
+ * cursor to the start of the new array and those after the cursor to
+ * its end, so that the new space becomes the gap.
+ */
+
+void EditorBuffer::expandCapacity() {
+    size_t newCapacity = 2 * capacity;
+    size_t nAfter = capacity - after;
+    char *newArray = new char[newCapacity];
+    memcpy(newArray, array, before);
+    memcpy(newArray + newCapacity - nAfter, array + after, nAfter);
+    delete[] array;
+    array = newArray;
+    after = newCapacity - nAfter;
+    capacity = newCapacity;
+}
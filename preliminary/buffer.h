@@ -7,6 +7,7 @@
 #ifndef _buffer_h
 #define _buffer_h
 
+#include <cstddef>
 #include <string>
 
 /*
@@ -91,56 +92,58 @@ public:
 
 /*
  * Method: getCursor
- * Usage: int cursor = buffer.getCursor();
- * ---------------------------------------
- * Returns the index of the cursor.
+ * Usage: long cursor = buffer.getCursor();
+ * ----------------------------------------
+ * Returns the index of the cursor, which may exceed the range of an int
+ * in a large buffer.
  */
 
-    int getCursor() const;
+    long getCursor() const;
 
 /* Private section */
 
 private:
 
 /*
- * Implementatino notes: Buffer data structure
+ * Implementation notes: Buffer data structure
  * -------------------------------------------
- * In the linked-list implementation of the buffer, the characters
- * in the buffer are stored in a list of Cell structures, each of
- * which contains a character and a pointer to the next cell in the
- * chain. To simplify the code used to maintain the cursor, this
- * implementation adds an extra "dummy" cell at the beginning of the
- * list. The character in this cell is not used, but having it in
- * the data structure provides a cell for the cursor to point to
- * when the cursor is at the beginning of the buffer.
- * 
- * The following diagram shows the structure of the list-based buffer
- * containing "ABC" with the cursor at the beginning:
- * 
- *        +-----+      +-----+      +-----+      +-----+      +-----+
- *  start |  o--+---==>|     |   -->|  A  |   -->|  B  |   -->|  C  |
- *        +-----+  /   +-----+  /   +-----+  /   +-----+  /   +-----+
- * cursor |  o--+--    |  o--+--    |  o--+--    |  o--+--    |  /  |
- *        +-----+      +-----+      +-----+      +-----+      +-----+
+ * In the gap-buffer implementation, the characters are stored in a
+ * single array whose capacity exceeds the length of the text. The
+ * characters before the cursor sit at the start of the array and the
+ * characters after the cursor sit at the end, with the unused space,
+ * called the gap, between them. Moving the cursor one character copies
+ * one character across the gap, and inserting a character fills the
+ * first position of the gap, so both take constant time. When the gap
+ * is used up, the array doubles in size, which keeps the average cost
+ * of an insertion constant and the storage to one byte per character
+ * plus the gap. The sizes and indices are size_t, so that a buffer can
+ * grow past the 2GB that an int can count.
+ *
+ * The following diagram shows the structure of a buffer with capacity
+ * 10 containing "ABCDE" with the cursor between the B and the C:
+ *
+ *         0     1     2     3     4     5     6     7     8     9
+ *      +-----+-----+-----+-----+-----+-----+-----+-----+-----+-----+
+ *      |  A  |  B  |     |     |     |     |     |  C  |  D  |  E  |
+ *      +-----+-----+-----+-----+-----+-----+-----+-----+-----+-----+
+ *
+ *      before = 2, after = 7
  */
 
-/*
- * Type: Cell
- * ----------
- * This structure type is used locally within the implementation to
- * store each cell in the linked-list representation. Each cell
- * contains one character and a pointer to the next cell in the chain.
- */
+/* Constants */
 
-    struct Cell {
-        char ch;
-        Cell *link;
-    };
+    static const int INITIAL_CAPACITY = 16;
 
 /* Instance variables */
 
-    Cell *start;    //Pointer to the dummy cell
-    Cell *cursor;   //Pionter to the cell before the cursor
+    char *array;        // The characters, with the gap at the cursor
+    size_t capacity;    // The allocated size of the array
+    size_t before;      // The number of characters before the cursor
+    size_t after;       // The index of the first character after the cursor
+
+/* Private methods */
+
+    void expandCapacity();
 
 /* Make it illegal to copy editor buffors */
 
@@ -0,0 +1,99 @@
+/*
+ * File: bytecode.cpp
+ * ------------------
+ * This file implements the bytecode.h interface.
+ */
+
+#include <string>
+#include "bytecode.h"
+#include "error.h"
+#include "exp.h"
+using namespace std;
+
+/*
+ * Implementation notes: BytecodeProgram methods
+ * ---------------------------------------------
+ * Apart from eval, every method passes the call on to the TypedProgram.
+ */
+
+BytecodeProgram::BytecodeProgram() {
+    /* Empty */
+}
+
+BytecodeProgram::BytecodeProgram(Expression *exp)
+        : program(exp) {
+    /* Empty */
+}
+
+BytecodeProgram::~BytecodeProgram() {
+    /* Empty */
+}
+
+void BytecodeProgram::compile(Expression *exp) {
+    program.compile(exp);
+}
+
+int BytecodeProgram::getSlotCount() const {
+    return program.getSlotCount();
+}
+
+int BytecodeProgram::getSlot(string_view name) const {
+    return program.getSlot(name);
+}
+
+string_view BytecodeProgram::getSlotName(int slot) const {
+    return program.getSlotName(slot);
+}
+
+bool BytecodeProgram::isInput(int slot) const {
+    return program.isInput(slot);
+}
+
+bool BytecodeProgram::isAssigned(int slot) const {
+    return program.isAssigned(slot);
+}
+
+int BytecodeProgram::execute(int *slots) const {
+    return program.execute(slots);
+}
+
+string BytecodeProgram::toString() const {
+    return program.toString();
+}
+
+/*
+ * Implementation notes: eval
+ * --------------------------
+ * The eval method checks every input slot before running the program,
+ * so that an undefined variable leaves the context unchanged.
+ */
+
+int BytecodeProgram::eval(EvaluationContext & context) const {
+    int nSlots = getSlotCount();
+    int *slots = new int[(nSlots == 0) ? 1 : nSlots];
+    for (int i = 0; i < nSlots; i++) {
+        int slot = context.findSlot(getSlotName(i));
+        if (slot >= 0 && context.isDefined(slot)) {
+            slots[i] = context.getValue(slot);
+        } else if (isInput(i)) {
+            delete[] slots;
+            error(string(getSlotName(i)) + " is undefined");
+        } else {
+            slots[i] = 0;
+        }
+    }
+    int value;
+    try {
+        value = execute(slots);
+    } catch (...) {
+        delete[] slots;
+        throw;
+    }
+    for (int i = 0; i < nSlots; i++) {
+        if (isAssigned(i)) {
+            context.setValue(getSlotName(i), slots[i]);
+        }
+    }
+    delete[] slots;
+    return value;
+}
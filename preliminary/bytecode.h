@@ -0,0 +1,177 @@
+/*
+ * File: bytecode.h
+ * ----------------
+ * This interface exports the BytecodeProgram class, which compiles an
+ * expression tree into a compact sequence of instructions for a small
+ * stack machine and then runs that sequence as often as required.
+ */
+
+#ifndef _bytecode_h
+#define _bytecode_h
+
+#include <string>
+#include <string_view>
+#include "exp.h"
+#include "typedprogram.h"
+
+/*
+ * Class: BytecodeProgram
+ * ----------------------
+ * This class holds an expression compiled to bytecode. Every variable in
+ * the expression is resolved to a slot number when the program is
+ * compiled, so the machine reads and writes variables by indexing an
+ * array instead of looking up their names. A client that evaluates the
+ * same formula against changing inputs binds the inputs to their slots
+ * once and then calls execute in a loop:
+ *
+ *      BytecodeProgram program(exp);
+ *      int x = program.getSlot("x");
+ *      int *slots = new int[program.getSlotCount()];
+ *      for (int i = 0; i < n; i++) {
+ *          slots[x] = i;
+ *          int value = program.execute(slots);
+ *          . . . use the value
+ *      }
+ *
+ * The eval method offers the same interface as Expression::eval by
+ * copying the variables between an EvaluationContext and the slots.
+ */
+
+class BytecodeProgram {
+
+public:
+
+/*
+ * Constructor: BytecodeProgram
+ * Usage: BytecodeProgram program;
+ *        BytecodeProgram program(exp);
+ * ------------------------------------
+ * Initializes a program, compiling the expression exp if it is given.
+ * The program does not keep any pointer to the expression tree, which
+ * the client may delete as soon as the constructor returns.
+ */
+
+    BytecodeProgram();
+    BytecodeProgram(Expression *exp);
+
+/*
+ * Destructor: ~BytecodeProgram
+ * ----------------------------
+ * Frees any heap storage associated with this program.
+ */
+
+    ~BytecodeProgram();
+
+/*
+ * Method: compile
+ * Usage: program.compile(exp);
+ * ----------------------------
+ * Replaces the contents of the program with the translation of exp.
+ * This method signals an error if the left side of an assignment is not
+ * an identifier.
+ */
+
+    void compile(Expression *exp);
+
+/*
+ * Method: getSlotCount
+ * Usage: int n = program.getSlotCount();
+ * --------------------------------------
+ * Returns the number of variable slots the program uses, which is the
+ * number of distinct identifiers in the expression.
+ */
+
+    int getSlotCount() const;
+
+/*
+ * Method: getSlot
+ * Usage: int slot = program.getSlot(name);
+ * ----------------------------------------
+ * Returns the slot of the named variable, or -1 if the expression does
+ * not mention it.
+ */
+
+    int getSlot(std::string_view name) const;
+
+/*
+ * Method: getSlotName
+ * Usage: std::string_view name = program.getSlotName(slot);
+ * ---------------------------------------------------------
+ * Returns the name of the variable in the specified slot.
+ */
+
+    std::string_view getSlotName(int slot) const;
+
+/*
+ * Methods: isInput, isAssigned
+ * Usage: if (program.isInput(slot)) . . .
+ *        if (program.isAssigned(slot)) . . .
+ * ------------------------------------------
+ * The isInput method returns true if the program may read the slot
+ * before assigning it, in which case the client must supply its value.
+ * The isAssigned method returns true if the program stores into the slot.
+ */
+
+    bool isInput(int slot) const;
+    bool isAssigned(int slot) const;
+
+/*
+ * Method: execute
+ * Usage: int value = program.execute(slots);
+ * ------------------------------------------
+ * Runs the program with the variables in the array slots, which must
+ * have getSlotCount() elements, and returns the value of the expression.
+ * Assignments update the array. This method signals an error on
+ * division by zero. Since execute changes nothing but the array, any
+ * number of threads may run the same program, each with its own slots.
+ */
+
+    int execute(int *slots) const;
+
+/*
+ * Method: eval
+ * Usage: int value = program.eval(context);
+ * -----------------------------------------
+ * Evaluates the program in the specified context, giving the same result
+ * as evaluating the original tree. The method copies the variables that
+ * the program reads from the context, runs the program, and copies the
+ * variables it assigns back into the context. An undefined input
+ * variable is reported before any assignment takes effect.
+ */
+
+    int eval(EvaluationContext & context) const;
+
+/*
+ * Method: toString
+ * Usage: string listing = program.toString();
+ * -------------------------------------------
+ * Returns a listing of the instructions, one per line.
+ */
+
+    std::string toString() const;
+
+/*
+ * Notes on representation
+ * -----------------------
+ * The compiler and the machine are those of TypedProgram<int>, whose
+ * ValueTraits give the int arithmetic of the expression tree. This
+ * class adds only the eval method, which connects the program to an
+ * EvaluationContext.
+ */
+
+private:
+
+/* Instance variables */
+
+    TypedProgram<int> program;      // The compiled expression
+
+/* Make it illegal to copy programs */
+
+    BytecodeProgram(const BytecodeProgram & src) { }
+    BytecodeProgram & operator=(const BytecodeProgram & src) {
+        return *this;
+    }
+
+};
+
+#endif
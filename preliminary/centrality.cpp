@@ -0,0 +1,468 @@
+/*
+ * File: centrality.cpp
+ * --------------------
+ * This file implements the centrality.h interface.
+ */
+
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "barrier.h"
+#include "centrality.h"
+#include "compactgraph.h"
+#include "error.h"
+#include "vector.h"
+using namespace std;
+
+/* Constants */
+
+const int SOURCES_PER_GRAB = 4;     // Sources a Brandes thread takes at once
+
+/*
+ * Type: Transpose
+ * ---------------
+ * This type holds the arcs of a graph grouped by their finishing node,
+ * in the same compressed form that CompactGraph uses for the arcs leaving
+ * each node. The arcs entering v come from sources[offsets[v]] through
+ * sources[offsets[v + 1] - 1].
+ */
+
+struct Transpose {
+    int *offsets;
+    int *sources;
+};
+
+/*
+ * Type: PageRankState
+ * -------------------
+ * This type holds the arrays and totals shared by the PageRank threads.
+ * The arrays are plain dynamic arrays rather than vectors so that the
+ * compiler can vectorize the loops over them.
+ */
+
+template <typename RealType>
+struct PageRankState {
+    const int *offsets;             // The transpose of the graph
+    const int *sources;
+    RealType *rank;                 // The current rank of each node
+    RealType *contrib;              // Rank divided by out-degree
+    RealType *invDegree;            // 1 / out-degree, or 0 if none
+    int *bounds;                    // First node of each thread's range
+    double *dangling;               // Per-thread rank of dangling nodes
+    double *change;                 // Per-thread total change in rank
+    Barrier *barrier;
+    int nThreads;
+    int nNodes;
+    double damping;
+    double tolerance;
+    int maxIterations;
+    RealType base;                  // Rank every node receives this step
+    int iterations;                 // The number of completed iterations
+    bool finished;                  // True when the iteration is over
+};
+
+/*
+ * Type: BrandesEntry
+ * ------------------
+ * This type holds the data that Brandes's algorithm keeps for each node
+ * during the search from one source.
+ */
+
+struct BrandesEntry {
+    double dist;                    // Distance from the source, or -1
+    double sigma;                   // Number of shortest paths to the node
+    double delta;                   // Dependency of the source on the node
+};
+
+/* Private function prototypes */
+
+static void buildTranspose(const CompactGraph & g, Transpose & t);
+static int chooseThreadCount(int nThreads);
+template <typename RealType>
+static void pageRankThread(PageRankState<RealType> *state, int id);
+static void brandesThread(const CompactGraph *g, bool weighted,
+                          int nSamples, atomic<int> *next, double *scores);
+
+/*
+ * Implementation notes: pageRank
+ * ------------------------------
+ * This implementation pulls rank along the arcs of the transposed graph
+ * rather than pushing it along the arcs of the graph itself. Pulling
+ * means that each node's new rank is a sum computed by exactly one
+ * thread, so the threads never write to the same location and need no
+ * atomic operations. Each iteration has two phases separated by a
+ * barrier:
+ *
+ * 1. Each thread computes rank / out-degree for the nodes in its range
+ *    and adds up the rank held by nodes that have no outgoing arcs.
+ * 2. Each thread computes the new rank of the nodes in its range from
+ *    the values computed in phase 1 by all the threads.
+ *
+ * The ranges are chosen so that each thread handles about the same
+ * number of nodes plus incoming arcs, which balances the work even when
+ * the degrees are very uneven.
+ */
+
+template <typename RealType>
+int pageRank(const CompactGraph & g, Vector<RealType> & ranks,
+             double damping, double tolerance, int maxIterations,
+             int nThreads) {
+    if (damping < 0 || damping > 1) error("pageRank: Illegal damping factor");
+    if (maxIterations < 1) error("pageRank: Need at least one iteration");
+    int n = g.size();
+    ranks.clear();
+    if (n == 0) return 0;
+    nThreads = chooseThreadCount(nThreads);
+    if (nThreads > n) nThreads = n;
+    Transpose t;
+    buildTranspose(g, t);
+    PageRankState<RealType> state;
+    state.offsets = t.offsets;
+    state.sources = t.sources;
+    state.rank = new RealType[n];
+    state.contrib = new RealType[n];
+    state.invDegree = new RealType[n];
+    for (int v = 0; v < n; v++) {
+        int degree = g.getArcEnd(v) - g.getArcBegin(v);
+        state.rank[v] = RealType(1.0 / n);
+        state.invDegree[v] = (degree == 0) ? 0 : RealType(1.0 / degree);
+    }
+    state.bounds = new int[nThreads + 1];
+    long totalWork = (long) n + g.getArcCount();
+    int v = 0;
+    for (int i = 0; i <= nThreads; i++) {
+        long target = totalWork * i / nThreads;
+        while (v < n && (long) v + t.offsets[v] < target) v++;
+        state.bounds[i] = v;
+    }
+    state.bounds[nThreads] = n;
+    state.dangling = new double[nThreads];
+    state.change = new double[nThreads];
+    Barrier barrier(nThreads);
+    state.barrier = &barrier;
+    state.nThreads = nThreads;
+    state.nNodes = n;
+    state.damping = damping;
+    state.tolerance = tolerance;
+    state.maxIterations = maxIterations;
+    state.iterations = 0;
+    state.finished = false;
+    Vector<thread *> threads;
+    for (int i = 1; i < nThreads; i++) {
+        threads.add(new thread(pageRankThread<RealType>, &state, i));
+    }
+    pageRankThread(&state, 0);
+    for (int i = 0; i < threads.size(); i++) {
+        threads[i]->join();
+        delete threads[i];
+    }
+    for (int i = 0; i < n; i++) {
+        ranks.add(state.rank[i]);
+    }
+    delete[] state.rank;
+    delete[] state.contrib;
+    delete[] state.invDegree;
+    delete[] state.bounds;
+    delete[] state.dangling;
+    delete[] state.change;
+    delete[] t.offsets;
+    delete[] t.sources;
+    return state.iterations;
+}
+
+template int pageRank<float>(const CompactGraph &, Vector<float> &,
+                             double, double, int, int);
+template int pageRank<double>(const CompactGraph &, Vector<double> &,
+                              double, double, int, int);
+
+void degreeCentrality(const CompactGraph & g, Vector<int> & inDegree,
+                      Vector<int> & outDegree) {
+    int n = g.size();
+    inDegree = Vector<int>(n, 0);
+    outDegree = Vector<int>(n, 0);
+    for (int v = 0; v < n; v++) {
+        outDegree[v] = g.getArcEnd(v) - g.getArcBegin(v);
+    }
+    const int *finishes = g.getFinishes();
+    for (int a = 0; a < g.getArcCount(); a++) {
+        inDegree[finishes[a]]++;
+    }
+}
+
+/*
+ * Implementation notes: betweennessCentrality
+ * -------------------------------------------
+ * The threads take sources from a shared counter and add their results
+ * into private arrays, which are summed at the end, so the only shared
+ * state they update during the computation is the counter itself.
+ */
+
+void betweennessCentrality(const CompactGraph & g, Vector<double> & scores,
+                           bool weighted, int nSamples, int nThreads) {
+    int n = g.size();
+    if (nSamples <= 0 || nSamples > n) nSamples = n;
+    nThreads = chooseThreadCount(nThreads);
+    if (nThreads > nSamples) nThreads = (nSamples < 1) ? 1 : nSamples;
+    if (weighted) {
+        for (int a = 0; a < g.getArcCount(); a++) {
+            if (g.getCost(a) <= 0) {
+                error("betweennessCentrality: Arc costs must be positive");
+            }
+        }
+    }
+    atomic<int> next(0);
+    Vector<double *> partial;
+    for (int i = 0; i < nThreads; i++) {
+        partial.add(new double[n]);
+    }
+    Vector<thread *> threads;
+    for (int i = 1; i < nThreads; i++) {
+        threads.add(new thread(brandesThread, &g, weighted, nSamples, &next,
+                               partial[i]));
+    }
+    brandesThread(&g, weighted, nSamples, &next, partial[0]);
+    for (int i = 0; i < threads.size(); i++) {
+        threads[i]->join();
+        delete threads[i];
+    }
+    double scale = (nSamples == 0) ? 0 : (double) n / nSamples;
+    scores = Vector<double>(n, 0.0);
+    for (int v = 0; v < n; v++) {
+        double total = 0;
+        for (int i = 0; i < nThreads; i++) {
+            total += partial[i][v];
+        }
+        scores[v] = total * scale;
+    }
+    for (int i = 0; i < nThreads; i++) {
+        delete[] partial[i];
+    }
+}
+
+/*
+ * Private function: buildTranspose
+ * Usage: buildTranspose(g, t);
+ * ----------------------------
+ * Fills in the transpose of g with a counting sort on the arc finishes.
+ * Since the arcs of g are already in order of their starting node, the
+ * sources of the arcs entering each node come out in increasing order,
+ * which makes the reads in the PageRank loop as sequential as possible.
+ */
+
+static void buildTranspose(const CompactGraph & g, Transpose & t) {
+    int n = g.size();
+    int m = g.getArcCount();
+    const int *finishes = g.getFinishes();
+    t.offsets = new int[n + 1];
+    t.sources = new int[m];
+    for (int v = 0; v <= n; v++) {
+        t.offsets[v] = 0;
+    }
+    for (int a = 0; a < m; a++) {
+        t.offsets[finishes[a] + 1]++;
+    }
+    for (int v = 0; v < n; v++) {
+        t.offsets[v + 1] += t.offsets[v];
+    }
+    int *fill = new int[n];
+    for (int v = 0; v < n; v++) {
+        fill[v] = t.offsets[v];
+    }
+    for (int v = 0; v < n; v++) {
+        for (int a = g.getArcBegin(v); a < g.getArcEnd(v); a++) {
+            t.sources[fill[finishes[a]]++] = v;
+        }
+    }
+    delete[] fill;
+}
+
+/*
+ * Private function: chooseThreadCount
+ * Usage: nThreads = chooseThreadCount(nThreads);
+ * ----------------------------------------------
+ * Replaces a thread count of zero or less with the number of processors.
+ */
+
+static int chooseThreadCount(int nThreads) {
+    if (nThreads <= 0) nThreads = thread::hardware_concurrency();
+    if (nThreads <= 0) nThreads = 1;
+    return nThreads;
+}
+
+/*
+ * Private function: pageRankThread
+ * Usage: pageRankThread(state, id);
+ * ---------------------------------
+ * Runs the iterations for the nodes in the range of thread id. The
+ * inner loop that sums the contributions keeps four separate partial
+ * sums. Floating-point addition is not associative, so without them the
+ * compiler would have to add the terms one after another; with them,
+ * the four additions are independent and can be pipelined or combined
+ * into vector instructions, and the result does not depend on the
+ * compiler options.
+ */
+
+template <typename RealType>
+static void pageRankThread(PageRankState<RealType> *state, int id) {
+    int lo = state->bounds[id];
+    int hi = state->bounds[id + 1];
+    const int *offsets = state->offsets;
+    const int *sources = state->sources;
+    RealType *rank = state->rank;
+    RealType *contrib = state->contrib;
+    const RealType *invDegree = state->invDegree;
+    RealType damping = RealType(state->damping);
+    while (true) {
+        double dangling = 0;
+        for (int v = lo; v < hi; v++) {
+            contrib[v] = rank[v] * invDegree[v];
+            if (invDegree[v] == 0) dangling += rank[v];
+        }
+        state->dangling[id] = dangling;
+        state->barrier->wait([state]() {
+            double total = 0;
+            for (int i = 0; i < state->nThreads; i++) {
+                total += state->dangling[i];
+            }
+            state->base = RealType((1 - state->damping) / state->nNodes
+                                   + state->damping * total / state->nNodes);
+        });
+        RealType base = state->base;
+        double change = 0;
+        for (int v = lo; v < hi; v++) {
+            int i = offsets[v];
+            int end = offsets[v + 1];
+            RealType s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+            for (; i + 4 <= end; i += 4) {
+                s0 += contrib[sources[i]];
+                s1 += contrib[sources[i + 1]];
+                s2 += contrib[sources[i + 2]];
+                s3 += contrib[sources[i + 3]];
+            }
+            for (; i < end; i++) {
+                s0 += contrib[sources[i]];
+            }
+            RealType updated = base + damping * ((s0 + s1) + (s2 + s3));
+            change += fabs((double) updated - rank[v]);
+            rank[v] = updated;
+        }
+        state->change[id] = change;
+        state->barrier->wait([state]() {
+            double total = 0;
+            for (int i = 0; i < state->nThreads; i++) {
+                total += state->change[i];
+            }
+            state->iterations++;
+            state->finished = total < state->tolerance
+                           || state->iterations >= state->maxIterations;
+        });
+        if (state->finished) break;
+    }
+}
+
+/*
+ * Private function: brandesThread
+ * Usage: brandesThread(g, weighted, nSamples, next, scores);
+ * ----------------------------------------------------------
+ * Runs Brandes's algorithm from each source this thread claims, adding
+ * the dependencies into scores. The forward search records the nodes in
+ * the order in which they are settled, together with each node's
+ * distance and number of shortest paths. The backward pass visits the
+ * nodes in the opposite order and, for each arc v -> w that lies on a
+ * shortest path, adds w's share to v's dependency. Testing the arcs in
+ * this way avoids storing lists of predecessors. Only the nodes that the
+ * search reached are reset before the next source.
+ *
+ * On a large graph, nearly every access to per-node data misses the
+ * cache, so the distance, path count and dependency of each node are
+ * kept together in a BrandesEntry, where one miss fetches all three.
+ */
+
+static void brandesThread(const CompactGraph *g, bool weighted,
+                          int nSamples, atomic<int> *next, double *scores) {
+    typedef pair<double,int> HeapEntry;
+    int n = g->size();
+    const int *offsets = g->getOffsets();
+    const int *finishes = g->getFinishes();
+    const double *costs = g->getCosts();
+    BrandesEntry *node = new BrandesEntry[n];
+    int *order = new int[n];
+    for (int v = 0; v < n; v++) {
+        node[v].dist = -1;
+        node[v].sigma = 0;
+        node[v].delta = 0;
+        scores[v] = 0;
+    }
+    while (true) {
+        int first = next->fetch_add(SOURCES_PER_GRAB);
+        if (first >= nSamples) break;
+        int last = min(first + SOURCES_PER_GRAB, nSamples);
+        for (int k = first; k < last; k++) {
+            int s = (int) ((long) k * n / nSamples);
+            int nOrdered = 0;
+            node[s].dist = 0;
+            node[s].sigma = 1;
+            if (weighted) {
+                priority_queue<HeapEntry,vector<HeapEntry>,
+                               greater<HeapEntry> > heap;
+                heap.push(HeapEntry(0, s));
+                while (!heap.empty()) {
+                    double d = heap.top().first;
+                    int v = heap.top().second;
+                    heap.pop();
+                    if (d > node[v].dist) continue;
+                    order[nOrdered++] = v;
+                    for (int a = offsets[v]; a < offsets[v + 1]; a++) {
+                        BrandesEntry & w = node[finishes[a]];
+                        double nd = d + costs[a];
+                        if (w.dist < 0 || nd < w.dist) {
+                            w.dist = nd;
+                            w.sigma = node[v].sigma;
+                            heap.push(HeapEntry(nd, finishes[a]));
+                        } else if (nd == w.dist) {
+                            w.sigma += node[v].sigma;
+                        }
+                    }
+                }
+            } else {
+                order[nOrdered++] = s;
+                for (int head = 0; head < nOrdered; head++) {
+                    int v = order[head];
+                    double nd = node[v].dist + 1;
+                    for (int a = offsets[v]; a < offsets[v + 1]; a++) {
+                        BrandesEntry & w = node[finishes[a]];
+                        if (w.dist < 0) {
+                            w.dist = nd;
+                            order[nOrdered++] = finishes[a];
+                        }
+                        if (w.dist == nd) w.sigma += node[v].sigma;
+                    }
+                }
+            }
+            for (int i = nOrdered - 1; i >= 0; i--) {
+                int v = order[i];
+                BrandesEntry & entry = node[v];
+                for (int a = offsets[v]; a < offsets[v + 1]; a++) {
+                    const BrandesEntry & w = node[finishes[a]];
+                    double length = weighted ? costs[a] : 1;
+                    if (w.dist == entry.dist + length) {
+                        entry.delta += entry.sigma / w.sigma * (1 + w.delta);
+                    }
+                }
+                if (v != s) scores[v] += entry.delta;
+            }
+            for (int i = 0; i < nOrdered; i++) {
+                int v = order[i];
+                node[v].dist = -1;
+                node[v].sigma = 0;
+                node[v].delta = 0;
+            }
+        }
+    }
+    delete[] node;
+    delete[] order;
+}
@@ -0,0 +1,91 @@
+/*
+ * File: centrality.h
+ * ------------------
+ * This interface exports functions that rank the nodes of a CompactGraph
+ * by PageRank, by degree, and by betweenness centrality.
+ */
+
+#ifndef _centrality_h
+#define _centrality_h
+
+#include "compactgraph.h"
+#include "vector.h"
+
+/*
+ * Constants: PageRank defaults
+ * ----------------------------
+ * These constants give the default damping factor, the default
+ * convergence tolerance and the default iteration limit for pageRank.
+ */
+
+const double DEFAULT_DAMPING = 0.85;
+const double DEFAULT_TOLERANCE = 1e-6;
+const int DEFAULT_MAX_ITERATIONS = 100;
+
+/*
+ * Function: pageRank
+ * Usage: int iterations = pageRank(g, ranks);
+ *        int iterations = pageRank(g, ranks, damping, tolerance,
+ *                                  maxIterations, nThreads);
+ * ---------------------------------------------------------------
+ * Computes the PageRank of every node of g and stores it in ranks, which
+ * is indexed by node number. The ranks sum to 1. A node with no outgoing
+ * arcs shares its rank equally among all the nodes, as if it had an arc
+ * to each of them. The iteration stops when the sum of the absolute
+ * changes in rank falls below tolerance or after maxIterations steps,
+ * and the function returns the number of iterations performed.
+ *
+ * The RealType parameter selects the precision of the scores and may be
+ * float or double. Single precision halves the memory traffic of each
+ * iteration, which is usually the limit on speed, but it cannot reach
+ * tolerances much below 1e-6 on large graphs. The work is divided among
+ * nThreads threads; if nThreads is zero or omitted, the function uses
+ * one thread per processor.
+ */
+
+template <typename RealType>
+int pageRank(const CompactGraph & g, Vector<RealType> & ranks,
+             double damping = DEFAULT_DAMPING,
+             double tolerance = DEFAULT_TOLERANCE,
+             int maxIterations = DEFAULT_MAX_ITERATIONS,
+             int nThreads = 0);
+
+/*
+ * Function: degreeCentrality
+ * Usage: degreeCentrality(g, inDegree, outDegree);
+ * ------------------------------------------------
+ * Stores the number of arcs entering and leaving each node in the two
+ * vectors, which are indexed by node number.
+ */
+
+void degreeCentrality(const CompactGraph & g, Vector<int> & inDegree,
+                      Vector<int> & outDegree);
+
+/*
+ * Function: betweennessCentrality
+ * Usage: betweennessCentrality(g, scores);
+ *        betweennessCentrality(g, scores, weighted, nSamples, nThreads);
+ * ----------------------------------------------------------------------
+ * Stores in scores the betweenness centrality of each node, which is the
+ * number of shortest paths between other ordered pairs of nodes that
+ * pass through it, with each pair contributing a total of 1 divided
+ * among its shortest paths. In a graph that stores each connection in
+ * both directions, every unordered pair is counted twice. The function
+ * uses Brandes's algorithm, which runs a single-source search from every
+ * node. If weighted is true, the searches use the arc costs, which must
+ * be positive; otherwise every arc has length 1, which allows
+ * breadth-first search and is considerably faster.
+ *
+ * An exact result takes time proportional to the number of nodes times
+ * the number of arcs, which is impractical for very large graphs. If
+ * nSamples is positive, the function uses only that many sources,
+ * spread evenly over the node numbers, and scales the result up to
+ * estimate the exact value. The sources are divided among nThreads
+ * threads, with the same default as for pageRank.
+ */
+
+void betweennessCentrality(const CompactGraph & g, Vector<double> & scores,
+                           bool weighted = false, int nSamples = 0,
+                           int nThreads = 0);
+
+#endif
@@ -0,0 +1,156 @@
+/*
+ * File: checkedint.h
+ * ------------------
+ * This interface exports the CheckedInt class, a 64-bit integer whose
+ * arithmetic signals an error instead of overflowing.
+ */
+
+#ifndef _checkedint_h
+#define _checkedint_h
+
+#include <cstdint>
+#include <ostream>
+#include "error.h"
+
+/*
+ * Class: CheckedInt
+ * -----------------
+ * This class holds a signed 64-bit integer. The arithmetic operators
+ * give the same results as those on int64_t whenever the exact result
+ * fits in 64 bits and call error otherwise, so that a computation never
+ * produces a wrong value silently. Division by zero is also an error.
+ * With GCC and Clang, each check compiles to the overflow flag set by the
+ * arithmetic instruction itself, so a CheckedInt costs little more than
+ * an int64_t. Other compilers get portable checks that compare the
+ * operands against the limits before doing the arithmetic.
+ */
+
+class CheckedInt {
+
+public:
+
+/*
+ * Constructor: CheckedInt
+ * Usage: CheckedInt n;
+ *        CheckedInt n(value);
+ * ---------------------------
+ * Initializes a CheckedInt to value. Like an int, a CheckedInt declared
+ * without a value has no particular value, which lets arrays of them be
+ * created without clearing them first.
+ */
+
+    CheckedInt() = default;
+
+    CheckedInt(int64_t value) {
+        this->value = value;
+    }
+
+/*
+ * Method: getValue
+ * Usage: int64_t value = n.getValue();
+ * ------------------------------------
+ * Returns the value as an ordinary integer.
+ */
+
+    int64_t getValue() const {
+        return value;
+    }
+
+/*
+ * Operators: +, -, *, /, ==, !=
+ * -----------------------------
+ * The arithmetic operators signal "Integer overflow" if the result does
+ * not fit. Division truncates toward zero, as it does for int64_t.
+ */
+
+#if defined(__GNUC__) || defined(__clang__)
+
+    friend CheckedInt operator+(CheckedInt x, CheckedInt y) {
+        int64_t result;
+        if (__builtin_add_overflow(x.value, y.value, &result)) overflow();
+        return CheckedInt(result);
+    }
+
+    friend CheckedInt operator-(CheckedInt x, CheckedInt y) {
+        int64_t result;
+        if (__builtin_sub_overflow(x.value, y.value, &result)) overflow();
+        return CheckedInt(result);
+    }
+
+    friend CheckedInt operator*(CheckedInt x, CheckedInt y) {
+        int64_t result;
+        if (__builtin_mul_overflow(x.value, y.value, &result)) overflow();
+        return CheckedInt(result);
+    }
+
+#else
+
+    friend CheckedInt operator+(CheckedInt x, CheckedInt y) {
+        if (y.value > 0 ? x.value > INT64_MAX - y.value
+                        : x.value < INT64_MIN - y.value) overflow();
+        return CheckedInt(x.value + y.value);
+    }
+
+    friend CheckedInt operator-(CheckedInt x, CheckedInt y) {
+        if (y.value < 0 ? x.value > INT64_MAX + y.value
+                        : x.value < INT64_MIN + y.value) overflow();
+        return CheckedInt(x.value - y.value);
+    }
+
+    friend CheckedInt operator*(CheckedInt x, CheckedInt y) {
+        int64_t a = x.value;
+        int64_t b = y.value;
+        if (a == 0 || b == 0) return CheckedInt(0);
+        bool fits;
+        if (a > 0) {
+            fits = (b > 0) ? a <= INT64_MAX / b : b >= INT64_MIN / a;
+        } else {
+            fits = (b > 0) ? a >= INT64_MIN / b : a >= INT64_MAX / b;
+        }
+        if (!fits) overflow();
+        return CheckedInt(a * b);
+    }
+
+#endif
+
+    friend CheckedInt operator/(CheckedInt x, CheckedInt y) {
+        if (y.value == 0) error("Division by 0");
+        if (y.value == -1 && x.value == INT64_MIN) overflow();
+        return CheckedInt(x.value / y.value);
+    }
+
+    friend bool operator==(CheckedInt x, CheckedInt y) {
+        return x.value == y.value;
+    }
+
+    friend bool operator!=(CheckedInt x, CheckedInt y) {
+        return x.value != y.value;
+    }
+
+/*
+ * Operator: <<
+ * ------------
+ * Writes the value to an output stream.
+ */
+
+    friend std::ostream & operator<<(std::ostream & os, CheckedInt x) {
+        return os << x.value;
+    }
+
+/* Private section */
+
+private:
+
+/* Instance variables */
+
+    int64_t value;          // The value of the integer
+
+/* Private methods */
+
+    static void overflow() {
+        error("Integer overflow");
+    }
+
+};
+
+#endif
@@ -0,0 +1,424 @@
+/*
+ * File: columnar.cpp
+ * ------------------
+ * This file implements the columnar.h interface.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include "columnar.h"
+#include "error.h"
+#include "exp.h"
+#include "strlib.h" // From Stanford libraries
+using namespace std;
+
+/* Constants */
+
+const int BLOCK_SIZE = 1024;        // Rows each step processes at a time
+const int LANES = 8;                // Values in one vector register
+
+/* Private function prototypes */
+
+static bool applyStep(OperatorType op, int32_t *dst, const int32_t *lhs,
+                      const int32_t *rhs, int n);
+static string operandToString(int operand, const StringInterner & names);
+static int chooseThreadCount(int nThreads);
+
+/*
+ * Implementation notes: vector types
+ * ----------------------------------
+ * With GCC or Clang, the kernels use the vector extensions, which map
+ * each operation on a Lanes value onto the widest instructions the target
+ * supports: one AVX2 instruction for eight values, or two SSE instructions
+ * on a baseline x86-64 build. The arithmetic is done in unsigned lanes so
+ * that overflow wraps instead of being undefined. Values are moved in and
+ * out with memcpy, which compiles to unaligned loads and stores, since the
+ * client's columns need not be aligned. Other compilers get scalar loops,
+ * which they are free to vectorize on their own.
+ */
+
+#if defined(__GNUC__)
+
+typedef uint32_t Lanes __attribute__((vector_size(LANES * sizeof(int32_t))));
+typedef int32_t Mask __attribute__((vector_size(LANES * sizeof(int32_t))));
+
+/*
+ * Macro: LANE_LOOP
+ * ----------------
+ * Applies the operator to as many whole vectors of lhs and rhs as fit in
+ * n values, advancing i past them. The vectors are kept in local variables
+ * rather than passed to helper functions, whose calling convention for
+ * wide vectors would depend on the target options.
+ */
+
+#define LANE_LOOP(OP)                                                   \
+    for (; i + LANES <= n; i += LANES) {                                \
+        Lanes x, y;                                                     \
+        memcpy(&x, lhs + i, sizeof x);                                  \
+        memcpy(&y, rhs + i, sizeof y);                                  \
+        x = x OP y;                                                     \
+        memcpy(dst + i, &x, sizeof x);                                  \
+    }
+
+#endif
+
+/*
+ * Implementation notes: constructor and destructor
+ * ------------------------------------------------
+ * The steps live in Vectors, so the destructor has nothing to free.
+ */
+
+ColumnarProgram::ColumnarProgram() {
+    nBuffers = 0;
+    root = 0;
+}
+
+ColumnarProgram::ColumnarProgram(Expression *exp) {
+    nBuffers = 0;
+    root = 0;
+    compile(exp);
+}
+
+ColumnarProgram::~ColumnarProgram() {
+    /* Empty */
+}
+
+/*
+ * Implementation notes: compile
+ * -----------------------------
+ * The compiler keeps the variables assigned so far, each with the buffer
+ * holding its latest value, and the buffer for each depth of intermediate
+ * results. A program whose root is a leaf has no steps at all.
+ */
+
+void ColumnarProgram::compile(Expression *exp) {
+    steps.clear();
+    constants.clear();
+    names.clear();
+    nBuffers = 0;
+    StringInterner assigned;
+    Vector<int> assignedBuffer;
+    Vector<int> temps;
+    root = compileTree(exp, 0, assigned, assignedBuffer, temps);
+    columns.clear();
+    for (int i = 0; i < names.size(); i++) {
+        columns.add(NULL);
+    }
+}
+
+int ColumnarProgram::getColumnCount() const {
+    return names.size();
+}
+
+int ColumnarProgram::getColumn(string_view name) const {
+    return names.find(name);
+}
+
+string_view ColumnarProgram::getColumnName(int column) const {
+    return names.getName(column);
+}
+
+void ColumnarProgram::bindColumn(int column, const int32_t *values) {
+    columns[column] = values;
+}
+
+void ColumnarProgram::bindColumn(string_view name, const int32_t *values) {
+    int column = names.find(name);
+    if (column < 0) error(string(name) + " is not an input column");
+    columns[column] = values;
+}
+
+/*
+ * Implementation notes: evaluate
+ * ------------------------------
+ * The rows are divided into blocks, and each thread takes a contiguous
+ * range of blocks, so that no two threads write the same cache line of
+ * the result. A thread that divides by zero sets the shared flag, which
+ * makes the others stop at the end of their current block, and the
+ * error is signaled here once every thread has finished. A single thread
+ * runs on the caller's stack without creating a thread at all.
+ */
+
+void ColumnarProgram::evaluate(int32_t *result, int nRows,
+                               int nThreads) const {
+    for (int i = 0; i < columns.size(); i++) {
+        if (columns[i] == NULL) {
+            error(string(names.getName(i)) + " is undefined");
+        }
+    }
+    if (nRows <= 0) return;
+    int nBlocks = (nRows + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    nThreads = chooseThreadCount(nThreads);
+    if (nThreads > nBlocks) nThreads = nBlocks;
+    atomic<bool> failed(false);
+    if (nThreads == 1) {
+        evaluateRange(result, 0, nRows, &failed);
+    } else {
+        Vector<thread *> threads;
+        for (int i = 0; i < nThreads; i++) {
+            long start = (long) nBlocks * i / nThreads * BLOCK_SIZE;
+            long finish = (long) nBlocks * (i + 1) / nThreads * BLOCK_SIZE;
+            if (finish > nRows) finish = nRows;
+            threads.add(new thread(&ColumnarProgram::evaluateRange, this,
+                                   result, (int) start, (int) finish,
+                                   &failed));
+        }
+        for (int i = 0; i < threads.size(); i++) {
+            threads[i]->join();
+            delete threads[i];
+        }
+    }
+    if (failed) error("Division by 0");
+}
+
+/*
+ * Implementation notes: toString
+ * ------------------------------
+ * Buffers appear as b0, b1, and so on, and input columns by name. The
+ * constant buffers are listed first, since each thread fills them before
+ * it runs the steps.
+ */
+
+string ColumnarProgram::toString() const {
+    string listing;
+    for (int i = 0; i < constants.size(); i++) {
+        listing += "b" + integerToString(constants[i].buffer) + " = "
+                 + integerToString(constants[i].value) + "\n";
+    }
+    for (int i = 0; i < steps.size(); i++) {
+        const Step & step = steps[i];
+        listing += "b" + integerToString(step.dst) + " = "
+                 + operandToString(step.lhs, names);
+        if (step.op != ASSIGN) {
+            listing += " " + operatorToString(step.op) + " "
+                     + operandToString(step.rhs, names);
+        }
+        listing += "\n";
+    }
+    listing += "result = " + operandToString(root, names) + "\n";
+    return listing;
+}
+
+/*
+ * Private method: compileTree
+ * Usage: int operand = compileTree(exp, depth, assigned, assignedBuffer,
+ *                                  temps);
+ * ----------------------------------------------------------------------
+ * Appends the steps for exp and returns the operand that holds its value.
+ * An intermediate result at the specified depth goes in the buffer
+ * temps[depth]. As in CompoundExp::eval, the right operand is compiled
+ * before the left, which is one level deeper so that it cannot overwrite
+ * the right operand's buffer. A variable that has been assigned refers to
+ * the buffer in assignedBuffer; any other variable is an input column.
+ * Constants, input columns and assigned buffers never change once written,
+ * so an assignment copies its value only when it is an intermediate.
+ */
+
+int ColumnarProgram::compileTree(Expression *exp, int depth,
+                                 StringInterner & assigned,
+                                 Vector<int> & assignedBuffer,
+                                 Vector<int> & temps) {
+    switch (exp->getType()) {
+        case CONSTANT: {
+            ConstantFill fill;
+            fill.buffer = nBuffers++;
+            fill.value = exp->getConstantValue();
+            constants.add(fill);
+            return fill.buffer;
+        }
+        case IDENTIFIER: {
+            string name = exp->getIdentifierName();
+            int var = assigned.find(name);
+            if (var >= 0) return assignedBuffer[var];
+            return ~names.intern(name);
+        }
+        case COMPOUND:
+            break;
+    }
+    OperatorType op = exp->getOperatorType();
+    if (op == ASSIGN) {
+        string name = exp->getLHS()->getIdentifierName();
+        int value = compileTree(exp->getRHS(), depth, assigned,
+                                assignedBuffer, temps);
+        if (depth < temps.size() && value == temps[depth]) {
+            Step step;
+            step.op = ASSIGN;
+            step.dst = nBuffers++;
+            step.lhs = value;
+            step.rhs = value;
+            steps.add(step);
+            value = step.dst;
+        }
+        int var = assigned.intern(name);
+        if (var == assignedBuffer.size()) {
+            assignedBuffer.add(value);
+        } else {
+            assignedBuffer[var] = value;
+        }
+        return value;
+    }
+    Step step;
+    step.op = op;
+    step.rhs = compileTree(exp->getRHS(), depth, assigned, assignedBuffer,
+                           temps);
+    step.lhs = compileTree(exp->getLHS(), depth + 1, assigned,
+                           assignedBuffer, temps);
+    while (temps.size() <= depth) {
+        temps.add(nBuffers++);
+    }
+    step.dst = temps[depth];
+    steps.add(step);
+    return step.dst;
+}
+
+/*
+ * Private method: evaluateRange
+ * Usage: evaluateRange(result, start, finish, failed);
+ * ----------------------------------------------------
+ * Evaluates rows start through finish - 1, one block at a time. The
+ * buffers for a block fit in the first-level cache for all but very large
+ * expressions, so the intermediate results never travel to memory.
+ */
+
+void ColumnarProgram::evaluateRange(int32_t *result, int start, int finish,
+                                    atomic<bool> *failed) const {
+    int32_t *buffers = new int32_t[(long) (nBuffers + 1) * BLOCK_SIZE];
+    for (int i = 0; i < constants.size(); i++) {
+        int32_t *buffer = buffers + (long) constants[i].buffer * BLOCK_SIZE;
+        for (int j = 0; j < BLOCK_SIZE; j++) {
+            buffer[j] = constants[i].value;
+        }
+    }
+    int nSteps = steps.size();
+    for (int row = start; row < finish; row += BLOCK_SIZE) {
+        if (failed->load(memory_order_relaxed)) break;
+        int n = (finish - row < BLOCK_SIZE) ? finish - row : BLOCK_SIZE;
+        for (int i = 0; i < nSteps; i++) {
+            const Step & step = steps[i];
+            const int32_t *lhs = (step.lhs >= 0)
+                               ? buffers + (long) step.lhs * BLOCK_SIZE
+                               : columns[~step.lhs] + row;
+            const int32_t *rhs = (step.rhs >= 0)
+                               ? buffers + (long) step.rhs * BLOCK_SIZE
+                               : columns[~step.rhs] + row;
+            int32_t *dst = buffers + (long) step.dst * BLOCK_SIZE;
+            if (!applyStep(step.op, dst, lhs, rhs, n)) {
+                failed->store(true);
+                break;
+            }
+        }
+        const int32_t *value = (root >= 0)
+                             ? buffers + (long) root * BLOCK_SIZE
+                             : columns[~root] + row;
+        memcpy(result + row, value, n * sizeof(int32_t));
+    }
+    delete[] buffers;
+}
+
+/*
+ * Private function: applyStep
+ * Usage: if (applyStep(op, dst, lhs, rhs, n)) . . .
+ * -------------------------------------------------
+ * Applies the operator to the first n values of lhs and rhs, storing the
+ * results in dst, and returns true. For division, the method first checks
+ * the whole divisor block for zeros, comparing a vector of divisors at a
+ * time and combining the comparisons with a bitwise or; if any divisor is
+ * zero, the method stores nothing and returns false. The processor has no
+ * vector instruction for integer division, so the quotients themselves
+ * are computed one at a time. A divisor of -1 negates the dividend
+ * through unsigned arithmetic, as the bytecode does, so that the most
+ * negative int wraps around to itself instead of trapping.
+ */
+
+static bool applyStep(OperatorType op, int32_t *dst, const int32_t *lhs,
+                      const int32_t *rhs, int n) {
+    int i = 0;
+    switch (op) {
+        case ASSIGN:
+            memcpy(dst, lhs, n * sizeof(int32_t));
+            return true;
+        case ADD:
+#if defined(__GNUC__)
+            LANE_LOOP(+);
+#endif
+            for (; i < n; i++) {
+                dst[i] = (uint32_t) lhs[i] + (uint32_t) rhs[i];
+            }
+            return true;
+        case SUBTRACT:
+#if defined(__GNUC__)
+            LANE_LOOP(-);
+#endif
+            for (; i < n; i++) {
+                dst[i] = (uint32_t) lhs[i] - (uint32_t) rhs[i];
+            }
+            return true;
+        case MULTIPLY:
+#if defined(__GNUC__)
+            LANE_LOOP(*);
+#endif
+            for (; i < n; i++) {
+                dst[i] = (uint32_t) lhs[i] * (uint32_t) rhs[i];
+            }
+            return true;
+        case DIVIDE: {
+            bool zero = false;
+#if defined(__GNUC__)
+            Mask zeros = { };
+            for (; i + LANES <= n; i += LANES) {
+                Lanes y;
+                memcpy(&y, rhs + i, sizeof y);
+                zeros |= (y == 0);
+            }
+            for (int k = 0; k < LANES; k++) {
+                if (zeros[k] != 0) zero = true;
+            }
+#endif
+            for (; i < n; i++) {
+                if (rhs[i] == 0) zero = true;
+            }
+            if (zero) return false;
+            for (i = 0; i < n; i++) {
+                if (rhs[i] == -1) {
+                    dst[i] = 0 - (uint32_t) lhs[i];
+                } else {
+                    dst[i] = lhs[i] / rhs[i];
+                }
+            }
+            return true;
+        }
+    }
+    return true;
+}
+
+#if defined(__GNUC__)
+#undef LANE_LOOP
+#endif
+
+/*
+ * Private function: operandToString
+ * Usage: string str = operandToString(operand, names);
+ * ----------------------------------------------------
+ * Returns the name of a buffer or input column for the listing.
+ */
+
+static string operandToString(int operand, const StringInterner & names) {
+    if (operand >= 0) return "b" + integerToString(operand);
+    return string(names.getName(~operand));
+}
+
+/*
+ * Private function: chooseThreadCount
+ * Usage: nThreads = chooseThreadCount(nThreads);
+ * ----------------------------------------------
+ * Replaces a thread count of zero or less with the number of processors.
+ */
+
+static int chooseThreadCount(int nThreads) {
+    if (nThreads <= 0) nThreads = thread::hardware_concurrency();
+    if (nThreads <= 0) nThreads = 1;
+    return nThreads;
+}
@@ -0,0 +1,199 @@
+/*
+ * File: columnar.h
+ * ----------------
+ * This interface exports the ColumnarProgram class, which evaluates an
+ * expression over many rows of input at once, with each variable bound
+ * to a column of values.
+ */
+
+#ifndef _columnar_h
+#define _columnar_h
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "exp.h"
+#include "interner.h"
+#include "vector.h"
+
+/*
+ * Class: ColumnarProgram
+ * ----------------------
+ * This class holds an expression compiled for evaluation over a table.
+ * Each variable the expression reads is an input column, which the client
+ * binds to an array holding one value per row. The evaluate method then
+ * fills a result array with the value of the expression for every row:
+ *
+ *      ColumnarProgram program(exp);
+ *      program.bindColumn("price", price);
+ *      program.bindColumn("qty", qty);
+ *      program.evaluate(total, nRows);
+ *
+ * Instead of walking the tree once per row, the program applies each
+ * operator to a whole block of rows in a tight loop, which the processor
+ * can run several lanes at a time. The blocks are divided among threads.
+ *
+ * An assignment inside the expression gives a name to an intermediate
+ * column, which later reads of the variable in the same row see, just as
+ * they would with Expression::eval. Assigned values are not returned to
+ * the client; a variable that is read before it is assigned is an input.
+ */
+
+class ColumnarProgram {
+
+public:
+
+/*
+ * Constructor: ColumnarProgram
+ * Usage: ColumnarProgram program;
+ *        ColumnarProgram program(exp);
+ * ------------------------------------
+ * Initializes a program, compiling the expression exp if it is given.
+ * The program does not keep any pointer to the expression tree.
+ */
+
+    ColumnarProgram();
+    ColumnarProgram(Expression *exp);
+
+/*
+ * Destructor: ~ColumnarProgram
+ * ----------------------------
+ * Frees any heap storage associated with this program. The columns
+ * belong to the client and are not freed.
+ */
+
+    ~ColumnarProgram();
+
+/*
+ * Method: compile
+ * Usage: program.compile(exp);
+ * ----------------------------
+ * Replaces the contents of the program with the translation of exp and
+ * unbinds every column. This method signals an error if the left side of
+ * an assignment is not an identifier.
+ */
+
+    void compile(Expression *exp);
+
+/*
+ * Method: getColumnCount
+ * Usage: int n = program.getColumnCount();
+ * ----------------------------------------
+ * Returns the number of input columns the expression reads.
+ */
+
+    int getColumnCount() const;
+
+/*
+ * Method: getColumn
+ * Usage: int column = program.getColumn(name);
+ * --------------------------------------------
+ * Returns the index of the input column for the named variable, or -1
+ * if the expression does not read that variable as an input.
+ */
+
+    int getColumn(std::string_view name) const;
+
+/*
+ * Method: getColumnName
+ * Usage: std::string_view name = program.getColumnName(column);
+ * -------------------------------------------------------------
+ * Returns the name of the variable for the specified input column.
+ */
+
+    std::string_view getColumnName(int column) const;
+
+/*
+ * Method: bindColumn
+ * Usage: program.bindColumn(column, values);
+ *        program.bindColumn(name, values);
+ * -----------------------------------------
+ * Binds an input column to an array, which must hold a value for every
+ * row passed to evaluate and must not change while evaluate runs. The
+ * second form signals an error if the expression does not read the named
+ * variable as an input.
+ */
+
+    void bindColumn(int column, const int32_t *values);
+    void bindColumn(std::string_view name, const int32_t *values);
+
+/*
+ * Method: evaluate
+ * Usage: program.evaluate(result, nRows);
+ *        program.evaluate(result, nRows, nThreads);
+ * -------------------------------------------------
+ * Stores the value of the expression for rows 0 through nRows - 1 in the
+ * array result, using the specified number of threads. If nThreads is
+ * zero or less, the method uses one thread per processor. This method
+ * signals an error if an input column is unbound or if any row divides
+ * by zero; the contents of result are unspecified after an error.
+ */
+
+    void evaluate(int32_t *result, int nRows, int nThreads = 0) const;
+
+/*
+ * Method: toString
+ * Usage: string listing = program.toString();
+ * -------------------------------------------
+ * Returns a listing of the column operations, one per line.
+ */
+
+    std::string toString() const;
+
+/*
+ * Notes on representation
+ * -----------------------
+ * The compiled program is a list of steps, each of which applies one
+ * operator to two operand columns and writes a destination column. An
+ * operand is either an input column, written ~c for column c, or one of
+ * the block buffers that each thread allocates for itself, written as a
+ * nonnegative buffer number. Constants have buffers filled once when a
+ * thread starts, and intermediate results have buffers assigned by depth,
+ * as the bytecode compiler assigns stack positions. An assignment of an
+ * intermediate result copies it into a fresh buffer, so a later step can
+ * never overwrite a value that an earlier read still refers to.
+ */
+
+private:
+
+/* Type definitions */
+
+    struct Step {
+        OperatorType op;    // The operator; ASSIGN copies lhs to dst
+        int dst;            // The buffer that receives the result
+        int lhs;            // The left operand
+        int rhs;            // The right operand, unused by ASSIGN
+    };
+
+    struct ConstantFill {
+        int buffer;         // The buffer holding the constant
+        int32_t value;      // The value of the constant
+    };
+
+/* Instance variables */
+
+    Vector<Step> steps;                 // The operations in order
+    Vector<ConstantFill> constants;     // The buffers holding constants
+    StringInterner names;               // The name of each input column
+    Vector<const int32_t *> columns;    // The array bound to each column
+    int nBuffers;                       // The buffers each thread needs
+    int root;                           // The operand holding the result
+
+/* Private methods */
+
+    int compileTree(Expression *exp, int depth, StringInterner & assigned,
+                    Vector<int> & assignedBuffer, Vector<int> & temps);
+    void evaluateRange(int32_t *result, int start, int finish,
+                       std::atomic<bool> *failed) const;
+
+/* Make it illegal to copy programs */
+
+    ColumnarProgram(const ColumnarProgram & src) { }
+    ColumnarProgram & operator=(const ColumnarProgram & src) {
+        return *this;
+    }
+
+};
+
+#endif
@@ -0,0 +1,377 @@
+/*
+ * File: compactgraph.cpp
+ * ----------------------
+ * This file implements the compactgraph.h interface.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include "compactgraph.h"
+#include "error.h"
+#include "interner.h"
+#include "mappedfile.h"
+using namespace std;
+
+/*
+ * Implementation notes: snapshot format
+ * -------------------------------------
+ * A snapshot file begins with the SnapshotHeader structure below, which
+ * is followed by the six arrays of the graph, each starting on an 8-byte
+ * boundary so that it can be used in place once the file is mapped:
+ *
+ *      offsets       nNodes + 1 ints
+ *      finishes      nArcs ints
+ *      costs         nArcs doubles
+ *      nameOffsets   nNodes + 1 ints
+ *      sortedIds     nNodes ints
+ *      nameChars     nameBytes chars
+ *
+ * The header records the byte position of each array, so later versions
+ * can add sections without breaking the layout of the existing ones.
+ * Numbers are stored in the byte order of the machine that wrote the
+ * file; the byteOrder field lets load reject a file from a machine with
+ * the opposite order instead of misreading it. SNAPSHOT_VERSION must be
+ * incremented whenever the meaning of an existing field changes.
+ */
+
+const int SNAPSHOT_VERSION = 1;
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+const char SNAPSHOT_MAGIC[8] = { 'C', 'G', 'R', 'A', 'P', 'H', '\r', '\n' };
+
+enum SnapshotSection {
+    OFFSETS, FINISHES, COSTS, NAME_OFFSETS, SORTED_IDS, NAME_CHARS,
+    N_SECTIONS
+};
+
+struct SnapshotHeader {
+    char magic[8];                  // Identifies the file as a snapshot
+    uint32_t byteOrder;             // BYTE_ORDER_MARK as written
+    int32_t version;                // SNAPSHOT_VERSION as written
+    int32_t nNodes;                 // The number of nodes
+    int32_t nArcs;                  // The number of arcs
+    int64_t nameBytes;              // The length of the name characters
+    int64_t fileSize;               // The total length of the file
+    int64_t position[N_SECTIONS];   // The byte position of each array
+    int64_t length[N_SECTIONS];     // The byte length of each array
+};
+
+/* Empty offsets array shared by every empty graph */
+
+static const int EMPTY_OFFSETS[1] = { 0 };
+
+/* Private function prototypes */
+
+int64_t alignSection(int64_t pos);
+
+/*
+ * Implementation notes: constructor and destructor
+ * ------------------------------------------------
+ * An empty graph points offsets at a shared one-element array, which
+ * keeps the invariant that offsets has nNodes + 1 entries.
+ */
+
+CompactGraph::CompactGraph() {
+    nNodes = 0;
+    nArcs = 0;
+    offsets = EMPTY_OFFSETS;
+    finishes = NULL;
+    costs = NULL;
+    nameChars = NULL;
+    nameOffsets = NULL;
+    sortedIds = NULL;
+    snapshot = NULL;
+}
+
+CompactGraph::~CompactGraph() {
+    clear();
+}
+
+/*
+ * Implementation notes: build
+ * ---------------------------
+ * The arcs are placed in the finishes and costs arrays using a counting
+ * sort on the starting node. The first pass counts the arcs leaving each
+ * node, a running sum turns the counts into offsets, and the second pass
+ * drops each arc into the next free position for its starting node. The
+ * name table is copied as a block from the interner and then indexed by
+ * sorting the node identifiers on their names.
+ */
+
+void CompactGraph::build(const StringInterner & names, int nArcs,
+                         const int *starts, const int *finishes,
+                         const double *costs) {
+    clear();
+    nNodes = names.size();
+    this->nArcs = nArcs;
+    int *newOffsets = new int[nNodes + 1];
+    for (int i = 0; i <= nNodes; i++) {
+        newOffsets[i] = 0;
+    }
+    for (int i = 0; i < nArcs; i++) {
+        newOffsets[starts[i] + 1]++;
+    }
+    for (int i = 0; i < nNodes; i++) {
+        newOffsets[i + 1] += newOffsets[i];
+    }
+    int *next = new int[nNodes];
+    memcpy(next, newOffsets, nNodes * sizeof(int));
+    int *newFinishes = new int[nArcs];
+    double *newCosts = new double[nArcs];
+    for (int i = 0; i < nArcs; i++) {
+        int pos = next[starts[i]]++;
+        newFinishes[pos] = finishes[i];
+        newCosts[pos] = costs[i];
+    }
+    delete[] next;
+    int *newNameOffsets = new int[nNodes + 1];
+    memcpy(newNameOffsets, names.getOffsets(), (nNodes + 1) * sizeof(int));
+    char *newNameChars = new char[newNameOffsets[nNodes] + 1];
+    memcpy(newNameChars, names.getCharacters(), newNameOffsets[nNodes]);
+    offsets = newOffsets;
+    this->finishes = newFinishes;
+    this->costs = newCosts;
+    nameOffsets = newNameOffsets;
+    nameChars = newNameChars;
+    int *newSortedIds = new int[nNodes];
+    for (int i = 0; i < nNodes; i++) {
+        newSortedIds[i] = i;
+    }
+    sort(newSortedIds, newSortedIds + nNodes, [this](int a, int b) {
+        return getName(a) < getName(b);
+    });
+    sortedIds = newSortedIds;
+}
+
+/*
+ * Implementation notes: save
+ * --------------------------
+ * The save method fills in the header, computing the position of each
+ * section by rounding up to the next multiple of 8, and then writes the
+ * header and the six arrays in order, padding between them with zeros.
+ */
+
+void CompactGraph::save(string filename) const {
+    SnapshotHeader header;
+    memset(&header, 0, sizeof header);
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof header.magic);
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.version = SNAPSHOT_VERSION;
+    header.nNodes = nNodes;
+    header.nArcs = nArcs;
+    header.nameBytes = (nNodes == 0) ? 0 : nameOffsets[nNodes];
+    const void *data[N_SECTIONS];
+    data[OFFSETS] = offsets;
+    header.length[OFFSETS] = (nNodes + 1) * sizeof(int32_t);
+    data[FINISHES] = finishes;
+    header.length[FINISHES] = nArcs * sizeof(int32_t);
+    data[COSTS] = costs;
+    header.length[COSTS] = nArcs * sizeof(double);
+    data[NAME_OFFSETS] = nameOffsets;
+    header.length[NAME_OFFSETS] = (nNodes == 0) ? 0
+                                : (nNodes + 1) * sizeof(int32_t);
+    data[SORTED_IDS] = sortedIds;
+    header.length[SORTED_IDS] = nNodes * sizeof(int32_t);
+    data[NAME_CHARS] = nameChars;
+    header.length[NAME_CHARS] = header.nameBytes;
+    int64_t pos = alignSection(sizeof header);
+    for (int i = 0; i < N_SECTIONS; i++) {
+        header.position[i] = pos;
+        pos = alignSection(pos + header.length[i]);
+    }
+    header.fileSize = pos;
+    ofstream outfile(filename.c_str(), ios::binary);
+    if (outfile.fail()) error("save: Can't create " + filename);
+    const char zeros[8] = { 0 };
+    outfile.write(reinterpret_cast<const char *>(&header), sizeof header);
+    pos = sizeof header;
+    for (int i = 0; i < N_SECTIONS; i++) {
+        outfile.write(zeros, header.position[i] - pos);
+        outfile.write(static_cast<const char *>(data[i]), header.length[i]);
+        pos = header.position[i] + header.length[i];
+    }
+    outfile.write(zeros, header.fileSize - pos);
+    outfile.close();
+    if (outfile.fail()) error("save: Error writing " + filename);
+}
+
+/*
+ * Implementation notes: load
+ * --------------------------
+ * The load method maps the file and checks the header: the magic bytes,
+ * the byte order, the version, the total size, and that every section
+ * lies inside the file, is aligned, and has the length implied by the
+ * node and arc counts. Once the header passes those checks, the array
+ * fields are simply pointed into the mapping. The contents of the arrays
+ * are trusted, which is what makes loading independent of graph size.
+ * Queries touch the snapshot at scattered places, so the file is mapped
+ * for random access, which keeps the kernel from reading ahead of each
+ * page that a query touches.
+ */
+
+void CompactGraph::load(string filename) {
+    clear();
+    MappedFile *file = new MappedFile(filename, MappedFile::RANDOM);
+    const char *base = file->getData();
+    SnapshotHeader header;
+    bool ok = file->size() >= sizeof header;
+    if (ok) {
+        memcpy(&header, base, sizeof header);
+        ok = memcmp(header.magic, SNAPSHOT_MAGIC, sizeof header.magic) == 0;
+    }
+    if (!ok) {
+        delete file;
+        error("load: " + filename + " is not a graph snapshot");
+    }
+    if (header.byteOrder != BYTE_ORDER_MARK
+            || header.version != SNAPSHOT_VERSION) {
+        delete file;
+        error("load: " + filename + " was written by an incompatible version");
+    }
+    int64_t expected[N_SECTIONS];
+    expected[OFFSETS] = (int64_t(header.nNodes) + 1) * sizeof(int32_t);
+    expected[FINISHES] = int64_t(header.nArcs) * sizeof(int32_t);
+    expected[COSTS] = int64_t(header.nArcs) * sizeof(double);
+    expected[NAME_OFFSETS] = (header.nNodes == 0) ? 0
+                           : (int64_t(header.nNodes) + 1) * sizeof(int32_t);
+    expected[SORTED_IDS] = int64_t(header.nNodes) * sizeof(int32_t);
+    expected[NAME_CHARS] = header.nameBytes;
+    ok = header.fileSize == int64_t(file->size()) && header.nNodes >= 0
+      && header.nArcs >= 0;
+    for (int i = 0; ok && i < N_SECTIONS; i++) {
+        ok = header.length[i] == expected[i] && header.position[i] % 8 == 0
+          && header.position[i] >= int64_t(sizeof header)
+          && header.position[i] + header.length[i] <= header.fileSize;
+    }
+    if (!ok) {
+        delete file;
+        error("load: " + filename + " is truncated or corrupt");
+    }
+    snapshot = file;
+    nNodes = header.nNodes;
+    nArcs = header.nArcs;
+    offsets = reinterpret_cast<const int *>(base + header.position[OFFSETS]);
+    finishes = reinterpret_cast<const int *>(base
+                                             + header.position[FINISHES]);
+    costs = reinterpret_cast<const double *>(base + header.position[COSTS]);
+    nameOffsets = (nNodes == 0) ? NULL
+                : reinterpret_cast<const int *>(base
+                                          + header.position[NAME_OFFSETS]);
+    sortedIds = reinterpret_cast<const int *>(base
+                                              + header.position[SORTED_IDS]);
+    nameChars = base + header.position[NAME_CHARS];
+}
+
+/*
+ * Implementation notes: clear
+ * ---------------------------
+ * The clear method frees the arrays if they were allocated by build or
+ * unmaps the snapshot if they came from load, and then restores the
+ * state of an empty graph.
+ */
+
+void CompactGraph::clear() {
+    if (snapshot != NULL) {
+        delete snapshot;
+    } else if (offsets != EMPTY_OFFSETS) {
+        delete[] offsets;
+        delete[] finishes;
+        delete[] costs;
+        delete[] nameChars;
+        delete[] nameOffsets;
+        delete[] sortedIds;
+    }
+    nNodes = 0;
+    nArcs = 0;
+    offsets = EMPTY_OFFSETS;
+    finishes = NULL;
+    costs = NULL;
+    nameChars = NULL;
+    nameOffsets = NULL;
+    sortedIds = NULL;
+    snapshot = NULL;
+}
+
+/*
+ * Implementation notes: getNodeId
+ * -------------------------------
+ * This method performs a binary search on the array of identifiers
+ * sorted by name.
+ */
+
+int CompactGraph::getNodeId(string_view name) const {
+    int lh = 0;
+    int rh = nNodes - 1;
+    while (lh <= rh) {
+        int mid = (lh + rh) / 2;
+        string_view midName = getName(sortedIds[mid]);
+        if (midName == name) return sortedIds[mid];
+        if (midName < name) {
+            lh = mid + 1;
+        } else {
+            rh = mid - 1;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Implementation notes: simple accessors
+ * --------------------------------------
+ * The remaining methods simply index into the arrays.
+ */
+
+int CompactGraph::size() const {
+    return nNodes;
+}
+
+int CompactGraph::getArcCount() const {
+    return nArcs;
+}
+
+string_view CompactGraph::getName(int node) const {
+    return string_view(nameChars + nameOffsets[node],
+                       nameOffsets[node + 1] - nameOffsets[node]);
+}
+
+int CompactGraph::getArcBegin(int node) const {
+    return offsets[node];
+}
+
+int CompactGraph::getArcEnd(int node) const {
+    return offsets[node + 1];
+}
+
+int CompactGraph::getFinish(int arc) const {
+    return finishes[arc];
+}
+
+double CompactGraph::getCost(int arc) const {
+    return costs[arc];
+}
+
+const int *CompactGraph::getOffsets() const {
+    return offsets;
+}
+
+const int *CompactGraph::getFinishes() const {
+    return finishes;
+}
+
+const double *CompactGraph::getCosts() const {
+    return costs;
+}
+
+/*
+ * Function: alignSection
+ * Usage: int64_t aligned = alignSection(pos);
+ * -------------------------------------------
+ * Rounds pos up to the next multiple of 8.
+ */
+
+int64_t alignSection(int64_t pos) {
+    return (pos + 7) & ~int64_t(7);
+}
@@ -0,0 +1,211 @@
+/*
+ * File: compactgraph.h
+ * --------------------
+ * This interface exports the CompactGraph class, a read-only graph
+ * representation that stores its arcs in flat arrays.
+ */
+
+#ifndef _compactgraph_h
+#define _compactgraph_h
+
+#include <string>
+#include <string_view>
+#include "interner.h"
+#include "mappedfile.h"
+
+/*
+ * Class: CompactGraph
+ * -------------------
+ * This class represents a directed graph with weighted arcs in the form
+ * usually called compressed sparse row, or CSR. Nodes are identified by
+ * the integers 0 through size() - 1, and the arcs leaving each node are
+ * stored next to each other in a single array. The arcs leaving node n
+ * are the ones whose indices run from getArcBegin(n) up to but not
+ * including getArcEnd(n), which leads to the following loop pattern:
+ *
+ *      for (int a = g.getArcBegin(n); a < g.getArcEnd(n); a++) {
+ *          int finish = g.getFinish(a);
+ *          double cost = g.getCost(a);
+ *          . . . process the arc from n to finish . . .
+ *      }
+ *
+ * A CompactGraph uses a small fraction of the memory of a Graph or
+ * SimpleGraph and can be traversed much faster, but it cannot be
+ * changed once it has been built. A graph can be saved to a binary
+ * snapshot file, which can later be loaded back without any parsing.
+ */
+
+class CompactGraph {
+
+public:
+
+/*
+ * Constructor: CompactGraph
+ * Usage: CompactGraph g;
+ * ----------------------
+ * Creates an empty graph.
+ */
+
+    CompactGraph();
+
+/*
+ * Destructor: ~CompactGraph
+ * -------------------------
+ * Frees any heap storage associated with this graph.
+ */
+
+    ~CompactGraph();
+
+/*
+ * Method: build
+ * Usage: g.build(names, nArcs, starts, finishes, costs);
+ * ------------------------------------------------------
+ * Replaces the contents of the graph. The nodes are the strings in names,
+ * numbered as the interner numbers them. Arc i runs from starts[i] to
+ * finishes[i] and has cost costs[i]. Arcs leaving the same node keep
+ * their relative order.
+ */
+
+    void build(const StringInterner & names, int nArcs, const int *starts,
+               const int *finishes, const double *costs);
+
+/*
+ * Method: save
+ * Usage: g.save(filename);
+ * ------------------------
+ * Writes the graph to the named file in the binary snapshot format
+ * described in compactgraph.cpp. This method signals an error if the
+ * file cannot be written.
+ */
+
+    void save(std::string filename) const;
+
+/*
+ * Method: load
+ * Usage: g.load(filename);
+ * ------------------------
+ * Replaces the contents of the graph with a snapshot written by save.
+ * The file is mapped into memory and used in place, so loading takes
+ * roughly constant time however large the graph is; the pages are read
+ * from disk as queries touch them. This method signals an error if the
+ * file is not a snapshot or was written by an incompatible version.
+ */
+
+    void load(std::string filename);
+
+/*
+ * Method: clear
+ * Usage: g.clear();
+ * -----------------
+ * Removes all nodes and arcs from the graph.
+ */
+
+    void clear();
+
+/*
+ * Method: size
+ * Usage: int n = g.size();
+ * ------------------------
+ * Returns the number of nodes in the graph.
+ */
+
+    int size() const;
+
+/*
+ * Method: getArcCount
+ * Usage: int n = g.getArcCount();
+ * -------------------------------
+ * Returns the number of arcs in the graph.
+ */
+
+    int getArcCount() const;
+
+/*
+ * Method: getName
+ * Usage: std::string_view name = g.getName(node);
+ * -----------------------------------------------
+ * Returns the name of the specified node.
+ */
+
+    std::string_view getName(int node) const;
+
+/*
+ * Method: getNodeId
+ * Usage: int node = g.getNodeId(name);
+ * ------------------------------------
+ * Returns the identifier of the node with the specified name, or -1
+ * if there is no such node.
+ */
+
+    int getNodeId(std::string_view name) const;
+
+/*
+ * Methods: getArcBegin, getArcEnd
+ * Usage: for (int a = g.getArcBegin(n); a < g.getArcEnd(n); a++) . . .
+ * --------------------------------------------------------------------
+ * Return the range of arc indices for the arcs that leave node n.
+ */
+
+    int getArcBegin(int node) const;
+    int getArcEnd(int node) const;
+
+/*
+ * Methods: getFinish, getCost
+ * Usage: int finish = g.getFinish(arc);
+ *        double cost = g.getCost(arc);
+ * ------------------------------------
+ * Return the node at the end of the specified arc and its cost.
+ */
+
+    int getFinish(int arc) const;
+    double getCost(int arc) const;
+
+/*
+ * Methods: getOffsets, getFinishes, getCosts
+ * Usage: const int *offsets = g.getOffsets();
+ * -------------------------------------------
+ * Return the underlying arrays for use in tight loops. The offsets array
+ * has size() + 1 entries; the other two have getArcCount() entries.
+ */
+
+    const int *getOffsets() const;
+    const int *getFinishes() const;
+    const double *getCosts() const;
+
+/*
+ * Notes on representation
+ * -----------------------
+ * The arcs are kept in three arrays. The offsets array gives the index
+ * of the first arc leaving each node, with a final entry equal to the
+ * number of arcs, and the finishes and costs arrays hold the other end
+ * and the cost of each arc. The node names are packed end to end in one
+ * character array, as in StringInterner. Instead of a hash table, the
+ * graph keeps the node identifiers sorted by name, so that getNodeId
+ * can use binary search and the whole structure consists of plain
+ * arrays with no pointers in them. That property is what allows load
+ * to point the array fields directly into a mapped snapshot file.
+ */
+
+private:
+
+/* Instance variables */
+
+    int nNodes;                 // The number of nodes
+    int nArcs;                  // The number of arcs
+    const int *offsets;         // First arc of each node (nNodes + 1)
+    const int *finishes;        // The finishing node of each arc
+    const double *costs;        // The cost of each arc
+    const char *nameChars;      // The characters of all the names
+    const int *nameOffsets;     // Start of each name in nameChars
+    const int *sortedIds;       // Node identifiers in name order
+    MappedFile *snapshot;       // The mapped snapshot, or NULL if the
+                                //   arrays are owned by the heap
+
+/* Make it illegal to copy compact graphs */
+
+    CompactGraph(const CompactGraph & src) { }
+    CompactGraph & operator=(const CompactGraph & src) { return *this; }
+
+};
+
+#endif
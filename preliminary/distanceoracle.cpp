@@ -0,0 +1,558 @@
+/*
+ * File: distanceoracle.cpp
+ * ------------------------
+ * This file implements the distanceoracle.h interface.
+ */
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+#include "distanceoracle.h"
+#include "error.h"
+#include "graphtypes.h"
+using namespace std;
+
+/* Constants and types */
+
+static const double INF = numeric_limits<double>::infinity();
+
+typedef pair<double,int> HeapEntry;
+typedef priority_queue<HeapEntry,vector<HeapEntry>,greater<HeapEntry> > MinHeap;
+
+/*
+ * Implementation notes: constructor and destructor
+ * ------------------------------------------------
+ * The constructor numbers the nodes and arcs of the graph and then picks
+ * the landmarks, which computes their trees as a side effect.
+ */
+
+DistanceOracle::DistanceOracle(SimpleGraph & g, int nLandmarks) {
+    graph = &g;
+    currentQuery = 0;
+    currentMark = 0;
+    nSettled = 0;
+    landmarkDist = NULL;
+    nColumns = 0;
+    rowCapacity = 0;
+    sourceRow = NULL;
+    targetRow = NULL;
+    for (Node *node : g.nodes) {
+        registerNode(node);
+    }
+    for (Arc *arc : g.arcs) {
+        registerArc(arc);
+    }
+    chooseLandmarks(nLandmarks);
+}
+
+DistanceOracle::~DistanceOracle() {
+    for (int i = 0; i < trees.size(); i++) {
+        delete trees[i];
+    }
+    delete[] landmarkDist;
+    delete[] sourceRow;
+    delete[] targetRow;
+}
+
+/*
+ * Implementation notes: getDistance
+ * ---------------------------------
+ * This method runs two A* searches that take turns, each settling its
+ * node with the smaller key: a forward search from s along the arcs and
+ * a backward search from t against them. Both use the average of the two
+ * landmark bounds as their potential,
+ *
+ *      p(v) = (bound from v to t - bound from s to v) / 2
+ *
+ * which the forward search adds to its distances and the backward search
+ * subtracts from them. Using the same potential with opposite signs keeps
+ * both searches consistent, so neither ever settles a node twice. Each
+ * arc that joins the two searches gives the length of some path from s
+ * to t, and the searches stop once the smallest forward and backward keys
+ * add up to at least the shortest such path. A node for which either
+ * bound is infinite cannot lie on a path from s to t and never goes on
+ * a heap.
+ *
+ * The rows of landmark distances for s and t are the same for every bound
+ * in the query, so they are copied into sourceRow and targetRow once at
+ * the start.
+ */
+
+double DistanceOracle::getDistance(Node *n1, Node *n2) {
+    int s = getNodeId(n1);
+    int t = getNodeId(n2);
+    currentQuery++;
+    nSettled = 0;
+    for (int k = 0; k < nColumns; k++) {
+        sourceRow[k] = landmarkDist[(long) s * nColumns + k];
+        targetRow[k] = landmarkDist[(long) t * nColumns + k];
+    }
+    SearchState & first = reachNode(s);
+    SearchState & last = reachNode(t);
+    if (isinf(first.potential) || isinf(last.potential)) return INF;
+    MinHeap heaps[2];
+    first.dist[0] = 0;
+    heaps[0].push(HeapEntry(first.potential, s));
+    last.dist[1] = 0;
+    heaps[1].push(HeapEntry(-last.potential, t));
+    double best = (s == t) ? 0 : INF;
+    while (!heaps[0].empty() && !heaps[1].empty()) {
+        double forwardKey = heaps[0].top().first;
+        double backwardKey = heaps[1].top().first;
+        if (forwardKey + backwardKey >= best) break;
+        int dir = (forwardKey <= backwardKey) ? 0 : 1;
+        int u = heaps[dir].top().second;
+        heaps[dir].pop();
+        SearchState & su = search[u];
+        if (su.closed[dir]) continue;
+        su.closed[dir] = true;
+        nSettled++;
+        Vector<int> & list = (dir == 0) ? outArcs[u] : inArcs[u];
+        for (int i = 0; i < list.size(); i++) {
+            ArcEntry & entry = arcs[list[i]];
+            int w = (dir == 0) ? entry.finish : entry.start;
+            SearchState & sw = reachNode(w);
+            if (sw.closed[dir] || isinf(sw.potential)) continue;
+            double d = su.dist[dir] + entry.cost;
+            if (d < sw.dist[dir]) {
+                sw.dist[dir] = d;
+                double p = (dir == 0) ? sw.potential : -sw.potential;
+                heaps[dir].push(HeapEntry(d + p, w));
+                if (d + sw.dist[1 - dir] < best) best = d + sw.dist[1 - dir];
+            }
+        }
+    }
+    return best;
+}
+
+double DistanceOracle::getDistance(string s1, string s2) {
+    Node *n1 = graph->nodeMap.get(s1);
+    Node *n2 = graph->nodeMap.get(s2);
+    if (n1 == NULL) error("getDistance: No node named " + s1);
+    if (n2 == NULL) error("getDistance: No node named " + s2);
+    return getDistance(n1, n2);
+}
+
+/*
+ * Implementation notes: addArc, removeArc, setCost
+ * ------------------------------------------------
+ * Each of these methods changes the graph in the same way as the
+ * functions in AirlineGraph.cpp and then asks every tree to repair
+ * itself. An arc that appears or gets cheaper can only improve distances;
+ * one that disappears or gets more expensive can only worsen them. Once
+ * the trees are repaired, no parent field refers to a removed arc, so
+ * its number goes on the free list for registerArc to reuse.
+ */
+
+Arc *DistanceOracle::addArc(Node *n1, Node *n2, double cost) {
+    if (cost < 0) error("addArc: Arc costs must not be negative");
+    Arc *arc = new Arc;
+    arc->start = n1;
+    arc->finish = n2;
+    arc->cost = cost;
+    graph->arcs.add(arc);
+    n1->arcs.add(arc);
+    int a = registerArc(arc);
+    nSettled = 0;
+    for (int i = 0; i < trees.size(); i++) {
+        arcImproved(trees[i], a);
+    }
+    return arc;
+}
+
+void DistanceOracle::removeArc(Arc *arc) {
+    if (!arcIds.containsKey(arc)) error("removeArc: Unknown arc");
+    int a = arcIds.get(arc);
+    ArcEntry & entry = arcs[a];
+    entry.arc = NULL;
+    removeFromList(outArcs[entry.start], a);
+    removeFromList(inArcs[entry.finish], a);
+    arcIds.remove(arc);
+    graph->arcs.remove(arc);
+    arc->start->arcs.remove(arc);
+    delete arc;
+    nSettled = 0;
+    for (int i = 0; i < trees.size(); i++) {
+        arcWorsened(trees[i], a);
+    }
+    freeArcs.add(a);
+}
+
+void DistanceOracle::setCost(Arc *arc, double cost) {
+    if (cost < 0) error("setCost: Arc costs must not be negative");
+    if (!arcIds.containsKey(arc)) error("setCost: Unknown arc");
+    int a = arcIds.get(arc);
+    double oldCost = arcs[a].cost;
+    arcs[a].cost = cost;
+    arc->cost = cost;
+    nSettled = 0;
+    for (int i = 0; i < trees.size(); i++) {
+        if (cost < oldCost) {
+            arcImproved(trees[i], a);
+        } else if (cost > oldCost) {
+            arcWorsened(trees[i], a);
+        }
+    }
+}
+
+int DistanceOracle::getLandmarkCount() const {
+    return landmarks.size();
+}
+
+int DistanceOracle::getSettledCount() const {
+    return nSettled;
+}
+
+/*
+ * Private method: getNodeId
+ * Usage: int v = getNodeId(node);
+ * -------------------------------
+ * Returns the number of the node, registering it if necessary.
+ */
+
+int DistanceOracle::getNodeId(Node *node) {
+    if (nodeIds.containsKey(node)) return nodeIds.get(node);
+    return registerNode(node);
+}
+
+/*
+ * Private method: registerNode
+ * Usage: int v = registerNode(node);
+ * ----------------------------------
+ * Gives the node the next number and extends every per-node array. A new
+ * node is unreachable from every landmark until arcs are added to it.
+ */
+
+int DistanceOracle::registerNode(Node *node) {
+    int v = nodes.size();
+    nodes.add(node);
+    nodeIds.put(node, v);
+    outArcs.add(Vector<int>());
+    inArcs.add(Vector<int>());
+    search.add(SearchState());
+    markStamp.add(0);
+    if (nColumns > 0 && v == rowCapacity) expandRows();
+    for (int k = 0; k < nColumns; k++) {
+        landmarkDist[(long) v * nColumns + k] = INF;
+    }
+    for (int i = 0; i < trees.size(); i++) {
+        trees[i]->parent.add(-1);
+    }
+    return v;
+}
+
+/*
+ * Private method: registerArc
+ * Usage: int a = registerArc(arc);
+ * --------------------------------
+ * Copies the arc into the arc table and the adjacency lists, reusing
+ * the number of a removed arc if there is one. Reuse keeps the table no
+ * larger than the greatest number of arcs the graph has held at once,
+ * however many arcs are added and removed over time.
+ */
+
+int DistanceOracle::registerArc(Arc *arc) {
+    if (arc->cost < 0) error("DistanceOracle: Arc costs must not be negative");
+    ArcEntry entry;
+    entry.arc = arc;
+    entry.start = getNodeId(arc->start);
+    entry.finish = getNodeId(arc->finish);
+    entry.cost = arc->cost;
+    int a;
+    if (freeArcs.isEmpty()) {
+        a = arcs.size();
+        arcs.add(entry);
+    } else {
+        a = freeArcs[freeArcs.size() - 1];
+        freeArcs.remove(freeArcs.size() - 1);
+        arcs[a] = entry;
+    }
+    arcIds.put(arc, a);
+    outArcs[entry.start].add(a);
+    inArcs[entry.finish].add(a);
+    return a;
+}
+
+/*
+ * Private method: chooseLandmarks
+ * Usage: chooseLandmarks(nLandmarks);
+ * -----------------------------------
+ * Chooses landmarks using the farthest-point heuristic: each new landmark
+ * is the node whose distance from the nearest existing landmark is
+ * greatest, with unreachable nodes counting as farthest of all. Spreading
+ * the landmarks out in this way makes the bounds useful in every part of
+ * the graph, including components that the first landmark cannot reach.
+ * The distance array gets its columns here, before any tree exists, and
+ * starts out with every entry infinite.
+ */
+
+void DistanceOracle::chooseLandmarks(int nLandmarks) {
+    int n = nodes.size();
+    if (nLandmarks > n) nLandmarks = n;
+    nColumns = 2 * nLandmarks;
+    rowCapacity = n;
+    landmarkDist = new double[(long) n * nColumns];
+    for (long k = 0; k < (long) n * nColumns; k++) {
+        landmarkDist[k] = INF;
+    }
+    sourceRow = new double[nColumns];
+    targetRow = new double[nColumns];
+    Vector<double> nearest(n, INF);
+    int next = 0;
+    for (int i = 0; i < nLandmarks; i++) {
+        landmarks.add(next);
+        Tree *forward = new Tree;
+        forward->backward = false;
+        forward->column = 2 * i;
+        computeTree(forward, next);
+        Tree *backward = new Tree;
+        backward->backward = true;
+        backward->column = 2 * i + 1;
+        computeTree(backward, next);
+        trees.add(forward);
+        trees.add(backward);
+        next = -1;
+        for (int v = 0; v < n; v++) {
+            double d = treeDist(forward, v);
+            if (d < nearest[v]) nearest[v] = d;
+            if (nearest[v] > 0 && (next == -1 || nearest[v] > nearest[next])) {
+                next = v;
+            }
+        }
+        if (next == -1) break;
+    }
+}
+
+/*
+ * Private method: computeTree
+ * Usage: computeTree(tree, root);
+ * -------------------------------
+ * Computes a full shortest-path tree rooted at the specified node.
+ */
+
+void DistanceOracle::computeTree(Tree *tree, int root) {
+    int n = nodes.size();
+    for (int v = 0; v < n; v++) {
+        treeDist(tree, v) = INF;
+    }
+    tree->parent = Vector<int>(n, -1);
+    treeDist(tree, root) = 0;
+    Vector<int> seeds;
+    seeds.add(root);
+    relaxFrom(tree, seeds);
+}
+
+/*
+ * Private method: relaxFrom
+ * Usage: relaxFrom(tree, seeds);
+ * ------------------------------
+ * Runs Dijkstra's algorithm in the tree starting from the seed nodes,
+ * whose distances must already be set. A forward tree follows arcs from
+ * start to finish; a backward tree follows them from finish to start.
+ * The search updates only nodes whose distances improve, so it stops on
+ * its own once a change has been fully propagated.
+ */
+
+void DistanceOracle::relaxFrom(Tree *tree, Vector<int> & seeds) {
+    MinHeap heap;
+    for (int i = 0; i < seeds.size(); i++) {
+        heap.push(HeapEntry(treeDist(tree, seeds[i]), seeds[i]));
+    }
+    while (!heap.empty()) {
+        double d = heap.top().first;
+        int u = heap.top().second;
+        heap.pop();
+        if (d > treeDist(tree, u)) continue;
+        nSettled++;
+        Vector<int> & list = tree->backward ? inArcs[u] : outArcs[u];
+        for (int i = 0; i < list.size(); i++) {
+            ArcEntry & entry = arcs[list[i]];
+            int w = tree->backward ? entry.start : entry.finish;
+            double nd = d + entry.cost;
+            if (nd < treeDist(tree, w)) {
+                treeDist(tree, w) = nd;
+                tree->parent[w] = list[i];
+                heap.push(HeapEntry(nd, w));
+            }
+        }
+    }
+}
+
+/*
+ * Private method: arcImproved
+ * Usage: arcImproved(tree, a);
+ * ----------------------------
+ * Repairs the tree after arc a has been added or made cheaper.
+ */
+
+void DistanceOracle::arcImproved(Tree *tree, int a) {
+    ArcEntry & entry = arcs[a];
+    int u = tree->backward ? entry.finish : entry.start;
+    int w = tree->backward ? entry.start : entry.finish;
+    double nd = treeDist(tree, u) + entry.cost;
+    if (nd < treeDist(tree, w)) {
+        treeDist(tree, w) = nd;
+        tree->parent[w] = a;
+        Vector<int> seeds;
+        seeds.add(w);
+        relaxFrom(tree, seeds);
+    }
+}
+
+/*
+ * Private method: arcWorsened
+ * Usage: arcWorsened(tree, a);
+ * ----------------------------
+ * Repairs the tree after arc a has been removed or made more expensive.
+ * Nothing changes unless a is a tree arc. If it is, the method collects
+ * the subtree below it, forgets the distances in that subtree, gives each
+ * subtree node the best distance available through an arc from outside
+ * the subtree, and lets relaxFrom settle the rest.
+ */
+
+void DistanceOracle::arcWorsened(Tree *tree, int a) {
+    ArcEntry & entry = arcs[a];
+    int child = tree->backward ? entry.start : entry.finish;
+    if (tree->parent[child] != a) return;
+    currentMark++;
+    Vector<int> affected;
+    affected.add(child);
+    markStamp[child] = currentMark;
+    for (int i = 0; i < affected.size(); i++) {
+        int u = affected[i];
+        Vector<int> & list = tree->backward ? inArcs[u] : outArcs[u];
+        for (int j = 0; j < list.size(); j++) {
+            int b = list[j];
+            int w = tree->backward ? arcs[b].start : arcs[b].finish;
+            if (tree->parent[w] == b && markStamp[w] != currentMark) {
+                markStamp[w] = currentMark;
+                affected.add(w);
+            }
+        }
+    }
+    Vector<int> seeds;
+    for (int i = 0; i < affected.size(); i++) {
+        int v = affected[i];
+        treeDist(tree, v) = INF;
+        tree->parent[v] = -1;
+        Vector<int> & list = tree->backward ? outArcs[v] : inArcs[v];
+        for (int j = 0; j < list.size(); j++) {
+            int b = list[j];
+            int u = tree->backward ? arcs[b].finish : arcs[b].start;
+            if (markStamp[u] == currentMark) continue;
+            double nd = treeDist(tree, u) + arcs[b].cost;
+            if (nd < treeDist(tree, v)) {
+                treeDist(tree, v) = nd;
+                tree->parent[v] = b;
+            }
+        }
+        if (!isinf(treeDist(tree, v))) seeds.add(v);
+    }
+    relaxFrom(tree, seeds);
+}
+
+/*
+ * Private method: treeDist
+ * Usage: double & d = treeDist(tree, v);
+ * --------------------------------------
+ * Returns a reference to the distance that the tree records for node v.
+ */
+
+double & DistanceOracle::treeDist(Tree *tree, int v) {
+    return landmarkDist[(long) v * nColumns + tree->column];
+}
+
+/*
+ * Private method: reachNode
+ * Usage: SearchState & state = reachNode(v);
+ * ------------------------------------------
+ * Returns the search state for node v, resetting it and computing the
+ * potential of v the first time the current query reaches the node.
+ */
+
+DistanceOracle::SearchState & DistanceOracle::reachNode(int v) {
+    SearchState & state = search[v];
+    if (state.query != currentQuery) {
+        state.query = currentQuery;
+        state.closed[0] = state.closed[1] = false;
+        state.dist[0] = state.dist[1] = INF;
+        const double *row = landmarkDist + (long) v * nColumns;
+        double toTarget = lowerBound(row, targetRow);
+        double fromSource = lowerBound(sourceRow, row);
+        if (isinf(toTarget) || isinf(fromSource)) {
+            state.potential = INF;
+        } else {
+            state.potential = (toTarget - fromSource) / 2;
+        }
+    }
+    return state;
+}
+
+/*
+ * Private method: lowerBound
+ * Usage: double h = lowerBound(from, to);
+ * ---------------------------------------
+ * Returns the best landmark lower bound on the distance from a node v to
+ * a node t, given the rows of landmark distances for v and t. The bound
+ * is infinite if some landmark proves that t is unreachable from v:
+ * either the landmark reaches v but not t, or t reaches the landmark but
+ * v does not.
+ */
+
+double DistanceOracle::lowerBound(const double *from, const double *to) {
+    double h = 0;
+    int nTrees = trees.size();
+    for (int k = 0; k < nTrees; k += 2) {
+        double fv = from[k];
+        double ft = to[k];
+        if (!isinf(fv)) {
+            if (isinf(ft)) return INF;
+            if (ft - fv > h) h = ft - fv;
+        }
+        double bv = from[k + 1];
+        double bt = to[k + 1];
+        if (!isinf(bt)) {
+            if (isinf(bv)) return INF;
+            if (bv - bt > h) h = bv - bt;
+        }
+    }
+    return h;
+}
+
+/*
+ * Private method: expandRows
+ * Usage: expandRows();
+ * --------------------
+ * Doubles the number of rows allocated in landmarkDist.
+ */
+
+void DistanceOracle::expandRows() {
+    int capacity = (rowCapacity == 0) ? 1 : 2 * rowCapacity;
+    double *array = new double[(long) capacity * nColumns];
+    for (long k = 0; k < (long) rowCapacity * nColumns; k++) {
+        array[k] = landmarkDist[k];
+    }
+    delete[] landmarkDist;
+    landmarkDist = array;
+    rowCapacity = capacity;
+}
+
+/*
+ * Private method: removeFromList
+ * Usage: removeFromList(list, a);
+ * -------------------------------
+ * Removes the arc number a from an adjacency list.
+ */
+
+void DistanceOracle::removeFromList(Vector<int> & list, int a) {
+    for (int i = 0; i < list.size(); i++) {
+        if (list[i] == a) {
+            list.remove(i);
+            return;
+        }
+    }
+}
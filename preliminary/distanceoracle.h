@@ -0,0 +1,242 @@
+/*
+ * File: distanceoracle.h
+ * ----------------------
+ * This interface exports the DistanceOracle class, which answers
+ * shortest-path distance queries on a SimpleGraph and keeps its
+ * precomputed data up to date as arcs are added, removed or repriced.
+ */
+
+#ifndef _distanceoracle_h
+#define _distanceoracle_h
+
+#include <string>
+#include "graphtypes.h"
+#include "map.h"
+#include "vector.h"
+
+/*
+ * Class: DistanceOracle
+ * ---------------------
+ * This class answers point-to-point distance queries using the ALT
+ * algorithm, which is A* search guided by distances to and from a
+ * small set of landmark nodes. For each landmark L, the oracle stores
+ * the distance from L to every node and from every node to L. By the
+ * triangle inequality, for any nodes v and t,
+ *
+ *      dist(v, t) >= dist(L, t) - dist(L, v)
+ *      dist(v, t) >= dist(v, L) - dist(t, L)
+ *
+ * which gives A* a lower bound on the remaining distance. Each query
+ * runs two such searches at once, one forward from the source and one
+ * backward from the target, and stops when they meet; together they
+ * settle only a small part of the graph.
+ *
+ * The oracle keeps a reference to the graph. Once an oracle exists, arcs
+ * should be changed only through its addArc, removeArc and setCost
+ * methods, which update the graph and then repair the landmark distances
+ * incrementally instead of recomputing them from scratch.
+ */
+
+class DistanceOracle {
+
+public:
+
+/*
+ * Constant: DEFAULT_LANDMARKS
+ * ---------------------------
+ * The number of landmarks used when the client does not specify one.
+ */
+
+    static const int DEFAULT_LANDMARKS = 8;
+
+/*
+ * Constructor: DistanceOracle
+ * Usage: DistanceOracle oracle(g);
+ *        DistanceOracle oracle(g, nLandmarks);
+ * --------------------------------------------
+ * Creates an oracle for the graph g and precomputes the landmark
+ * distances. Arc costs must not be negative. If the graph has fewer
+ * nodes than the requested number of landmarks, every node is used.
+ */
+
+    DistanceOracle(SimpleGraph & g, int nLandmarks = DEFAULT_LANDMARKS);
+
+/*
+ * Destructor: ~DistanceOracle
+ * ---------------------------
+ * Frees the storage used by the oracle. The graph itself is unaffected.
+ */
+
+    ~DistanceOracle();
+
+/*
+ * Method: getDistance
+ * Usage: double d = oracle.getDistance(n1, n2);
+ *        double d = oracle.getDistance(s1, s2);
+ * ---------------------------------------------
+ * Returns the length of the shortest path from n1 to n2, which may be
+ * specified as node pointers or by name. If there is no path, the result
+ * is infinite, which can be tested using std::isinf.
+ */
+
+    double getDistance(Node *n1, Node *n2);
+    double getDistance(std::string s1, std::string s2);
+
+/*
+ * Method: addArc
+ * Usage: Arc *arc = oracle.addArc(n1, n2, cost);
+ * ----------------------------------------------
+ * Adds a directed arc from n1 to n2 to the graph and updates the landmark
+ * distances. The nodes must already be in the graph's node set; nodes
+ * added to the graph after the oracle was created are registered
+ * automatically the first time they appear in an arc.
+ */
+
+    Arc *addArc(Node *n1, Node *n2, double cost);
+
+/*
+ * Method: removeArc
+ * Usage: oracle.removeArc(arc);
+ * -----------------------------
+ * Removes the arc from the graph, frees it, and updates the landmark
+ * distances.
+ */
+
+    void removeArc(Arc *arc);
+
+/*
+ * Method: setCost
+ * Usage: oracle.setCost(arc, cost);
+ * ---------------------------------
+ * Changes the cost of an arc in the graph and updates the landmark
+ * distances.
+ */
+
+    void setCost(Arc *arc, double cost);
+
+/*
+ * Method: getLandmarkCount
+ * Usage: int n = oracle.getLandmarkCount();
+ * -----------------------------------------
+ * Returns the number of landmarks the oracle is using.
+ */
+
+    int getLandmarkCount() const;
+
+/*
+ * Method: getSettledCount
+ * Usage: int n = oracle.getSettledCount();
+ * ----------------------------------------
+ * Returns the number of nodes settled by the most recent query or update,
+ * which shows how much of the graph the last operation had to look at.
+ */
+
+    int getSettledCount() const;
+
+/*
+ * Notes on representation
+ * -----------------------
+ * The oracle numbers the nodes densely and keeps its own copy of the
+ * arcs, indexed by arc number, along with a list of outgoing and incoming
+ * arc numbers for each node. The numbers of removed arcs are kept on a
+ * free list and given to the next arcs added, so the table does not grow
+ * when arcs are repeatedly added and removed. The incoming lists are
+ * needed both for the distances to each landmark and for repairing
+ * distances after an arc gets more expensive. Each landmark contributes
+ * two shortest-path trees, one computed along the arcs and one against
+ * them. Each tree keeps the tree arc (the parent) for every node, but the
+ * distances from all the trees live together in one flat array with a
+ * row for each node, in which tree k owns column k. A query reads a whole
+ * row every time it reaches a node, so keeping the row in adjacent cache
+ * lines matters more than anything else about the layout.
+ *
+ * The state of a query is kept in one SearchState per node, so that
+ * reaching a node touches a single record. Each record carries the number
+ * of the query that last reached the node, which lets a new query start
+ * without clearing the records of the last one.
+ *
+ * When an arc becomes cheaper or is added, the change can only shorten
+ * paths, so the repair is a Dijkstra search that starts at the arc and
+ * stops as soon as no distance improves. When an arc becomes more
+ * expensive or is removed, only the nodes below it in a tree can be
+ * affected. The repair marks that subtree as unknown, seeds each of its
+ * nodes from the best arc that enters it from outside the subtree, and
+ * runs Dijkstra within the subtree. Either way, the work is proportional
+ * to the part of the tree that actually changes.
+ */
+
+private:
+
+/* Type for the copy of each arc */
+
+    struct ArcEntry {
+        Arc *arc;               // The arc in the client's graph
+        int start;              // The starting node number
+        int finish;             // The finishing node number
+        double cost;            // The current cost
+    };
+
+/* Type for one shortest-path tree rooted at a landmark */
+
+    struct Tree {
+        bool backward;          // True if distances lead to the landmark
+        int column;             // The tree's column in landmarkDist
+        Vector<int> parent;     // The tree arc for each node, or -1
+    };
+
+/* Type for the state of a node during a query */
+
+    struct SearchState {
+        int query;              // The query that last reached the node
+        bool closed[2];         // True once settled forward or backward
+        double dist[2];         // Tentative distances from s and to t
+        double potential;       // The A* potential, or INF if useless
+    };
+
+/* Instance variables */
+
+    SimpleGraph *graph;             // The graph being queried
+    Vector<Node *> nodes;           // The node with each number
+    Map<Node *,int> nodeIds;        // The number of each node
+    Vector<ArcEntry> arcs;          // The arcs by arc number
+    Map<Arc *,int> arcIds;          // The number of each arc
+    Vector<int> freeArcs;           // Numbers of removed arcs to reuse
+    Vector< Vector<int> > outArcs;  // Arc numbers leaving each node
+    Vector< Vector<int> > inArcs;   // Arc numbers entering each node
+    Vector<int> landmarks;          // The node number of each landmark
+    Vector<Tree *> trees;           // Two trees for each landmark
+    double *landmarkDist;           // Tree distances, one row per node
+    int nColumns;                   // Entries in each row (one per tree)
+    int rowCapacity;                // Rows allocated in landmarkDist
+    double *sourceRow;              // Copy of the row for the query source
+    double *targetRow;              // Copy of the row for the query target
+    Vector<SearchState> search;     // The query state of each node
+    int currentQuery;               // Stamp for the current query
+    Vector<int> markStamp;          // Repair in which the node was marked
+    int currentMark;                // Stamp for the current repair
+    int nSettled;                   // Nodes settled by the last operation
+
+/* Private methods */
+
+    int getNodeId(Node *node);
+    int registerNode(Node *node);
+    int registerArc(Arc *arc);
+    void chooseLandmarks(int nLandmarks);
+    void computeTree(Tree *tree, int root);
+    void relaxFrom(Tree *tree, Vector<int> & seeds);
+    void arcImproved(Tree *tree, int a);
+    void arcWorsened(Tree *tree, int a);
+    double & treeDist(Tree *tree, int v);
+    SearchState & reachNode(int v);
+    double lowerBound(const double *from, const double *to);
+    void expandRows();
+    void removeFromList(Vector<int> & list, int a);
+
+/* Make it illegal to copy oracles */
+
+    DistanceOracle(const DistanceOracle & src) { }
+    DistanceOracle & operator=(const DistanceOracle & src) { return *this; }
+
+};
+
+#endif
@@ -4,12 +4,35 @@
  * This file implements the exp.h interface
  */
 
+#include <cstring>
+#include <functional>
+#include <mutex>
 #include <string>
 #include "error.h"
 #include "exp.h"
 #include "strlib.h"
 using namespace std;
 
+/*
+ * Implementation notes: profiling
+ * -------------------------------
+ * When EVAL_PROFILE is defined, each eval method reports its node to the
+ * running EvalProfiler, and the context counts its operations. In other
+ * builds these macros expand to nothing, so that profiling costs nothing
+ * unless it is compiled in.
+ */
+
+#ifdef EVAL_PROFILE
+#include "profiler.h"
+#define PROFILE_NODE(exp, kind) EvalProfiler::Frame profileFrame(exp, kind)
+#define COUNT_NAME_LOOKUP() EvalProfiler::countNameLookup()
+#define COUNT_SLOT_ACCESS() EvalProfiler::countSlotAccess()
+#else
+#define PROFILE_NODE(exp, kind)
+#define COUNT_NAME_LOOKUP()
+#define COUNT_SLOT_ACCESS()
+#endif
+
 /*
  * Implementation notes: Expression
  * --------------------------------
@@ -25,6 +48,10 @@ Expression::~Expression() {
     /* Empty */
 }
 
+void Expression::bind(EvaluationContext & context) {
+    /* Empty */
+}
+
 int Expression::getConstantValue() {
     error("getConstantValue: Illegal expression type");
     return 0;
@@ -40,6 +67,11 @@ std::string Expression::getOperator() {
     return "";
 }
 
+OperatorType Expression::getOperatorType() {
+    error("getOperatorType: Illegal expression type");
+    return ASSIGN;
+}
+
 Expression *Expression::getLHS() {
     error("getLHS: Illegal expression type");
     return NULL;
@@ -62,6 +94,7 @@ ConstantExp::ConstantExp(int value) {
 }
 
 int ConstantExp::eval(EvaluationContext & context) {
+    PROFILE_NODE(this, CONSTANT);
     return value;
 }
 
@@ -80,21 +113,54 @@ int ConstantExp::getConstantValue() {
 /*
  * Implementation notes: IdentifierExp
  * -----------------------------------
- * The IdentifierExp subclass represents a variable name. The
- * implementation of eval looks up that name in the evaluation context.
+ * The IdentifierExp subclass represents a variable name. The node gets
+ * the number of its name when it is created and passes it to the context
+ * on every access, which lets the context find the slot with an array
+ * index. The node itself never changes after it is created. The private
+ * constructor, which ExpressionArena uses, borrows the characters of the
+ * name instead of copying them.
  */
 
 IdentifierExp::IdentifierExp(string name) {
-    this->name = name;
+    ownedName = new char[name.length()];
+    memcpy(ownedName, name.data(), name.length());
+    this->name = string_view(ownedName, name.length());
+    nameNumber = EvaluationContext::getNameNumber(this->name);
+}
+
+IdentifierExp::IdentifierExp(const char *chars, long length) {
+    ownedName = NULL;
+    name = string_view(chars, length);
+    nameNumber = EvaluationContext::getNameNumber(name);
+}
+
+IdentifierExp::~IdentifierExp() {
+    delete[] ownedName;
 }
 
 int IdentifierExp::eval(EvaluationContext & context) {
-    if (!context.isDefined(name)) error(name + " is undefined");
-    return context.getValue(name);
+    PROFILE_NODE(this, IDENTIFIER);
+    int value = 0;
+    if (!context.readValue(nameNumber, name, value)) {
+        error(string(name) + " is undefined");
+    }
+    return value;
+}
+
+void IdentifierExp::bind(EvaluationContext & context) {
+    context.getSlot(nameNumber, name);
+}
+
+void IdentifierExp::assign(EvaluationContext & context, int value) {
+    context.setValue(context.getSlot(nameNumber, name), value);
+}
+
+int IdentifierExp::getSlot(EvaluationContext & context) {
+    return context.getSlot(nameNumber, name);
 }
 
 string IdentifierExp::toString() {
-    return name;
+    return string(name);
 }
 
 ExpressionType IdentifierExp::getType() {
@@ -102,48 +168,95 @@ ExpressionType IdentifierExp::getType() {
 }
 
 string IdentifierExp::getIdentifierName() {
-    return name;
+    return string(name);
+}
+
+/*
+ * Implementation notes: stringToOperator, operatorToString
+ * --------------------------------------------------------
+ * These functions translate between operators and their symbols. They
+ * are used only when an expression is built or displayed, never during
+ * evaluation.
+ */
+
+OperatorType stringToOperator(string str) {
+    if (str == "=") return ASSIGN;
+    if (str == "+") return ADD;
+    if (str == "-") return SUBTRACT;
+    if (str == "*") return MULTIPLY;
+    if (str == "/") return DIVIDE;
+    error("Illegal operator \"" + str + "\"");
+    return ASSIGN;
+}
+
+string operatorToString(OperatorType op) {
+    switch (op) {
+        case ASSIGN: return "=";
+        case ADD: return "+";
+        case SUBTRACT: return "-";
+        case MULTIPLY: return "*";
+        case DIVIDE: return "/";
+    }
+    return "?";
 }
 
 /*
  * Implementation notes: CompoundExp
  * ---------------------------------
  * The implementation of eval for CompoundExp evaluates the left and right
- * subexpressions recursively and then applies the operator. Assignment is
- * treated as a special case because it does not evaluate the left operand.
+ * subexpressions recursively and then applies the operator, which it
+ * selects with a switch on the operator type. Assignment is treated as a
+ * special case because it does not evaluate the left operand.
  */
 
-CompoundExp::CompoundExp(string op, Expression *lhs, Expression *rhs) {
+CompoundExp::CompoundExp(OperatorType op, Expression *lhs, Expression *rhs) {
     this->op = op;
     this->lhs = lhs;
     this->rhs = rhs;
 }
 
+CompoundExp::CompoundExp(string op, Expression *lhs, Expression *rhs) {
+    this->op = stringToOperator(op);
+    this->lhs = lhs;
+    this->rhs = rhs;
+}
+
 CompoundExp::~CompoundExp() {
     delete lhs;
     delete rhs;
 }
 
 int CompoundExp::eval(EvaluationContext & context) {
+    PROFILE_NODE(this, op);
     int right = rhs->eval(context);
-    if (op == "=") {
-        context.setValue(lhs->getIdentifierName(), right);
+    if (op == ASSIGN) {
+        if (lhs->getType() != IDENTIFIER) lhs->getIdentifierName();
+        static_cast<IdentifierExp *>(lhs)->assign(context, right);
         return right;
     }
     int left = lhs->eval(context);
-    if (op == "+") return left + right;
-    if (op == "-") return left - right;
-    if (op == "*") return left * right;
-    if (op == "/") {
-        if (right == 0) error("Division by 0");
-        return left / right;
+    switch (op) {
+        case ADD: return left + right;
+        case SUBTRACT: return left - right;
+        case MULTIPLY: return left * right;
+        case DIVIDE:
+            if (right == 0) error("Division by 0");
+            if (right == -1) return int(0 - unsigned(left));
+            return left / right;
+        default: break;
     }
     error("Illegal operator in expression");
     return 0;
 }
 
+void CompoundExp::bind(EvaluationContext & context) {
+    lhs->bind(context);
+    rhs->bind(context);
+}
+
 string CompoundExp::toString() {
-    return '(' + lhs->toString() + ' ' + op + ' ' + rhs->toString() + ')';
+    return '(' + lhs->toString() + ' ' + operatorToString(op) + ' '
+               + rhs->toString() + ')';
 }
 
 ExpressionType CompoundExp::getType() {
@@ -151,6 +264,10 @@ ExpressionType CompoundExp::getType() {
 }
 
 string CompoundExp::getOperator() {
+    return operatorToString(op);
+}
+
+OperatorType CompoundExp::getOperatorType() {
     return op;
 }
 
@@ -165,18 +282,272 @@ Expression *CompoundExp::getRHS() {
 /*
  * Implementation notes: EvaluationContext
  * ---------------------------------------
- * The methods in the EvaluationContext class simply call the appropriate
- * method on the map used to represent the symbol table.
+ * The methods that take a name translate it to a slot and then call the
+ * versions that take a slot. Looking up a name that has no slot does not
+ * create one, so asking about an unknown variable leaves the context
+ * unchanged. Reading a variable that is not defined gives 0, as the
+ * Map class does for a missing key.
+ */
+
+EvaluationContext::EvaluationContext() {
+    values = NULL;
+    defined = NULL;
+    capacity = 0;
+    slotsByNumber = NULL;
+    numberCapacity = 0;
+    memoValues = NULL;
+    memoStamps = NULL;
+    memoCapacity = 0;
+    memoGeneration = 0;
+}
+
+EvaluationContext::~EvaluationContext() {
+    delete[] values;
+    delete[] defined;
+    delete[] slotsByNumber;
+    delete[] memoValues;
+    delete[] memoStamps;
+}
+
+void EvaluationContext::setValue(string_view var, int value) {
+    setValue(getSlot(var), value);
+}
+
+void EvaluationContext::setValue(int slot, int value) {
+    COUNT_SLOT_ACCESS();
+    values[slot] = value;
+    defined[slot] = true;
+}
+
+void EvaluationContext::clearValue(string_view var) {
+    COUNT_NAME_LOOKUP();
+    int slot = names.find(var);
+    if (slot >= 0) clearValue(slot);
+}
+
+void EvaluationContext::clearValue(int slot) {
+    COUNT_SLOT_ACCESS();
+    defined[slot] = false;
+}
+
+int EvaluationContext::getValue(string_view var) const {
+    COUNT_NAME_LOOKUP();
+    int slot = names.find(var);
+    return (slot < 0) ? 0 : getValue(slot);
+}
+
+int EvaluationContext::getValue(int slot) const {
+    COUNT_SLOT_ACCESS();
+    return defined[slot] ? values[slot] : 0;
+}
+
+bool EvaluationContext::isDefined(string_view var) const {
+    COUNT_NAME_LOOKUP();
+    int slot = names.find(var);
+    return slot >= 0 && defined[slot];
+}
+
+bool EvaluationContext::isDefined(int slot) const {
+    COUNT_SLOT_ACCESS();
+    return defined[slot];
+}
+
+int EvaluationContext::getSlot(string_view var) {
+    COUNT_NAME_LOOKUP();
+    int slot = names.intern(var);
+    if (slot == capacity) expandCapacity();
+    return slot;
+}
+
+int EvaluationContext::findSlot(string_view var) const {
+    COUNT_NAME_LOOKUP();
+    return names.find(var);
+}
+
+/*
+ * Implementation notes: getNameNumber
+ * -----------------------------------
+ * The names are divided among NAME_SHARDS interners by a hash of their
+ * characters, and each interner has its own lock, so that threads that
+ * parse at the same time seldom wait for one another. Name k of shard s
+ * gets the number k * NAME_SHARDS + s, which keeps the numbers distinct
+ * and close to dense. Numbering takes place only when an identifier node
+ * is created, never during evaluation.
+ */
+
+int EvaluationContext::getNameNumber(string_view var) {
+    struct alignas(64) NameShard {
+        mutex lock;
+        StringInterner names;
+    };
+    static NameShard shards[NAME_SHARDS];
+    int s = hash<string_view>()(var) % NAME_SHARDS;
+    lock_guard<mutex> guard(shards[s].lock);
+    return shards[s].names.intern(var) * NAME_SHARDS + s;
+}
+
+/*
+ * Implementation notes: findSlot, getSlot and readValue by number
+ * ---------------------------------------------------------------
+ * A name that has not been looked up by number in this context has no
+ * entry in slotsByNumber, so these methods fall back on the versions
+ * that take a name and record the answer. A variable without a slot is
+ * not recorded, so each findSlot for it hashes the name again, which
+ * happens only on the way to an error.
  */
 
-void EvaluationContext::setValue(string var, int value) {
-    symbolTable.put(var, value);
+int EvaluationContext::findSlot(int number, string_view var) {
+    if (number < numberCapacity && slotsByNumber[number] >= 0) {
+        return slotsByNumber[number];
+    }
+    int slot = findSlot(var);
+    if (slot >= 0) recordSlot(number, slot);
+    return slot;
+}
+
+int EvaluationContext::getSlot(int number, string_view var) {
+    if (number < numberCapacity && slotsByNumber[number] >= 0) {
+        return slotsByNumber[number];
+    }
+    int slot = getSlot(var);
+    recordSlot(number, slot);
+    return slot;
+}
+
+bool EvaluationContext::readValue(int number, string_view var, int & value) {
+    int slot = findSlot(number, var);
+    if (slot < 0) return false;
+    COUNT_SLOT_ACCESS();
+    if (!defined[slot]) return false;
+    value = values[slot];
+    return true;
+}
+
+int EvaluationContext::getSlotCount() const {
+    return names.size();
 }
 
-int EvaluationContext::getValue(string var) {
-    return symbolTable.get(var);
+string_view EvaluationContext::getSlotName(int slot) const {
+    return names.getName(slot);
 }
 
-bool EvaluationContext::isDefined(string var) {
-    return symbolTable.containsKey(var);
-}
\ No newline at end of file
+EvaluationContext::EvaluationContext(const EvaluationContext & src) {
+    values = NULL;
+    defined = NULL;
+    capacity = 0;
+    slotsByNumber = NULL;
+    numberCapacity = 0;
+    memoValues = NULL;
+    memoStamps = NULL;
+    memoCapacity = 0;
+    memoGeneration = 0;
+    deepCopy(src);
+}
+
+EvaluationContext & EvaluationContext::operator=(const EvaluationContext &
+                                                                   src) {
+    if (this != &src) {
+        names.clear();
+        for (int i = 0; i < capacity; i++) {
+            defined[i] = false;
+        }
+        for (int i = 0; i < numberCapacity; i++) {
+            slotsByNumber[i] = -1;
+        }
+        deepCopy(src);
+    }
+    return *this;
+}
+
+/*
+ * Private method: expandCapacity
+ * Usage: expandCapacity();
+ * ------------------------
+ * Doubles the size of the slot arrays. The new slots are undefined.
+ */
+
+void EvaluationContext::expandCapacity() {
+    int newCapacity = (capacity == 0) ? INITIAL_CAPACITY : 2 * capacity;
+    int *newValues = new int[newCapacity];
+    bool *newDefined = new bool[newCapacity];
+    for (int i = 0; i < newCapacity; i++) {
+        newValues[i] = (i < capacity) ? values[i] : 0;
+        newDefined[i] = (i < capacity) ? defined[i] : false;
+    }
+    delete[] values;
+    delete[] defined;
+    values = newValues;
+    defined = newDefined;
+    capacity = newCapacity;
+}
+
+/*
+ * Private method: deepCopy
+ * Usage: deepCopy(src);
+ * ---------------------
+ * Copies the variables of src into this context, which must have no
+ * slots. Interning the names in slot order gives every variable the
+ * same slot it has in src.
+ */
+
+void EvaluationContext::deepCopy(const EvaluationContext & src) {
+    for (int i = 0; i < src.getSlotCount(); i++) {
+        int slot = getSlot(src.getSlotName(i));
+        values[slot] = src.values[i];
+        defined[slot] = src.defined[i];
+    }
+}
+
+/*
+ * Private method: expandMemo
+ * Usage: expandMemo(index);
+ * -------------------------
+ * Doubles the memo arrays until index fits. A value counts as stored
+ * only if its stamp matches the number of the current startMemo call,
+ * so the new entries get the stamp -1, which never matches.
+ */
+
+void EvaluationContext::expandMemo(int index) {
+    int newCapacity = (memoCapacity == 0) ? INITIAL_CAPACITY
+                                          : 2 * memoCapacity;
+    while (newCapacity <= index) {
+        newCapacity *= 2;
+    }
+    int *newValues = new int[newCapacity];
+    long *newStamps = new long[newCapacity];
+    for (int i = 0; i < newCapacity; i++) {
+        newValues[i] = (i < memoCapacity) ? memoValues[i] : 0;
+        newStamps[i] = (i < memoCapacity) ? memoStamps[i] : -1;
+    }
+    delete[] memoValues;
+    delete[] memoStamps;
+    memoValues = newValues;
+    memoStamps = newStamps;
+    memoCapacity = newCapacity;
+}
+
+/*
+ * Private method: recordSlot
+ * Usage: recordSlot(number, slot);
+ * --------------------------------
+ * Records the slot for a name number, growing slotsByNumber if the
+ * number is beyond its end.
+ */
+
+void EvaluationContext::recordSlot(int number, int slot) {
+    if (number >= numberCapacity) {
+        int newCapacity = (numberCapacity == 0) ? INITIAL_CAPACITY
+                                                : 2 * numberCapacity;
+        while (newCapacity <= number) {
+            newCapacity *= 2;
+        }
+        int *array = new int[newCapacity];
+        for (int i = 0; i < newCapacity; i++) {
+            array[i] = (i < numberCapacity) ? slotsByNumber[i] : -1;
+        }
+        delete[] slotsByNumber;
+        slotsByNumber = array;
+        numberCapacity = newCapacity;
+    }
+    slotsByNumber[number] = slot;
+}
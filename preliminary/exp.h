@@ -8,12 +8,14 @@
 #define _exp_h
 
 #include <string>
-#include "map.h"
+#include <string_view>
+#include "interner.h"
 #include "tokenscanner.h"
 
-/* Forward reference */
+/* Forward references */
 
 class EvaluationContext;
+class ExpressionArena;
 
 /*
  * Type: ExpressionType
@@ -24,6 +26,36 @@ class EvaluationContext;
 
 enum ExpressionType { CONSTANT, IDENTIFIER, COMPOUND };
 
+/*
+ * Type: OperatorType
+ * ------------------
+ * This enumerated type identifies the operator in a compound expression.
+ * The parser translates each operator token into one of these constants
+ * once, so that evaluation can select the operation with a switch rather
+ * than by comparing strings.
+ */
+
+enum OperatorType { ASSIGN, ADD, SUBTRACT, MULTIPLY, DIVIDE };
+
+/*
+ * Function: stringToOperator
+ * Usage: OperatorType op = stringToOperator(str);
+ * -----------------------------------------------
+ * Returns the operator whose symbol is str. This function signals an
+ * error if str is not one of the symbols =, +, -, * and /.
+ */
+
+OperatorType stringToOperator(std::string str);
+
+/*
+ * Function: operatorToString
+ * Usage: string str = operatorToString(op);
+ * -----------------------------------------
+ * Returns the symbol for the specified operator.
+ */
+
+std::string operatorToString(OperatorType op);
+
 /*
  * Class: Expression
  * -----------------
@@ -69,11 +101,31 @@ public:
  * Usage: int value = exp->eval(context);
  * --------------------------------------
  * Evaluates this expression and returns its value in the context of
- * the specified EvaluationContext object.
+ * the specified EvaluationContext object. Evaluation never changes the
+ * tree, so the same expression may be evaluated in several contexts at
+ * once on different threads, provided that each context is used by only
+ * one thread at a time. Reading a variable that is not defined signals
+ * an error and leaves the context as it was.
  */
 
     virtual int eval(EvaluationContext & context) = 0;
 
+/*
+ * Method: bind
+ * Usage: exp->bind(context);
+ * --------------------------
+ * Gives every variable in this expression a slot in the specified
+ * context, creating an undefined slot for any variable the context has
+ * not seen. The context remembers the slot of each name, so evaluating
+ * the expression there reads and writes each variable with array
+ * indexes instead of looking up its name. Calling bind is optional,
+ * because eval finds each slot the first time it needs it; an explicit
+ * call moves that work out of the first evaluation and reserves slots in
+ * advance. Binding changes only the context, never the expression.
+ */
+
+    virtual void bind(EvaluationContext & context);
+
 /*
  * Method: toString
  * Usage: string str = exp->toString();
@@ -103,6 +155,7 @@ public:
     virtual int getConstantValue();
     virtual std::string getIdentifierName();
     virtual std::string getOperator();
+    virtual OperatorType getOperatorType();
     virtual Expression *getLHS();
     virtual Expression *getRHS();
 
@@ -158,15 +211,61 @@ public:
 
     IdentifierExp(std::string name);
 
+/*
+ * Method: assign
+ * Usage: id->assign(context, value);
+ * ----------------------------------
+ * Sets the variable named by this identifier to value in the specified
+ * context, using its slot. CompoundExp calls this method to carry out
+ * an assignment.
+ */
+
+    void assign(EvaluationContext & context, int value);
+
+/*
+ * Method: getSlot
+ * Usage: int slot = id->getSlot(context);
+ * ---------------------------------------
+ * Returns the slot of the variable named by this identifier in the
+ * specified context, giving the variable a slot if it has none.
+ */
+
+    int getSlot(EvaluationContext & context);
+
 /* Prototypes for the virtual methods overriden by this class */
 
+    virtual ~IdentifierExp();
     virtual int eval(EvaluationContext & context);
+    virtual void bind(EvaluationContext & context);
     virtual std::string toString();
     virtual ExpressionType getType();
     virtual std::string getIdentifierName();
 
+/*
+ * Notes on representation
+ * -----------------------
+ * The name is a view of characters that the node owns when it is created
+ * with new, and that belong to the arena when it is created by an
+ * ExpressionArena, in which case ownedName is NULL and the destructor
+ * has nothing to free. The node also keeps the number that
+ * EvaluationContext::getNameNumber assigns to the name, which every
+ * context uses to find the slot of the variable.
+ */
+
 private:
-    std::string name;       // The name of the identifier
+    std::string_view name;  // The name of the identifier
+    char *ownedName;        // The characters of name if owned, or NULL
+    int nameNumber;         // The number of the name in every context
+
+    IdentifierExp(const char *chars, long length);
+    friend class ExpressionArena;
+
+/* Make it illegal to copy identifiers */
+
+    IdentifierExp(const IdentifierExp & src) { }
+    IdentifierExp & operator=(const IdentifierExp & src) {
+        return *this;
+    }
 
 };
 
@@ -186,24 +285,28 @@ public:
  * Usage: Expression *exp = new CompoundExp(op, lhs, rhs);
  * -------------------------------------------------------
  * Creates a new compound expression composed of the operator (op)
- * and the left and right subexpressions (lhs and rhs).
+ * and the left and right subexpressions (lhs and rhs). The operator
+ * may be given either as an OperatorType or as its symbol.
  */
 
+    CompoundExp(OperatorType op, Expression *lhs, Expression *rhs);
     CompoundExp(std::string op, Expression *lhs, Expression *rhs);
 
 /* Prototypes for the virtual methods overriden by this class */
 
     virtual ~CompoundExp();
     virtual int eval(EvaluationContext & context);
+    virtual void bind(EvaluationContext & context);
     virtual std::string toString();
     virtual ExpressionType getType();
     virtual std::string getOperator();
+    virtual OperatorType getOperatorType();
     virtual Expression *getLHS();
     virtual Expression *getRHS();
 
 private:
 
-    std::string op;         // The operator string (+, -, *, /)
+    OperatorType op;        // The operator (=, +, -, *, /)
     Expression *lhs, *rhs;   // The left and right subexpression
 
 };
@@ -212,43 +315,240 @@ private:
  * Class: EvaluationContext
  * ------------------------
  * This class encapsulates the information that the evaluator needs to
- * know in order to evaluate an expression.
+ * know in order to evaluate an expression. Each variable the context
+ * has seen occupies a slot, which is a small integer that stays the same
+ * for the life of the context. The variables can be read and written
+ * either by name, which is convenient for the interpreter's top level,
+ * or by slot, which is a single array access.
  */
 
 class EvaluationContext {
 
 public:
 
+/*
+ * Constructor: EvaluationContext
+ * Usage: EvaluationContext context;
+ * ---------------------------------
+ * Initializes a context in which no variables are defined.
+ */
+
+    EvaluationContext();
+
+/*
+ * Destructor: ~EvaluationContext
+ * ------------------------------
+ * Frees any heap storage associated with this context.
+ */
+
+    ~EvaluationContext();
+
 /*
  * Method: setValue
  * Usage: context.setValue(var, value);
- * ------------------------------------
- * Sets the value associated with the specified var.
+ *        context.setValue(slot, value);
+ * -------------------------------------
+ * Sets the value associated with the specified variable, which may be
+ * given by name or by slot.
  */
 
-    void setValue(std::string var, int value);
+    void setValue(std::string_view var, int value);
+    void setValue(int slot, int value);
+
+/*
+ * Method: clearValue
+ * Usage: context.clearValue(var);
+ *        context.clearValue(slot);
+ * --------------------------------
+ * Makes the specified variable undefined again. The variable keeps its
+ * slot.
+ */
+
+    void clearValue(std::string_view var);
+    void clearValue(int slot);
 
 /*
  * Method: getValue
  * Usage: int value = context.getValue(var);
- * -----------------------------------------
- * Returns the value associated with the specified variable.
+ *        int value = context.getValue(slot);
+ * ------------------------------------------
+ * Returns the value associated with the specified variable, which may
+ * be given by name or by slot.
  */
 
-    int getValue(std::string var);
+    int getValue(std::string_view var) const;
+    int getValue(int slot) const;
 
 /*
  * Method: isDefined
  * Usage: if (context.isDefined(var)) . . .
- * ----------------------------------------
+ *        if (context.isDefined(slot)) . . .
+ * -----------------------------------------
  * Returns true if the specified variable is defined.
  */
 
-    bool isDefined(std::string var);
+    bool isDefined(std::string_view var) const;
+    bool isDefined(int slot) const;
+
+/*
+ * Method: getSlot
+ * Usage: int slot = context.getSlot(var);
+ * ---------------------------------------
+ * Returns the slot of the named variable, giving it a new slot if the
+ * context has not seen it before. A new slot holds no value, so the
+ * variable remains undefined until it is assigned.
+ */
+
+    int getSlot(std::string_view var);
+
+/*
+ * Method: findSlot
+ * Usage: int slot = context.findSlot(var);
+ * ----------------------------------------
+ * Returns the slot of the named variable, or -1 if it has none.
+ */
+
+    int findSlot(std::string_view var) const;
+
+/*
+ * Method: getNameNumber
+ * Usage: int number = EvaluationContext::getNameNumber(var);
+ * ----------------------------------------------------------
+ * Returns a small nonnegative integer that stands for the name in every
+ * context. A client that looks up the same name many times, as an
+ * expression tree does, can get its number once and then use the
+ * versions of findSlot and getSlot below, which index an array in the
+ * context instead of hashing the name. This method may be called from
+ * any thread. The numbers are never reused, so the table of names grows
+ * with the number of distinct names the program ever uses.
+ */
+
+    static int getNameNumber(std::string_view var);
+
+/*
+ * Methods: findSlot, getSlot (by name number)
+ * Usage: int slot = context.findSlot(number, var);
+ *        int slot = context.getSlot(number, var);
+ * -----------------------------------------------
+ * These methods do the same work as the versions that take only a name,
+ * where number must be getNameNumber(var). The context remembers the
+ * slot for each number, so after the first call these methods cost an
+ * array access. The findSlot method returns -1 for a variable with no
+ * slot and, like the version that takes a name, never creates one.
+ */
+
+    int findSlot(int number, std::string_view var);
+    int getSlot(int number, std::string_view var);
+
+/*
+ * Method: readValue
+ * Usage: if (context.readValue(number, var, value)) . . .
+ * -------------------------------------------------------
+ * Looks up the variable by name number as findSlot does and, if it is
+ * defined, stores its value in the reference parameter value and returns
+ * true. If the variable is undefined, this method returns false and
+ * leaves value unchanged. A reader that needs both the test and the
+ * value gets them with one call.
+ */
+
+    bool readValue(int number, std::string_view var, int & value);
+
+/*
+ * Methods: getSlotCount, getSlotName
+ * Usage: for (int i = 0; i < context.getSlotCount(); i++) . . .
+ *        std::string_view name = context.getSlotName(slot);
+ * -------------------------------------------------------------
+ * These methods make it possible to list the variables by slot.
+ */
+
+    int getSlotCount() const;
+    std::string_view getSlotName(int slot) const;
+
+/*
+ * Methods: startMemo, recallMemo, storeMemo
+ * Usage: context.startMemo();
+ *        if (context.recallMemo(index, value)) . . .
+ *        context.storeMemo(index, value);
+ * ----------------------------------------------
+ * These methods let an expression that evaluates a shared subexpression
+ * only once keep the value in the context rather than in the tree, so
+ * that the tree can still be evaluated on several threads. The startMemo
+ * method forgets every value stored so far. The recallMemo method
+ * returns true and sets value if a value has been stored under index
+ * since then, and storeMemo stores one. The index is any small
+ * nonnegative integer chosen by the expression. The methods are defined
+ * here so that the compiler can expand them inline.
+ */
+
+    void startMemo() {
+        memoGeneration++;
+    }
+
+    bool recallMemo(int index, int & value) const {
+        if (index >= memoCapacity || memoStamps[index] != memoGeneration) {
+            return false;
+        }
+        value = memoValues[index];
+        return true;
+    }
+
+    void storeMemo(int index, int value) {
+        if (index >= memoCapacity) expandMemo(index);
+        memoValues[index] = value;
+        memoStamps[index] = memoGeneration;
+    }
+
+/*
+ * Copy constructor and assignment operator
+ * ----------------------------------------
+ * Copying a context copies its variables, which keep their slots.
+ */
+
+    EvaluationContext(const EvaluationContext & src);
+    EvaluationContext & operator=(const EvaluationContext & src);
+
+/*
+ * Notes on representation
+ * -----------------------
+ * The names of the variables are kept in a StringInterner, whose
+ * identifiers serve as the slots. The values are kept in a parallel
+ * array together with a flag that records whether each one is defined.
+ * A second array, indexed by name number, records the slot of each name
+ * that has been looked up by number, or -1 if it has not. Keeping that
+ * table in the context rather than in the expression tree is what lets
+ * a tree be shared by several contexts. The remembered values of
+ * shared subexpressions are kept the same way, each with the number of
+ * the startMemo call that stored it, so that starting a new evaluation
+ * does not have to clear them. A copy of a context does not copy them.
+ */
 
 private:
 
-    Map<std::string,int> symbolTable;
+/* Constant definitions */
+
+    static const int INITIAL_CAPACITY = 16;
+    static const int NAME_SHARDS = 16;
+
+/* Instance variables */
+
+    StringInterner names;       // The name of the variable in each slot
+    int *values;                // The value in each slot
+    bool *defined;              // Whether each slot holds a value
+    int capacity;               // The allocated size of the arrays
+    int *slotsByNumber;         // The slot for each name number, or -1
+    int numberCapacity;         // The allocated size of slotsByNumber
+    int *memoValues;            // The remembered value for each index
+    long *memoStamps;           // The startMemo call that stored it
+    int memoCapacity;           // The allocated size of the memo arrays
+    long memoGeneration;        // The number of calls to startMemo
+
+/* Private methods */
+
+    void expandCapacity();
+    void deepCopy(const EvaluationContext & src);
+    void recordSlot(int number, int slot);
+    void expandMemo(int index);
+
 };
 
 #endif
\ No newline at end of file
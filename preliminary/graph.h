@@ -9,8 +9,12 @@
 #define _graph_h
 
 #include <string>
-#include "map.h"
+#include <string_view>
+#include "error.h"
+#include "interner.h"
+#include "pool.h"
 #include "set.h"
+#include "vector.h"
 
 /*
  * Class: Graph<NodeType,ArcType>
@@ -28,6 +32,12 @@
  * The ArcType definition must include:
  *   - A NodeType * field called start
  *   - A NodeType * field called finish
+ *
+ * Every node name is interned when it is first added, which gives the
+ * node a dense integer identifier in the range 0 to getNodeIdLimit() - 1.
+ * Each method that takes a node name has a version that takes an
+ * identifier instead, which avoids looking up the name. The methods that
+ * take names accept std::string_view, so a lookup never copies its key.
  */
 
 template <typename NodeType,typename ArcType>
@@ -74,7 +84,8 @@ public:
  * Method: clear
  * Usage: g.clear();
  * -----------------
- * Reinitializes the graph to be empty, freeing any heap storagi.
+ * Reinitializes the graph to be empty, freeing any heap storage. Nodes
+ * and arcs created by the graph itself are released a chunk at a time.
  */
 
     void clear();
@@ -85,80 +96,117 @@ public:
  *        g.addNode(node);
  * -----------------------
  * Adds a node to the graph. The first form creates the node from
- * the name. The second form takes a node pointer created by the client.
- * Both forms returns a pointer to the added node, although that value is
- * typically ignored.
+ * the name. The second form takes a node pointer created by the client
+ * using new, which the graph deletes when it is cleared. Both forms
+ * return a pointer to the added node, although that value is typically
+ * ignored.
  */
 
-    NodeType *addNode(std::string name);
+    NodeType *addNode(std::string_view name);
     NodeType *addNode(NodeType *node);
 
 /*
  * Method: removeNode
  * Usage: g.removeNode(name);
+ *        g.removeNode(id);
  *        g.removeNode(node);
  * --------------------------
  * Removes a node from the graph, where the node can be specified
- * eithes by its name or as a pointer value. Removing a node also
- * removes all arcs that contain that node.
+ * either by its name, by its identifier or as a pointer value. Removing
+ * a node also removes all arcs that contain that node.
  */
 
-    void removeNode(std::string name);
+    void removeNode(std::string_view name);
+    void removeNode(int id);
     void removeNode(NodeType *node);
 
 /*
  * Method: getNode
  * Usage: NodeType *node = g.getNode(name);
- * ----------------------------------------
+ *        NodeType *node = g.getNode(id);
+ * --------------------------------------
  * Looks up a node in the name table attached to the graph and
  * returns a pointer to that node. If no node with the specified
- * name exists, getNode returns NULL.
+ * name or identifier exists, getNode returns NULL.
  */
 
-    NodeType *getNode(std::string name) const;
+    NodeType *getNode(std::string_view name) const;
+    NodeType *getNode(int id) const;
+
+/*
+ * Method: getNodeId
+ * Usage: int id = g.getNodeId(name);
+ *        int id = g.getNodeId(node);
+ * ----------------------------------
+ * Returns the identifier of a node, specified by name or as a pointer.
+ * If the graph contains no such node, getNodeId returns -1. A node keeps
+ * its identifier for as long as the graph exists, and a node that is
+ * removed and later added again with the same name gets the same one.
+ */
+
+    int getNodeId(std::string_view name) const;
+    int getNodeId(NodeType *node) const;
+
+/*
+ * Method: getNodeIdLimit
+ * Usage: Vector<int> data(g.getNodeIdLimit(), 0);
+ * -----------------------------------------------
+ * Returns one more than the largest identifier issued so far, which is
+ * the size of an array that can hold data for every node by identifier.
+ * Identifiers of removed nodes remain in the range.
+ */
+
+    int getNodeIdLimit() const;
 
 /*
  * Method: addArc
  * Usage: g.addArc(s1, s2);
+ *        g.addArc(id1, id2);
  *        g.addArc(n1, n2);
  *        g.addArc(arc);
  * ---------------------
  * Adds an arc to the graph. The endpoints of the arc can be specified
- * either as strings indicating the names of the nodes or as pointers to
- * the node structures. All versions return a pointer to the added arc,
- * although that value is typically ignored.
+ * as strings indicating the names of the nodes, as node identifiers, or
+ * as pointers to the node structures. All versions return a pointer to
+ * the added arc, although that value is typically ignored.
  */
 
-    ArcType *addArc(std::string s1, std::string s2);
+    ArcType *addArc(std::string_view s1, std::string_view s2);
+    ArcType *addArc(int id1, int id2);
     ArcType *addArc(NodeType *n1, NodeType *n2);
     ArcType *addArc(ArcType *arc);
 
 /*
  * Method: removeArc
  * Usage: g.removeArc(s1, s2);
+ *        g.removeArc(id1, id2);
  *        g.removeArc(n1, n2);
  *        g.removeArc(arc);
  * ------------------------
  * Removes an arc from the graph, where the arc can be specified in any
- * of three ways: by the name of its endpoints, by the node pointers
- * at its endpoints, or as an arc pointer. If more than one arc
- * connects the specified endpoints, all of them are removed.
+ * of four ways: by the names of its endpoints, by their identifiers, by
+ * the node pointers at its endpoints, or as an arc pointer. If more than
+ * one arc connects the specified endpoints, all of them are removed.
  */
 
-    void removeArc(std::string s1, std::string s2);
+    void removeArc(std::string_view s1, std::string_view s2);
+    void removeArc(int id1, int id2);
     void removeArc(NodeType *n1, NodeType *n2);
     void removeArc(ArcType *arc);
 
 /*
  * Method: isConnected
  * Usage: if (g.isConnected(s1, s2)) . . .
+ *        if (g.isConnected(id1, id2)) . . .
  *        if (g.isConnected(n1, n2)) . . .
  * ---------------------------------------
  * Returns true if the graph contains an arc between the specified nodes.
- * Nodes can be specified either by name or as pointers to node objects.
+ * Nodes can be specified by name, by identifier or as pointers to node
+ * objects.
  */
 
-    bool isConnected(std::string s1, std::string s2) const;
+    bool isConnected(std::string_view s1, std::string_view s2) const;
+    bool isConnected(int id1, int id2) const;
     bool isConnected(NodeType *n1, NodeType *n2) const;
 
 /*
@@ -175,27 +223,31 @@ public:
  * Usage: for (ArcType *arc : g.getArcSet()) . . .
  *        for (ArcType *arc : g.getArcSet(node)) . . .
  *        for (ArcType *arc : g.getArcSet(name)) . . .
+ *        for (ArcType *arc : g.getArcSet(id)) . . .
  * ---------------------------------------------------
- * Returns the set of all arcs in the group or, in the second and
- * third forms, the arcs that start at the specified node, which
- * can be indicated either as a pointer or by name.
+ * Returns the set of all arcs in the group or, in the other forms, the
+ * arcs that start at the specified node, which can be indicated as a
+ * pointer, by name or by identifier.
  */
 
     Set<ArcType *> & getArcSet();
     Set<ArcType *> & getArcSet(NodeType *node);
-    Set<ArcType *> & getArcSet(std::string name);
+    Set<ArcType *> & getArcSet(std::string_view name);
+    Set<ArcType *> & getArcSet(int id);
 
 /*
  * Method: getNeighbors
  * Usage: for (NodeType *node : g.getNeighbors(node)) . . .
  *        for (NodeType *node : g.getNeighbors(name)) . . .
+ *        for (NodeType *node : g.getNeighbors(id)) . . .
  * --------------------------------------------------------
  * Returns the set of nodes that are neighbors of the specified
- * node, which can be indicated either as a pointer or by name.
+ * node, which can be indicated as a pointer, by name or by identifier.
  */
 
     Set<NodeType *> getNeighbors(NodeType *node);
-    Set<NodeType *> getNeighbors(std::string name);
+    Set<NodeType *> getNeighbors(std::string_view name);
+    Set<NodeType *> getNeighbors(int id);
 
 /*
  * Methods: copy constructors and assignment operator
@@ -210,8 +262,19 @@ public:
  * Notes on representation
  * -----------------------
  * The Graph class is built as a layered abstraction on top of the Set
- * and Map classes. Most of the complexity appears in the underlying
- * implementations.
+ * class. Most of the complexity appears in the underlying
+ * implementations. Nodes and arcs that the graph creates itself come
+ * from a pair of Pool objects, which means that building a large graph
+ * makes only a handful of allocations for the node and arc structures.
+ * Nodes and arcs supplied by the client are also entered in sets of
+ * their own, which tell clear which objects it has to delete.
+ *
+ * Names are kept in a StringInterner, which stores each name once and
+ * finds it by hashing, and the interned identifier indexes a vector of
+ * node pointers. Looking up a name therefore costs one hash and one
+ * string comparison instead of a series of comparisons in a tree. The
+ * interner never forgets a name, so the entry for a removed node is
+ * simply set to NULL.
  */
 
 private:
@@ -220,12 +283,20 @@ private:
 
     Set<NodeType *> nodes;                  // The set of nodes in the graph
     Set<ArcType *> arcs;                    // The set of arcs in the graph
-    Map<std::string,NodeType *> nodeMap;    // A map from names and nodes
+    StringInterner names;                   // The identifier of each name
+    Vector<NodeType *> nodeTable;           // The node with each identifier
+    Pool<NodeType> nodePool;                // Storage for graph-made nodes
+    Pool<ArcType> arcPool;                  // Storage for graph-made arcs
+    Set<NodeType *> clientNodes;            // Nodes supplied by the client
+    Set<ArcType *> clientArcs;              // Arcs supplied by the client
 
 /* Private methods */
 
     void deepCopy(const Graph & src);
-    NodeType *getExistingNode(std::string name) const;
+    NodeType *insertNode(NodeType *node);
+    ArcType *insertArc(ArcType *arc);
+    NodeType *getExistingNode(std::string_view name) const;
+    NodeType *getExistingNode(int id) const;
 };
 
 /*
@@ -266,44 +337,72 @@ bool Graph<NodeType,ArcType>::isEmpty() const {
 
 /*
  * Implementation notes: clear
- * -----------------------------------
- * The implementation of clear frees all nodes and arcs.
+ * ---------------------------
+ * The implementation of clear frees all nodes and arcs. Only the nodes
+ * and arcs supplied by the client have to be deleted one at a time, and
+ * those are recorded in sets of their own, so clear never has to ask
+ * which objects came from the pools. The rest are released by clearing
+ * the pools a chunk at a time.
  */
 
 template <typename NodeType,typename ArcType>
 void Graph<NodeType,ArcType>::clear() {
-    for (NodeType *node : nodes) {
+    for (NodeType *node : clientNodes) {
         delete node;
     }
-    for (NodeType *arc : arcs) {
+    for (ArcType *arc : clientArcs) {
         delete arc;
     }
+    clientNodes.clear();
+    clientArcs.clear();
     arcs.clear();
     nodes.clear();
-    nodeMap.clear();
+    names.clear();
+    nodeTable.clear();
+    nodePool.clear();
+    arcPool.clear();
 }
 
 /*
  * Implementation notes: addNode
  * -----------------------------
  * The addNode method adds the node to the set of nodes for the graph and
- * to the map from names to nodes.
+ * records it in the node table under the identifier of its name, growing
+ * the table when the name is new. Nodes created from a name are taken
+ * from the node pool rather than allocated individually.
  */
 
 template <typename NodeType,typename ArcType>
-NodeType *Graph<NodeType,ArcType>::addNode(std::string name) {
-    if (nodeMap.containsKey(name)) {
-        error("addNode: Node " + name + " already exists");
+NodeType *Graph<NodeType,ArcType>::addNode(std::string_view name) {
+    if (getNodeId(name) >= 0) {
+        error("addNode: Node " + std::string(name) + " already exists");
     }
-    NodeType * node = new NodeType();
-    node->name = name;
-    return addNode(node);
+    NodeType *node = nodePool.allocate();
+    node->name = std::string(name);
+    return insertNode(node);
 }
 
 template <typename NodeType,typename ArcType>
 NodeType *Graph<NodeType,ArcType>::addNode(NodeType *node) {
+    clientNodes.add(node);
+    return insertNode(node);
+}
+
+/*
+ * Private method: insertNode
+ * Usage: insertNode(node);
+ * ------------------------
+ * Adds a node to the graph without recording who allocated it.
+ */
+
+template <typename NodeType,typename ArcType>
+NodeType *Graph<NodeType,ArcType>::insertNode(NodeType *node) {
     nodes.add(node);
-    nodeMap[node->name] = node;
+    int id = names.intern(node->name);
+    while (nodeTable.size() <= id) {
+        nodeTable.add(NULL);
+    }
+    nodeTable[id] = node;
     return node;
 }
 
@@ -317,10 +416,15 @@ NodeType *Graph<NodeType,ArcType>::addNode(NodeType *node) {
  */
 
 template <typename NodeType,typename ArcType>
-void Graph<NodeType,ArcType>::removeNode(std::string name) {
+void Graph<NodeType,ArcType>::removeNode(std::string_view name) {
     removeNode(getExistingNode(name));
 }
 
+template <typename NodeType,typename ArcType>
+void Graph<NodeType,ArcType>::removeNode(int id) {
+    removeNode(getExistingNode(id));
+}
+
 template <typename NodeType,typename ArcType>
 void Graph<NodeType,ArcType>::removeNode(NodeType *node) {
     Vector<ArcType *> toRemove;
@@ -335,26 +439,61 @@ void Graph<NodeType,ArcType>::removeNode(NodeType *node) {
         }
     }
     nodes.remove(node);
+    clientNodes.remove(node);
+    int id = names.find(node->name);
+    if (id >= 0 && nodeTable[id] == node) nodeTable[id] = NULL;
 }
 
 /*
- * Implementation notes: getNode, getExistingNode
- * ----------------------------------------------
- * The getNode method simply looks up the name in the map, which correctly
- * returns NULL if the name is not found. Other methods in the
- * implementation call the previous method getExistingNode instead,
- * which checks for a NULL value and signals an error.
+ * Implementation notes: getNode, getNodeId, getExistingNode
+ * ---------------------------------------------------------
+ * The getNode method translates a name to its identifier and returns
+ * the entry in the node table, which is NULL if the node was removed.
+ * Other methods in the implementation call the private method
+ * getExistingNode instead, which checks for a NULL value and signals
+ * an error.
  */
 
 template <typename NodeType,typename ArcType>
-NodeType *Graph<NodeType,ArcType>::getNode(std::string name) const {
-    return nodeMap.get(name);
+NodeType *Graph<NodeType,ArcType>::getNode(std::string_view name) const {
+    return getNode(names.find(name));
+}
+
+template <typename NodeType,typename ArcType>
+NodeType *Graph<NodeType,ArcType>::getNode(int id) const {
+    if (id < 0 || id >= nodeTable.size()) return NULL;
+    return nodeTable.get(id);
+}
+
+template <typename NodeType,typename ArcType>
+int Graph<NodeType,ArcType>::getNodeId(std::string_view name) const {
+    int id = names.find(name);
+    return (getNode(id) == NULL) ? -1 : id;
+}
+
+template <typename NodeType,typename ArcType>
+int Graph<NodeType,ArcType>::getNodeId(NodeType *node) const {
+    int id = names.find(node->name);
+    return (id >= 0 && getNode(id) == node) ? id : -1;
+}
+
+template <typename NodeType,typename ArcType>
+int Graph<NodeType,ArcType>::getNodeIdLimit() const {
+    return names.size();
+}
+
+template <typename NodeType,typename ArcType>
+NodeType *Graph<NodeType,ArcType>::getExistingNode(std::string_view name)
+                                                                    const {
+    NodeType *node = getNode(name);
+    if (node == NULL) error("No node named " + std::string(name));
+    return node;
 }
 
 template <typename NodeType,typename ArcType>
-NodeType *Graph<NodeType,ArcType>::getExistingNode(std::string name) const {
-    NodeType *node = nodeMap.get(name);
-    if (node == NULL) error("No node named " + name);
+NodeType *Graph<NodeType,ArcType>::getExistingNode(int id) const {
+    NodeType *node = getNode(id);
+    if (node == NULL) error("No node with identifier " + std::to_string(id));
     return node;
 }
 
@@ -362,23 +501,43 @@ NodeType *Graph<NodeType,ArcType>::getExistingNode(std::string name) const {
  * Implementation notes: addArc
  * ----------------------------
  * The addArc method appears in three forms, as described in the interface.
+ * Arcs created from a pair of endpoints are taken from the arc pool.
  */
 
 template <typename NodeType,typename ArcType>
-ArcType *Graph<NodeType,ArcType>::addArc(std::string s1, std::string s2) {
+ArcType *Graph<NodeType,ArcType>::addArc(std::string_view s1,
+                                         std::string_view s2) {
     return addArc(getExistingNode(s1), getExistingNode(s2));
 }
 
+template <typename NodeType,typename ArcType>
+ArcType *Graph<NodeType,ArcType>::addArc(int id1, int id2) {
+    return addArc(getExistingNode(id1), getExistingNode(id2));
+}
+
 template <typename NodeType,typename ArcType>
 ArcType *Graph<NodeType,ArcType>::addArc(NodeType *n1, NodeType *n2) {
-    ArcType *arc = new ArcType();
+    ArcType *arc = arcPool.allocate();
     arc->start = n1;
     arc->finish = n2;
-    return addArc(arc);
+    return insertArc(arc);
 }
 
 template <typename NodeType,typename ArcType>
 ArcType *Graph<NodeType,ArcType>::addArc(ArcType *arc) {
+    clientArcs.add(arc);
+    return insertArc(arc);
+}
+
+/*
+ * Private method: insertArc
+ * Usage: insertArc(arc);
+ * ----------------------
+ * Adds an arc to the graph without recording who allocated it.
+ */
+
+template <typename NodeType,typename ArcType>
+ArcType *Graph<NodeType,ArcType>::insertArc(ArcType *arc) {
     arc->start->arcs.add(arc);
     arcs.add(arc);
     return arc;
@@ -395,10 +554,16 @@ ArcType *Graph<NodeType,ArcType>::addArc(ArcType *arc) {
  */
 
 template <typename NodeType,typename ArcType>
-void Graph<NodeType,ArcType>::removeArc(std::string s1, std::string s2) {
+void Graph<NodeType,ArcType>::removeArc(std::string_view s1,
+                                        std::string_view s2) {
     removeArc(getExistingNode(s1), getExistingNode(s2));
 }
 
+template <typename NodeType,typename ArcType>
+void Graph<NodeType,ArcType>::removeArc(int id1, int id2) {
+    removeArc(getExistingNode(id1), getExistingNode(id2));
+}
+
 template <typename NodeType,typename ArcType>
 void Graph<NodeType,ArcType>::removeArc(NodeType *n1, NodeType *n2) {
     Vector<ArcType *> toRemove;
@@ -408,9 +573,7 @@ void Graph<NodeType,ArcType>::removeArc(NodeType *n1, NodeType *n2) {
         }
     }
     for (ArcType *arc: toRemove) {
-        if (arc->start == node || arc->finish == node) {
-            removeArc(arc);
-        }
+        removeArc(arc);
     }
 }
 
@@ -418,6 +581,7 @@ template <typename NodeType,typename ArcType>
 void Graph<NodeType,ArcType>::removeArc(ArcType *arc) {
     arc->start->arcs.remove(arc);
     arcs.remove(arc);
+    clientArcs.remove(arc);
 }
 
 /*
@@ -427,11 +591,16 @@ void Graph<NodeType,ArcType>::removeArc(ArcType *arc) {
  */
 
 template <typename NodeType,typename ArcType>
-bool Graph<NodeType,ArcType>::isConnected(std::string s1,
-                                          std::string s2) const {
+bool Graph<NodeType,ArcType>::isConnected(std::string_view s1,
+                                          std::string_view s2) const {
     return isConnected(getExistingNode(s1), getExistingNode(s2));
 }
 
+template <typename NodeType,typename ArcType>
+bool Graph<NodeType,ArcType>::isConnected(int id1, int id2) const {
+    return isConnected(getExistingNode(id1), getExistingNode(id2));
+}
+
 template <typename NodeType,typename ArcType>
 bool Graph<NodeType,ArcType>::isConnected(NodeType *n1, NodeType *n2) const {
     for (ArcType *arc : n1->arcs) {
@@ -464,10 +633,15 @@ Set<ArcType *> & Graph<NodeType,ArcType>::getArcSet(NodeType *node) {
 }
 
 template <typename NodeType,typename ArcType>
-Set<ArcType *> & Graph<NodeType,ArcType>::getArcSet(std::string name) {
+Set<ArcType *> & Graph<NodeType,ArcType>::getArcSet(std::string_view name) {
     return getArcSet(getExistingNode(name));
 }
 
+template <typename NodeType,typename ArcType>
+Set<ArcType *> & Graph<NodeType,ArcType>::getArcSet(int id) {
+    return getArcSet(getExistingNode(id));
+}
+
 /*
  * Implementation notes: getNeighbors
  * ----------------------------------
@@ -485,10 +659,15 @@ Set<NodeType *> Graph<NodeType, ArcType>::getNeighbors(NodeType *node) {
 }
 
 template <typename NodeType,typename ArcType>
-Set<NodeType *> Graph<NodeType, ArcType>::getNeighbors(std::string name) {
+Set<NodeType *> Graph<NodeType, ArcType>::getNeighbors(std::string_view name) {
     return getNeighbors(getExistingNode(name));
 }
 
+template <typename NodeType,typename ArcType>
+Set<NodeType *> Graph<NodeType, ArcType>::getNeighbors(int id) {
+    return getNeighbors(getExistingNode(id));
+}
+
 /*
  * Implementation notes: copy constructor and assignment operator
  * --------------------------------------------------------------
@@ -515,23 +694,29 @@ Graph<NodeType,ArcType>::Graph(const Graph & src) {
  * Private method: deepCopy
  * ------------------------
  * This method reallocates all the nodes and arcs to ensure that the
- * structures are disjoint.
+ * structures are disjoint. The copies always come from the pools of the
+ * new graph, even if the originals were supplied by the client. The
+ * names are interned first in their original order, so every node keeps
+ * its identifier in the copy.
  */
 
 template <typename NodeType,typename ArcType>
 void Graph<NodeType,ArcType>::deepCopy(const Graph & other) {
+    for (int id = 0; id < other.names.size(); id++) {
+        names.intern(other.names.getName(id));
+    }
     for (NodeType *oldNode : other.nodes) {
-        NodeType *newNode = new NodeType();
+        NodeType *newNode = nodePool.allocate();
         *newNode = *oldNode;
         newNode->arcs.clear();
-        addNode(newNode);
+        insertNode(newNode);
     }
     for (ArcType *oldArc : other.arcs) {
-        ArcType *newArc = new ArcType();
+        ArcType *newArc = arcPool.allocate();
         *newArc = *oldArc;
         newArc->start = getExistingNode(oldArc->start->name);
         newArc->finish = getExistingNode(oldArc->finish->name);
-        addArc(newArc);
+        insertArc(newArc);
     }
 }
 
@@ -0,0 +1,102 @@
+/*
+ * File: graphconvert.h
+ * --------------------
+ * This interface exports functions that copy a SimpleGraph or a Graph
+ * into a CompactGraph, so that the algorithms written for the compact
+ * representation can be applied to the other two.
+ */
+
+#ifndef _graphconvert_h
+#define _graphconvert_h
+
+#include "compactgraph.h"
+#include "graph.h"
+#include "graphtypes.h"
+#include "interner.h"
+
+/*
+ * Function: toCompactGraph
+ * Usage: toCompactGraph(g, compact);
+ * ----------------------------------
+ * Replaces the contents of compact with a copy of the graph g, which may
+ * be a SimpleGraph or any Graph<NodeType,ArcType> whose ArcType has a
+ * numeric field called cost. The nodes are numbered in the order in
+ * which the node set of g returns them, and each node in compact has
+ * the same name as the corresponding node in g, so getNodeId translates
+ * from names to node numbers.
+ */
+
+void toCompactGraph(SimpleGraph & g, CompactGraph & compact);
+
+template <typename NodeType,typename ArcType>
+void toCompactGraph(Graph<NodeType,ArcType> & g, CompactGraph & compact);
+
+/* Private section */
+
+/**********************************************************************/
+/* Note: Everything below this point in the file is logically part    */
+/* of the implementation and should not be of interest to clients.    */
+/**********************************************************************/
+
+/*
+ * Implementation notes: toCompactGraph
+ * ------------------------------------
+ * Both versions intern the node names first, which gives each node its
+ * number, and then collect the arcs into the parallel arrays expected by
+ * CompactGraph::build. Looking up the number of each endpoint by name
+ * keeps the functions independent of how the graph maps nodes to names.
+ */
+
+template <typename NodeType,typename ArcType>
+void toCompactGraph(Graph<NodeType,ArcType> & g, CompactGraph & compact) {
+    StringInterner names;
+    for (NodeType *node : g.getNodeSet()) {
+        names.intern(node->name);
+    }
+    int nArcs = g.getArcSet().size();
+    int *starts = new int[nArcs];
+    int *finishes = new int[nArcs];
+    double *costs = new double[nArcs];
+    int i = 0;
+    for (ArcType *arc : g.getArcSet()) {
+        starts[i] = names.find(arc->start->name);
+        finishes[i] = names.find(arc->finish->name);
+        costs[i] = arc->cost;
+        i++;
+    }
+    compact.build(names, nArcs, starts, finishes, costs);
+    delete[] starts;
+    delete[] finishes;
+    delete[] costs;
+}
+
+/*
+ * Implementation notes: toCompactGraph for SimpleGraph
+ * ----------------------------------------------------
+ * SimpleGraph is not a template, but it has the same fields as Graph, so
+ * this version is written inline here to keep the two side by side.
+ */
+
+inline void toCompactGraph(SimpleGraph & g, CompactGraph & compact) {
+    StringInterner names;
+    for (Node *node : g.nodes) {
+        names.intern(node->name);
+    }
+    int nArcs = g.arcs.size();
+    int *starts = new int[nArcs];
+    int *finishes = new int[nArcs];
+    double *costs = new double[nArcs];
+    int i = 0;
+    for (Arc *arc : g.arcs) {
+        starts[i] = names.find(arc->start->name);
+        finishes[i] = names.find(arc->finish->name);
+        costs[i] = arc->cost;
+        i++;
+    }
+    compact.build(names, nArcs, starts, finishes, costs);
+    delete[] starts;
+    delete[] finishes;
+    delete[] costs;
+}
+
+#endif
@@ -0,0 +1,316 @@
+/*
+ * File: graphloader.cpp
+ * ---------------------
+ * This file implements the graphloader.h interface.
+ */
+
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include "compactgraph.h"
+#include "error.h"
+#include "graphloader.h"
+#include "graphtypes.h"
+#include "interner.h"
+#include "mappedfile.h"
+#include "strlib.h" // From Stanford libraries
+#include "vector.h"
+using namespace std;
+
+/* Constants */
+
+const long MIN_CHUNK_SIZE = 1 << 16;    // Smallest chunk worth a thread
+
+/*
+ * Type: ChunkParse
+ * ----------------
+ * This type holds the work of one parsing thread: the range of the file
+ * it reads, the names it has seen, numbered locally, and the arcs it has
+ * found, expressed in those local numbers.
+ */
+
+struct ChunkParse {
+    const char *begin;          // First character of the chunk
+    const char *end;            // One past the last character
+    StringInterner names;       // Names in order of appearance
+    Vector<int> starts;         // Local start of each arc
+    Vector<int> finishes;       // Local finish of each arc
+    Vector<double> costs;       // Cost of each arc
+    const char *badLine;        // First malformed line, or NULL
+    int *globalIds;             // Map from local to global identifiers
+    int firstArc;               // Position of the first arc overall
+};
+
+/* Private function prototypes */
+
+void parseChunk(ChunkParse *chunk);
+int splitLine(const char *cp, const char *eol, string_view fields[]);
+void remapChunk(ChunkParse *chunk, int *starts, int *finishes,
+                double *costs);
+const char *findLineStart(const char *data, const char *cp, const char *end);
+int countLines(const char *data, const char *cp);
+
+/*
+ * Implementation notes: loadEdgeList
+ * ----------------------------------
+ * The CompactGraph version of loadEdgeList works in four phases:
+ *
+ * 1. Map the file and divide it into chunks that start on line boundaries.
+ * 2. Parse the chunks in parallel. Each thread interns the names in its
+ *    own chunk, so the threads share no data and need no locking.
+ * 3. Merge the per-chunk name tables into one. Taking the chunks in file
+ *    order preserves the rule that nodes are numbered by first appearance,
+ *    and this phase touches each distinct name once per chunk rather than
+ *    once per arc.
+ * 4. Translate the arcs to global numbers in parallel, writing each chunk
+ *    into its own slice of the arc arrays, and build the CSR structure.
+ */
+
+LoadStats loadEdgeList(string filename, CompactGraph & g, int nThreads) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    MappedFile file(filename);
+    const char *data = file.getData();
+    const char *end = data + file.size();
+    if (nThreads <= 0) nThreads = thread::hardware_concurrency();
+    if (nThreads <= 0) nThreads = 1;
+    long maxThreads = file.size() / MIN_CHUNK_SIZE;
+    if (nThreads > maxThreads) nThreads = (maxThreads < 1) ? 1 : maxThreads;
+    ChunkParse *chunks = new ChunkParse[nThreads];
+    for (int i = 0; i < nThreads; i++) {
+        chunks[i].begin = (i == 0) ? data
+                        : findLineStart(data, data + file.size() * i / nThreads,
+                                        end);
+        chunks[i].badLine = NULL;
+        chunks[i].globalIds = NULL;
+    }
+    for (int i = 0; i < nThreads; i++) {
+        chunks[i].end = (i == nThreads - 1) ? end : chunks[i + 1].begin;
+    }
+    Vector<thread *> threads;
+    for (int i = 1; i < nThreads; i++) {
+        threads.add(new thread(parseChunk, &chunks[i]));
+    }
+    parseChunk(&chunks[0]);
+    for (int i = 0; i < threads.size(); i++) {
+        threads[i]->join();
+        delete threads[i];
+    }
+    threads.clear();
+    for (int i = 0; i < nThreads; i++) {
+        if (chunks[i].badLine != NULL) {
+            int line = countLines(data, chunks[i].badLine);
+            delete[] chunks;
+            error("loadEdgeList: Malformed line " + integerToString(line)
+                  + " in " + filename);
+        }
+    }
+    StringInterner names;
+    int nArcs = 0;
+    for (int i = 0; i < nThreads; i++) {
+        ChunkParse & chunk = chunks[i];
+        chunk.globalIds = new int[chunk.names.size()];
+        for (int id = 0; id < chunk.names.size(); id++) {
+            chunk.globalIds[id] = names.intern(chunk.names.getName(id));
+        }
+        chunk.firstArc = nArcs;
+        nArcs += chunk.starts.size();
+    }
+    int *starts = new int[nArcs];
+    int *finishes = new int[nArcs];
+    double *costs = new double[nArcs];
+    for (int i = 1; i < nThreads; i++) {
+        threads.add(new thread(remapChunk, &chunks[i], starts, finishes,
+                               costs));
+    }
+    remapChunk(&chunks[0], starts, finishes, costs);
+    for (int i = 0; i < threads.size(); i++) {
+        threads[i]->join();
+        delete threads[i];
+    }
+    for (int i = 0; i < nThreads; i++) {
+        delete[] chunks[i].globalIds;
+    }
+    delete[] chunks;
+    g.build(names, nArcs, starts, finishes, costs);
+    delete[] starts;
+    delete[] finishes;
+    delete[] costs;
+    LoadStats stats;
+    stats.bytes = file.size();
+    stats.nThreads = nThreads;
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    stats.seconds = elapsed.count();
+    return stats;
+}
+
+/*
+ * Implementation notes: loadEdgeList for SimpleGraph
+ * --------------------------------------------------
+ * This version loads the file into a CompactGraph first, which does all
+ * of the parsing and name lookup, and then creates the Node and Arc
+ * structures in the same way as the functions in AirlineGraph.cpp. Each
+ * name is looked up in the node map only once, not once per arc.
+ */
+
+LoadStats loadEdgeList(string filename, SimpleGraph & g, bool undirected) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    CompactGraph compact;
+    LoadStats stats = loadEdgeList(filename, compact);
+    Node **nodes = new Node *[compact.size()];
+    for (int id = 0; id < compact.size(); id++) {
+        string name(compact.getName(id));
+        Node *node = g.nodeMap.get(name);
+        if (node == NULL) {
+            node = new Node;
+            node->name = name;
+            g.nodes.add(node);
+            g.nodeMap[name] = node;
+        }
+        nodes[id] = node;
+    }
+    for (int id = 0; id < compact.size(); id++) {
+        for (int a = compact.getArcBegin(id); a < compact.getArcEnd(id); a++) {
+            Node *finish = nodes[compact.getFinish(a)];
+            for (int dir = 0; dir < (undirected ? 2 : 1); dir++) {
+                Arc *arc = new Arc;
+                arc->start = (dir == 0) ? nodes[id] : finish;
+                arc->finish = (dir == 0) ? finish : nodes[id];
+                arc->cost = compact.getCost(a);
+                g.arcs.add(arc);
+                arc->start->arcs.add(arc);
+            }
+        }
+    }
+    delete[] nodes;
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    stats.seconds = elapsed.count();
+    return stats;
+}
+
+/*
+ * Implementation notes: getThroughput
+ * -----------------------------------
+ * A megabyte here is 2^20 bytes.
+ */
+
+double getThroughput(const LoadStats & stats) {
+    if (stats.seconds <= 0) return 0;
+    return stats.bytes / (1024.0 * 1024.0) / stats.seconds;
+}
+
+/*
+ * Function: parseChunk
+ * Usage: parseChunk(chunk);
+ * -------------------------
+ * Parses every line in the chunk, interning the names and recording the
+ * arcs in local numbers. Parsing stops at the first malformed line, which
+ * is recorded in the badLine field.
+ */
+
+void parseChunk(ChunkParse *chunk) {
+    const char *cp = chunk->begin;
+    while (cp < chunk->end) {
+        const char *eol = static_cast<const char *>(
+                              memchr(cp, '\n', chunk->end - cp));
+        if (eol == NULL) eol = chunk->end;
+        string_view fields[3];
+        int nFields = splitLine(cp, eol, fields);
+        if (nFields != 0) {
+            double cost = 1;
+            if (nFields == 3) {
+                const char *last = fields[2].data() + fields[2].length();
+                from_chars_result result = from_chars(fields[2].data(), last,
+                                                      cost);
+                if (result.ptr != last || result.ec != errc()) nFields = -1;
+            }
+            if (nFields < 2) {
+                chunk->badLine = cp;
+                return;
+            }
+            chunk->starts.add(chunk->names.intern(fields[0]));
+            chunk->finishes.add(chunk->names.intern(fields[1]));
+            chunk->costs.add(cost);
+        }
+        cp = eol + 1;
+    }
+}
+
+/*
+ * Function: splitLine
+ * Usage: int nFields = splitLine(cp, eol, fields);
+ * ------------------------------------------------
+ * Divides the line between cp and eol into fields separated by commas
+ * or tabs, trimming spaces and carriage returns from each field. The
+ * function returns 0 for a blank line or a comment and -1 for a line
+ * with an empty field or more than three fields; otherwise, it returns
+ * the number of fields stored in the array.
+ */
+
+int splitLine(const char *cp, const char *eol, string_view fields[]) {
+    while (cp < eol && (*cp == ' ' || *cp == '\r')) cp++;
+    if (cp == eol || *cp == '#') return 0;
+    int nFields = 0;
+    while (true) {
+        const char *start = cp;
+        while (cp < eol && *cp != ',' && *cp != '\t') cp++;
+        const char *finish = cp;
+        while (start < finish && (*start == ' ' || *start == '\r')) start++;
+        while (finish > start && (finish[-1] == ' ' || finish[-1] == '\r')) {
+            finish--;
+        }
+        if (start == finish || nFields == 3) return -1;
+        fields[nFields++] = string_view(start, finish - start);
+        if (cp == eol) return nFields;
+        cp++;
+    }
+}
+
+/*
+ * Function: remapChunk
+ * Usage: remapChunk(chunk, starts, finishes, costs);
+ * --------------------------------------------------
+ * Copies the arcs of the chunk into its slice of the global arc arrays,
+ * translating local node numbers into global ones.
+ */
+
+void remapChunk(ChunkParse *chunk, int *starts, int *finishes,
+                double *costs) {
+    int base = chunk->firstArc;
+    for (int i = 0; i < chunk->starts.size(); i++) {
+        starts[base + i] = chunk->globalIds[chunk->starts[i]];
+        finishes[base + i] = chunk->globalIds[chunk->finishes[i]];
+        costs[base + i] = chunk->costs[i];
+    }
+}
+
+/*
+ * Function: findLineStart
+ * Usage: const char *lp = findLineStart(data, cp, end);
+ * -----------------------------------------------------
+ * Returns the start of the first line that begins at or after cp.
+ */
+
+const char *findLineStart(const char *data, const char *cp, const char *end) {
+    if (cp == data || cp[-1] == '\n') return cp;
+    const char *eol = static_cast<const char *>(memchr(cp, '\n', end - cp));
+    return (eol == NULL) ? end : eol + 1;
+}
+
+/*
+ * Function: countLines
+ * Usage: int line = countLines(data, cp);
+ * ---------------------------------------
+ * Returns the line number, counting from 1, of the line containing cp.
+ * This function is used only to report errors.
+ */
+
+int countLines(const char *data, const char *cp) {
+    int line = 1;
+    for (const char *p = data; p < cp; p++) {
+        if (*p == '\n') line++;
+    }
+    return line;
+}
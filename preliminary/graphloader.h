@@ -0,0 +1,66 @@
+/*
+ * File: graphloader.h
+ * -------------------
+ * This interface exports functions that read a graph from a text file
+ * containing one arc per line.
+ */
+
+#ifndef _graphloader_h
+#define _graphloader_h
+
+#include <string>
+#include "compactgraph.h"
+#include "graphtypes.h"
+
+/*
+ * Type: LoadStats
+ * ---------------
+ * This type reports how much data a loader read and how long it took.
+ */
+
+struct LoadStats {
+    long bytes;             // The size of the input file
+    double seconds;         // The elapsed time for the whole load
+    int nThreads;           // The number of parsing threads used
+};
+
+/*
+ * Function: loadEdgeList
+ * Usage: LoadStats stats = loadEdgeList(filename, g);
+ *        LoadStats stats = loadEdgeList(filename, g, nThreads);
+ *        loadEdgeList(filename, simple, undirected);
+ * ------------------------------------------------------------
+ * Reads an edge-list file into a graph. Each line of the file has the form
+ *
+ *      start,finish,cost
+ *
+ * where the fields may be separated either by commas or by tabs and the
+ * cost may be omitted, in which case it is 1. Spaces around a field are
+ * ignored, as are blank lines and lines beginning with #. Node names are
+ * numbered in the order in which they first appear in the file.
+ *
+ * The first two forms build a CompactGraph, splitting the file into
+ * chunks that are parsed in parallel. If nThreads is zero or omitted,
+ * the function uses one thread per processor. The third form loads the
+ * file in the same way and then adds its nodes and arcs to a SimpleGraph,
+ * reusing any nodes that already exist. If undirected is true, each line
+ * adds an arc in both directions, as addFlight does in AirlineGraph.cpp.
+ * All forms signal an error if a line does not have two or three fields
+ * or if its cost is not a number.
+ */
+
+LoadStats loadEdgeList(std::string filename, CompactGraph & g,
+                       int nThreads = 0);
+LoadStats loadEdgeList(std::string filename, SimpleGraph & g,
+                       bool undirected = false);
+
+/*
+ * Function: getThroughput
+ * Usage: double mbps = getThroughput(stats);
+ * ------------------------------------------
+ * Returns the load rate in megabytes per second.
+ */
+
+double getThroughput(const LoadStats & stats);
+
+#endif
@@ -0,0 +1,190 @@
+/*
+ * File: interner.cpp
+ * ------------------
+ * This file implements the interner.h interface using a packed string
+ * table and an open-addressing hash table.
+ */
+
+#include <cstring>
+#include <string_view>
+#include "interner.h"
+using namespace std;
+
+/*
+ * Implementation notes: constructor and destructor
+ * ------------------------------------------------
+ * The constructor allocates the initial arrays, and the destructor
+ * frees them.
+ */
+
+StringInterner::StringInterner() {
+    charCapacity = 8 * INITIAL_CAPACITY;
+    chars = new char[charCapacity];
+    nChars = 0;
+    nameCapacity = INITIAL_CAPACITY;
+    offsets = new int[nameCapacity + 1];
+    offsets[0] = 0;
+    nNames = 0;
+    tableSize = 2 * INITIAL_CAPACITY;
+    table = new Slot[tableSize];
+    for (int i = 0; i < tableSize; i++) {
+        table[i].id = -1;
+    }
+}
+
+StringInterner::~StringInterner() {
+    delete[] chars;
+    delete[] offsets;
+    delete[] table;
+}
+
+int StringInterner::size() const {
+    return nNames;
+}
+
+/*
+ * Implementation notes: intern
+ * ----------------------------
+ * The intern method looks for the string in the hash table and returns
+ * the existing identifier if it finds one. Otherwise, it appends the
+ * characters to the string table, growing the arrays by doubling when
+ * necessary, and records the new identifier in the empty slot. The hash
+ * table is rebuilt at twice the size whenever it becomes half full.
+ */
+
+int StringInterner::intern(string_view str) {
+    unsigned hash = hashCode(str);
+    int slot = findSlot(str, hash);
+    if (table[slot].id != -1) return table[slot].id;
+    if (nChars + int(str.length()) > charCapacity) {
+        while (nChars + int(str.length()) > charCapacity) {
+            charCapacity *= 2;
+        }
+        char *oldChars = chars;
+        chars = new char[charCapacity];
+        memcpy(chars, oldChars, nChars);
+        delete[] oldChars;
+    }
+    if (nNames == nameCapacity) {
+        int *oldOffsets = offsets;
+        nameCapacity *= 2;
+        offsets = new int[nameCapacity + 1];
+        memcpy(offsets, oldOffsets, (nNames + 1) * sizeof(int));
+        delete[] oldOffsets;
+    }
+    memcpy(chars + nChars, str.data(), str.length());
+    nChars += str.length();
+    int id = nNames++;
+    offsets[nNames] = nChars;
+    table[slot].id = id;
+    table[slot].hash = hash;
+    if (2 * nNames > tableSize) expandTable();
+    return id;
+}
+
+/*
+ * Implementation notes: find, getName
+ * -----------------------------------
+ * These methods read the tables without changing them.
+ */
+
+int StringInterner::find(string_view str) const {
+    return table[findSlot(str, hashCode(str))].id;
+}
+
+string_view StringInterner::getName(int id) const {
+    return string_view(chars + offsets[id], offsets[id + 1] - offsets[id]);
+}
+
+const char *StringInterner::getCharacters() const {
+    return chars;
+}
+
+const int *StringInterner::getOffsets() const {
+    return offsets;
+}
+
+/*
+ * Implementation notes: clear
+ * ---------------------------
+ * The clear method keeps the allocated arrays and simply marks them as
+ * empty so that the interner can be refilled without reallocation.
+ */
+
+void StringInterner::clear() {
+    nChars = 0;
+    nNames = 0;
+    for (int i = 0; i < tableSize; i++) {
+        table[i].id = -1;
+    }
+}
+
+/*
+ * Private method: findSlot
+ * Usage: int slot = findSlot(str, hash);
+ * --------------------------------------
+ * Returns the index of the slot that holds str or, if str is not in the
+ * table, the index of the empty slot where it belongs.
+ */
+
+int StringInterner::findSlot(string_view str, unsigned hash) const {
+    int mask = tableSize - 1;
+    int slot = hash & mask;
+    while (table[slot].id != -1
+           && (table[slot].hash != hash || getName(table[slot].id) != str)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/*
+ * Private method: expandTable
+ * ---------------------------
+ * This method doubles the size of the hash table and reinserts every
+ * occupied slot using the hash code stored in it. The string table
+ * itself does not move.
+ */
+
+void StringInterner::expandTable() {
+    Slot *oldTable = table;
+    int oldSize = tableSize;
+    tableSize *= 2;
+    table = new Slot[tableSize];
+    for (int i = 0; i < tableSize; i++) {
+        table[i].id = -1;
+    }
+    int mask = tableSize - 1;
+    for (int i = 0; i < oldSize; i++) {
+        if (oldTable[i].id != -1) {
+            int slot = oldTable[i].hash & mask;
+            while (table[slot].id != -1) {
+                slot = (slot + 1) & mask;
+            }
+            table[slot] = oldTable[i];
+        }
+    }
+    delete[] oldTable;
+}
+
+/*
+ * Private method: hashCode
+ * ------------------------
+ * This method computes the djb2 hash of the string, as in StringMap, and
+ * then scrambles the bits. Names such as "node17" and "node18" have djb2
+ * hashes that differ only slightly, and without the final mixing step
+ * they land in adjacent slots and form the long runs that make linear
+ * probing slow.
+ */
+
+unsigned StringInterner::hashCode(string_view str) {
+    unsigned hash = 5381;
+    for (char ch : str) {
+        hash = 33 * hash + (unsigned char) ch;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+    return hash;
+}
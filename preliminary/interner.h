@@ -0,0 +1,161 @@
+/*
+ * File: interner.h
+ * ----------------
+ * This interface exports the StringInterner class, which assigns a dense
+ * integer identifier to each distinct string it is given.
+ */
+
+#ifndef _interner_h
+#define _interner_h
+
+#include <string_view>
+
+/*
+ * Class: StringInterner
+ * ---------------------
+ * This class maps strings to the integers 0, 1, 2, and so on, in the order
+ * in which the strings are first seen. Each string is stored exactly once,
+ * and the integer can be used in place of the string as an array index.
+ * The interner is typically used to give graph nodes dense identifiers:
+ *
+ *      StringInterner names;
+ *      int id = names.intern("Boston");
+ *      . . . later . . .
+ *      std::string_view name = names.getName(id);
+ */
+
+class StringInterner {
+
+public:
+
+/*
+ * Constructor: StringInterner
+ * Usage: StringInterner names;
+ * ----------------------------
+ * Initializes a new interner containing no strings.
+ */
+
+    StringInterner();
+
+/*
+ * Destructor: ~StringInterner
+ * ---------------------------
+ * Frees any heap storage associated with this interner.
+ */
+
+    ~StringInterner();
+
+/*
+ * Method: size
+ * Usage: int n = names.size();
+ * ----------------------------
+ * Returns the number of distinct strings in the interner, which is also
+ * one more than the largest identifier handed out so far.
+ */
+
+    int size() const;
+
+/*
+ * Method: intern
+ * Usage: int id = names.intern(str);
+ * ----------------------------------
+ * Returns the identifier for str, adding the string to the interner if
+ * it has not been seen before.
+ */
+
+    int intern(std::string_view str);
+
+/*
+ * Method: find
+ * Usage: int id = names.find(str);
+ * --------------------------------
+ * Returns the identifier for str, or -1 if the string has never been
+ * interned. Unlike intern, this method never changes the interner.
+ */
+
+    int find(std::string_view str) const;
+
+/*
+ * Method: getName
+ * Usage: std::string_view name = names.getName(id);
+ * -------------------------------------------------
+ * Returns the string with the specified identifier. The characters are
+ * owned by the interner and may move the next time a string is added.
+ */
+
+    std::string_view getName(int id) const;
+
+/*
+ * Method: getCharacters, getOffsets
+ * Usage: const char *chars = names.getCharacters();
+ *        const int *offsets = names.getOffsets();
+ * ------------------------------------------------
+ * Return the internal string table, in which the string with identifier
+ * id occupies the characters from offsets[id] up to offsets[id + 1].
+ * These methods let clients copy every name without a loop of lookups.
+ */
+
+    const char *getCharacters() const;
+    const int *getOffsets() const;
+
+/*
+ * Method: clear
+ * Usage: names.clear();
+ * ---------------------
+ * Removes every string from the interner.
+ */
+
+    void clear();
+
+/*
+ * Notes on representation
+ * -----------------------
+ * The strings are packed end to end in a single character array, and a
+ * parallel array of offsets marks where each one begins. Lookups use an
+ * open-addressing hash table of identifiers, with linear probing and a
+ * power-of-two table size, which is kept no more than half full. Each
+ * slot records the full hash code next to the identifier, so that most
+ * mismatches are rejected without touching the string table and the
+ * table can be expanded without rehashing any strings. The hash function
+ * is the djb2 function used by StringMap, followed by a step that mixes
+ * the bits.
+ */
+
+private:
+
+/* Constant definitions */
+
+    static const int INITIAL_CAPACITY = 64;
+
+/* Type for slots in the hash table */
+
+    struct Slot {
+        int id;                 // The identifier, or -1 if empty
+        unsigned hash;          // The hash code of the string
+    };
+
+/* Instance variables */
+
+    char *chars;            // The characters of every string, end to end
+    int nChars;             // The number of characters in use
+    int charCapacity;       // The allocated size of chars
+    int *offsets;           // The start of each string in chars
+    int nNames;             // The number of strings
+    int nameCapacity;       // The allocated size of offsets, less one
+    Slot *table;            // Hash table of identifiers
+    int tableSize;          // The number of slots in table
+
+/* Private methods */
+
+    static unsigned hashCode(std::string_view str);
+    int findSlot(std::string_view str, unsigned hash) const;
+    void expandTable();
+
+/* Make it illegal to copy interners */
+
+    StringInterner(const StringInterner & src) { }
+    StringInterner & operator=(const StringInterner & src) { return *this; }
+
+};
+
+#endif
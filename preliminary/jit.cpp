@@ -0,0 +1,418 @@
+/*
+ * File: jit.cpp
+ * -------------
+ * This file implements the jit.h interface.
+ */
+
+#include <cstring>
+#include <string>
+#include "error.h"
+#include "exp.h"
+#include "jit.h"
+#include "parser.h"
+#include "tokenscanner.h"
+using namespace std;
+
+#if defined(__x86_64__) && defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define NATIVE_CODE_AVAILABLE
+#endif
+
+/* Constants */
+
+const int INITIAL_CODE_CAPACITY = 64;
+
+/* Private function prototypes */
+
+static bool assignsTo(Expression *exp, const string & name);
+
+/*
+ * Implementation notes: constructor and destructor
+ * ------------------------------------------------
+ * The bytecode is compiled first, both because it checks the expression
+ * and because it numbers the slots that the machine code uses.
+ */
+
+NativeProgram::NativeProgram(Expression *exp, bool useNative)
+        : bytecode(exp) {
+    function = NULL;
+    pages = NULL;
+    pageBytes = 0;
+    code = NULL;
+    codeLength = 0;
+    codeCapacity = 0;
+    nSlots = getSlotCount();
+    slotInfo = new SlotInfo[(nSlots == 0) ? 1 : nSlots];
+    for (int i = 0; i < nSlots; i++) {
+        string_view name = getSlotName(i);
+        slotInfo[i].name = name;
+        slotInfo[i].nameNumber = EvaluationContext::getNameNumber(name);
+        slotInfo[i].input = isInput(i);
+        slotInfo[i].assigned = isAssigned(i);
+    }
+    if (useNative && compileNative(exp)) {
+        function = reinterpret_cast<NativeFunction>(pages);
+    }
+    delete[] code;
+    code = NULL;
+}
+
+NativeProgram::~NativeProgram() {
+#ifdef NATIVE_CODE_AVAILABLE
+    if (pages != NULL) munmap(pages, pageBytes);
+#endif
+    delete[] code;
+    delete[] slotInfo;
+}
+
+bool NativeProgram::isNative() const {
+    return function != NULL;
+}
+
+int NativeProgram::getSlotCount() const {
+    return bytecode.getSlotCount();
+}
+
+int NativeProgram::getSlot(string_view name) const {
+    return bytecode.getSlot(name);
+}
+
+string_view NativeProgram::getSlotName(int slot) const {
+    return bytecode.getSlotName(slot);
+}
+
+bool NativeProgram::isInput(int slot) const {
+    return bytecode.isInput(slot);
+}
+
+bool NativeProgram::isAssigned(int slot) const {
+    return bytecode.isAssigned(slot);
+}
+
+/*
+ * Implementation notes: execute
+ * -----------------------------
+ * The machine code cannot signal an error itself, since an exception
+ * cannot unwind through a frame the compiler knows nothing about, so it
+ * reports division by zero through a flag that execute then checks.
+ */
+
+int NativeProgram::execute(int *slots) const {
+    if (function == NULL) return bytecode.execute(slots);
+    int divideByZero = 0;
+    int value = function(slots, &divideByZero);
+    if (divideByZero) error("Division by 0");
+    return value;
+}
+
+/*
+ * Implementation notes: eval
+ * --------------------------
+ * This method follows BytecodeProgram::eval, except that it runs the
+ * program through execute so that it uses the machine code. It finds the
+ * slots in the context by name number, and it copies in only the input
+ * variables, since the program writes every other slot before reading
+ * it. The slot array lives on the stack unless the program has more
+ * slots than that allows, which happens only for unusually long formulas.
+ */
+
+int NativeProgram::eval(EvaluationContext & context) const {
+    int buffer[MAX_STACK_SLOTS];
+    int *slots = (nSlots <= MAX_STACK_SLOTS) ? buffer : new int[nSlots];
+    int value;
+    try {
+        for (int i = 0; i < nSlots; i++) {
+            const SlotInfo & info = slotInfo[i];
+            if (!info.input) continue;
+            if (!context.readValue(info.nameNumber, info.name, slots[i])) {
+                error(string(info.name) + " is undefined");
+            }
+        }
+        value = execute(slots);
+    } catch (...) {
+        if (slots != buffer) delete[] slots;
+        throw;
+    }
+    for (int i = 0; i < nSlots; i++) {
+        const SlotInfo & info = slotInfo[i];
+        if (info.assigned) {
+            int slot = context.getSlot(info.nameNumber, info.name);
+            context.setValue(slot, slots[i]);
+        }
+    }
+    if (slots != buffer) delete[] slots;
+    return value;
+}
+
+/*
+ * Private method: compileNative
+ * Usage: if (compileNative(exp)) . . .
+ * ------------------------------------
+ * Assembles the machine code for exp and copies it into executable
+ * memory, returning false if native code is not available. Under the
+ * System V calling convention, the slot array arrives in rdi and the
+ * address of the division flag in rsi, and the result is returned in
+ * eax. The code saves the stack pointer in r8 on entry, so that the
+ * division check can return directly however many operands are pushed.
+ * The pages are writable while the code is copied into them and are
+ * then made executable, so they are never both at once.
+ */
+
+bool NativeProgram::compileNative(Expression *exp) {
+#ifdef NATIVE_CODE_AVAILABLE
+    emit(0x49); emit(0x89); emit(0xE0);         // mov r8, rsp
+    compileTree(exp);
+    emit(0xC3);                                 // ret
+    long pageSize = sysconf(_SC_PAGESIZE);
+    pageBytes = (codeLength + pageSize - 1) / pageSize * pageSize;
+    void *mem = mmap(NULL, pageBytes, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) return false;
+    memcpy(mem, code, codeLength);
+    if (mprotect(mem, pageBytes, PROT_READ | PROT_EXEC) != 0) {
+        munmap(mem, pageBytes);
+        return false;
+    }
+    pages = mem;
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*
+ * Private method: compileTree
+ * Usage: compileTree(exp);
+ * ------------------------
+ * Appends code that leaves the value of exp in eax. The general case of
+ * an operator evaluates the right operand, pushes it, evaluates the left
+ * operand and pops the right one into ecx, following the order used by
+ * CompoundExp::eval. Most operators in real formulas have a constant or
+ * a variable on the right, which compileWithOperand handles without
+ * using the stack.
+ */
+
+void NativeProgram::compileTree(Expression *exp) {
+    switch (exp->getType()) {
+        case CONSTANT:
+            emit(0xB8);                         // mov eax, imm32
+            emitInt(exp->getConstantValue());
+            return;
+        case IDENTIFIER:
+            emit(0x8B); emit(0x87);             // mov eax, [rdi + disp32]
+            emitInt(slotOffset(exp));
+            return;
+        case COMPOUND:
+            break;
+    }
+    OperatorType op = exp->getOperatorType();
+    if (op == ASSIGN) {
+        compileTree(exp->getRHS());
+        emit(0x89); emit(0x87);                 // mov [rdi + disp32], eax
+        emitInt(slotOffset(exp->getLHS()));
+        return;
+    }
+    if (compileWithOperand(exp)) return;
+    compileTree(exp->getRHS());
+    emit(0x50);                                 // push rax
+    compileTree(exp->getLHS());
+    emit(0x59);                                 // pop rcx
+    compileOperator(op);
+}
+
+/*
+ * Private method: compileOperator
+ * Usage: compileOperator(op);
+ * ---------------------------
+ * Appends code that computes eax op ecx into eax. Before dividing, the
+ * code tests the divisor and, if it is 0, restores the stack pointer,
+ * sets the flag and returns. A divisor of -1 negates eax instead, since
+ * idiv traps on the most negative int divided by -1, and negation wraps
+ * it around to itself, as the bytecode does.
+ */
+
+void NativeProgram::compileOperator(OperatorType op) {
+    switch (op) {
+        case ADD:
+            emit(0x01); emit(0xC8);             // add eax, ecx
+            break;
+        case SUBTRACT:
+            emit(0x29); emit(0xC8);             // sub eax, ecx
+            break;
+        case MULTIPLY:
+            emit(0x0F); emit(0xAF); emit(0xC1); // imul eax, ecx
+            break;
+        case DIVIDE:
+            emit(0x85); emit(0xC9);             // test ecx, ecx
+            emit(0x75); emit(0x0A);             // jnz past the next three
+            emit(0x4C); emit(0x89); emit(0xC4); // mov rsp, r8
+            emit(0xC7); emit(0x06); emitInt(1); // mov dword [rsi], 1
+            emit(0xC3);                         // ret
+            emit(0x83); emit(0xF9); emit(0xFF); // cmp ecx, -1
+            emit(0x75); emit(0x04);             // jne past the next two
+            emit(0xF7); emit(0xD8);             // neg eax
+            emit(0xEB); emit(0x03);             // jmp past the division
+            emit(0x99);                         // cdq
+            emit(0xF7); emit(0xF9);             // idiv ecx
+            break;
+        default:
+            error("Illegal operator in expression");
+    }
+}
+
+/*
+ * Private method: compileWithOperand
+ * Usage: if (compileWithOperand(exp)) . . .
+ * -----------------------------------------
+ * Appends code for an operator whose right operand is a constant or a
+ * variable, using that operand directly in the instruction, and returns
+ * true; returns false if the method does not apply. The left operand is
+ * computed first, which is safe unless it assigns the variable on the
+ * right, since reading a constant or a variable has no other effect.
+ */
+
+bool NativeProgram::compileWithOperand(Expression *exp) {
+    OperatorType op = exp->getOperatorType();
+    Expression *rhs = exp->getRHS();
+    if (rhs->getType() == CONSTANT) {
+        compileTree(exp->getLHS());
+        switch (op) {
+            case ADD: emit(0x05); break;        // add eax, imm32
+            case SUBTRACT: emit(0x2D); break;   // sub eax, imm32
+            case MULTIPLY:
+                emit(0x69); emit(0xC0);         // imul eax, eax, imm32
+                break;
+            default:
+                emit(0xB9);                     // mov ecx, imm32
+                emitInt(rhs->getConstantValue());
+                compileOperator(op);
+                return true;
+        }
+        emitInt(rhs->getConstantValue());
+        return true;
+    }
+    if (rhs->getType() != IDENTIFIER) return false;
+    if (assignsTo(exp->getLHS(), rhs->getIdentifierName())) return false;
+    compileTree(exp->getLHS());
+    switch (op) {
+        case ADD: emit(0x03); emit(0x87); break;    // add eax, [rdi + d]
+        case SUBTRACT: emit(0x2B); emit(0x87); break;   // sub eax, [rdi + d]
+        case MULTIPLY:
+            emit(0x0F); emit(0xAF); emit(0x87);     // imul eax, [rdi + d]
+            break;
+        default:
+            emit(0x8B); emit(0x8F);                 // mov ecx, [rdi + d]
+            emitInt(slotOffset(rhs));
+            compileOperator(op);
+            return true;
+    }
+    emitInt(slotOffset(rhs));
+    return true;
+}
+
+/*
+ * Private method: slotOffset
+ * Usage: int offset = slotOffset(exp);
+ * ------------------------------------
+ * Returns the byte offset of the variable exp in the slot array.
+ */
+
+int NativeProgram::slotOffset(Expression *exp) const {
+    return bytecode.getSlot(exp->getIdentifierName()) * sizeof(int);
+}
+
+/*
+ * Private methods: emit, emitInt
+ * Usage: emit(byte);
+ *        emitInt(word);
+ * ---------------------
+ * Append a byte or a little-endian 32-bit integer to the code being
+ * assembled, doubling the array when it is full.
+ */
+
+void NativeProgram::emit(int byte) {
+    if (codeLength == codeCapacity) {
+        codeCapacity = (codeCapacity == 0) ? INITIAL_CODE_CAPACITY
+                                           : 2 * codeCapacity;
+        unsigned char *array = new unsigned char[codeCapacity];
+        for (int i = 0; i < codeLength; i++) {
+            array[i] = code[i];
+        }
+        delete[] code;
+        code = array;
+    }
+    code[codeLength++] = (unsigned char) byte;
+}
+
+void NativeProgram::emitInt(int word) {
+    unsigned int bits = word;
+    for (int i = 0; i < 4; i++) {
+        emit(bits & 0xFF);
+        bits >>= 8;
+    }
+}
+
+/*
+ * Implementation notes: JitCache
+ * ------------------------------
+ * A formula is parsed with the same scanner options as the interpreter.
+ * The tree is needed only while the program is compiled.
+ */
+
+JitCache::JitCache(bool useNative) {
+    this->useNative = useNative;
+}
+
+JitCache::~JitCache() {
+    clear();
+}
+
+NativeProgram *JitCache::get(const string & text) {
+    int id = texts.find(text);
+    if (id >= 0) return programs[id];
+    TokenScanner scanner;
+    scanner.ignoreWhitespace();
+    scanner.scanNumbers();
+    scanner.setInput(text);
+    Expression *exp = parseExp(scanner);
+    NativeProgram *program;
+    try {
+        program = new NativeProgram(exp, useNative);
+    } catch (...) {
+        delete exp;
+        throw;
+    }
+    delete exp;
+    texts.intern(text);
+    programs.add(program);
+    return program;
+}
+
+int JitCache::size() const {
+    return programs.size();
+}
+
+void JitCache::clear() {
+    for (int i = 0; i < programs.size(); i++) {
+        delete programs[i];
+    }
+    programs.clear();
+    texts.clear();
+}
+
+/*
+ * Private function: assignsTo
+ * Usage: if (assignsTo(exp, name)) . . .
+ * --------------------------------------
+ * Returns true if exp contains an assignment to the named variable.
+ */
+
+static bool assignsTo(Expression *exp, const string & name) {
+    if (exp->getType() != COMPOUND) return false;
+    if (exp->getOperatorType() == ASSIGN
+            && exp->getLHS()->getIdentifierName() == name) {
+        return true;
+    }
+    return assignsTo(exp->getLHS(), name) || assignsTo(exp->getRHS(), name);
+}
@@ -0,0 +1,260 @@
+/*
+ * File: jit.h
+ * -----------
+ * This interface exports the NativeProgram class, which translates an
+ * expression into machine code, and the JitCache class, which keeps the
+ * translations of the formulas a program evaluates most often.
+ */
+
+#ifndef _jit_h
+#define _jit_h
+
+#include <string>
+#include <string_view>
+#include "bytecode.h"
+#include "exp.h"
+#include "interner.h"
+#include "vector.h"
+
+/*
+ * Class: NativeProgram
+ * --------------------
+ * This class holds an expression compiled to x86-64 machine code. Its
+ * interface matches that of BytecodeProgram: variables are resolved to
+ * slots when the program is compiled, and execute runs the program with
+ * the variables in an array of slots. The native code performs the same
+ * operations as CompoundExp::eval, in the same order, but keeps the
+ * intermediate values in processor registers and needs no dispatch at all.
+ *
+ * Native code is generated only on x86-64 Linux, where the program can
+ * allocate executable memory. On any other system, or if the client asks
+ * for it, the program falls back to running the bytecode, which gives the
+ * same results more slowly. The isNative method tells which is in use.
+ */
+
+class NativeProgram {
+
+public:
+
+/*
+ * Constructor: NativeProgram
+ * Usage: NativeProgram program(exp);
+ *        NativeProgram program(exp, useNative);
+ * ---------------------------------------------
+ * Compiles the expression exp. If useNative is false, the program always
+ * uses the bytecode fallback. The program does not keep any pointer to
+ * the expression tree. This constructor signals an error if the left
+ * side of an assignment is not an identifier.
+ */
+
+    NativeProgram(Expression *exp, bool useNative = true);
+
+/*
+ * Destructor: ~NativeProgram
+ * --------------------------
+ * Frees the machine code and any other storage used by this program.
+ */
+
+    ~NativeProgram();
+
+/*
+ * Method: isNative
+ * Usage: if (program.isNative()) . . .
+ * ------------------------------------
+ * Returns true if the program runs as machine code and false if it runs
+ * as bytecode.
+ */
+
+    bool isNative() const;
+
+/*
+ * Methods: getSlotCount, getSlot, getSlotName, isInput, isAssigned
+ * ----------------------------------------------------------------
+ * These methods describe the variable slots exactly as the methods of
+ * the same names in BytecodeProgram do.
+ */
+
+    int getSlotCount() const;
+    int getSlot(std::string_view name) const;
+    std::string_view getSlotName(int slot) const;
+    bool isInput(int slot) const;
+    bool isAssigned(int slot) const;
+
+/*
+ * Method: execute
+ * Usage: int value = program.execute(slots);
+ * ------------------------------------------
+ * Runs the program with the variables in the array slots, which must
+ * have getSlotCount() elements, and returns the value of the expression.
+ * Assignments update the array. This method signals an error on
+ * division by zero. Any number of threads may run the same program,
+ * each with its own slots.
+ */
+
+    int execute(int *slots) const;
+
+/*
+ * Method: eval
+ * Usage: int value = program.eval(context);
+ * -----------------------------------------
+ * Evaluates the program in the specified context, copying variables in
+ * and out of the context as BytecodeProgram::eval does. The program
+ * finds each variable in the context by the number of its name, so this
+ * method looks up no names once the context has seen them, and it needs
+ * no heap storage unless the program has more than MAX_STACK_SLOTS
+ * variables.
+ */
+
+    int eval(EvaluationContext & context) const;
+
+/*
+ * Notes on representation
+ * -----------------------
+ * The program always holds the bytecode translation, which assigns the
+ * slots and serves as the fallback. The machine code, if any, occupies
+ * its own pages, which are made executable and read-only once the code is
+ * written, and is called as a function of two arguments: the slot array
+ * and a flag that the code sets instead of returning if a divisor is 0.
+ * For eval, the program also keeps a SlotInfo record for each slot, with
+ * the name and name number that it passes to the context and copies of
+ * the flags that the bytecode records, so that eval makes no calls to
+ * the bytecode at all.
+ */
+
+private:
+
+/* Constants */
+
+    static const int MAX_STACK_SLOTS = 16;
+
+/* Type definitions */
+
+    typedef int (*NativeFunction)(int *slots, int *divideByZero);
+
+    struct SlotInfo {
+        std::string_view name;      // The name of the variable
+        int nameNumber;             // The number of the name in a context
+        bool input;                 // Whether the program reads it first
+        bool assigned;              // Whether the program assigns it
+    };
+
+/* Instance variables */
+
+    BytecodeProgram bytecode;       // The translation to bytecode
+    NativeFunction function;        // The entry point, or NULL
+    void *pages;                    // The executable memory, or NULL
+    long pageBytes;                 // The size of the executable memory
+    unsigned char *code;            // The code being assembled
+    int codeLength;                 // The number of bytes in code
+    int codeCapacity;               // The allocated size of code
+    SlotInfo *slotInfo;             // The description of each slot
+    int nSlots;                     // The number of slots
+
+/* Private methods */
+
+    bool compileNative(Expression *exp);
+    void compileTree(Expression *exp);
+    void compileOperator(OperatorType op);
+    bool compileWithOperand(Expression *exp);
+    int slotOffset(Expression *exp) const;
+    void emit(int byte);
+    void emitInt(int word);
+
+/* Make it illegal to copy programs */
+
+    NativeProgram(const NativeProgram & src) { }
+    NativeProgram & operator=(const NativeProgram & src) {
+        return *this;
+    }
+
+};
+
+/*
+ * Class: JitCache
+ * ---------------
+ * This class keeps the compiled programs for the formulas a client has
+ * evaluated, indexed by the text of each formula, so that a formula that
+ * is evaluated again is neither parsed nor compiled a second time. The
+ * text must match exactly, including its spacing. The cache is not safe
+ * for use by several threads at once, although the programs it returns
+ * are.
+ */
+
+class JitCache {
+
+public:
+
+/*
+ * Constructor: JitCache
+ * Usage: JitCache cache;
+ *        JitCache cache(useNative);
+ * ---------------------------------
+ * Initializes an empty cache. The useNative flag is passed to every
+ * NativeProgram the cache creates.
+ */
+
+    JitCache(bool useNative = true);
+
+/*
+ * Destructor: ~JitCache
+ * ---------------------
+ * Deletes every program in the cache.
+ */
+
+    ~JitCache();
+
+/*
+ * Method: get
+ * Usage: NativeProgram *program = cache.get(text);
+ * ------------------------------------------------
+ * Returns the compiled program for the formula in text, parsing and
+ * compiling it the first time the text appears. The program belongs to
+ * the cache. This method signals an error if the text is not a legal
+ * expression, in which case nothing is added to the cache.
+ */
+
+    NativeProgram *get(const std::string & text);
+
+/*
+ * Method: size
+ * Usage: int n = cache.size();
+ * ----------------------------
+ * Returns the number of programs in the cache.
+ */
+
+    int size() const;
+
+/*
+ * Method: clear
+ * Usage: cache.clear();
+ * ---------------------
+ * Deletes every program in the cache.
+ */
+
+    void clear();
+
+/*
+ * Notes on representation
+ * -----------------------
+ * The text of each formula is interned, and the interner's number for
+ * the text indexes the vector of programs.
+ */
+
+private:
+
+/* Instance variables */
+
+    StringInterner texts;               // The text of each formula
+    Vector<NativeProgram *> programs;   // The program for each text
+    bool useNative;                     // Whether to generate machine code
+
+/* Make it illegal to copy caches */
+
+    JitCache(const JitCache & src) { }
+    JitCache & operator=(const JitCache & src) {
+        return *this;
+    }
+
+};
+
+#endif
@@ -0,0 +1,83 @@
+/*
+ * File: mappedfile.cpp
+ * --------------------
+ * This file implements the mappedfile.h interface on top of the POSIX
+ * open, fstat and mmap calls.
+ */
+
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "error.h"
+#include "mappedfile.h"
+using namespace std;
+
+MappedFile::MappedFile() {
+    data = NULL;
+    length = 0;
+}
+
+MappedFile::MappedFile(string filename, AccessPattern pattern) {
+    data = NULL;
+    length = 0;
+    open(filename, pattern);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+/*
+ * Implementation notes: open
+ * --------------------------
+ * The file descriptor is needed only long enough to create the mapping
+ * and can be closed immediately afterwards. The access pattern becomes
+ * an madvise hint: MADV_SEQUENTIAL makes the kernel read ahead
+ * aggressively, which suits the loaders that scan the file from start to
+ * finish, while MADV_RANDOM turns read-ahead off, so that a client that
+ * touches scattered pages does not pay for reading their neighbors.
+ * Empty files cannot be mapped and are simply left with a NULL data
+ * pointer.
+ */
+
+void MappedFile::open(string filename, AccessPattern pattern) {
+    close();
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) error("MappedFile: Can't open " + filename);
+    struct stat info;
+    if (fstat(fd, &info) < 0) {
+        ::close(fd);
+        error("MappedFile: Can't read the size of " + filename);
+    }
+    if (info.st_size > 0) {
+        void *addr = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            error("MappedFile: Can't map " + filename);
+        }
+        if (pattern == SEQUENTIAL) {
+            madvise(addr, info.st_size, MADV_SEQUENTIAL);
+        } else if (pattern == RANDOM) {
+            madvise(addr, info.st_size, MADV_RANDOM);
+        }
+        data = static_cast<const char *>(addr);
+        length = info.st_size;
+    }
+    ::close(fd);
+}
+
+void MappedFile::close() {
+    if (data != NULL) munmap(const_cast<char *>(data), length);
+    data = NULL;
+    length = 0;
+}
+
+const char *MappedFile::getData() const {
+    return data;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
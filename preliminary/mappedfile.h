@@ -0,0 +1,115 @@
+/*
+ * File: mappedfile.h
+ * ------------------
+ * This interface exports the MappedFile class, which makes the contents
+ * of a file available as a read-only array of characters in memory.
+ */
+
+#ifndef _mappedfile_h
+#define _mappedfile_h
+
+#include <cstddef>
+#include <string>
+
+/*
+ * Class: MappedFile
+ * -----------------
+ * This class maps a file into the address space of the program using
+ * the POSIX mmap call. The operating system reads pages of the file on
+ * demand, so opening even a very large file is fast, and no copy of the
+ * data is made in the heap.
+ */
+
+class MappedFile {
+
+public:
+
+/*
+ * Type: AccessPattern
+ * -------------------
+ * This type describes the order in which the client expects to read the
+ * file, which the kernel uses to decide how far to read ahead. The
+ * SEQUENTIAL pattern suits a client that scans the file from start to
+ * finish, RANDOM suits one that jumps around in it, and NORMAL gives no
+ * hint at all.
+ */
+
+    enum AccessPattern { SEQUENTIAL, RANDOM, NORMAL };
+
+/*
+ * Constructor: MappedFile
+ * Usage: MappedFile file;
+ *        MappedFile file(filename);
+ *        MappedFile file(filename, pattern);
+ * ------------------------------------------
+ * Creates a MappedFile object. The second and third forms also call
+ * open.
+ */
+
+    MappedFile();
+    MappedFile(std::string filename, AccessPattern pattern = SEQUENTIAL);
+
+/*
+ * Destructor: ~MappedFile
+ * -----------------------
+ * Unmaps the file if it is still open.
+ */
+
+    ~MappedFile();
+
+/*
+ * Method: open
+ * Usage: file.open(filename);
+ *        file.open(filename, pattern);
+ * ------------------------------------
+ * Maps the named file into memory, closing any file that was open
+ * before, and passes the access pattern on to the kernel. Without a
+ * pattern, the file is assumed to be read sequentially. This method
+ * signals an error if the file cannot be mapped.
+ */
+
+    void open(std::string filename, AccessPattern pattern = SEQUENTIAL);
+
+/*
+ * Method: close
+ * Usage: file.close();
+ * --------------------
+ * Unmaps the file. Pointers returned by getData become invalid.
+ */
+
+    void close();
+
+/*
+ * Method: getData
+ * Usage: const char *data = file.getData();
+ * -----------------------------------------
+ * Returns a pointer to the first character of the file. An empty file
+ * is represented by a NULL pointer and a size of zero.
+ */
+
+    const char *getData() const;
+
+/*
+ * Method: size
+ * Usage: size_t n = file.size();
+ * ------------------------------
+ * Returns the number of bytes in the file.
+ */
+
+    size_t size() const;
+
+private:
+
+/* Instance variables */
+
+    const char *data;       // The address of the mapping
+    size_t length;          // The length of the mapping in bytes
+
+/* Make it illegal to copy mapped files */
+
+    MappedFile(const MappedFile & src) { }
+    MappedFile & operator=(const MappedFile & src) { return *this; }
+
+};
+
+#endif
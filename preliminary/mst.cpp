@@ -0,0 +1,600 @@
+/*
+ * File: mst.cpp
+ * -------------
+ * This file implements the mst.h interface.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "compactgraph.h"
+#include "error.h"
+#include "graphtypes.h"
+#include "mst.h"
+#include "vector.h"
+using namespace std;
+
+/* Constants */
+
+const int MIN_EDGES_PER_THREAD = 1 << 15;  // Smallest slice worth a thread
+
+/*
+ * Class: UnionFind
+ * ----------------
+ * This class keeps track of a partition of the numbers 0 to n-1 into
+ * disjoint sets. It uses union by size, which keeps the trees shallow,
+ * and path halving, which flattens them further on every find.
+ */
+
+class UnionFind {
+
+public:
+
+    UnionFind(int n) {
+        parent = new int[n];
+        size = new int[n];
+        for (int i = 0; i < n; i++) {
+            parent[i] = i;
+            size[i] = 1;
+        }
+    }
+
+    ~UnionFind() {
+        delete[] parent;
+        delete[] size;
+    }
+
+/*
+ * Method: find
+ * Usage: int root = uf.find(x);
+ * -----------------------------
+ * Returns the representative of the set containing x.
+ */
+
+    int find(int x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+/*
+ * Method: unite
+ * Usage: if (uf.unite(x, y)) . . .
+ * --------------------------------
+ * Merges the sets containing x and y. The result is false if they were
+ * already the same set.
+ */
+
+    bool unite(int x, int y) {
+        x = find(x);
+        y = find(y);
+        if (x == y) return false;
+        if (size[x] < size[y]) swap(x, y);
+        parent[y] = x;
+        size[x] += size[y];
+        return true;
+    }
+
+private:
+
+    int *parent;        // The parent of each element, or itself for a root
+    int *size;          // The number of elements below each root
+
+/* Make it illegal to copy union-find structures */
+
+    UnionFind(const UnionFind & src) { }
+    UnionFind & operator=(const UnionFind & src) { return *this; }
+
+};
+
+/*
+ * Class: IndexedHeap
+ * ------------------
+ * This class is a binary min-heap of node numbers in which each node has
+ * a key and a recorded position, so that the key of a node already on the
+ * heap can be lowered in logarithmic time. The key of a node is the index
+ * of the cheapest edge known to reach it, and nodes are compared using
+ * the edge order shared by all the MST functions.
+ */
+
+class IndexedHeap {
+
+public:
+
+    IndexedHeap(int n, const WeightedEdge *edges) {
+        this->edges = edges;
+        heap = new int[n];
+        position = new int[n];
+        key = new int[n];
+        count = 0;
+        for (int i = 0; i < n; i++) {
+            position[i] = -1;
+        }
+    }
+
+    ~IndexedHeap() {
+        delete[] heap;
+        delete[] position;
+        delete[] key;
+    }
+
+    bool isEmpty() const {
+        return count == 0;
+    }
+
+    int getKey(int v) const {
+        return key[v];
+    }
+
+/*
+ * Method: pushOrLower
+ * Usage: heap.pushOrLower(v, e);
+ * ------------------------------
+ * Adds v to the heap with the key e or, if v is already on the heap with
+ * a worse key, lowers its key to e.
+ */
+
+    void pushOrLower(int v, int e) {
+        if (position[v] < 0) {
+            position[v] = count;
+            heap[count++] = v;
+        } else if (!isBetter(e, key[v])) {
+            return;
+        }
+        key[v] = e;
+        siftUp(position[v]);
+    }
+
+/*
+ * Method: pop
+ * Usage: int v = heap.pop();
+ * --------------------------
+ * Removes and returns the node with the smallest key.
+ */
+
+    int pop() {
+        int v = heap[0];
+        position[v] = -1;
+        count--;
+        if (count > 0) {
+            heap[0] = heap[count];
+            position[heap[0]] = 0;
+            siftDown(0);
+        }
+        return v;
+    }
+
+/*
+ * Method: isBetter
+ * Usage: if (IndexedHeap::isBetter(e1, e2, edges)) . . .
+ * ------------------------------------------------------
+ * Returns true if edge e1 comes before edge e2, comparing costs first
+ * and indices second.
+ */
+
+    static bool isBetter(int e1, int e2, const WeightedEdge *edges) {
+        if (edges[e1].cost != edges[e2].cost) {
+            return edges[e1].cost < edges[e2].cost;
+        }
+        return e1 < e2;
+    }
+
+private:
+
+    const WeightedEdge *edges;  // The edges to which the keys refer
+    int *heap;                  // The nodes in heap order
+    int *position;              // The heap index of each node, or -1
+    int *key;                   // The key of each node
+    int count;                  // The number of nodes on the heap
+
+    bool isBetter(int e1, int e2) const {
+        return isBetter(e1, e2, edges);
+    }
+
+    void siftUp(int i) {
+        int v = heap[i];
+        while (i > 0) {
+            int p = (i - 1) / 2;
+            if (!isBetter(key[v], key[heap[p]])) break;
+            heap[i] = heap[p];
+            position[heap[i]] = i;
+            i = p;
+        }
+        heap[i] = v;
+        position[v] = i;
+    }
+
+    void siftDown(int i) {
+        int v = heap[i];
+        while (true) {
+            int child = 2 * i + 1;
+            if (child >= count) break;
+            if (child + 1 < count
+                    && isBetter(key[heap[child + 1]], key[heap[child]])) {
+                child++;
+            }
+            if (!isBetter(key[heap[child]], key[v])) break;
+            heap[i] = heap[child];
+            position[heap[i]] = i;
+            i = child;
+        }
+        heap[i] = v;
+        position[v] = i;
+    }
+
+/* Make it illegal to copy heaps */
+
+    IndexedHeap(const IndexedHeap & src) { }
+    IndexedHeap & operator=(const IndexedHeap & src) { return *this; }
+
+};
+
+/*
+ * Type: BoruvkaSlice
+ * ------------------
+ * This type holds the work of one Boruvka thread: a slice of the list of
+ * edges that still cross between components, along with pointers to the
+ * data shared by all the threads.
+ */
+
+struct BoruvkaSlice {
+    int *live;                  // The slice of the live edge list
+    int count;                  // The number of live edges in the slice
+    const WeightedEdge *edges;  // All the edges
+    const int *component;       // The component label of each node
+    atomic<int> *best;          // The best edge leaving each component
+};
+
+/* Private function prototypes */
+
+static WeightedEdge *copyEdges(int nNodes, const Vector<WeightedEdge> & edges);
+static void findBestEdges(BoruvkaSlice *slice);
+static void removeInternalEdges(BoruvkaSlice *slice);
+static void offerEdge(atomic<int> & best, int e, const WeightedEdge *edges);
+static void runSlices(void (*fn)(BoruvkaSlice *), BoruvkaSlice *slices,
+                      int nThreads);
+
+/*
+ * Implementation notes: kruskalMST
+ * --------------------------------
+ * The sort works on an array of edge indices rather than on the edges
+ * themselves, which keeps the index available for breaking ties.
+ */
+
+double kruskalMST(int nNodes, const Vector<WeightedEdge> & edges,
+                  Vector<int> & tree) {
+    tree.clear();
+    int nEdges = edges.size();
+    WeightedEdge *array = copyEdges(nNodes, edges);
+    int *order = new int[nEdges];
+    for (int i = 0; i < nEdges; i++) {
+        order[i] = i;
+    }
+    sort(order, order + nEdges, [array](int e1, int e2) {
+        return IndexedHeap::isBetter(e1, e2, array);
+    });
+    UnionFind uf(nNodes);
+    double total = 0;
+    for (int i = 0; i < nEdges && tree.size() < nNodes - 1; i++) {
+        int e = order[i];
+        if (uf.unite(array[e].u, array[e].v)) {
+            tree.add(e);
+            total += array[e].cost;
+        }
+    }
+    delete[] order;
+    delete[] array;
+    return total;
+}
+
+/*
+ * Implementation notes: primMST
+ * -----------------------------
+ * Prim's algorithm needs the edges at each node, so the function first
+ * builds an adjacency structure in the same compressed form that
+ * CompactGraph uses, with each edge appearing once at each endpoint.
+ * To handle graphs that are not connected, the search restarts from
+ * every node that the previous searches did not reach.
+ */
+
+double primMST(int nNodes, const Vector<WeightedEdge> & edges,
+               Vector<int> & tree) {
+    tree.clear();
+    int nEdges = edges.size();
+    WeightedEdge *array = copyEdges(nNodes, edges);
+    int *offsets = new int[nNodes + 1];
+    int *incident = new int[2 * nEdges];
+    for (int v = 0; v <= nNodes; v++) {
+        offsets[v] = 0;
+    }
+    for (int e = 0; e < nEdges; e++) {
+        offsets[array[e].u + 1]++;
+        offsets[array[e].v + 1]++;
+    }
+    for (int v = 0; v < nNodes; v++) {
+        offsets[v + 1] += offsets[v];
+    }
+    int *fill = new int[nNodes];
+    for (int v = 0; v < nNodes; v++) {
+        fill[v] = offsets[v];
+    }
+    for (int e = 0; e < nEdges; e++) {
+        incident[fill[array[e].u]++] = e;
+        incident[fill[array[e].v]++] = e;
+    }
+    delete[] fill;
+    bool *inTree = new bool[nNodes];
+    for (int v = 0; v < nNodes; v++) {
+        inTree[v] = false;
+    }
+    IndexedHeap heap(nNodes, array);
+    double total = 0;
+    for (int root = 0; root < nNodes; root++) {
+        if (inTree[root]) continue;
+        inTree[root] = true;
+        int v = root;
+        while (true) {
+            for (int i = offsets[v]; i < offsets[v + 1]; i++) {
+                int e = incident[i];
+                int w = (array[e].u == v) ? array[e].v : array[e].u;
+                if (!inTree[w]) heap.pushOrLower(w, e);
+            }
+            if (heap.isEmpty()) break;
+            v = heap.pop();
+            inTree[v] = true;
+            tree.add(heap.getKey(v));
+            total += array[heap.getKey(v)].cost;
+        }
+    }
+    delete[] inTree;
+    delete[] incident;
+    delete[] offsets;
+    delete[] array;
+    return total;
+}
+
+/*
+ * Implementation notes: boruvkaMST
+ * --------------------------------
+ * Each round has three phases, of which the first and last run in
+ * parallel over slices of the live edge list:
+ *
+ * 1. Every thread scans its edges and offers each one to the components
+ *    at both of its ends. The best edge for each component is an atomic
+ *    integer that a thread replaces only with an edge that comes earlier
+ *    in the edge order, so the threads need no locks.
+ * 2. A single thread adds the best edge of each component to the tree,
+ *    using a union-find structure to skip an edge that two components
+ *    both chose. Because every component uses the same strict order,
+ *    the chosen edges can never form a cycle. The nodes then take the
+ *    label of their new component.
+ * 3. Every thread removes the edges that now lie inside a component by
+ *    compacting its slice in place, and the slices are joined together.
+ *
+ * The number of components at least halves in every round, so there are
+ * at most log2(n) rounds, and the live edge list shrinks as it goes.
+ */
+
+double boruvkaMST(int nNodes, const Vector<WeightedEdge> & edges,
+                  Vector<int> & tree, int nThreads) {
+    tree.clear();
+    int nEdges = edges.size();
+    WeightedEdge *array = copyEdges(nNodes, edges);
+    if (nThreads <= 0) nThreads = thread::hardware_concurrency();
+    if (nThreads <= 0) nThreads = 1;
+    int *component = new int[nNodes];
+    atomic<int> *best = new atomic<int>[nNodes];
+    for (int v = 0; v < nNodes; v++) {
+        component[v] = v;
+        best[v].store(-1, memory_order_relaxed);
+    }
+    int *live = new int[nEdges];
+    int nLive = 0;
+    for (int e = 0; e < nEdges; e++) {
+        if (array[e].u != array[e].v) live[nLive++] = e;
+    }
+    UnionFind uf(nNodes);
+    BoruvkaSlice *slices = new BoruvkaSlice[nThreads];
+    double total = 0;
+    while (nLive > 0) {
+        int nSlices = nLive / MIN_EDGES_PER_THREAD;
+        if (nSlices > nThreads) nSlices = nThreads;
+        if (nSlices < 1) nSlices = 1;
+        for (int i = 0; i < nSlices; i++) {
+            int begin = (int) ((long) nLive * i / nSlices);
+            int end = (int) ((long) nLive * (i + 1) / nSlices);
+            slices[i].live = live + begin;
+            slices[i].count = end - begin;
+            slices[i].edges = array;
+            slices[i].component = component;
+            slices[i].best = best;
+        }
+        runSlices(findBestEdges, slices, nSlices);
+        int added = 0;
+        for (int c = 0; c < nNodes; c++) {
+            int e = best[c].load(memory_order_relaxed);
+            if (e < 0) continue;
+            best[c].store(-1, memory_order_relaxed);
+            if (uf.unite(array[e].u, array[e].v)) {
+                tree.add(e);
+                total += array[e].cost;
+                added++;
+            }
+        }
+        if (added == 0) break;
+        for (int v = 0; v < nNodes; v++) {
+            component[v] = uf.find(v);
+        }
+        runSlices(removeInternalEdges, slices, nSlices);
+        nLive = 0;
+        for (int i = 0; i < nSlices; i++) {
+            copy(slices[i].live, slices[i].live + slices[i].count,
+                 live + nLive);
+            nLive += slices[i].count;
+        }
+    }
+    delete[] slices;
+    delete[] live;
+    delete[] best;
+    delete[] component;
+    delete[] array;
+    return total;
+}
+
+/*
+ * Implementation notes: findMinimumSpanningTree for SimpleGraph
+ * -------------------------------------------------------------
+ * This version numbers the nodes by walking the node set. That set, like
+ * the arc set, is ordered by pointer value, so the numbering and the order
+ * of the edges can differ from one run to the next. The numbers are used
+ * only inside this function, and the tree does not depend on them when
+ * the arc costs are distinct. When several arcs have the same cost,
+ * which of them ends up in the tree can vary between runs.
+ */
+
+Set<Arc *> findMinimumSpanningTree(SimpleGraph & g, MSTAlgorithm algorithm) {
+    Map<Node *,int> nodeIds;
+    for (Node *node : g.nodes) {
+        nodeIds.put(node, nodeIds.size());
+    }
+    Vector<Arc *> arcs;
+    Vector<WeightedEdge> edges;
+    for (Arc *arc : g.arcs) {
+        WeightedEdge edge;
+        edge.u = nodeIds.get(arc->start);
+        edge.v = nodeIds.get(arc->finish);
+        edge.cost = arc->cost;
+        arcs.add(arc);
+        edges.add(edge);
+    }
+    Vector<int> tree;
+    runMSTAlgorithm(algorithm, nodeIds.size(), edges, tree);
+    Set<Arc *> result;
+    for (int i = 0; i < tree.size(); i++) {
+        result.add(arcs[tree[i]]);
+    }
+    return result;
+}
+
+void getEdges(const CompactGraph & g, Vector<WeightedEdge> & edges) {
+    edges.clear();
+    for (int n = 0; n < g.size(); n++) {
+        for (int a = g.getArcBegin(n); a < g.getArcEnd(n); a++) {
+            WeightedEdge edge;
+            edge.u = n;
+            edge.v = g.getFinish(a);
+            edge.cost = g.getCost(a);
+            edges.add(edge);
+        }
+    }
+}
+
+double runMSTAlgorithm(MSTAlgorithm algorithm, int nNodes,
+                       const Vector<WeightedEdge> & edges,
+                       Vector<int> & tree) {
+    switch (algorithm) {
+      case KRUSKAL: return kruskalMST(nNodes, edges, tree);
+      case PRIM: return primMST(nNodes, edges, tree);
+      case BORUVKA: return boruvkaMST(nNodes, edges, tree);
+    }
+    error("runMSTAlgorithm: Illegal algorithm");
+    return 0;
+}
+
+/*
+ * Private function: copyEdges
+ * Usage: WeightedEdge *array = copyEdges(nNodes, edges);
+ * ------------------------------------------------------
+ * Copies the edges into a dynamic array, which the caller must free, and
+ * checks that every endpoint is a legal node number.
+ */
+
+static WeightedEdge *copyEdges(int nNodes, const Vector<WeightedEdge> & edges) {
+    WeightedEdge *array = new WeightedEdge[edges.size()];
+    for (int i = 0; i < edges.size(); i++) {
+        array[i] = edges[i];
+        if (array[i].u < 0 || array[i].u >= nNodes
+                || array[i].v < 0 || array[i].v >= nNodes) {
+            delete[] array;
+            error("MST: Edge endpoint out of range");
+        }
+    }
+    return array;
+}
+
+/*
+ * Private function: findBestEdges
+ * Usage: findBestEdges(slice);
+ * ----------------------------
+ * Offers each edge in the slice to the components at its two ends.
+ */
+
+static void findBestEdges(BoruvkaSlice *slice) {
+    const WeightedEdge *edges = slice->edges;
+    for (int i = 0; i < slice->count; i++) {
+        int e = slice->live[i];
+        offerEdge(slice->best[slice->component[edges[e].u]], e, edges);
+        offerEdge(slice->best[slice->component[edges[e].v]], e, edges);
+    }
+}
+
+/*
+ * Private function: removeInternalEdges
+ * Usage: removeInternalEdges(slice);
+ * ----------------------------------
+ * Removes the edges whose ends are now in the same component, keeping
+ * the others in order at the front of the slice.
+ */
+
+static void removeInternalEdges(BoruvkaSlice *slice) {
+    const WeightedEdge *edges = slice->edges;
+    int kept = 0;
+    for (int i = 0; i < slice->count; i++) {
+        int e = slice->live[i];
+        if (slice->component[edges[e].u] != slice->component[edges[e].v]) {
+            slice->live[kept++] = e;
+        }
+    }
+    slice->count = kept;
+}
+
+/*
+ * Private function: offerEdge
+ * Usage: offerEdge(best, e, edges);
+ * ---------------------------------
+ * Replaces the edge stored in best with e if e comes earlier in the edge
+ * order. If another thread changes best in the meantime, the comparison
+ * is simply repeated with the new value.
+ */
+
+static void offerEdge(atomic<int> & best, int e, const WeightedEdge *edges) {
+    int current = best.load(memory_order_relaxed);
+    while (current < 0 || IndexedHeap::isBetter(e, current, edges)) {
+        if (best.compare_exchange_weak(current, e, memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+/*
+ * Private function: runSlices
+ * Usage: runSlices(fn, slices, nThreads);
+ * ---------------------------------------
+ * Calls fn on each of the first nThreads slices, using a separate thread
+ * for every slice but the first, and waits for all of them to finish.
+ */
+
+static void runSlices(void (*fn)(BoruvkaSlice *), BoruvkaSlice *slices,
+                      int nThreads) {
+    Vector<thread *> threads;
+    for (int i = 1; i < nThreads; i++) {
+        threads.add(new thread(fn, &slices[i]));
+    }
+    fn(&slices[0]);
+    for (int i = 0; i < threads.size(); i++) {
+        threads[i]->join();
+        delete threads[i];
+    }
+}
@@ -0,0 +1,171 @@
+/*
+ * File: mst.h
+ * -----------
+ * This interface exports functions that find a minimum spanning tree of
+ * an undirected graph using the algorithms of Kruskal, Prim and Boruvka.
+ */
+
+#ifndef _mst_h
+#define _mst_h
+
+#include "compactgraph.h"
+#include "graph.h"
+#include "graphtypes.h"
+#include "map.h"
+#include "set.h"
+#include "vector.h"
+
+/*
+ * Type: WeightedEdge
+ * ------------------
+ * This type represents an undirected edge between two numbered nodes.
+ * The MST functions work on a vector of these edges, which the front ends
+ * below produce from the various graph classes.
+ */
+
+struct WeightedEdge {
+    int u;              // The number of one endpoint
+    int v;              // The number of the other endpoint
+    double cost;        // The cost of the edge
+};
+
+/*
+ * Type: MSTAlgorithm
+ * ------------------
+ * This enumerated type selects the algorithm used by the front ends.
+ */
+
+enum MSTAlgorithm { KRUSKAL, PRIM, BORUVKA };
+
+/*
+ * Function: kruskalMST
+ * Usage: double total = kruskalMST(nNodes, edges, tree);
+ * ------------------------------------------------------
+ * Finds a minimum spanning tree by sorting the edges and adding each one
+ * that joins two different components, which a union-find structure
+ * tracks. The indices of the chosen edges are stored in tree, and the
+ * function returns their total cost. If the graph is not connected, the
+ * result is a minimum spanning forest with one tree per component.
+ *
+ * All three MST functions break ties between edges of equal cost by
+ * preferring the edge with the smaller index. That makes the tree unique,
+ * so the three functions always choose exactly the same edges.
+ */
+
+double kruskalMST(int nNodes, const Vector<WeightedEdge> & edges,
+                  Vector<int> & tree);
+
+/*
+ * Function: primMST
+ * Usage: double total = primMST(nNodes, edges, tree);
+ * ---------------------------------------------------
+ * Finds a minimum spanning tree by growing it outward from one node at a
+ * time, using an indexed heap that holds the cheapest known edge to each
+ * node outside the tree. The arguments and result are the same as those
+ * for kruskalMST.
+ */
+
+double primMST(int nNodes, const Vector<WeightedEdge> & edges,
+               Vector<int> & tree);
+
+/*
+ * Function: boruvkaMST
+ * Usage: double total = boruvkaMST(nNodes, edges, tree);
+ *        double total = boruvkaMST(nNodes, edges, tree, nThreads);
+ * ---------------------------------------------------------------
+ * Finds a minimum spanning tree using Boruvka's algorithm, which works in
+ * rounds. In each round, every component picks its cheapest outgoing
+ * edge, and all of those edges are added at once, which at least halves
+ * the number of components. The scan over the edges in each round is
+ * divided among nThreads threads; if nThreads is zero or omitted, the
+ * function uses one thread per processor. The other arguments and the
+ * result are the same as those for kruskalMST.
+ */
+
+double boruvkaMST(int nNodes, const Vector<WeightedEdge> & edges,
+                  Vector<int> & tree, int nThreads = 0);
+
+/*
+ * Function: findMinimumSpanningTree
+ * Usage: Set<Arc *> tree = findMinimumSpanningTree(g);
+ *        Set<Arc *> tree = findMinimumSpanningTree(g, algorithm);
+ * ------------------------------------------------------------
+ * Returns the arcs of a minimum spanning tree (or forest) of the graph,
+ * which may be a SimpleGraph or any Graph<NodeType,ArcType>. The graph is
+ * treated as undirected, so it does not matter whether each connection is
+ * stored in one direction or, as in AirlineGraph.cpp, in both. Only one
+ * arc of each chosen connection appears in the result. The algorithm
+ * argument selects the algorithm and defaults to BORUVKA. For the Graph
+ * version, the ArcType must also have a numeric field called cost.
+ */
+
+Set<Arc *> findMinimumSpanningTree(SimpleGraph & g,
+                                   MSTAlgorithm algorithm = BORUVKA);
+
+template <typename NodeType,typename ArcType>
+Set<ArcType *> findMinimumSpanningTree(Graph<NodeType,ArcType> & g,
+                                       MSTAlgorithm algorithm = BORUVKA);
+
+/*
+ * Function: getEdges
+ * Usage: getEdges(g, edges);
+ * --------------------------
+ * Fills edges with one WeightedEdge per arc of a CompactGraph, using the
+ * graph's node numbers as the endpoints.
+ */
+
+void getEdges(const CompactGraph & g, Vector<WeightedEdge> & edges);
+
+/*
+ * Function: runMSTAlgorithm
+ * Usage: double total = runMSTAlgorithm(algorithm, nNodes, edges, tree);
+ * ----------------------------------------------------------------------
+ * Calls the function that implements the specified algorithm.
+ */
+
+double runMSTAlgorithm(MSTAlgorithm algorithm, int nNodes,
+                       const Vector<WeightedEdge> & edges,
+                       Vector<int> & tree);
+
+/* Private section */
+
+/**********************************************************************/
+/* Note: Everything below this point in the file is logically part    */
+/* of the implementation and should not be of interest to clients.    */
+/**********************************************************************/
+
+/*
+ * Implementation notes: findMinimumSpanningTree
+ * ---------------------------------------------
+ * The template version numbers the nodes, converts the arcs to edges,
+ * runs the selected algorithm and maps the chosen edges back to arcs,
+ * which is exactly what the SimpleGraph version does in mst.cpp.
+ */
+
+template <typename NodeType,typename ArcType>
+Set<ArcType *> findMinimumSpanningTree(Graph<NodeType,ArcType> & g,
+                                       MSTAlgorithm algorithm) {
+    Map<NodeType *,int> nodeIds;
+    for (NodeType *node : g.getNodeSet()) {
+        nodeIds.put(node, nodeIds.size());
+    }
+    Vector<ArcType *> arcs;
+    Vector<WeightedEdge> edges;
+    for (ArcType *arc : g.getArcSet()) {
+        WeightedEdge edge;
+        edge.u = nodeIds.get(arc->start);
+        edge.v = nodeIds.get(arc->finish);
+        edge.cost = arc->cost;
+        arcs.add(arc);
+        edges.add(edge);
+    }
+    Vector<int> tree;
+    runMSTAlgorithm(algorithm, nodeIds.size(), edges, tree);
+    Set<ArcType *> result;
+    for (int i = 0; i < tree.size(); i++) {
+        result.add(arcs[tree[i]]);
+    }
+    return result;
+}
+
+#endif
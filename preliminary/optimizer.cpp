@@ -0,0 +1,515 @@
+/*
+ * File: optimizer.cpp
+ * -------------------
+ * This file implements the optimizer.h interface.
+ */
+
+#include <climits>
+#include <cstdio>
+#include <string>
+#include "error.h"
+#include "exp.h"
+#include "optimizer.h"
+#include "set.h"
+using namespace std;
+
+/*
+ * Class: SharedExp
+ * ----------------
+ * This class represents a compound expression built by the optimizer.
+ * It behaves like CompoundExp, except that it does not delete its
+ * operands, which may belong to other expressions as well, and that a
+ * node with more than one parent remembers its value. When it gets its
+ * second parent, the node takes the next memo index from the optimizer,
+ * under which it keeps its value in the context until the root starts
+ * the next evaluation. The tree itself never changes during eval.
+ */
+
+class SharedExp : public Expression {
+
+public:
+
+    SharedExp(OperatorType op, Expression *lhs, Expression *rhs,
+              int *nMemos) {
+        this->op = op;
+        this->lhs = lhs;
+        this->rhs = rhs;
+        this->nMemos = nMemos;
+        nParents = 0;
+        memo = -1;
+    }
+
+    virtual int eval(EvaluationContext & context) {
+        int result;
+        if (memo >= 0 && context.recallMemo(memo, result)) return result;
+        result = evalOperator(context);
+        if (memo >= 0) context.storeMemo(memo, result);
+        return result;
+    }
+
+    virtual void bind(EvaluationContext & context) {
+        lhs->bind(context);
+        rhs->bind(context);
+    }
+
+    virtual string toString() {
+        return '(' + lhs->toString() + ' ' + operatorToString(op) + ' '
+                   + rhs->toString() + ')';
+    }
+
+    virtual ExpressionType getType() {
+        return COMPOUND;
+    }
+
+    virtual string getOperator() {
+        return operatorToString(op);
+    }
+
+    virtual OperatorType getOperatorType() {
+        return op;
+    }
+
+    virtual Expression *getLHS() {
+        return lhs;
+    }
+
+    virtual Expression *getRHS() {
+        return rhs;
+    }
+
+    void addParent() {
+        nParents++;
+        if (nParents == 2) memo = (*nMemos)++;
+    }
+
+private:
+
+    OperatorType op;            // The operator
+    Expression *lhs, *rhs;      // The operands, which this node shares
+    int *nMemos;                // The optimizer's count of memo indices
+    int nParents;               // The number of nodes that use this one
+    int memo;                   // The memo index, or -1 if unshared
+
+    int evalOperator(EvaluationContext & context) {
+        int right = rhs->eval(context);
+        if (op == ASSIGN) {
+            if (lhs->getType() != IDENTIFIER) lhs->getIdentifierName();
+            static_cast<IdentifierExp *>(lhs)->assign(context, right);
+            return right;
+        }
+        int left = lhs->eval(context);
+        switch (op) {
+            case ADD: return left + right;
+            case SUBTRACT: return left - right;
+            case MULTIPLY: return left * right;
+            case DIVIDE:
+                if (right == 0) error("Division by 0");
+                if (right == -1) return int(0 - unsigned(left));
+                return left / right;
+            default: break;
+        }
+        error("Illegal operator in expression");
+        return 0;
+    }
+
+};
+
+/*
+ * Class: RootExp
+ * --------------
+ * This class marks the root of an optimized expression. Evaluating it
+ * calls startMemo on the context, which tells the shared nodes below
+ * that the values they remember are out of date, and then evaluates the
+ * expression. Every other method passes the request on,
+ * so the root looks to clients exactly like the expression it holds.
+ */
+
+class RootExp : public Expression {
+
+public:
+
+    RootExp(Expression *exp) {
+        this->exp = exp;
+    }
+
+    virtual int eval(EvaluationContext & context) {
+        context.startMemo();
+        return exp->eval(context);
+    }
+
+    virtual void bind(EvaluationContext & context) {
+        exp->bind(context);
+    }
+
+    virtual string toString() {
+        return exp->toString();
+    }
+
+    virtual ExpressionType getType() {
+        return exp->getType();
+    }
+
+    virtual int getConstantValue() {
+        return exp->getConstantValue();
+    }
+
+    virtual string getIdentifierName() {
+        return exp->getIdentifierName();
+    }
+
+    virtual string getOperator() {
+        return exp->getOperator();
+    }
+
+    virtual OperatorType getOperatorType() {
+        return exp->getOperatorType();
+    }
+
+    virtual Expression *getLHS() {
+        return exp->getLHS();
+    }
+
+    virtual Expression *getRHS() {
+        return exp->getRHS();
+    }
+
+private:
+
+    Expression *exp;            // The optimized expression
+
+};
+
+/* Private function prototypes */
+
+static void findAssignments(Expression *exp, Set<string> & assigned);
+static bool isConstant(Expression *exp, int value);
+static bool fold(OperatorType op, int left, int right, int & result);
+static string addressKey(char tag, Expression *lhs, Expression *rhs);
+
+/*
+ * Implementation notes: constructor, destructor and clear
+ * -------------------------------------------------------
+ * Every node the optimizer allocates is recorded in allNodes, so the
+ * destructor can free them without walking the expressions, which would
+ * reach the shared nodes more than once.
+ */
+
+ExpressionOptimizer::ExpressionOptimizer() {
+    nMemos = 0;
+}
+
+ExpressionOptimizer::~ExpressionOptimizer() {
+    clear();
+}
+
+void ExpressionOptimizer::clear() {
+    for (int i = 0; i < allNodes.size(); i++) {
+        delete allNodes[i];
+    }
+    allNodes.clear();
+    shared.clear();
+    keys.clear();
+    nMemos = 0;
+}
+
+int ExpressionOptimizer::getNodeCount() const {
+    return allNodes.size();
+}
+
+/*
+ * Implementation notes: optimize
+ * ------------------------------
+ * The optimize method first collects the variables the expression
+ * assigns, which decides what may be shared, and then rebuilds the
+ * expression from the bottom up.
+ */
+
+Expression *ExpressionOptimizer::optimize(Expression *exp) {
+    Set<string> assigned;
+    findAssignments(exp, assigned);
+    bool pure, safe;
+    Expression *result = rebuild(exp, assigned, assigned.isEmpty(),
+                                 pure, safe);
+    SharedExp *node = dynamic_cast<SharedExp *>(result);
+    if (node != NULL) node->addParent();
+    return record(new RootExp(result));
+}
+
+/*
+ * Private method: rebuild
+ * Usage: Expression *opt = rebuild(exp, assigned, reorder, pure, safe);
+ * ---------------------------------------------------------------------
+ * Returns the optimized form of exp. On return, pure indicates whether
+ * the result may be shared, which requires that it neither assigns a
+ * variable nor reads one in the set assigned, and safe indicates whether
+ * it can be discarded without changing the outcome, which requires that
+ * it neither assigns a variable nor divides. The reorder flag allows the
+ * operands of + and * to be exchanged.
+ */
+
+Expression *ExpressionOptimizer::rebuild(Expression *exp,
+                                         const Set<string> & assigned,
+                                         bool reorder, bool & pure,
+                                         bool & safe) {
+    switch (exp->getType()) {
+        case CONSTANT:
+            pure = safe = true;
+            return makeConstant(exp->getConstantValue());
+        case IDENTIFIER: {
+            string name = exp->getIdentifierName();
+            pure = !assigned.contains(name);
+            safe = true;
+            return makeIdentifier(name, pure);
+        }
+        case COMPOUND:
+            break;
+    }
+    OperatorType op = exp->getOperatorType();
+    bool rhsPure, rhsSafe;
+    Expression *rhs = rebuild(exp->getRHS(), assigned, reorder,
+                              rhsPure, rhsSafe);
+    if (op == ASSIGN) {
+        Expression *lhs = exp->getLHS();
+        if (lhs->getType() == IDENTIFIER) {
+            lhs = makeIdentifier(lhs->getIdentifierName(), false);
+        } else {
+            bool lhsPure, lhsSafe;
+            lhs = rebuild(lhs, assigned, reorder, lhsPure, lhsSafe);
+        }
+        pure = safe = false;
+        return makeCompound(ASSIGN, lhs, rhs, false);
+    }
+    bool lhsPure, lhsSafe;
+    Expression *lhs = rebuild(exp->getLHS(), assigned, reorder,
+                              lhsPure, lhsSafe);
+    pure = lhsPure && rhsPure;
+    safe = lhsSafe && rhsSafe && op != DIVIDE;
+    return simplify(op, lhs, rhs, reorder, pure, lhsSafe, rhsSafe);
+}
+
+/*
+ * Private method: simplify
+ * Usage: Expression *opt = simplify(op, lhs, rhs, reorder, share,
+ *                                   lhsSafe, rhsSafe);
+ * ---------------------------------------------------------------
+ * Returns the simplest expression equivalent to lhs op rhs, where the
+ * operands have already been optimized. The rules are tried in order:
+ * folding two constants, applying an identity, moving a constant operand
+ * of + or * to the right, combining it with a constant operand of the
+ * same operator on the left, and finally ordering the operands of + and
+ * * by address so that a + b and b + a produce the same key. Moving a
+ * constant is always allowed, since a constant cannot affect or be
+ * affected by anything else in the expression. The safety flags move
+ * with their operands. When a constant is combined with the one inside
+ * lhs, the operand left over is as safe as lhs itself, because lhs adds
+ * to it only a constant and an operator that cannot fail.
+ */
+
+Expression *ExpressionOptimizer::simplify(OperatorType op, Expression *lhs,
+                                          Expression *rhs, bool reorder,
+                                          bool share, bool lhsSafe,
+                                          bool rhsSafe) {
+    int value;
+    if (lhs->getType() == CONSTANT && rhs->getType() == CONSTANT
+            && fold(op, lhs->getConstantValue(), rhs->getConstantValue(),
+                    value)) {
+        return makeConstant(value);
+    }
+    switch (op) {
+        case ADD:
+            if (isConstant(rhs, 0)) return lhs;
+            if (isConstant(lhs, 0)) return rhs;
+            break;
+        case SUBTRACT:
+            if (isConstant(rhs, 0)) return lhs;
+            break;
+        case MULTIPLY:
+            if (isConstant(rhs, 1)) return lhs;
+            if (isConstant(lhs, 1)) return rhs;
+            if (isConstant(rhs, 0) && lhsSafe) return rhs;
+            if (isConstant(lhs, 0) && rhsSafe) return lhs;
+            break;
+        case DIVIDE:
+            if (isConstant(rhs, 1)) return lhs;
+            break;
+        default:
+            break;
+    }
+    if (op == ADD || op == MULTIPLY) {
+        if (lhs->getType() == CONSTANT) {
+            swapOperands(lhs, rhs, lhsSafe, rhsSafe);
+        }
+        if (rhs->getType() == CONSTANT && lhs->getType() == COMPOUND
+                && lhs->getOperatorType() == op
+                && lhs->getRHS()->getType() == CONSTANT) {
+            fold(op, lhs->getRHS()->getConstantValue(),
+                 rhs->getConstantValue(), value);
+            return simplify(op, lhs->getLHS(), makeConstant(value),
+                            reorder, share, lhsSafe, true);
+        }
+        if (reorder && rhs->getType() != CONSTANT && lhs > rhs) {
+            swapOperands(lhs, rhs, lhsSafe, rhsSafe);
+        }
+    }
+    return makeCompound(op, lhs, rhs, share);
+}
+
+/*
+ * Private method: swapOperands
+ * Usage: swapOperands(lhs, rhs, lhsSafe, rhsSafe);
+ * ------------------------------------------------
+ * Exchanges the two operands together with their safety flags.
+ */
+
+void ExpressionOptimizer::swapOperands(Expression * & lhs,
+                                       Expression * & rhs,
+                                       bool & lhsSafe, bool & rhsSafe) {
+    Expression *tmp = lhs;
+    lhs = rhs;
+    rhs = tmp;
+    bool safe = lhsSafe;
+    lhsSafe = rhsSafe;
+    rhsSafe = safe;
+}
+
+/*
+ * Private methods: makeConstant, makeIdentifier, makeCompound
+ * -----------------------------------------------------------
+ * These methods return a node of the appropriate type, reusing an
+ * identical node if there is one and the new node may be shared. Each
+ * compound node records how many parents its operands have, so that
+ * those with more than one know to remember their values.
+ */
+
+Expression *ExpressionOptimizer::makeConstant(int value) {
+    string key = "#" + to_string(value);
+    Expression *exp = findShared(key);
+    if (exp == NULL) {
+        exp = record(new ConstantExp(value));
+        shared.add(exp);
+    }
+    return exp;
+}
+
+Expression *ExpressionOptimizer::makeIdentifier(string name, bool share) {
+    if (!share) return record(new IdentifierExp(name));
+    Expression *exp = findShared("$" + name);
+    if (exp == NULL) {
+        exp = record(new IdentifierExp(name));
+        shared.add(exp);
+    }
+    return exp;
+}
+
+Expression *ExpressionOptimizer::makeCompound(OperatorType op,
+                                              Expression *lhs,
+                                              Expression *rhs, bool share) {
+    if (share) {
+        string key = addressKey(operatorToString(op)[0], lhs, rhs);
+        Expression *exp = findShared(key);
+        if (exp != NULL) return exp;
+    }
+    SharedExp *node = new SharedExp(op, lhs, rhs, &nMemos);
+    SharedExp *operand = dynamic_cast<SharedExp *>(lhs);
+    if (operand != NULL) operand->addParent();
+    operand = dynamic_cast<SharedExp *>(rhs);
+    if (operand != NULL) operand->addParent();
+    record(node);
+    if (share) shared.add(node);
+    return node;
+}
+
+/*
+ * Private method: findShared
+ * Usage: Expression *exp = findShared(key);
+ * -----------------------------------------
+ * Returns the shared node with the specified key, or NULL if there is
+ * none, in which case the caller must add the new node to shared, where
+ * it takes the index that intern has just given the key.
+ */
+
+Expression *ExpressionOptimizer::findShared(const string & key) {
+    int id = keys.intern(key);
+    return (id < shared.size()) ? shared[id] : NULL;
+}
+
+/*
+ * Private method: record
+ * Usage: exp = record(exp);
+ * -------------------------
+ * Adds exp to the list of nodes to delete and returns it.
+ */
+
+Expression *ExpressionOptimizer::record(Expression *exp) {
+    allNodes.add(exp);
+    return exp;
+}
+
+/*
+ * Private function: findAssignments
+ * Usage: findAssignments(exp, assigned);
+ * --------------------------------------
+ * Adds to assigned the name of every variable assigned in exp.
+ */
+
+static void findAssignments(Expression *exp, Set<string> & assigned) {
+    if (exp->getType() != COMPOUND) return;
+    if (exp->getOperatorType() == ASSIGN
+            && exp->getLHS()->getType() == IDENTIFIER) {
+        assigned.add(exp->getLHS()->getIdentifierName());
+    }
+    findAssignments(exp->getLHS(), assigned);
+    findAssignments(exp->getRHS(), assigned);
+}
+
+/*
+ * Private function: isConstant
+ * Usage: if (isConstant(exp, value)) . . .
+ * ----------------------------------------
+ * Returns true if exp is a constant with the specified value.
+ */
+
+static bool isConstant(Expression *exp, int value) {
+    return exp->getType() == CONSTANT && exp->getConstantValue() == value;
+}
+
+/*
+ * Private function: fold
+ * Usage: if (fold(op, left, right, result)) . . .
+ * -----------------------------------------------
+ * Computes left op right in result and returns true, unless the
+ * operation would fail at run time, in which case it returns false and
+ * the operation is left for evaluation to report. Addition, subtraction
+ * and multiplication are done in unsigned arithmetic, which wraps around
+ * in the same way as the evaluator on two's-complement machines without
+ * the undefined behavior of signed overflow.
+ */
+
+static bool fold(OperatorType op, int left, int right, int & result) {
+    unsigned a = left, b = right;
+    switch (op) {
+        case ADD: result = (int) (a + b); return true;
+        case SUBTRACT: result = (int) (a - b); return true;
+        case MULTIPLY: result = (int) (a * b); return true;
+        case DIVIDE:
+            if (right == 0 || (left == INT_MIN && right == -1)) return false;
+            result = left / right;
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*
+ * Private function: addressKey
+ * Usage: string key = addressKey(tag, lhs, rhs);
+ * ----------------------------------------------
+ * Returns the key for a compound node, which consists of the operator
+ * symbol and the addresses of the two operands.
+ */
+
+static string addressKey(char tag, Expression *lhs, Expression *rhs) {
+    char key[64];
+    snprintf(key, sizeof key, "%c%p,%p", tag, (void *) lhs, (void *) rhs);
+    return key;
+}
@@ -0,0 +1,158 @@
+/*
+ * File: optimizer.h
+ * -----------------
+ * This interface exports the ExpressionOptimizer class, which rewrites
+ * expression trees so that they do less work each time they are
+ * evaluated.
+ */
+
+#ifndef _optimizer_h
+#define _optimizer_h
+
+#include <string>
+#include "exp.h"
+#include "interner.h"
+#include "set.h"
+#include "vector.h"
+
+/*
+ * Class: ExpressionOptimizer
+ * --------------------------
+ * This class translates an expression tree into an equivalent expression
+ * that is cheaper to evaluate. The optimizer makes three improvements:
+ *
+ * 1. Constant folding. A subexpression whose operands are constants is
+ *    replaced by its value, so x * (2 + 3) becomes x * 5. A constant
+ *    applied to the result of the same operator with a constant operand
+ *    is combined with it, so x * 60 * 60 becomes x * 3600.
+ *
+ * 2. Algebraic simplification. The identities x + 0 = x, x - 0 = x,
+ *    x * 1 = x, x / 1 = x and x * 0 = 0 remove operations that have no
+ *    effect.
+ *
+ * 3. Common subexpression elimination. Identical subexpressions are
+ *    represented by a single node, which turns the tree into a directed
+ *    acyclic graph, and a node used in more than one place is evaluated
+ *    only once per evaluation of the whole expression. Because + and *
+ *    are commutative, a + b and b + a count as identical.
+ *
+ * The optimizer never changes the value of an expression that evaluates
+ * without error, but a few expressions that signal an error no longer do:
+ * simplifying x * 0 to 0 drops the check that the variables in x are
+ * defined. The optimizer does not apply that rule if x could divide by 0
+ * or contains an assignment.
+ *
+ * Assignments inside an expression limit what the optimizer can do, as
+ * an assignment can change the value of a later use of the variable. A
+ * subexpression is shared with another only if it contains no assignment
+ * and reads no variable that is assigned anywhere in the expression, and
+ * the operands of + and * are not reordered if the expression contains
+ * any assignment.
+ *
+ * The optimized expression belongs to the optimizer, which reuses nodes
+ * among all the expressions it produces and deletes them when it is
+ * itself deleted or cleared. The client should evaluate an optimized
+ * expression only through the root returned by optimize, which tells
+ * the context to forget the values of shared nodes from the previous
+ * evaluation. Those values live in the context, so an optimized
+ * expression, like any other, may be evaluated on several threads at
+ * once, each with its own context.
+ */
+
+class ExpressionOptimizer {
+
+public:
+
+/*
+ * Constructor: ExpressionOptimizer
+ * Usage: ExpressionOptimizer optimizer;
+ * -------------------------------------
+ * Initializes an optimizer that has not yet produced any expressions.
+ */
+
+    ExpressionOptimizer();
+
+/*
+ * Destructor: ~ExpressionOptimizer
+ * --------------------------------
+ * Deletes every expression this optimizer has produced.
+ */
+
+    ~ExpressionOptimizer();
+
+/*
+ * Method: optimize
+ * Usage: Expression *opt = optimizer.optimize(exp);
+ * -------------------------------------------------
+ * Returns an optimized equivalent of exp, which is left unchanged. The
+ * client must not delete the result.
+ */
+
+    Expression *optimize(Expression *exp);
+
+/*
+ * Method: getNodeCount
+ * Usage: int n = optimizer.getNodeCount();
+ * ----------------------------------------
+ * Returns the number of distinct nodes in all the expressions this
+ * optimizer has produced, which measures how much sharing it found.
+ */
+
+    int getNodeCount() const;
+
+/*
+ * Method: clear
+ * Usage: optimizer.clear();
+ * -------------------------
+ * Deletes every expression this optimizer has produced.
+ */
+
+    void clear();
+
+/*
+ * Notes on representation
+ * -----------------------
+ * Each shareable node is entered in a StringInterner under a key. The
+ * key of a constant or an identifier gives its value or name, and the
+ * key of a compound node gives its operator and the addresses of its
+ * operands. Since the operands are themselves shared, two subexpressions
+ * are identical exactly when their keys match, and the interner's number
+ * for a key indexes the vector of shared nodes. Every node the optimizer
+ * allocates is also recorded in allNodes so that it can be deleted.
+ */
+
+private:
+
+/* Instance variables */
+
+    StringInterner keys;            // The key of each shared node
+    Vector<Expression *> shared;    // The shared node for each key
+    Vector<Expression *> allNodes;  // Every node this optimizer created
+    int nMemos;                     // The memo indices given to nodes
+
+/* Private methods */
+
+    Expression *rebuild(Expression *exp, const Set<std::string> & assigned,
+                        bool reorder, bool & pure, bool & safe);
+    Expression *simplify(OperatorType op, Expression *lhs, Expression *rhs,
+                         bool reorder, bool share, bool lhsSafe,
+                         bool rhsSafe);
+    static void swapOperands(Expression * & lhs, Expression * & rhs,
+                             bool & lhsSafe, bool & rhsSafe);
+    Expression *makeConstant(int value);
+    Expression *makeIdentifier(std::string name, bool share);
+    Expression *makeCompound(OperatorType op, Expression *lhs,
+                             Expression *rhs, bool share);
+    Expression *findShared(const std::string & key);
+    Expression *record(Expression *exp);
+
+/* Make it illegal to copy optimizers */
+
+    ExpressionOptimizer(const ExpressionOptimizer & src) { }
+    ExpressionOptimizer & operator=(const ExpressionOptimizer & src) {
+        return *this;
+    }
+
+};
+
+#endif
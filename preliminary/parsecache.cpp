@@ -0,0 +1,345 @@
+/*
+ * File: parsecache.cpp
+ * --------------------
+ * This file implements the parsecache.h interface.
+ */
+
+#include <string>
+#include <string_view>
+#include "error.h"
+#include "exp.h"
+#include "optimizer.h"
+#include "parsecache.h"
+#include "parser.h"
+#include "tokenscanner.h"
+using namespace std;
+
+/* Constants */
+
+const long OPTIMIZED_NODE_BYTES = 64;   // Estimated size of an optimizer node
+const int MIN_REOPTIMIZE_NODES = 1024;  // Garbage worth collecting
+
+/*
+ * Implementation notes: constructor and destructor
+ * ------------------------------------------------
+ * The scanner is configured once, since every expression is read the
+ * same way.
+ */
+
+ParseCache::ParseCache(long maxBytes, bool optimize) {
+    scanner.ignoreWhitespace();
+    scanner.scanNumbers();
+    optimizing = optimize;
+    nBuckets = INITIAL_BUCKET_COUNT;
+    buckets = new Entry *[nBuckets];
+    for (int i = 0; i < nBuckets; i++) {
+        buckets[i] = NULL;
+    }
+    nEntries = 0;
+    head = tail = NULL;
+    nBytes = 0;
+    this->maxBytes = maxBytes;
+    nLiveNodes = 0;
+    nHits = 0;
+    nMisses = 0;
+}
+
+ParseCache::~ParseCache() {
+    clear();
+    delete[] buckets;
+}
+
+/*
+ * Implementation notes: get
+ * -------------------------
+ * A miss parses the text before changing anything, so that an error
+ * leaves the cache as it was. The new entry goes to the front of the
+ * list, where trimming the cache cannot reach it.
+ */
+
+Expression *ParseCache::get(string_view text) {
+    unsigned hash = hashCode(text);
+    Entry *entry = findEntry(text, hash);
+    if (entry != NULL) {
+        nHits++;
+        moveToFront(entry);
+        return entry->root;
+    }
+    nMisses++;
+    scanner.borrowInput(text);
+    Expression *exp = parseExp(scanner);
+    entry = addEntry(text, hash, exp);
+    trimToBudget();
+    int garbage = optimizer.getNodeCount() - 2 * nLiveNodes;
+    if (optimizing && garbage > MIN_REOPTIMIZE_NODES) reoptimizeAll();
+    return entry->root;
+}
+
+long ParseCache::getHitCount() const {
+    return nHits;
+}
+
+long ParseCache::getMissCount() const {
+    return nMisses;
+}
+
+int ParseCache::size() const {
+    return nEntries;
+}
+
+long ParseCache::getBytesUsed() const {
+    return nBytes;
+}
+
+long ParseCache::getMaxBytes() const {
+    return maxBytes;
+}
+
+void ParseCache::setMaxBytes(long maxBytes) {
+    this->maxBytes = maxBytes;
+    trimToBudget();
+}
+
+void ParseCache::clear() {
+    while (tail != NULL) {
+        removeEntry(tail);
+    }
+    optimizer.clear();
+    nLiveNodes = 0;
+}
+
+/*
+ * Private method: findEntry
+ * Usage: Entry *entry = findEntry(text, hash);
+ * --------------------------------------------
+ * Returns the entry for text, or NULL if there is none. Comparing the
+ * stored hash codes first avoids most string comparisons.
+ */
+
+ParseCache::Entry *ParseCache::findEntry(string_view text,
+                                         unsigned hash) const {
+    for (Entry *ep = buckets[hash & (nBuckets - 1)]; ep != NULL;
+                                                     ep = ep->chain) {
+        if (ep->hash == hash && ep->text == text) return ep;
+    }
+    return NULL;
+}
+
+/*
+ * Private method: addEntry
+ * Usage: Entry *entry = addEntry(text, hash, exp);
+ * ------------------------------------------------
+ * Creates an entry for the parsed tree exp, optimizing it if necessary,
+ * and links it into the hash table and the front of the list. If the
+ * optimizer signals an error, exp is deleted and nothing is added.
+ */
+
+ParseCache::Entry *ParseCache::addEntry(string_view text, unsigned hash,
+                                        Expression *exp) {
+    Entry *entry = new Entry;
+    entry->text = string(text);
+    entry->hash = hash;
+    entry->exp = exp;
+    entry->root = exp;
+    entry->nOptimizedNodes = 0;
+    if (optimizing) {
+        try {
+            optimizeEntry(entry);
+        } catch (ErrorException & ex) {
+            delete exp;
+            delete entry;
+            throw;
+        }
+    }
+    entry->bytes = sizeof(Entry) + entry->text.capacity() + treeBytes(exp)
+                 + entry->nOptimizedNodes * OPTIMIZED_NODE_BYTES;
+    if (nEntries >= nBuckets) expandTable();
+    int bucket = hash & (nBuckets - 1);
+    entry->chain = buckets[bucket];
+    buckets[bucket] = entry;
+    entry->prev = NULL;
+    entry->next = head;
+    if (head != NULL) head->prev = entry;
+    head = entry;
+    if (tail == NULL) tail = entry;
+    nEntries++;
+    nBytes += entry->bytes;
+    return entry;
+}
+
+/*
+ * Private method: removeEntry
+ * Usage: removeEntry(entry);
+ * --------------------------
+ * Unlinks the entry from the hash table and the list and deletes it
+ * together with its original tree. Its optimized tree stays in the
+ * optimizer until the next time the optimizer is cleared.
+ */
+
+void ParseCache::removeEntry(Entry *entry) {
+    Entry **link = &buckets[entry->hash & (nBuckets - 1)];
+    while (*link != entry) {
+        link = &(*link)->chain;
+    }
+    *link = entry->chain;
+    if (entry->prev == NULL) {
+        head = entry->next;
+    } else {
+        entry->prev->next = entry->next;
+    }
+    if (entry->next == NULL) {
+        tail = entry->prev;
+    } else {
+        entry->next->prev = entry->prev;
+    }
+    nEntries--;
+    nBytes -= entry->bytes;
+    nLiveNodes -= entry->nOptimizedNodes;
+    delete entry->exp;
+    delete entry;
+}
+
+/*
+ * Private method: moveToFront
+ * Usage: moveToFront(entry);
+ * --------------------------
+ * Moves the entry to the front of the list of entries.
+ */
+
+void ParseCache::moveToFront(Entry *entry) {
+    if (entry == head) return;
+    entry->prev->next = entry->next;
+    if (entry->next == NULL) {
+        tail = entry->prev;
+    } else {
+        entry->next->prev = entry->prev;
+    }
+    entry->prev = NULL;
+    entry->next = head;
+    head->prev = entry;
+    head = entry;
+}
+
+/*
+ * Private method: trimToBudget
+ * Usage: trimToBudget();
+ * ----------------------
+ * Discards the least recently used entries until the cache fits in its
+ * budget or holds only the most recently used entry.
+ */
+
+void ParseCache::trimToBudget() {
+    while (nBytes > maxBytes && tail != head) {
+        removeEntry(tail);
+    }
+}
+
+/*
+ * Private method: optimizeEntry
+ * Usage: optimizeEntry(entry);
+ * ----------------------------
+ * Sets the root of the entry to the optimized form of its tree. The
+ * entry is charged with the nodes the optimizer had to create, which
+ * leaves out any nodes it shared with earlier trees.
+ */
+
+void ParseCache::optimizeEntry(Entry *entry) {
+    int before = optimizer.getNodeCount();
+    entry->root = optimizer.optimize(entry->exp);
+    entry->nOptimizedNodes = optimizer.getNodeCount() - before;
+    nLiveNodes += entry->nOptimizedNodes;
+}
+
+/*
+ * Private method: reoptimizeAll
+ * Usage: reoptimizeAll();
+ * -----------------------
+ * Clears the optimizer, which frees the trees of the discarded entries,
+ * and optimizes the trees of the remaining entries again. None of them
+ * can fail, since each was optimized successfully before.
+ */
+
+void ParseCache::reoptimizeAll() {
+    optimizer.clear();
+    nLiveNodes = 0;
+    for (Entry *ep = tail; ep != NULL; ep = ep->prev) {
+        nBytes -= ep->bytes;
+        ep->bytes -= ep->nOptimizedNodes * OPTIMIZED_NODE_BYTES;
+        optimizeEntry(ep);
+        ep->bytes += ep->nOptimizedNodes * OPTIMIZED_NODE_BYTES;
+        nBytes += ep->bytes;
+    }
+}
+
+/*
+ * Private method: expandTable
+ * Usage: expandTable();
+ * ---------------------
+ * Doubles the number of buckets and relinks every entry using the hash
+ * code stored in it.
+ */
+
+void ParseCache::expandTable() {
+    Entry **oldBuckets = buckets;
+    int oldCount = nBuckets;
+    nBuckets *= 2;
+    buckets = new Entry *[nBuckets];
+    for (int i = 0; i < nBuckets; i++) {
+        buckets[i] = NULL;
+    }
+    for (int i = 0; i < oldCount; i++) {
+        Entry *ep = oldBuckets[i];
+        while (ep != NULL) {
+            Entry *next = ep->chain;
+            int bucket = ep->hash & (nBuckets - 1);
+            ep->chain = buckets[bucket];
+            buckets[bucket] = ep;
+            ep = next;
+        }
+    }
+    delete[] oldBuckets;
+}
+
+/*
+ * Private method: treeBytes
+ * Usage: long bytes = treeBytes(exp);
+ * -----------------------------------
+ * Returns the number of bytes in the nodes of a tree built by the parser
+ * on the heap, counting the name of each identifier.
+ */
+
+long ParseCache::treeBytes(Expression *exp) {
+    switch (exp->getType()) {
+        case CONSTANT:
+            return sizeof(ConstantExp);
+        case IDENTIFIER:
+            return sizeof(IdentifierExp)
+                 + exp->getIdentifierName().length() + 1;
+        case COMPOUND:
+            break;
+    }
+    return sizeof(CompoundExp) + treeBytes(exp->getLHS())
+                               + treeBytes(exp->getRHS());
+}
+
+/*
+ * Private method: hashCode
+ * ------------------------
+ * This method computes the djb2 hash of the string and scrambles the
+ * bits, as in StringInterner. The bucket is taken from the low bits,
+ * which djb2 alone leaves poorly mixed for texts that differ only near
+ * the end.
+ */
+
+unsigned ParseCache::hashCode(string_view str) {
+    unsigned hash = 5381;
+    for (char ch : str) {
+        hash = 33 * hash + (unsigned char) ch;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+    return hash;
+}
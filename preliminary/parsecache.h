@@ -0,0 +1,196 @@
+/*
+ * File: parsecache.h
+ * ------------------
+ * This interface exports the ParseCache class, which remembers the trees
+ * for expressions that have been parsed before.
+ */
+
+#ifndef _parsecache_h
+#define _parsecache_h
+
+#include <string>
+#include <string_view>
+#include "exp.h"
+#include "optimizer.h"
+#include "tokenscanner.h"
+
+/*
+ * Class: ParseCache
+ * -----------------
+ * This class maps the text of an expression to its parsed tree, so that
+ * a program that sees the same text many times scans and parses it only
+ * once. The cache holds as many trees as fit in a memory budget and,
+ * when it is full, discards the tree that was used least recently. The
+ * cache can also optimize each tree as it parses it, in which case it
+ * returns the optimized tree:
+ *
+ *      ParseCache cache;
+ *      while (. . . read a line . . .) {
+ *          int value = cache.get(line)->eval(context);
+ *          . . .
+ *      }
+ *
+ * The context remembers the slot of every name it has seen, so a cached
+ * tree also skips looking up its variables by name.
+ */
+
+class ParseCache {
+
+public:
+
+/*
+ * Constructor: ParseCache
+ * Usage: ParseCache cache;
+ *        ParseCache cache(maxBytes);
+ *        ParseCache cache(maxBytes, optimize);
+ * ------------------------------------------
+ * Initializes an empty cache that keeps its trees within approximately
+ * maxBytes bytes, or one megabyte by default. If optimize is true, the
+ * cache passes each tree through an ExpressionOptimizer.
+ */
+
+    ParseCache(long maxBytes = DEFAULT_MAX_BYTES, bool optimize = false);
+
+/*
+ * Destructor: ~ParseCache
+ * -----------------------
+ * Deletes every tree in the cache.
+ */
+
+    ~ParseCache();
+
+/*
+ * Method: get
+ * Usage: Expression *exp = cache.get(text);
+ * -----------------------------------------
+ * Returns the tree for text, parsing it if it is not in the cache. The
+ * tree belongs to the cache and remains valid until the next call to get
+ * or clear. The text must match exactly, including spaces. If text does
+ * not parse, get signals the parser's error and caches nothing.
+ */
+
+    Expression *get(std::string_view text);
+
+/*
+ * Methods: getHitCount, getMissCount
+ * Usage: long hits = cache.getHitCount();
+ *        long misses = cache.getMissCount();
+ * ----------------------------------------
+ * Return the number of calls to get that found their text in the cache
+ * and the number that had to parse it.
+ */
+
+    long getHitCount() const;
+    long getMissCount() const;
+
+/*
+ * Methods: size, getBytesUsed
+ * Usage: int n = cache.size();
+ *        long bytes = cache.getBytesUsed();
+ * ---------------------------------------
+ * Return the number of trees in the cache and an estimate of the memory
+ * they occupy, which counts the nodes, the names of identifiers and the
+ * text that serves as the key.
+ */
+
+    int size() const;
+    long getBytesUsed() const;
+
+/*
+ * Methods: getMaxBytes, setMaxBytes
+ * Usage: long maxBytes = cache.getMaxBytes();
+ *        cache.setMaxBytes(maxBytes);
+ * -------------------------------------------
+ * Get and set the memory budget. Lowering the budget discards trees at
+ * once. The cache always keeps the tree most recently returned, even if
+ * that tree by itself exceeds the budget.
+ */
+
+    long getMaxBytes() const;
+    void setMaxBytes(long maxBytes);
+
+/*
+ * Method: clear
+ * Usage: cache.clear();
+ * ---------------------
+ * Deletes every tree in the cache. The counters are not reset.
+ */
+
+    void clear();
+
+/*
+ * Notes on representation
+ * -----------------------
+ * Each tree is held in an entry, which is linked into two structures: a
+ * chained hash table keyed by the text, and a doubly linked list that
+ * runs from the most recently used entry to the least. A hit moves its
+ * entry to the front of the list, and when the cache is over budget the
+ * entries at the back are discarded. Both operations take constant time.
+ *
+ * Optimized trees are built by a single ExpressionOptimizer, which owns
+ * them and cannot delete them one at a time, so each entry also keeps
+ * its original tree. When the optimizer holds more than twice as many
+ * nodes as the entries still use, the cache clears it and optimizes the
+ * remaining trees again.
+ */
+
+private:
+
+/* Constants */
+
+    static const long DEFAULT_MAX_BYTES = 1 << 20;
+    static const int INITIAL_BUCKET_COUNT = 64;
+
+/* Type for an entry in the cache */
+
+    struct Entry {
+        std::string text;       // The text of the expression
+        unsigned hash;          // The hash code of the text
+        Expression *exp;        // The tree produced by the parser
+        Expression *root;       // The tree returned to the client
+        int nOptimizedNodes;    // The nodes the optimizer made for root
+        long bytes;             // The estimated size of the entry
+        Entry *chain;           // The next entry in the same bucket
+        Entry *prev;            // The next more recently used entry
+        Entry *next;            // The next less recently used entry
+    };
+
+/* Instance variables */
+
+    TokenScanner scanner;           // Reads the text to be parsed
+    ExpressionOptimizer optimizer;  // Produces the optimized trees
+    bool optimizing;                // Whether to optimize each tree
+    Entry **buckets;                // The hash table of entries
+    int nBuckets;                   // The number of buckets
+    int nEntries;                   // The number of entries
+    Entry *head;                    // The most recently used entry
+    Entry *tail;                    // The least recently used entry
+    long nBytes;                    // The estimated size of all entries
+    long maxBytes;                  // The memory budget
+    int nLiveNodes;                 // Optimizer nodes used by the entries
+    long nHits;                     // The number of hits
+    long nMisses;                   // The number of misses
+
+/* Private methods */
+
+    Entry *findEntry(std::string_view text, unsigned hash) const;
+    Entry *addEntry(std::string_view text, unsigned hash, Expression *exp);
+    void removeEntry(Entry *entry);
+    void moveToFront(Entry *entry);
+    void trimToBudget();
+    void optimizeEntry(Entry *entry);
+    void reoptimizeAll();
+    void expandTable();
+    static long treeBytes(Expression *exp);
+    static unsigned hashCode(std::string_view str);
+
+/* Make it illegal to copy parse caches */
+
+    ParseCache(const ParseCache & src) { }
+    ParseCache & operator=(const ParseCache & src) {
+        return *this;
+    }
+
+};
+
+#endif
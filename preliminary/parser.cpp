@@ -6,6 +6,8 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
+#include "arena.h"
 #include "error.h"
 #include "exp.h"
 #include "parser.h"
@@ -13,14 +15,50 @@
 #include "tokenscanner.h"
 using namespace std;
 
+/*
+ * Type: OperatorTable
+ * -------------------
+ * Every operator is a single character, so the parser classifies a token
+ * by indexing these arrays with its character. The constructor is
+ * constexpr, which means the table below is filled in by the compiler
+ * and costs nothing at run time. Characters that are not operators have
+ * precedence 0.
+ */
+
+struct OperatorTable {
+
+    static const int N_CHARS = 128;
+
+    int precedence[N_CHARS];        // The precedence of each operator
+    OperatorType type[N_CHARS];     // The OperatorType of each operator
+
+    constexpr OperatorTable() : precedence(), type() {
+        precedence['='] = 1;  type['='] = ASSIGN;
+        precedence['+'] = 2;  type['+'] = ADD;
+        precedence['-'] = 2;  type['-'] = SUBTRACT;
+        precedence['*'] = 3;  type['*'] = MULTIPLY;
+        precedence['/'] = 3;  type['/'] = DIVIDE;
+    }
+
+};
+
+constexpr OperatorTable OPERATORS;
+
+/* Private function prototypes */
+
+static Expression *newConstant(int value, ExpressionArena *arena);
+static Expression *newIdentifier(string_view name, ExpressionArena *arena);
+static Expression *newCompound(OperatorType op, Expression *lhs,
+                               Expression *rhs, ExpressionArena *arena);
+
 /*
  * Implementation notes: parseExp
  * ------------------------------
  * This code just reads an expression and then checks for extra tokens.
  */
 
-Expression *parseExp(TokenScanner & scanner) {
-    Expression *exp = readE(scanner, 0);
+Expression *parseExp(TokenScanner & scanner, ExpressionArena *arena) {
+    Expression *exp = readE(scanner, 0, arena);
     if (scanner.hasMoreTokens()) {
         error("Unexpected token\"" + scanner.nextToken() + "\"");
     }
@@ -35,18 +73,25 @@ Expression *parseExp(TokenScanner & scanner) {
  * the grammar. At each level, the parser reads operators and subexpressions
  * until it finds an operator whose precedence is greater than that of the
  * prevailing one. When a higher-precedence operator is found, readE calls
- * itself recursively to read that subexpression as a unit.
+ * itself recursively to read that subexpression as a unit. The token is
+ * translated to an OperatorType here, once, so that evaluation never
+ * looks at the operator string. The parser reads tokens as views of the
+ * input, so that scanning allocates no memory; it is done with the text
+ * of the operator before reading the right operand, since a streaming
+ * scanner may then reuse the memory the view refers to.
  */
 
-Expression *readE(TokenScanner & scanner, int prec) {
-    Expression *exp = readT(scanner);
-    string token;
+Expression *readE(TokenScanner & scanner, int prec,
+                  ExpressionArena *arena) {
+    Expression *exp = readT(scanner, arena);
+    Token token;
     while (true) {
-        token = scanner.nextToken();
-        int tprec = precedence(token);
+        token = scanner.readToken();
+        int tprec = precedence(token.text);
         if (tprec <= prec) break;
-        Expression *rhs = readE(scanner, tprec);
-        exp = new CompoundExp(token, exp, rhs);
+        OperatorType op = OPERATORS.type[(unsigned char) token.text[0]];
+        Expression *rhs = readE(scanner, tprec, arena);
+        exp = newCompound(op, exp, rhs, arena);
     }
     scanner.saveToken(token);
     return exp;
@@ -56,17 +101,21 @@ Expression *readE(TokenScanner & scanner, int prec) {
  * Implementation notes: readT
  * ---------------------------
  * This function scans a term, which is either an integer, an identifier,
- * or a paranthesized subexpression.
+ * or a paranthesized subexpression. In an arena, the name of an
+ * identifier is copied straight from the token, with no intermediate
+ * string.
  */
 
-Expression *readT(TokenScanner & scanner) {
-    string token = scanner.nextToken();
-    TokenType type = scanner.getTokenType(token);
-    if (type == WORD) return new IdentifierExp(token);
-    if (type == NUMBER) return new ConstantExp(stringToInteger(token));
-    if (token != "(") error("Unexpected token \"" + token + "\"");
-    Expression *exp = readE(scanner, 0);
-    if (scanner.nextToken() != ")") {
+Expression *readT(TokenScanner & scanner, ExpressionArena *arena) {
+    Token token = scanner.readToken();
+    if (token.type == WORD) return newIdentifier(token.text, arena);
+    string text(token.text);
+    if (token.type == NUMBER) {
+        return newConstant(stringToInteger(text), arena);
+    }
+    if (text != "(") error("Unexpected token \"" + text + "\"");
+    Expression *exp = readE(scanner, 0, arena);
+    if (scanner.readToken().text != ")") {
         error("Unbalanced parantheses");
     }
     return exp;
@@ -75,13 +124,37 @@ Expression *readT(TokenScanner & scanner) {
 /*
  * Implementation notes: precedence
  * --------------------------------
- * This function checks he token against each of the defined operators
- * and returns the appropriate precedence value.
+ * This function looks up a one-character token in the operator table.
+ * Any other token has precedence 0.
+ */
+
+int precedence(string_view token) {
+    if (token.length() != 1) return 0;
+    unsigned char ch = token[0];
+    return (ch < OperatorTable::N_CHARS) ? OPERATORS.precedence[ch] : 0;
+}
+
+/*
+ * Private functions: newConstant, newIdentifier, newCompound
+ * Usage: Expression *exp = newConstant(value, arena);
+ *        Expression *exp = newIdentifier(name, arena);
+ *        Expression *exp = newCompound(op, lhs, rhs, arena);
+ * ---------------------------------------------------------
+ * Create a node in the arena, or with new if the arena is NULL.
  */
 
-int precedence(string token) {
-    if (token == "=") return 1;
-    if (token == "+" || token == "-") return 2;
-    if (token == "*" || token == "/") return 3;
-    return 0;
-}
\ No newline at end of file
+static Expression *newConstant(int value, ExpressionArena *arena) {
+    if (arena != NULL) return arena->newConstant(value);
+    return new ConstantExp(value);
+}
+
+static Expression *newIdentifier(string_view name, ExpressionArena *arena) {
+    if (arena != NULL) return arena->newIdentifier(name);
+    return new IdentifierExp(string(name));
+}
+
+static Expression *newCompound(OperatorType op, Expression *lhs,
+                               Expression *rhs, ExpressionArena *arena) {
+    if (arena != NULL) return arena->newCompound(op, lhs, rhs);
+    return new CompoundExp(op, lhs, rhs);
+}
@@ -0,0 +1,68 @@
+/*
+ * File: parser.h
+ * --------------
+ * This file acts as the interface to the parser module, which reads
+ * an expression from a TokenScanner and builds the corresponding
+ * expression tree.
+ */
+
+#ifndef _parser_h
+#define _parser_h
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "arena.h"
+#include "exp.h"
+#include "tokenscanner.h"
+
+/*
+ * Function: parseExp
+ * Usage: Expression *exp = parseExp(scanner);
+ *        Expression *exp = parseExp(scanner, &arena);
+ * -----------------------------------------------------
+ * Parses an expression by reading tokens from the scanner, which must
+ * be provided by the client. The scanner should be set to ignore
+ * whitespace and to scan numbers. If an arena is given, the nodes of the
+ * tree are created in it and are released when the arena is cleared;
+ * otherwise they are created with new and the client deletes the tree.
+ */
+
+Expression *parseExp(TokenScanner & scanner, ExpressionArena *arena = NULL);
+
+/*
+ * Function: readE
+ * Usage: Expression *exp = readE(scanner, prec);
+ *        Expression *exp = readE(scanner, prec, arena);
+ * -------------------------------------------------------
+ * Returns the next expression from the scanner involving only operators
+ * whose precedence is greater than prec. The nodes are created in the
+ * arena if it is not NULL.
+ */
+
+Expression *readE(TokenScanner & scanner, int prec,
+                  ExpressionArena *arena = NULL);
+
+/*
+ * Function: readT
+ * Usage: Expression *exp = readT(scanner);
+ *        Expression *exp = readT(scanner, arena);
+ * -------------------------------------------------
+ * Returns the next individual term, which is either a constant, an
+ * identifier, or a parenthesized subexpression. The nodes are created in
+ * the arena if it is not NULL.
+ */
+
+Expression *readT(TokenScanner & scanner, ExpressionArena *arena = NULL);
+
+/*
+ * Function: precedence
+ * Usage: int prec = precedence(token);
+ * ------------------------------------
+ * Returns the precedence of the specified operator token. If the token
+ * is not an operator, precedence returns 0.
+ */
+
+int precedence(std::string_view token);
+
+#endif
@@ -0,0 +1,197 @@
+/*
+ * File: partition.cpp
+ * -------------------
+ * This file implements the partition.h interface.
+ */
+
+#include <cmath>
+#include "compactgraph.h"
+#include "error.h"
+#include "partition.h"
+#include "vector.h"
+using namespace std;
+
+/* Constants */
+
+const double FENNEL_GAMMA = 1.5;    // Exponent of the Fennel size penalty
+
+/*
+ * Implementation notes: constructor and destructor
+ * ------------------------------------------------
+ * The constructor places the nodes and then builds the subgraphs, which
+ * needs to know the owner of both ends of every arc.
+ */
+
+GraphPartition::GraphPartition(const CompactGraph & g, int k,
+                               PartitionMethod method, double slack) {
+    if (k < 1) error("GraphPartition: Need at least one part");
+    if (slack < 0) error("GraphPartition: Slack must not be negative");
+    graph = &g;
+    nParts = k;
+    nCut = 0;
+    assignNodes(method, slack);
+    for (int p = 0; p < nParts; p++) {
+        subgraphs.add(new Subgraph);
+    }
+    for (int node = 0; node < g.size(); node++) {
+        subgraphs[parts[node]]->nodes.add(node);
+    }
+    Vector<int> ghostIndex(g.size(), -1);
+    for (int p = 0; p < nParts; p++) {
+        buildSubgraph(p, ghostIndex);
+    }
+}
+
+GraphPartition::~GraphPartition() {
+    for (int p = 0; p < subgraphs.size(); p++) {
+        delete subgraphs[p];
+    }
+}
+
+const CompactGraph & GraphPartition::getGraph() const {
+    return *graph;
+}
+
+int GraphPartition::getPartCount() const {
+    return nParts;
+}
+
+int GraphPartition::getPart(int node) const {
+    return parts[node];
+}
+
+int GraphPartition::getLocalId(int node) const {
+    return localIds[node];
+}
+
+const Subgraph & GraphPartition::getSubgraph(int p) const {
+    if (p < 0 || p >= nParts) error("getSubgraph: Part out of range");
+    return *subgraphs[p];
+}
+
+int GraphPartition::getCutArcCount() const {
+    return nCut;
+}
+
+/*
+ * Private method: assignNodes
+ * Usage: assignNodes(method, slack);
+ * ----------------------------------
+ * Streams over the nodes in order and places each one in the part with
+ * the best score among those that are not yet full. The neighbors of a
+ * node include both the nodes it has arcs to and the nodes that have
+ * arcs to it, since either kind of arc is cut if the two ends are placed
+ * apart; the incoming arcs come from a transpose built at the start.
+ * Ties go to the smaller part, which spreads out nodes that have no
+ * placed neighbors. The Fennel penalty uses the constant
+ *
+ *      alpha = sqrt(k) * m / n^1.5
+ *
+ * recommended by its authors, where m is the number of arcs.
+ */
+
+void GraphPartition::assignNodes(PartitionMethod method, double slack) {
+    int n = graph->size();
+    int m = graph->getArcCount();
+    int capacity = (int) ceil((1 + slack) * n / nParts);
+    if (capacity < 1) capacity = 1;
+    double alpha = (n == 0) ? 0 : sqrt((double) nParts) * m / pow(n, 1.5);
+    Vector<int> inOffsets(n + 1, 0);
+    Vector<int> inStarts(m, 0);
+    for (int a = 0; a < m; a++) {
+        inOffsets[graph->getFinish(a) + 1]++;
+    }
+    for (int v = 0; v < n; v++) {
+        inOffsets[v + 1] += inOffsets[v];
+    }
+    Vector<int> fill = inOffsets;
+    for (int v = 0; v < n; v++) {
+        for (int a = graph->getArcBegin(v); a < graph->getArcEnd(v); a++) {
+            inStarts[fill[graph->getFinish(a)]++] = v;
+        }
+    }
+    parts = Vector<int>(n, -1);
+    localIds = Vector<int>(n, -1);
+    Vector<int> sizes(nParts, 0);
+    Vector<int> counts(nParts, 0);
+    Vector<int> touched;
+    for (int v = 0; v < n; v++) {
+        for (int a = graph->getArcBegin(v); a < graph->getArcEnd(v); a++) {
+            int p = parts[graph->getFinish(a)];
+            if (p >= 0 && counts[p]++ == 0) touched.add(p);
+        }
+        for (int i = inOffsets[v]; i < inOffsets[v + 1]; i++) {
+            int p = parts[inStarts[i]];
+            if (p >= 0 && counts[p]++ == 0) touched.add(p);
+        }
+        int best = -1;
+        double bestScore = 0;
+        for (int p = 0; p < nParts; p++) {
+            if (sizes[p] >= capacity) continue;
+            double score;
+            if (method == LDG) {
+                score = counts[p] * (1 - (double) sizes[p] / capacity);
+            } else {
+                score = counts[p] - alpha * FENNEL_GAMMA
+                                  * pow(sizes[p], FENNEL_GAMMA - 1);
+            }
+            if (best < 0 || score > bestScore
+                    || (score == bestScore && sizes[p] < sizes[best])) {
+                best = p;
+                bestScore = score;
+            }
+        }
+        parts[v] = best;
+        localIds[v] = sizes[best]++;
+        for (int i = 0; i < touched.size(); i++) {
+            counts[touched[i]] = 0;
+        }
+        touched.clear();
+    }
+}
+
+/*
+ * Private method: buildSubgraph
+ * Usage: buildSubgraph(p, ghostIndex);
+ * ------------------------------------
+ * Copies the arcs of the nodes in part p into its subgraph, replacing
+ * each remote finish with a ghost. The ghost numbers are handed out in
+ * order of first appearance, using the table ghostIndex, indexed by
+ * global node number, to find the ghost for a node that has already been
+ * seen. The table is shared by all the parts and must be -1 everywhere
+ * on entry; before returning, the method resets just the entries for the
+ * ghosts of this part, so building every part costs time proportional to
+ * the number of arcs rather than k times the number of nodes.
+ */
+
+void GraphPartition::buildSubgraph(int p, Vector<int> & ghostIndex) {
+    Subgraph & sub = *subgraphs[p];
+    int nLocal = sub.nodes.size();
+    sub.offsets.add(0);
+    for (int i = 0; i < nLocal; i++) {
+        int v = sub.nodes[i];
+        bool onBoundary = false;
+        for (int a = graph->getArcBegin(v); a < graph->getArcEnd(v); a++) {
+            int w = graph->getFinish(a);
+            if (parts[w] == p) {
+                sub.finishes.add(localIds[w]);
+            } else {
+                if (ghostIndex[w] < 0) {
+                    ghostIndex[w] = sub.ghosts.size();
+                    sub.ghosts.add(w);
+                    sub.ghostParts.add(parts[w]);
+                    sub.ghostLocalIds.add(localIds[w]);
+                }
+                sub.finishes.add(nLocal + ghostIndex[w]);
+                onBoundary = true;
+                nCut++;
+            }
+            sub.costs.add(graph->getCost(a));
+        }
+        sub.offsets.add(sub.finishes.size());
+        if (onBoundary) sub.boundary.add(i);
+    }
+    for (int i = 0; i < sub.ghosts.size(); i++) {
+        ghostIndex[sub.ghosts[i]] = -1;
+    }
+}
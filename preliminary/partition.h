@@ -0,0 +1,181 @@
+/*
+ * File: partition.h
+ * -----------------
+ * This interface exports the GraphPartition class, which divides the
+ * nodes of a CompactGraph among a fixed number of parts so that each
+ * part can be processed by its own thread.
+ */
+
+#ifndef _partition_h
+#define _partition_h
+
+#include "compactgraph.h"
+#include "vector.h"
+
+/*
+ * Type: PartitionMethod
+ * ---------------------
+ * This enumerated type selects the heuristic used to place each node.
+ * Both are streaming heuristics, which look at each node once, in order,
+ * and put it in the part that already holds most of its neighbors:
+ *
+ *   LDG      Linear deterministic greedy, which scales the number of
+ *            neighbors in a part by the fraction of the part still free.
+ *   FENNEL   The Fennel objective, which subtracts a penalty that grows
+ *            with the size of the part as size^1.5.
+ *
+ * Fennel usually cuts fewer arcs; LDG produces more even part sizes.
+ */
+
+enum PartitionMethod { LDG, FENNEL };
+
+/*
+ * Type: Subgraph
+ * --------------
+ * This type describes one part of a partitioned graph. The nodes that the
+ * part owns are numbered locally from 0 to nodes.size() - 1, and their
+ * arcs are stored in the same compressed form as in CompactGraph. An arc
+ * whose finish is owned by another part points at a ghost, which is a
+ * local stand-in for the remote node numbered nodes.size() + g, where g
+ * indexes the ghost table. The ghost table records where each remote
+ * node lives, so that a message sent along the arc can be delivered
+ * without any lookup by global number.
+ */
+
+struct Subgraph {
+    Vector<int> nodes;          // The global number of each local node
+    Vector<int> offsets;        // First arc of each local node (n + 1)
+    Vector<int> finishes;       // Local finish of each arc, or n + ghost
+    Vector<double> costs;       // The cost of each arc
+    Vector<int> ghosts;         // The global number of each ghost
+    Vector<int> ghostParts;     // The part that owns each ghost
+    Vector<int> ghostLocalIds;  // The number of each ghost in its owner
+    Vector<int> boundary;       // Local nodes with an arc to a ghost
+};
+
+/*
+ * Class: GraphPartition
+ * ---------------------
+ * This class assigns every node of a CompactGraph to one of k parts and
+ * builds a Subgraph for each part, including its boundary tables. The
+ * graph must not be changed or destroyed while the partition exists.
+ */
+
+class GraphPartition {
+
+public:
+
+/*
+ * Constant: DEFAULT_SLACK
+ * -----------------------
+ * The fraction by which a part may exceed n / k nodes.
+ */
+
+    static constexpr double DEFAULT_SLACK = 0.1;
+
+/*
+ * Constructor: GraphPartition
+ * Usage: GraphPartition partition(g, k);
+ *        GraphPartition partition(g, k, method, slack);
+ * -----------------------------------------------------
+ * Divides the nodes of g into k parts using the specified method, which
+ * defaults to FENNEL. No part receives more than (1 + slack) * n / k
+ * nodes, rounded up.
+ */
+
+    GraphPartition(const CompactGraph & g, int k,
+                   PartitionMethod method = FENNEL,
+                   double slack = DEFAULT_SLACK);
+
+/*
+ * Destructor: ~GraphPartition
+ * ---------------------------
+ * Frees the subgraphs. The graph itself is unaffected.
+ */
+
+    ~GraphPartition();
+
+/*
+ * Method: getGraph
+ * Usage: const CompactGraph & g = partition.getGraph();
+ * -----------------------------------------------------
+ * Returns the graph that was partitioned.
+ */
+
+    const CompactGraph & getGraph() const;
+
+/*
+ * Method: getPartCount
+ * Usage: int k = partition.getPartCount();
+ * ----------------------------------------
+ * Returns the number of parts.
+ */
+
+    int getPartCount() const;
+
+/*
+ * Methods: getPart, getLocalId
+ * Usage: int p = partition.getPart(node);
+ *        int local = partition.getLocalId(node);
+ * ----------------------------------------------
+ * Return the part that owns a node and the node's number within it.
+ */
+
+    int getPart(int node) const;
+    int getLocalId(int node) const;
+
+/*
+ * Method: getSubgraph
+ * Usage: const Subgraph & sub = partition.getSubgraph(p);
+ * -------------------------------------------------------
+ * Returns the subgraph for part p.
+ */
+
+    const Subgraph & getSubgraph(int p) const;
+
+/*
+ * Method: getCutArcCount
+ * Usage: int cut = partition.getCutArcCount();
+ * --------------------------------------------
+ * Returns the number of arcs whose ends lie in different parts, which
+ * is the number of messages that cross between threads when every node
+ * sends along every arc.
+ */
+
+    int getCutArcCount() const;
+
+/* Private section */
+
+private:
+
+/*
+ * Notes on representation
+ * -----------------------
+ * The part and local number of every node are kept in two arrays indexed
+ * by global node number. The streaming pass keeps a count of how many
+ * neighbors of the current node fall in each part, and it clears only
+ * the entries it touched, so placing a node costs time proportional to
+ * its degree plus k. Building the subgraphs uses the same technique with
+ * a single table that maps global node numbers to ghosts.
+ */
+
+    const CompactGraph *graph;      // The graph that was partitioned
+    int nParts;                     // The number of parts
+    Vector<int> parts;              // The part that owns each node
+    Vector<int> localIds;           // The local number of each node
+    Vector<Subgraph *> subgraphs;   // The subgraph for each part
+    int nCut;                       // The number of cut arcs
+
+/* Private methods */
+
+    void assignNodes(PartitionMethod method, double slack);
+    void buildSubgraph(int p, Vector<int> & ghostIndex);
+
+/* Make it illegal to copy partitions */
+
+    GraphPartition(const GraphPartition & src) { }
+    GraphPartition & operator=(const GraphPartition & src) { return *this; }
+
+};
+
+#endif
@@ -0,0 +1,235 @@
+/*
+ * File: pool.h
+ * ------------
+ * This interface exports the Pool template class, a slab allocator that
+ * hands out objects of a single type from large preallocated chunks.
+ */
+
+#ifndef _pool_h
+#define _pool_h
+
+#include <new>
+#include <type_traits>
+
+/*
+ * Class: Pool<ValueType>
+ * ----------------------
+ * This class allocates objects of the specified value type from a list
+ * of chunks, each of which holds many objects. Allocating an object is
+ * usually just an increment of a counter, and the heap is touched only
+ * when the current chunk runs out of space. Objects are never returned
+ * to the pool individually; the clear method releases all of them at once.
+ */
+
+template <typename ValueType>
+class Pool {
+
+public:
+
+/*
+ * Constructor: Pool
+ * Usage: Pool<ValueType> pool;
+ * ----------------------------
+ * Initializes a new empty pool. No chunk is allocated until the first
+ * call to allocate.
+ */
+
+    Pool();
+
+/*
+ * Destructor: ~Pool
+ * Usage: (usually implicit)
+ * -------------------------
+ * Destroys every object allocated from this pool and frees the chunks.
+ */
+
+    ~Pool();
+
+/*
+ * Method: allocate
+ * Usage: ValueType *ptr = pool.allocate();
+ * ----------------------------------------
+ * Returns a pointer to a new default-constructed object. The object
+ * belongs to the pool and must not be freed using delete.
+ */
+
+    ValueType *allocate();
+
+/*
+ * Method: clear
+ * Usage: pool.clear();
+ * --------------------
+ * Destroys every object allocated from this pool and frees the chunks.
+ * Apart from the destructor calls, which are skipped for trivially
+ * destructible types, this operation runs in time proportional to the
+ * number of chunks.
+ */
+
+    void clear();
+
+/*
+ * Method: size
+ * Usage: int n = pool.size();
+ * ---------------------------
+ * Returns the number of objects currently allocated from this pool.
+ */
+
+    int size() const;
+
+/*
+ * Method: getChunkCount
+ * Usage: int n = pool.getChunkCount();
+ * ------------------------------------
+ * Returns the number of chunks currently held by this pool. Each chunk
+ * costs two heap allocations: one for its header and one for its storage.
+ */
+
+    int getChunkCount() const;
+
+/* Private section */
+
+/*
+ * Implementation notes: Pool data structure
+ * -----------------------------------------
+ * The chunks are kept in a linked list with the most recent chunk at
+ * the head, which is the only one with free space. Each new chunk is
+ * twice as large as the one before it, up to MAX_CHUNK_SIZE objects,
+ * so the number of chunks grows only logarithmically until that limit
+ * is reached. The storage in each chunk is raw memory; objects are
+ * constructed in place by allocate and destroyed in place by clear.
+ */
+
+private:
+
+    static const int INITIAL_CHUNK_SIZE = 64;
+    static const int MAX_CHUNK_SIZE = 65536;
+
+/* Type for chunks in the list */
+
+    struct Chunk {
+        ValueType *array;       // Raw storage for capacity objects
+        int capacity;           // The number of objects in the chunk
+        int count;              // The number of objects in use
+        Chunk *link;            // The next (older) chunk
+    };
+
+/* Instance variables */
+
+    Chunk *chunks;          // The most recently allocated chunk
+    int nObjects;           // The number of objects in all chunks
+    int nChunks;            // The number of chunks in the list
+
+/* Private methods */
+
+    void addChunk();
+
+/* Make it illegal to copy pools */
+
+    Pool(const Pool & src) { }
+    Pool & operator=(const Pool & src) { return *this; }
+
+};
+
+/*
+ * Implementation notes: Pool constructor and destructor
+ * -----------------------------------------------------
+ * The constructor creates an empty chunk list, and the destructor calls
+ * clear to release whatever the pool has allocated.
+ */
+
+template <typename ValueType>
+Pool<ValueType>::Pool() {
+    chunks = NULL;
+    nObjects = 0;
+    nChunks = 0;
+}
+
+template <typename ValueType>
+Pool<ValueType>::~Pool() {
+    clear();
+}
+
+/*
+ * Implementation notes: allocate
+ * ------------------------------
+ * The allocate method adds a new chunk if the current one is full and
+ * then constructs the object in the next free slot using placement new.
+ */
+
+template <typename ValueType>
+ValueType *Pool<ValueType>::allocate() {
+    if (chunks == NULL || chunks->count == chunks->capacity) addChunk();
+    ValueType *ptr = new (chunks->array + chunks->count) ValueType();
+    chunks->count++;
+    nObjects++;
+    return ptr;
+}
+
+/*
+ * Implementation notes: clear
+ * ---------------------------
+ * The clear method walks the chunk list, destroying the objects in each
+ * chunk before freeing its storage. The destructor loop disappears at
+ * compile time for types that have nothing to destroy.
+ */
+
+template <typename ValueType>
+void Pool<ValueType>::clear() {
+    Chunk *cp = chunks;
+    while (cp != NULL) {
+        Chunk *next = cp->link;
+        if (!std::is_trivially_destructible<ValueType>::value) {
+            for (int i = 0; i < cp->count; i++) {
+                cp->array[i].~ValueType();
+            }
+        }
+        ::operator delete(cp->array);
+        delete cp;
+        cp = next;
+    }
+    chunks = NULL;
+    nObjects = 0;
+    nChunks = 0;
+}
+
+/*
+ * Implementation notes: size, getChunkCount
+ * -----------------------------------------
+ * These methods simply return the counters kept by the pool.
+ */
+
+template <typename ValueType>
+int Pool<ValueType>::size() const {
+    return nObjects;
+}
+
+template <typename ValueType>
+int Pool<ValueType>::getChunkCount() const {
+    return nChunks;
+}
+
+/*
+ * Private method: addChunk
+ * ------------------------
+ * This method allocates a new chunk twice the size of the current one
+ * and pushes it on the front of the chunk list.
+ */
+
+template <typename ValueType>
+void Pool<ValueType>::addChunk() {
+    int capacity = INITIAL_CHUNK_SIZE;
+    if (chunks != NULL) {
+        capacity = 2 * chunks->capacity;
+        if (capacity > MAX_CHUNK_SIZE) capacity = MAX_CHUNK_SIZE;
+    }
+    Chunk *cp = new Chunk;
+    cp->array = static_cast<ValueType *>(
+                    ::operator new(capacity * sizeof(ValueType)));
+    cp->capacity = capacity;
+    cp->count = 0;
+    cp->link = chunks;
+    chunks = cp;
+    nChunks++;
+}
+
+#endif
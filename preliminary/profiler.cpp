@@ -0,0 +1,267 @@
+/*
+ * File: profiler.cpp
+ * ------------------
+ * This file implements the profiler.h interface.
+ */
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "exp.h"
+#include "interner.h"
+#include "profiler.h"
+#include "vector.h"
+using namespace std;
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLE_COUNTER_AVAILABLE
+#endif
+
+/* Private function prototypes */
+
+static long long readCycles();
+static string categoryName(int category);
+
+/* Class variables */
+
+thread_local EvalProfiler *EvalProfiler::running = NULL;
+
+/*
+ * Implementation notes: constructor and destructor
+ * ------------------------------------------------
+ * The counts are cleared by reset, which the constructor shares.
+ */
+
+EvalProfiler::EvalProfiler() {
+    reset();
+}
+
+EvalProfiler::~EvalProfiler() {
+    stop();
+}
+
+bool EvalProfiler::isAvailable() {
+#ifdef EVAL_PROFILE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void EvalProfiler::start() {
+    running = this;
+}
+
+void EvalProfiler::stop() {
+    if (running == this) running = NULL;
+}
+
+void EvalProfiler::reset() {
+    for (int i = 0; i < N_CATEGORIES; i++) {
+        counts[i] = 0;
+        cycles[i] = 0;
+    }
+    nNameLookups = 0;
+    nSlotAccesses = 0;
+    chains.clear();
+    chainCycles.clear();
+    stack.clear();
+    overhead = 0;
+}
+
+/*
+ * Implementation notes: getNodeCount, getNodeCycles
+ * -------------------------------------------------
+ * The compound nodes are recorded by operator, so their figures are the
+ * sums over the operator categories.
+ */
+
+long EvalProfiler::getNodeCount(ExpressionType type) const {
+    if (type != COMPOUND) return counts[type];
+    long total = 0;
+    for (int i = FIRST_OPERATOR; i < N_CATEGORIES; i++) {
+        total += counts[i];
+    }
+    return total;
+}
+
+long EvalProfiler::getNodeCycles(ExpressionType type) const {
+    if (type != COMPOUND) return cycles[type];
+    long total = 0;
+    for (int i = FIRST_OPERATOR; i < N_CATEGORIES; i++) {
+        total += cycles[i];
+    }
+    return total;
+}
+
+long EvalProfiler::getOperatorCount(OperatorType op) const {
+    return counts[FIRST_OPERATOR + op];
+}
+
+long EvalProfiler::getOperatorCycles(OperatorType op) const {
+    return cycles[FIRST_OPERATOR + op];
+}
+
+long EvalProfiler::getNameLookupCount() const {
+    return nNameLookups;
+}
+
+long EvalProfiler::getSlotAccessCount() const {
+    return nSlotAccesses;
+}
+
+/*
+ * Implementation notes: writeSummary
+ * ----------------------------------
+ * The compound nodes are reported only by operator, since their total
+ * is the sum of those lines.
+ */
+
+void EvalProfiler::writeSummary(ostream & out) const {
+    out << left << setw(12) << "node" << right << setw(14) << "count"
+        << setw(16) << "cycles" << setw(12) << "per node" << endl;
+    for (int i = 0; i < N_CATEGORIES; i++) {
+        if (i == COMPOUND) continue;
+        out << left << setw(12) << categoryName(i) << right
+            << setw(14) << counts[i] << setw(16) << cycles[i]
+            << setw(12) << ((counts[i] == 0) ? 0 : cycles[i] / counts[i])
+            << endl;
+    }
+    out << "name lookups: " << nNameLookups << endl;
+    out << "slot accesses: " << nSlotAccesses << endl;
+}
+
+/*
+ * Implementation notes: writeFoldedStacks
+ * ---------------------------------------
+ * A chain is always created after the chain that encloses it, so the
+ * names can be built in order, each from the name of its parent. Equal
+ * subtrees at different addresses form separate chains with the same
+ * name, whose cycles are added together under one line.
+ */
+
+void EvalProfiler::writeFoldedStacks(ostream & out) const {
+    Vector<string> names;
+    StringInterner lines;
+    Vector<long long> lineCycles;
+    for (int i = 0; i < chainCycles.size(); i++) {
+        int parent;
+        Expression *exp;
+        getChainKey(i, parent, exp);
+        string name = exp->toString();
+        if (parent != -1) name = names[parent] + ';' + name;
+        names.add(name);
+        int line = lines.intern(name);
+        if (line == lineCycles.size()) lineCycles.add(0);
+        lineCycles[line] += chainCycles[i];
+    }
+    for (int i = 0; i < lineCycles.size(); i++) {
+        if (lineCycles[i] > 0) {
+            out << lines.getName(i) << ' ' << lineCycles[i] << endl;
+        }
+    }
+}
+
+/*
+ * Private method: enter
+ * Usage: enter(exp, category);
+ * ----------------------------
+ * Records the start of the evaluation of exp. Its chain is found from
+ * the key made up of the enclosing chain, or -1 at the top level, and
+ * the address of exp. The cycles spent here are added to the profiler's
+ * overhead, so that they are not charged to the enclosing nodes.
+ */
+
+void EvalProfiler::enter(Expression *exp, int category) {
+    long long before = readCycles();
+    int parent = stack.isEmpty() ? -1 : stack[stack.size() - 1].chain;
+    char key[KEY_SIZE];
+    memcpy(key, &parent, sizeof parent);
+    memcpy(key + sizeof parent, &exp, sizeof exp);
+    Activation activation = Activation();
+    activation.chain = chains.intern(string_view(key, KEY_SIZE));
+    activation.category = category;
+    if (activation.chain == chainCycles.size()) chainCycles.add(0);
+    stack.add(activation);
+    Activation & top = stack[stack.size() - 1];
+    long long after = readCycles();
+    overhead += after - before;
+    top.start = after;
+    top.overhead = overhead;
+}
+
+/*
+ * Private method: exit
+ * Usage: exit();
+ * --------------
+ * Records the end of the evaluation of the node on top of the stack.
+ * Its own cycles are the elapsed cycles less the profiler's overhead in
+ * the meantime and the cycles of its operands, which are in turn added
+ * to the node that encloses it.
+ */
+
+void EvalProfiler::exit() {
+    long long before = readCycles();
+    Activation activation = stack[stack.size() - 1];
+    stack.remove(stack.size() - 1);
+    long long total = before - activation.start
+                    - (overhead - activation.overhead);
+    long long self = total - activation.children;
+    counts[activation.category]++;
+    cycles[activation.category] += self;
+    chainCycles[activation.chain] += self;
+    if (!stack.isEmpty()) stack[stack.size() - 1].children += total;
+    overhead += readCycles() - before;
+}
+
+/*
+ * Private method: getChainKey
+ * Usage: getChainKey(chain, parent, exp);
+ * ---------------------------------------
+ * Unpacks the key of a chain into the enclosing chain and the node.
+ */
+
+void EvalProfiler::getChainKey(int chain, int & parent,
+                               Expression * & exp) const {
+    string_view key = chains.getName(chain);
+    memcpy(&parent, key.data(), sizeof parent);
+    memcpy(&exp, key.data() + sizeof parent, sizeof exp);
+}
+
+/*
+ * Private function: readCycles
+ * Usage: long long now = readCycles();
+ * ------------------------------------
+ * Returns the processor's time-stamp counter where one is available and
+ * the steady clock in nanoseconds elsewhere.
+ */
+
+static long long readCycles() {
+#ifdef CYCLE_COUNTER_AVAILABLE
+    return __rdtsc();
+#else
+    return chrono::duration_cast<chrono::nanoseconds>(
+               chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/*
+ * Private function: categoryName
+ * Usage: string name = categoryName(category);
+ * --------------------------------------------
+ * Returns the name of a category in the summary.
+ */
+
+static string categoryName(int category) {
+    switch (category) {
+        case CONSTANT: return "constant";
+        case IDENTIFIER: return "identifier";
+        case COMPOUND: return "compound";
+    }
+    OperatorType op = OperatorType(category - COMPOUND - 1);
+    return "operator " + operatorToString(op);
+}
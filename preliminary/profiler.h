@@ -0,0 +1,270 @@
+/*
+ * File: profiler.h
+ * ----------------
+ * This interface exports the EvalProfiler class, which measures where
+ * the time goes when expressions are evaluated.
+ */
+
+#ifndef _profiler_h
+#define _profiler_h
+
+#include <ostream>
+#include <string>
+#include "exp.h"
+#include "interner.h"
+#include "vector.h"
+
+/*
+ * Class: EvalProfiler
+ * -------------------
+ * This class records, for every node evaluated while it is running, the
+ * number of evaluations and the processor cycles spent, grouped by node
+ * type and by operator. It also counts the operations on an
+ * EvaluationContext, separating the lookups of variables by name from
+ * the cheaper accesses by slot. Finally, it records the cycles for each
+ * chain of nested subexpressions in the "folded stack" format read by
+ * flame-graph tools, where each frame is named by the toString form of
+ * a subexpression, which shows which formulas are worth optimizing:
+ *
+ *      EvalProfiler profiler;
+ *      profiler.start();
+ *      . . . evaluate expressions . . .
+ *      profiler.stop();
+ *      profiler.writeSummary(cout);
+ *      profiler.writeFoldedStacks(outfile);
+ *
+ * The instrumentation is compiled into exp.cpp only when the macro
+ * EVAL_PROFILE is defined, so an ordinary build pays nothing for it. In
+ * other builds the profiler records nothing, which the client can detect
+ * with isAvailable. A profiler sees only the evaluations on the thread
+ * that started it.
+ */
+
+class EvalProfiler {
+
+public:
+
+/*
+ * Constructor: EvalProfiler
+ * Usage: EvalProfiler profiler;
+ * -----------------------------
+ * Initializes a profiler that is not yet running.
+ */
+
+    EvalProfiler();
+
+/*
+ * Destructor: ~EvalProfiler
+ * -------------------------
+ * Stops the profiler if it is running and frees its storage.
+ */
+
+    ~EvalProfiler();
+
+/*
+ * Method: isAvailable
+ * Usage: if (EvalProfiler::isAvailable()) . . .
+ * ---------------------------------------------
+ * Returns true if the expression classes were compiled with the
+ * instrumentation.
+ */
+
+    static bool isAvailable();
+
+/*
+ * Methods: start, stop
+ * Usage: profiler.start();
+ *        profiler.stop();
+ * ------------------------
+ * Start and stop recording the evaluations on the calling thread. The
+ * counts accumulate over every period between start and stop. Starting
+ * one profiler stops any other running on the same thread. Neither
+ * method may be called while an expression is being evaluated.
+ */
+
+    void start();
+    void stop();
+
+/*
+ * Method: reset
+ * Usage: profiler.reset();
+ * ------------------------
+ * Discards everything the profiler has recorded.
+ */
+
+    void reset();
+
+/*
+ * Methods: getNodeCount, getNodeCycles
+ * Usage: long n = profiler.getNodeCount(type);
+ *        long cycles = profiler.getNodeCycles(type);
+ * ------------------------------------------------
+ * Return the number of nodes of the specified type that have been
+ * evaluated and the cycles spent in them, not counting the cycles spent
+ * in their subexpressions. The figures for COMPOUND are the totals over
+ * all the operators.
+ */
+
+    long getNodeCount(ExpressionType type) const;
+    long getNodeCycles(ExpressionType type) const;
+
+/*
+ * Methods: getOperatorCount, getOperatorCycles
+ * Usage: long n = profiler.getOperatorCount(op);
+ *        long cycles = profiler.getOperatorCycles(op);
+ * --------------------------------------------------
+ * Return the same figures for the compound nodes with the specified
+ * operator.
+ */
+
+    long getOperatorCount(OperatorType op) const;
+    long getOperatorCycles(OperatorType op) const;
+
+/*
+ * Methods: getNameLookupCount, getSlotAccessCount
+ * Usage: long n = profiler.getNameLookupCount();
+ *        long n = profiler.getSlotAccessCount();
+ * ----------------------------------------------
+ * Return the number of operations on evaluation contexts that looked up
+ * a variable by name, which hashes the name, and the number that used a
+ * slot directly.
+ */
+
+    long getNameLookupCount() const;
+    long getSlotAccessCount() const;
+
+/*
+ * Method: writeSummary
+ * Usage: profiler.writeSummary(out);
+ * ----------------------------------
+ * Writes a table of the counts and cycles by node type and operator,
+ * followed by the counts of context operations.
+ */
+
+    void writeSummary(std::ostream & out) const;
+
+/*
+ * Method: writeFoldedStacks
+ * Usage: profiler.writeFoldedStacks(out);
+ * ---------------------------------------
+ * Writes one line for each chain of nested subexpressions that was
+ * evaluated, giving the subexpressions from the outermost in, separated
+ * by semicolons, followed by a space and the cycles spent in the
+ * innermost one itself. Chains that print the same are reported on one
+ * line. The expressions that were evaluated must still exist.
+ */
+
+    void writeFoldedStacks(std::ostream & out) const;
+
+/*
+ * Class: EvalProfiler::Frame
+ * --------------------------
+ * The instrumented eval methods create a Frame on entry, which reports
+ * the node to the running profiler, if there is one, and reports the
+ * end of the evaluation when it is destroyed, even by an error.
+ */
+
+    class Frame {
+    public:
+        Frame(Expression *exp, ExpressionType type) {
+            profiler = running;
+            if (profiler != NULL) profiler->enter(exp, type);
+        }
+        Frame(Expression *exp, OperatorType op) {
+            profiler = running;
+            if (profiler != NULL) profiler->enter(exp, FIRST_OPERATOR + op);
+        }
+        ~Frame() {
+            if (profiler != NULL) profiler->exit();
+        }
+    private:
+        EvalProfiler *profiler;
+    };
+
+/*
+ * Methods: countNameLookup, countSlotAccess
+ * Usage: EvalProfiler::countNameLookup();
+ *        EvalProfiler::countSlotAccess();
+ * ---------------------------------------
+ * Called by the instrumented EvaluationContext methods to count their
+ * operations.
+ */
+
+    static void countNameLookup() {
+        if (running != NULL) running->nNameLookups++;
+    }
+
+    static void countSlotAccess() {
+        if (running != NULL) running->nSlotAccesses++;
+    }
+
+/*
+ * Notes on representation
+ * -----------------------
+ * The counts are kept in arrays indexed by a category, which numbers
+ * the node types followed by the operators. The compound nodes are
+ * counted only by operator. Each chain of nested subexpressions is
+ * identified by the chain that encloses it and the node that ends it.
+ * The bytes of that pair are kept as a key in a StringInterner, whose
+ * identifiers index the cycles for each chain, so entering a node costs
+ * one hash of a few bytes. The text of the chains is built only when
+ * the folded stacks are written. While an expression is evaluated, the
+ * profiler keeps a stack of the nodes that have not yet returned.
+ *
+ * Cycles are read from the processor's time-stamp counter where there is
+ * one and from the steady clock elsewhere. The profiler times its own
+ * work and subtracts it from every node that encloses it. What remains
+ * in each node includes the calls into the profiler and a reading of
+ * the counter, several dozen cycles, so the figures are best compared
+ * with one another.
+ */
+
+private:
+
+/* Constants */
+
+    static const int FIRST_OPERATOR = COMPOUND + 1;
+    static const int N_CATEGORIES = FIRST_OPERATOR + DIVIDE + 1;
+    static const int KEY_SIZE = sizeof(int) + sizeof(Expression *);
+
+/* Type for a node that has not yet returned */
+
+    struct Activation {
+        int chain;              // The chain of subexpressions it ends
+        int category;           // The category of the node
+        long long start;        // The cycle count when it was entered
+        long long overhead;     // The profiler's cycles at that point
+        long long children;     // The cycles spent in its operands
+    };
+
+/* Instance variables */
+
+    long counts[N_CATEGORIES];      // The evaluations in each category
+    long long cycles[N_CATEGORIES]; // The cycles in each category
+    long nNameLookups;              // Context operations by name
+    long nSlotAccesses;             // Context operations by slot
+    StringInterner chains;          // The key of each chain
+    Vector<long long> chainCycles;  // The cycles of each chain
+    Vector<Activation> stack;       // The nodes being evaluated
+    long long overhead;             // The profiler's own cycles
+
+/* Class variables */
+
+    static thread_local EvalProfiler *running;  // The profiler, if any
+
+/* Private methods */
+
+    void enter(Expression *exp, int category);
+    void exit();
+    void getChainKey(int chain, int & parent, Expression * & exp) const;
+
+/* Make it illegal to copy profilers */
+
+    EvalProfiler(const EvalProfiler & src) { }
+    EvalProfiler & operator=(const EvalProfiler & src) {
+        return *this;
+    }
+
+};
+
+#endif
@@ -0,0 +1,325 @@
+/*
+ * File: reactive.cpp
+ * ------------------
+ * This file implements the reactive.h interface.
+ */
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "error.h"
+#include "exp.h"
+#include "reactive.h"
+#include "vector.h"
+using namespace std;
+
+/*
+ * Implementation notes: constructor and destructor
+ * ------------------------------------------------
+ * The per-slot vectors grow as the context gives out slots, so the
+ * constructor has nothing to allocate.
+ */
+
+ReactiveContext::ReactiveContext() {
+    generation = 0;
+    nEvaluations = 0;
+}
+
+ReactiveContext::~ReactiveContext() {
+    for (int i = 0; i < formulas.size(); i++) {
+        if (formulas[i] != NULL) {
+            delete formulas[i]->exp;
+            delete formulas[i];
+        }
+    }
+}
+
+/*
+ * Implementation notes: defineFormula
+ * -----------------------------------
+ * Everything that can fail is checked before the context changes. The
+ * formula would depend on itself if it read its own variable or any
+ * formula that already depends on that variable, which are exactly the
+ * slots reachable from it along the lists of readers.
+ */
+
+void ReactiveContext::defineFormula(string_view name, Expression *exp) {
+    Vector<int> reads;
+    collectReads(exp, reads);
+    int slot = getSlot(name);
+    markReachable(slot);
+    for (int i = 0; i < reads.size(); i++) {
+        if (visited[reads[i]] == generation) {
+            error("Formula for " + string(name) + " refers to itself");
+        }
+    }
+    if (formulas[slot] != NULL) {
+        Formula *old = formulas[slot];
+        for (int i = 0; i < old->reads.size(); i++) {
+            removeReader(old->reads[i], slot);
+        }
+        delete old->exp;
+        delete old;
+    }
+    Formula *formula = new Formula;
+    formula->exp = exp;
+    formula->reads = reads;
+    formulas[slot] = formula;
+    for (int i = 0; i < reads.size(); i++) {
+        readers[reads[i]].add(slot);
+    }
+    int newHeight = 0;
+    for (int i = 0; i < reads.size(); i++) {
+        newHeight = max(newHeight, height[reads[i]] + 1);
+    }
+    if (newHeight > height[slot]) {
+        height[slot] = newHeight;
+        raiseHeights(slot);
+    }
+    schedule(slot);
+    update();
+}
+
+void ReactiveContext::setValue(string_view var, int value) {
+    int slot = getSlot(var);
+    if (formulas[slot] != NULL) {
+        error(string(var) + " is defined by a formula");
+    }
+    if (context.isDefined(slot) && context.getValue(slot) == value) return;
+    context.setValue(slot, value);
+    scheduleReaders(slot);
+    update();
+}
+
+int ReactiveContext::getValue(string_view var) const {
+    return context.getValue(var);
+}
+
+bool ReactiveContext::isFormula(string_view var) const {
+    int slot = context.findSlot(var);
+    return slot >= 0 && slot < formulas.size() && formulas[slot] != NULL;
+}
+
+bool ReactiveContext::isDefined(string_view var) const {
+    return context.isDefined(var);
+}
+
+string ReactiveContext::getError(string_view var) const {
+    if (!isFormula(var)) return "";
+    return formulas[context.findSlot(var)]->error;
+}
+
+long ReactiveContext::getEvaluationCount() const {
+    return nEvaluations;
+}
+
+const EvaluationContext & ReactiveContext::getContext() const {
+    return context;
+}
+
+/*
+ * Private method: getSlot
+ * Usage: int slot = getSlot(var);
+ * -------------------------------
+ * Returns the slot of the named variable, creating it if necessary.
+ */
+
+int ReactiveContext::getSlot(string_view var) {
+    int slot = context.getSlot(var);
+    addSlots();
+    return slot;
+}
+
+/*
+ * Private method: addSlots
+ * Usage: addSlots();
+ * ------------------
+ * Extends the per-slot vectors to cover every slot in the context.
+ */
+
+void ReactiveContext::addSlots() {
+    while (formulas.size() < context.getSlotCount()) {
+        formulas.add(NULL);
+        readers.add(Vector<int>());
+        height.add(0);
+        waiting.add(false);
+        visited.add(-1);
+    }
+}
+
+/*
+ * Private method: collectReads
+ * Usage: collectReads(exp, reads);
+ * --------------------------------
+ * Binds exp to the context and stores in reads the slots of the
+ * variables it reads, each listed once. This method signals an error if
+ * exp contains an assignment, since a formula must not change any
+ * variable other than its own.
+ */
+
+void ReactiveContext::collectReads(Expression *exp, Vector<int> & reads) {
+    Vector<Expression *> stack;
+    Vector<int> all;
+    stack.add(exp);
+    while (!stack.isEmpty()) {
+        Expression *node = stack[stack.size() - 1];
+        stack.remove(stack.size() - 1);
+        if (node->getType() == IDENTIFIER) {
+            all.add(static_cast<IdentifierExp *>(node)->getSlot(context));
+        } else if (node->getType() == COMPOUND) {
+            if (node->getOperatorType() == ASSIGN) {
+                error("A formula cannot contain an assignment");
+            }
+            stack.add(node->getLHS());
+            stack.add(node->getRHS());
+        }
+    }
+    addSlots();
+    generation++;
+    reads.clear();
+    for (int i = 0; i < all.size(); i++) {
+        if (visited[all[i]] != generation) {
+            visited[all[i]] = generation;
+            reads.add(all[i]);
+        }
+    }
+}
+
+/*
+ * Private method: markReachable
+ * Usage: markReachable(start);
+ * ----------------------------
+ * Starts a new search and marks with its generation every slot that can
+ * be reached from start by following the lists of readers, including
+ * start itself. The search keeps its own stack, so that a long chain of
+ * formulas cannot overflow the call stack.
+ */
+
+void ReactiveContext::markReachable(int start) {
+    generation++;
+    Vector<int> stack;
+    visited[start] = generation;
+    stack.add(start);
+    while (!stack.isEmpty()) {
+        int slot = stack[stack.size() - 1];
+        stack.remove(stack.size() - 1);
+        for (int i = 0; i < readers[slot].size(); i++) {
+            int reader = readers[slot][i];
+            if (visited[reader] != generation) {
+                visited[reader] = generation;
+                stack.add(reader);
+            }
+        }
+    }
+}
+
+/*
+ * Private method: raiseHeights
+ * Usage: raiseHeights(slot);
+ * --------------------------
+ * Restores the rule that a formula is higher than every variable it
+ * reads after the height of slot has gone up. Only the formulas whose
+ * heights change are visited.
+ */
+
+void ReactiveContext::raiseHeights(int slot) {
+    Vector<int> stack;
+    stack.add(slot);
+    while (!stack.isEmpty()) {
+        int top = stack[stack.size() - 1];
+        stack.remove(stack.size() - 1);
+        for (int i = 0; i < readers[top].size(); i++) {
+            int reader = readers[top][i];
+            if (height[reader] <= height[top]) {
+                height[reader] = height[top] + 1;
+                stack.add(reader);
+            }
+        }
+    }
+}
+
+/*
+ * Private method: update
+ * Usage: update();
+ * ----------------
+ * Evaluates the formulas in the heap, lowest first. A formula whose
+ * value changes adds the formulas that read it, which are all higher.
+ */
+
+void ReactiveContext::update() {
+    while (!heap.empty()) {
+        int slot = heap.top().second;
+        heap.pop();
+        waiting[slot] = false;
+        if (evaluate(slot)) scheduleReaders(slot);
+    }
+}
+
+/*
+ * Private method: evaluate
+ * Usage: if (evaluate(slot)) . . .
+ * --------------------------------
+ * Evaluates the formula in the specified slot, stores its value, and
+ * returns true if the variable changed. A failure leaves the variable
+ * undefined and records the message.
+ */
+
+bool ReactiveContext::evaluate(int slot) {
+    Formula *formula = formulas[slot];
+    bool wasDefined = context.isDefined(slot);
+    int oldValue = context.getValue(slot);
+    nEvaluations++;
+    try {
+        int value = formula->exp->eval(context);
+        formula->error = "";
+        context.setValue(slot, value);
+        return !wasDefined || value != oldValue;
+    } catch (ErrorException & ex) {
+        formula->error = ex.getMessage();
+        context.clearValue(slot);
+        return wasDefined;
+    }
+}
+
+/*
+ * Private methods: schedule, scheduleReaders
+ * Usage: schedule(slot);
+ *        scheduleReaders(slot);
+ * -----------------------------
+ * Add to the heap the formula in slot or every formula that reads slot,
+ * skipping any formula that is already waiting.
+ */
+
+void ReactiveContext::schedule(int slot) {
+    if (!waiting[slot]) {
+        waiting[slot] = true;
+        heap.push(HeapEntry(height[slot], slot));
+    }
+}
+
+void ReactiveContext::scheduleReaders(int slot) {
+    for (int i = 0; i < readers[slot].size(); i++) {
+        schedule(readers[slot][i]);
+    }
+}
+
+/*
+ * Private method: removeReader
+ * Usage: removeReader(slot, reader);
+ * ----------------------------------
+ * Removes the formula reader from the list of readers of slot.
+ */
+
+void ReactiveContext::removeReader(int slot, int reader) {
+    Vector<int> & list = readers[slot];
+    for (int i = 0; i < list.size(); i++) {
+        if (list[i] == reader) {
+            list.remove(i);
+            return;
+        }
+    }
+}
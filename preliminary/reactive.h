@@ -0,0 +1,203 @@
+/*
+ * File: reactive.h
+ * ----------------
+ * This interface exports the ReactiveContext class, which keeps the
+ * values of named formulas up to date as the variables they read change.
+ */
+
+#ifndef _reactive_h
+#define _reactive_h
+
+#include <functional>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "exp.h"
+#include "vector.h"
+
+/*
+ * Class: ReactiveContext
+ * ----------------------
+ * This class works like a spreadsheet. Each variable is either an input,
+ * whose value the client sets, or a formula, whose value is that of an
+ * expression over other variables. The context records which variables
+ * each formula reads, and when a variable changes, it evaluates again
+ * only the formulas that depend on it, each after the formulas it reads.
+ * The value of every other formula stays as it was computed before:
+ *
+ *      ReactiveContext sheet;
+ *      sheet.setValue("price", 20);
+ *      sheet.setValue("qty", 3);
+ *      sheet.defineFormula("total", parseExp(scanner));  // price * qty
+ *      sheet.setValue("qty", 4);       // Evaluates total again
+ *      int total = sheet.getValue("total");
+ *
+ * A formula that fails, for example by dividing by zero or by reading an
+ * undefined variable, leaves its variable undefined, so the formulas
+ * that read it fail as well until the cause is corrected.
+ */
+
+class ReactiveContext {
+
+public:
+
+/*
+ * Constructor: ReactiveContext
+ * Usage: ReactiveContext sheet;
+ * -----------------------------
+ * Initializes a context with no variables and no formulas.
+ */
+
+    ReactiveContext();
+
+/*
+ * Destructor: ~ReactiveContext
+ * ----------------------------
+ * Deletes the expressions of every formula.
+ */
+
+    ~ReactiveContext();
+
+/*
+ * Method: defineFormula
+ * Usage: sheet.defineFormula(name, exp);
+ * --------------------------------------
+ * Makes the named variable a formula whose value is that of exp,
+ * replacing any value or formula the variable had, and then brings up
+ * to date the formula and every formula that depends on it. The context
+ * takes ownership of the expression. This method signals an error, and
+ * leaves the expression to the client, if exp contains an assignment or
+ * if the formula would depend on itself.
+ */
+
+    void defineFormula(std::string_view name, Expression *exp);
+
+/*
+ * Method: setValue
+ * Usage: sheet.setValue(var, value);
+ * ----------------------------------
+ * Sets the value of an input and evaluates again the formulas that
+ * depend on it. Nothing is evaluated if the value does not change. This
+ * method signals an error if var is a formula.
+ */
+
+    void setValue(std::string_view var, int value);
+
+/*
+ * Method: getValue
+ * Usage: int value = sheet.getValue(var);
+ * ---------------------------------------
+ * Returns the current value of an input or a formula, without
+ * evaluating anything. An undefined variable or a failed formula has
+ * the value 0.
+ */
+
+    int getValue(std::string_view var) const;
+
+/*
+ * Methods: isFormula, isDefined, getError
+ * Usage: if (sheet.isFormula(var)) . . .
+ *        if (sheet.isDefined(var)) . . .
+ *        std::string msg = sheet.getError(var);
+ * ----------------------------------------------
+ * Return whether var is a formula, whether it has a value, and, for a
+ * formula that failed, the error message, which is empty otherwise.
+ */
+
+    bool isFormula(std::string_view var) const;
+    bool isDefined(std::string_view var) const;
+    std::string getError(std::string_view var) const;
+
+/*
+ * Method: getEvaluationCount
+ * Usage: long n = sheet.getEvaluationCount();
+ * -------------------------------------------
+ * Returns the number of times the context has evaluated a formula, which
+ * shows how much work the updates have saved.
+ */
+
+    long getEvaluationCount() const;
+
+/*
+ * Method: getContext
+ * Usage: const EvaluationContext & context = sheet.getContext();
+ * --------------------------------------------------------------
+ * Returns the underlying context, which holds the value of every
+ * variable. The client may read it but must change values through
+ * setValue.
+ */
+
+    const EvaluationContext & getContext() const;
+
+/*
+ * Notes on representation
+ * -----------------------
+ * The variables are the slots of an EvaluationContext, and the formulas
+ * are bound to it. For each slot, the context keeps the formula that
+ * defines it, if any, and the list of formulas that read it, which are
+ * the arcs of the dependency graph. Each slot also has a height: inputs
+ * have height 0, and a formula is higher than every variable it reads.
+ * An update keeps the formulas waiting to be evaluated in a heap ordered
+ * by height, so that a formula is evaluated only after every formula it
+ * reads that was waiting with it. A formula is put in the heap only when
+ * a variable it reads changes value, so a formula whose value comes out
+ * the same stops the update from spreading, and the update never looks
+ * at the formulas beyond that point. Defining a formula raises the
+ * heights of its dependents if necessary, but heights are never lowered,
+ * since a height that is too high does no harm. The search for cycles
+ * marks the slots it visits with a generation number, so that no array
+ * has to be cleared between searches.
+ */
+
+private:
+
+/* Type for a formula */
+
+    struct Formula {
+        Expression *exp;        // The expression for the formula
+        Vector<int> reads;      // The slots the expression reads
+        std::string error;      // The message from the last failure
+    };
+
+/* Type for an entry in the heap, which pairs a height with a slot */
+
+    typedef std::pair<int,int> HeapEntry;
+
+/* Instance variables */
+
+    EvaluationContext context;      // The values of the variables
+    Vector<Formula *> formulas;     // The formula for each slot, or NULL
+    Vector< Vector<int> > readers;  // The formulas that read each slot
+    Vector<int> height;             // The height of each slot
+    Vector<bool> waiting;           // Whether each formula is in the heap
+    Vector<int> visited;            // The last search to visit each slot
+    std::priority_queue<HeapEntry,std::vector<HeapEntry>,
+                        std::greater<HeapEntry> > heap;
+    int generation;             // The number of the current search
+    long nEvaluations;          // The number of formulas evaluated
+
+/* Private methods */
+
+    int getSlot(std::string_view var);
+    void addSlots();
+    void collectReads(Expression *exp, Vector<int> & reads);
+    void markReachable(int start);
+    void raiseHeights(int slot);
+    void update();
+    bool evaluate(int slot);
+    void schedule(int slot);
+    void scheduleReaders(int slot);
+    void removeReader(int slot, int reader);
+
+/* Make it illegal to copy reactive contexts */
+
+    ReactiveContext(const ReactiveContext & src) { }
+    ReactiveContext & operator=(const ReactiveContext & src) {
+        return *this;
+    }
+
+};
+
+#endif
@@ -0,0 +1,412 @@
+/*
+ * File: script.cpp
+ * ----------------
+ * This file implements the script.h interface.
+ */
+
+#include <atomic>
+#include <cctype>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include "arena.h"
+#include "barrier.h"
+#include "error.h"
+#include "exp.h"
+#include "parser.h"
+#include "script.h"
+#include "tokenscanner.h"
+#include "vector.h"
+using namespace std;
+
+/* Constants */
+
+const int STATEMENTS_PER_GRAB = 64; // Statements a thread takes at once
+const int LINES_PER_READER = 4096;  // Fewest lines worth a parsing thread
+
+/* Private function prototypes */
+
+static bool isBlank(const string & line);
+static int chooseThreadCount(int nThreads);
+
+/*
+ * Implementation notes: constructor and destructor
+ * ------------------------------------------------
+ * The arrays that sort the statements by level are allocated by run, and
+ * the arenas for parsing threads by read.
+ */
+
+Script::Script(EvaluationContext & context) {
+    this->context = &context;
+    scanner.ignoreWhitespace();
+    scanner.scanNumbers();
+    nLevels = 0;
+    order = NULL;
+    levelStart = NULL;
+}
+
+Script::~Script() {
+    for (int i = 0; i < statements.size(); i++) {
+        delete statements[i].error;
+    }
+    delete[] order;
+    delete[] levelStart;
+    for (int i = 0; i < readArenas.size(); i++) {
+        delete readArenas[i];
+    }
+}
+
+/*
+ * Implementation notes: read
+ * --------------------------
+ * On one thread, read hands each line to addStatement as it arrives.
+ * Otherwise it first copies the lines into one string, since the end of
+ * the script is known only when the stream runs out or a line says
+ * "quit", and divides them into one run of consecutive lines for each
+ * thread. Each thread parses its lines into its own arena and stores the
+ * trees in statements that read has already added. Parsing touches
+ * nothing that the threads share except the name numbers, whose
+ * interners have their own locks. The levels depend on the order of the
+ * statements, so they are assigned afterward, in order, on the calling
+ * thread, which also gives every variable its slot in the context before
+ * any thread runs a statement.
+ */
+
+void Script::read(istream & infile, int nThreads) {
+    nThreads = chooseThreadCount(nThreads);
+    string line;
+    if (nThreads == 1) {
+        while (getline(infile, line)) {
+            if (line == "quit") break;
+            if (!isBlank(line)) addStatement(line);
+        }
+        return;
+    }
+    string text;
+    Vector<long> lineEnds;
+    while (getline(infile, line)) {
+        if (line == "quit") break;
+        if (!isBlank(line)) {
+            text += line;
+            lineEnds.add(text.length());
+        }
+    }
+    int nLines = lineEnds.size();
+    int maxUseful = nLines / LINES_PER_READER;
+    if (nThreads > maxUseful) nThreads = (maxUseful == 0) ? 1 : maxUseful;
+    int base = statements.size();
+    Statement statement;
+    statement.exp = NULL;
+    statement.value = 0;
+    statement.level = 0;
+    statement.error = NULL;
+    for (int i = 0; i < nLines; i++) {
+        statements.add(statement);
+    }
+    Vector<thread *> threads;
+    for (int t = 0; t < nThreads; t++) {
+        int first = (long) nLines * t / nThreads;
+        int last = (long) nLines * (t + 1) / nThreads;
+        ExpressionArena *lineArena = new ExpressionArena();
+        readArenas.add(lineArena);
+        threads.add(new thread(&Script::parseLines, this, string_view(text),
+                               &lineEnds, first, last, base, lineArena));
+    }
+    for (int t = 0; t < threads.size(); t++) {
+        threads[t]->join();
+        delete threads[t];
+    }
+    for (int i = base; i < statements.size(); i++) {
+        if (statements[i].exp != NULL) {
+            statements[i].level = assignLevel(statements[i].exp);
+        }
+    }
+}
+
+/*
+ * Implementation notes: addStatement
+ * ----------------------------------
+ * The scanner borrows the text, which is safe because the arena copies
+ * the names of identifiers. A statement that fails to parse may leave
+ * some nodes in the arena, which are released with the others.
+ */
+
+void Script::addStatement(const string & text) {
+    Statement statement;
+    statement.exp = NULL;
+    statement.value = 0;
+    statement.level = 0;
+    statement.error = NULL;
+    scanner.borrowInput(text);
+    try {
+        statement.exp = parseExp(scanner, &arena);
+        statement.level = assignLevel(statement.exp);
+    } catch (ErrorException & ex) {
+        statement.error = new string(ex.getMessage());
+    }
+    statements.add(statement);
+}
+
+int Script::size() const {
+    return statements.size();
+}
+
+/*
+ * Implementation notes: run
+ * -------------------------
+ * With one thread, the statements simply run in source order. Otherwise
+ * each thread runs the levels in turn. The barrier both separates the levels
+ * and makes the values written in one level visible to the threads that
+ * read them in the next.
+ */
+
+void Script::run(int nThreads) {
+    nThreads = chooseThreadCount(nThreads);
+    int maxUseful = (statements.size() + STATEMENTS_PER_GRAB - 1)
+                  / STATEMENTS_PER_GRAB;
+    if (nThreads > maxUseful) nThreads = maxUseful;
+    if (nThreads <= 1) {
+        for (int i = 0; i < statements.size(); i++) {
+            runStatement(i);
+        }
+    } else {
+        sortByLevel();
+        Barrier barrier(nThreads);
+        next = 0;
+        Vector<thread *> threads;
+        for (int i = 0; i < nThreads; i++) {
+            threads.add(new thread(&Script::runThread, this, &barrier));
+        }
+        for (int i = 0; i < threads.size(); i++) {
+            threads[i]->join();
+            delete threads[i];
+        }
+    }
+}
+
+int Script::getLevelCount() const {
+    return nLevels;
+}
+
+bool Script::hasError(int i) const {
+    return statements[i].error != NULL;
+}
+
+int Script::getValue(int i) const {
+    if (hasError(i)) error("getValue: Statement failed");
+    return statements[i].value;
+}
+
+string Script::getError(int i) const {
+    return hasError(i) ? *statements[i].error : "";
+}
+
+/*
+ * Private method: parseLines
+ * Usage: parseLines(text, lineEnds, first, last, base, lineArena);
+ * ----------------------------------------------------------------
+ * Parses lines first through last - 1 of text, where line i ends at
+ * lineEnds[i], into lineArena, storing the tree or the error message of
+ * line i in statement base + i. Each thread that read starts runs this
+ * method on its own lines with its own scanner and arena.
+ */
+
+void Script::parseLines(string_view text, const Vector<long> *lineEnds,
+                        int first, int last, int base,
+                        ExpressionArena *lineArena) {
+    TokenScanner lineScanner;
+    lineScanner.ignoreWhitespace();
+    lineScanner.scanNumbers();
+    for (int i = first; i < last; i++) {
+        Statement & statement = statements[base + i];
+        long start = (i == 0) ? 0 : (*lineEnds)[i - 1];
+        lineScanner.borrowInput(text.substr(start, (*lineEnds)[i] - start));
+        try {
+            statement.exp = parseExp(lineScanner, lineArena);
+        } catch (ErrorException & ex) {
+            statement.error = new string(ex.getMessage());
+        }
+    }
+}
+
+/*
+ * Private method: assignLevel
+ * Usage: int level = assignLevel(exp);
+ * ------------------------------------
+ * Returns the level of a new statement and records its variables. A
+ * statement that reads a variable must follow the last statement to
+ * assign it; one that assigns a variable must follow both that statement
+ * and every statement that has read the variable since. Only the highest
+ * of these levels matters, because the others are lower still.
+ */
+
+int Script::assignLevel(Expression *exp) {
+    reads.clear();
+    writes.clear();
+    collectVariables(exp);
+    int level = 0;
+    for (int k = 0; k < reads.size(); k++) {
+        level = max(level, lastWriter[reads[k]] + 1);
+    }
+    for (int k = 0; k < writes.size(); k++) {
+        level = max(level, lastWriter[writes[k]] + 1);
+        level = max(level, lastReader[writes[k]] + 1);
+    }
+    for (int k = 0; k < writes.size(); k++) {
+        lastWriter[writes[k]] = level;
+        lastReader[writes[k]] = -1;
+    }
+    for (int k = 0; k < reads.size(); k++) {
+        lastReader[reads[k]] = max(lastReader[reads[k]], level);
+    }
+    if (level >= nLevels) nLevels = level + 1;
+    return level;
+}
+
+/*
+ * Private method: collectVariables
+ * Usage: collectVariables(exp);
+ * -----------------------------
+ * Adds the slots of the variables that exp reads to reads and those it
+ * assigns to writes. The left side of an assignment that is not an
+ * identifier is treated as a read, which is harmless, since evaluating
+ * it is an error.
+ */
+
+void Script::collectVariables(Expression *exp) {
+    switch (exp->getType()) {
+        case CONSTANT:
+            return;
+        case IDENTIFIER:
+            reads.add(variableSlot(exp));
+            return;
+        case COMPOUND:
+            break;
+    }
+    Expression *lhs = exp->getLHS();
+    if (exp->getOperatorType() == ASSIGN && lhs->getType() == IDENTIFIER) {
+        writes.add(variableSlot(lhs));
+    } else {
+        collectVariables(lhs);
+    }
+    collectVariables(exp->getRHS());
+}
+
+/*
+ * Private method: variableSlot
+ * Usage: int slot = variableSlot(exp);
+ * ------------------------------------
+ * Binds the identifier exp to the context and returns its slot, making
+ * room to record the levels of statements that use any new slot.
+ */
+
+int Script::variableSlot(Expression *exp) {
+    int slot = static_cast<IdentifierExp *>(exp)->getSlot(*context);
+    while (lastWriter.size() <= slot) {
+        lastWriter.add(-1);
+        lastReader.add(-1);
+    }
+    return slot;
+}
+
+/*
+ * Private method: sortByLevel
+ * Usage: sortByLevel();
+ * ---------------------
+ * Fills order with the statements sorted by level and levelStart with
+ * the position of each level in order. The counting sort keeps the
+ * statements in source order within each level.
+ */
+
+void Script::sortByLevel() {
+    int n = statements.size();
+    delete[] order;
+    delete[] levelStart;
+    order = new int[(n == 0) ? 1 : n];
+    levelStart = new int[nLevels + 2];
+    for (int level = 0; level <= nLevels + 1; level++) {
+        levelStart[level] = 0;
+    }
+    for (int i = 0; i < n; i++) {
+        levelStart[statements[i].level + 2]++;
+    }
+    for (int level = 1; level <= nLevels; level++) {
+        levelStart[level + 1] += levelStart[level];
+    }
+    for (int i = 0; i < n; i++) {
+        order[levelStart[statements[i].level + 1]++] = i;
+    }
+}
+
+/*
+ * Private method: runThread
+ * Usage: runThread(barrier);
+ * --------------------------
+ * Runs the statements this thread claims in each level and waits for the
+ * other threads at the end of the level. The last thread to arrive
+ * resets the shared counter for the next level.
+ */
+
+void Script::runThread(Barrier *barrier) {
+    for (int level = 0; level < nLevels; level++) {
+        int start = levelStart[level];
+        int count = levelStart[level + 1] - start;
+        while (true) {
+            int first = next.fetch_add(STATEMENTS_PER_GRAB);
+            if (first >= count) break;
+            int last = min(first + STATEMENTS_PER_GRAB, count);
+            for (int k = first; k < last; k++) {
+                runStatement(order[start + k]);
+            }
+        }
+        barrier->wait([this] { next = 0; });
+    }
+}
+
+/*
+ * Private method: runStatement
+ * Usage: runStatement(i);
+ * -----------------------
+ * Evaluates statement i and records its value or its error. A statement
+ * that did not parse keeps the message from the parser.
+ */
+
+void Script::runStatement(int i) {
+    Statement & statement = statements[i];
+    if (statement.exp == NULL) return;
+    delete statement.error;
+    statement.error = NULL;
+    try {
+        statement.value = statement.exp->eval(*context);
+    } catch (ErrorException & ex) {
+        statement.error = new string(ex.getMessage());
+    }
+}
+
+/*
+ * Private function: isBlank
+ * Usage: if (isBlank(line)) . . .
+ * -------------------------------
+ * Returns true if the line contains only whitespace.
+ */
+
+static bool isBlank(const string & line) {
+    for (size_t i = 0; i < line.length(); i++) {
+        if (!isspace((unsigned char) line[i])) return false;
+    }
+    return true;
+}
+
+/*
+ * Private function: chooseThreadCount
+ * Usage: nThreads = chooseThreadCount(nThreads);
+ * ----------------------------------------------
+ * Replaces a thread count of zero or less with the number of processors.
+ */
+
+static int chooseThreadCount(int nThreads) {
+    if (nThreads <= 0) nThreads = thread::hardware_concurrency();
+    if (nThreads <= 0) nThreads = 1;
+    return nThreads;
+}
@@ -0,0 +1,210 @@
+/*
+ * File: script.h
+ * --------------
+ * This interface exports the Script class, which runs a file of
+ * statements as a batch, evaluating independent statements in parallel.
+ */
+
+#ifndef _script_h
+#define _script_h
+
+#include <atomic>
+#include <istream>
+#include <string>
+#include <string_view>
+#include "arena.h"
+#include "barrier.h"
+#include "exp.h"
+#include "tokenscanner.h"
+#include "vector.h"
+
+/*
+ * Class: Script
+ * -------------
+ * This class holds a sequence of statements, each of which is an
+ * expression like those typed at the interpreter, and runs them with the
+ * same results as evaluating them one at a time in order. Before running
+ * the statements, the script builds the dependency graph among them:
+ * a statement depends on an earlier one if it reads a variable the
+ * earlier statement assigns, or if it assigns a variable the earlier
+ * statement reads or assigns. Statements that do not depend on each
+ * other, directly or indirectly, are evaluated in parallel. The value
+ * or error message of each statement is kept, so that the client can
+ * report the results in source order:
+ *
+ *      Script script(context);
+ *      script.read(infile);
+ *      script.run();
+ *      for (int i = 0; i < script.size(); i++) {
+ *          . . . report script.getValue(i) or script.getError(i) . . .
+ *      }
+ */
+
+class Script {
+
+public:
+
+/*
+ * Constructor: Script
+ * Usage: Script script(context);
+ * ------------------------------
+ * Initializes an empty script whose statements are evaluated in the
+ * specified context, which holds the variables before the script starts
+ * and after it ends. The context must exist as long as the script.
+ */
+
+    Script(EvaluationContext & context);
+
+/*
+ * Destructor: ~Script
+ * -------------------
+ * Frees the statements and any other storage used by this script.
+ */
+
+    ~Script();
+
+/*
+ * Method: read
+ * Usage: script.read(infile);
+ *        script.read(infile, nThreads);
+ * -------------------------------------
+ * Adds a statement for every line of the stream, up to the end of the
+ * stream or a line containing only "quit". Blank lines are skipped. The
+ * lines are parsed on nThreads threads, or one per processor if nThreads
+ * is 0, and the dependencies among the statements are then found on the
+ * calling thread. The results are the same as calling addStatement for
+ * each line in turn.
+ */
+
+    void read(std::istream & infile, int nThreads = 0);
+
+/*
+ * Method: addStatement
+ * Usage: script.addStatement(text);
+ * ---------------------------------
+ * Parses text and adds it to the end of the script. A statement that
+ * cannot be parsed is kept with its error message and has no effect
+ * when the script runs.
+ */
+
+    void addStatement(const std::string & text);
+
+/*
+ * Method: size
+ * Usage: int n = script.size();
+ * -----------------------------
+ * Returns the number of statements in the script.
+ */
+
+    int size() const;
+
+/*
+ * Method: run
+ * Usage: script.run();
+ *        script.run(nThreads);
+ * ----------------------------
+ * Evaluates every statement in the script's context. The statements
+ * are divided among nThreads threads; if nThreads is 0, the script uses
+ * one thread per processor. An error in one statement is recorded and
+ * does not stop the others.
+ */
+
+    void run(int nThreads = 0);
+
+/*
+ * Method: getLevelCount
+ * Usage: int n = script.getLevelCount();
+ * --------------------------------------
+ * Returns the number of statements in the longest chain of dependent
+ * statements. The statements cannot run in fewer than this many
+ * parallel steps.
+ */
+
+    int getLevelCount() const;
+
+/*
+ * Methods: hasError, getValue, getError
+ * Usage: if (script.hasError(i)) . . .
+ *        int value = script.getValue(i);
+ *        std::string msg = script.getError(i);
+ * ---------------------------------------------
+ * Return the outcome of statement i in the last call to run: whether it
+ * failed, its value if it did not, and its error message if it did.
+ */
+
+    bool hasError(int i) const;
+    int getValue(int i) const;
+    std::string getError(int i) const;
+
+/*
+ * Notes on representation
+ * -----------------------
+ * The expression trees are built in an arena, or, when read parses on
+ * several threads, in an arena for each thread. The dependency graph is
+ * represented by giving each statement a level one greater than the
+ * highest level of the statements it depends on, which is computed as
+ * each statement is added, while its tree is still in the cache. Finding
+ * the variables of a statement binds its identifiers to the context, so
+ * that each name is looked up once, and the variables are known by their
+ * slots. For each slot, the script keeps the level of the last statement
+ * to assign it and the highest level of the statements that have read
+ * it since then.
+ *
+ * Since every tree is bound before the script runs, the threads never
+ * add a slot to the context; each thread writes only to the slots of the
+ * statements it evaluates, and the levels keep two threads from touching
+ * the same slot at once. The statements in a level are independent, so
+ * the threads take them in small groups from a shared counter and meet
+ * at a barrier, which resets the counter, before starting on the next
+ * level. A statement keeps its error message on the heap, since few
+ * statements fail, which keeps the array of statements small.
+ */
+
+private:
+
+/* Type for one statement */
+
+    struct Statement {
+        Expression *exp;        // The tree, or NULL if it did not parse
+        int value;              // The value of the statement
+        int level;              // The number of the statement's level
+        std::string *error;     // The error message, or NULL if none
+    };
+
+/* Instance variables */
+
+    ExpressionArena arena;      // Holds the trees of the statements
+    Vector<ExpressionArena *> readArenas;   // Trees parsed by threads
+    TokenScanner scanner;       // Reads the text of each statement
+    Vector<Statement> statements;   // The statements in source order
+    Vector<int> lastWriter;     // Level of the last assignment to each
+    Vector<int> lastReader;     // Highest level to read each since then
+    Vector<int> reads, writes;  // The slots used by one statement
+    int nLevels;                // The number of levels
+    int *order;                 // The statements sorted by level
+    int *levelStart;            // The index in order of each level
+    EvaluationContext *context; // The context of the statements
+    std::atomic<int> next;      // The next statement to take in a level
+
+/* Private methods */
+
+    void parseLines(std::string_view text, const Vector<long> *lineEnds,
+                    int first, int last, int base,
+                    ExpressionArena *lineArena);
+    int assignLevel(Expression *exp);
+    void collectVariables(Expression *exp);
+    int variableSlot(Expression *exp);
+    void sortByLevel();
+    void runThread(Barrier *barrier);
+    void runStatement(int i);
+
+/* Make it illegal to copy scripts */
+
+    Script(const Script & src) { }
+    Script & operator=(const Script & src) {
+        return *this;
+    }
+
+};
+
+#endif
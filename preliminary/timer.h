@@ -0,0 +1,32 @@
+/*
+ * File: timer.h
+ * -------------
+ * This interface exports the elapsedMs function, which the benchmark
+ * programs use to time their work.
+ */
+
+#ifndef _timer_h
+#define _timer_h
+
+#include <chrono>
+
+/*
+ * Function: elapsedMs
+ * Usage: double ms = elapsedMs(start);
+ * ------------------------------------
+ * Returns the number of milliseconds since start, which is a reading of
+ * the steady clock, as in
+ *
+ *      std::chrono::steady_clock::time_point start =
+ *          std::chrono::steady_clock::now();
+ *      . . . do the work to be timed . . .
+ *      double ms = elapsedMs(start);
+ */
+
+inline double elapsedMs(std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double,std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+#endif
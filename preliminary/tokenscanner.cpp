@@ -5,59 +5,229 @@
  * are straightforward enough to require no additional documentation.
  */
 
-#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <istream>
 #include <string>
+#include <unistd.h>
+#include "error.h"
 #include "tokenscanner.h"
 using namespace std;
 
+/* Constants */
+
+const long STREAM_WINDOW_SIZE = 64 * 1024;  // Initial size of the window
+
+const unsigned char SPACE = 1;      // Flag for whitespace characters
+const unsigned char DIGIT = 2;      // Flag for the digits 0 through 9
+const unsigned char LETTER = 4;     // Flag for the letters A-Z and a-z
+const unsigned char ALNUM = DIGIT | LETTER;
+
+/*
+ * Type: CharacterTable
+ * --------------------
+ * The scanner classifies a character by indexing this table with its
+ * value as an unsigned char, which replaces the calls to isspace, isdigit
+ * and isalnum. Unlike those functions, the table does not depend on the
+ * locale, and it has no undefined behavior for negative char values: only
+ * the ASCII space, tab, newline, vertical tab, form feed and return are
+ * whitespace, only ASCII digits and letters can begin numbers and words,
+ * and every byte from 128 to 255 is an operator. As in parser.cpp, the
+ * constructor is constexpr, so the compiler fills in the table.
+ */
+
+struct CharacterTable {
+
+    static const int N_CHARS = 256;
+
+    unsigned char flags[N_CHARS];   // The class flags of each character
+
+    constexpr CharacterTable() : flags() {
+        for (int ch = '\t'; ch <= '\r'; ch++) {
+            flags[ch] = SPACE;
+        }
+        flags[' '] = SPACE;
+        for (int ch = '0'; ch <= '9'; ch++) {
+            flags[ch] = DIGIT;
+        }
+        for (int ch = 'a'; ch <= 'z'; ch++) {
+            flags[ch] = LETTER;
+            flags[ch - 'a' + 'A'] = LETTER;
+        }
+    }
+
+};
+
+constexpr CharacterTable CHARACTERS;
+
+/*
+ * Implementation notes: vector scanning
+ * -------------------------------------
+ * Most of the characters in a typical input belong to long runs of
+ * whitespace or of letters and digits, and the scanner finds the end of
+ * such a run 16 bytes at a time. With GCC or Clang on a little-endian
+ * machine, the vector extensions compare 16 characters against the class
+ * at once, which compiles to a handful of SSE2 or NEON instructions. The
+ * comparison leaves 0xFF in each byte that matches, so the first byte
+ * that does not match is found by counting the trailing one bits of the
+ * result, read as two 64-bit words. The last few bytes of the input, and
+ * every byte on other compilers, are classified through the table.
+ */
+
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) \
+                      && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define VECTOR_SCAN
+const int VECTOR_BYTES = 16;
+typedef unsigned char Bytes __attribute__((vector_size(VECTOR_BYTES)));
+#endif
+
+/* Private function prototypes */
+
+static long skipRun(const char *str, long start, long end,
+                    unsigned char mask);
+
+/*
+ * Functions: isSpaceChar, isDigitChar, isAlnumChar
+ * Usage: if (isSpaceChar(ch)) . . .
+ * ---------------------------------
+ * These functions classify a character using the table.
+ */
+
+static inline bool isSpaceChar(char ch) {
+    return (CHARACTERS.flags[(unsigned char) ch] & SPACE) != 0;
+}
+
+static inline bool isDigitChar(char ch) {
+    return (CHARACTERS.flags[(unsigned char) ch] & DIGIT) != 0;
+}
+
+static inline bool isAlnumChar(char ch) {
+    return (CHARACTERS.flags[(unsigned char) ch] & ALNUM) != 0;
+}
+
 TokenScanner::TokenScanner() {
-    /* Empty */
+    ignoreWhitespaceFlag = false;
+    scanNumbersFlag = false;
+    window = NULL;
+    windowSize = 0;
+    borrowInput("");
 }
 
 TokenScanner::TokenScanner(string str) {
+    ignoreWhitespaceFlag = false;
+    scanNumbersFlag = false;
+    window = NULL;
+    windowSize = 0;
     setInput(str);
 }
 
+TokenScanner::~TokenScanner() {
+    delete[] window;
+}
+
 void TokenScanner::setInput(string str) {
+    input.swap(str);
+    borrowInput(input);
+}
+
+void TokenScanner::borrowInput(string_view str) {
     buffer = str;
     cp = 0;
+    stream = NULL;
+    fd = -1;
+    streamEnded = true;
+    savedTokens.clear();
+    savedStrings.clear();
+}
+
+void TokenScanner::setInput(istream & infile) {
+    startStream();
+    stream = &infile;
+}
+
+void TokenScanner::setInputDescriptor(int fd) {
+    startStream();
+    this->fd = fd;
 }
 
 bool TokenScanner::hasMoreTokens() {
+    int nSaved = savedTokens.size();
+    if (nSaved > 0) {
+        if (savedTokens[nSaved - 1].copied) {
+            return savedStrings[savedStrings.size() - 1] != "";
+        }
+        return savedTokens[nSaved - 1].token.type != END_OF_INPUT;
+    }
     if (ignoreWhitespaceFlag) skipWhitespace();
-    return cp < buffer.length();
+    return !atEnd();
+}
+
+string TokenScanner::nextToken() {
+    return string(readToken().text);
 }
 
 /*
- * Implementation notes: nextToken
+ * Implementation notes: readToken
  * -------------------------------
  * This method starts by looking at the current character, which is
- * indicated by the index cp. If the index is past the end of the string,
- * nextToken returns the empty string. If the character is alphanumeric,
- * nextToken scans ahead until it finds the end of a word; if not,
- * nextToken returns the character as a one-character string.
+ * indicated by the index cp, unless a token has been saved, in which case
+ * it returns that token instead. If the index is past the end of the
+ * string, readToken returns the empty token. If the character is a
+ * digit and numbers are being scanned, readToken returns the number. If
+ * the character is alphanumeric, readToken scans ahead until it finds
+ * the end of a word; if not, readToken returns the character as a
+ * one-character token. In every case the text is a substring of the
+ * view, which costs nothing. When the input is streamed, a word or a
+ * number that reaches the end of the window is continued after refill
+ * has moved it to the start of the window and read more input; refill
+ * updates start and cp to match.
  */
 
-string TokenScanner::nextToken() {
+Token TokenScanner::readToken() {
+    int nSaved = savedTokens.size();
+    if (nSaved > 0) {
+        SavedToken saved = savedTokens[nSaved - 1];
+        savedTokens.remove(nSaved - 1);
+        if (!saved.copied) return saved.token;
+        current.swap(savedStrings[savedStrings.size() - 1]);
+        savedStrings.remove(savedStrings.size() - 1);
+        Token token;
+        token.text = current;
+        token.type = (current == "") ? END_OF_INPUT : getTokenType(current);
+        return token;
+    }
     if (ignoreWhitespaceFlag) skipWhitespace();
-    if (cp >= buffer.length()) {
-        return "";
-    } else if (isalnum(buffer[cp])) {
-        int start = cp;
-        while (cp < buffer.length() && isalnum(buffer[cp])) {
-            cp++;
+    Token token;
+    if (atEnd()) {
+        token.type = END_OF_INPUT;
+        return token;
+    }
+    long start = cp;
+    if (scanNumbersFlag && isDigitChar(buffer[cp])) {
+        cp = scanNumber(start);
+        token.type = NUMBER;
+    } else if (isAlnumChar(buffer[cp])) {
+        cp = skipRun(buffer.data(), cp + 1, buffer.length(), ALNUM);
+        while (cp == (long) buffer.length() && refill(start)) {
+            cp = skipRun(buffer.data(), cp, buffer.length(), ALNUM);
         }
-        return buffer.substr(start, cp - start);
+        token.type = WORD;
     } else {
-        return string(1, buffer[cp++]);
+        token.type = isSpaceChar(buffer[cp]) ? SEPARATOR : OPERATOR;
+        cp++;
     }
+    token.text = buffer.substr(start, cp - start);
+    return token;
 }
 
 /*
  * Implementation notes: ignoreWhitespace and skipWhitespace
  * ---------------------------------------------------------
  * The ignoreWhitespace method simply sets a flag. The private method
- * skipWhitespace is called only if that flag is true.
+ * skipWhitespace is called only if that flag is true. A run of whitespace
+ * that reaches the end of a streamed window is discarded, and the scan
+ * continues in the next block.
  */
 
 void TokenScanner::ignoreWhitespace() {
@@ -65,7 +235,214 @@ void TokenScanner::ignoreWhitespace() {
 }
 
 void TokenScanner::skipWhitespace() {
-    while (cp < buffer.length() && isspace(buffer[cp])) {
-        cp++;
+    while (!atEnd() && isSpaceChar(buffer[cp])) {
+        cp = skipRun(buffer.data(), cp + 1, buffer.length(), SPACE);
+    }
+}
+
+void TokenScanner::scanNumbers() {
+    scanNumbersFlag = true;
+}
+
+/*
+ * Implementation notes: saveToken
+ * -------------------------------
+ * A Token is saved as it is unless its text is in current, which the
+ * next string token read would overwrite; such a token is saved as a
+ * string instead.
+ */
+
+void TokenScanner::saveToken(string token) {
+    SavedToken saved;
+    saved.copied = true;
+    savedTokens.add(saved);
+    savedStrings.add(token);
+}
+
+void TokenScanner::saveToken(Token token) {
+    if (!token.text.empty() && token.text.data() == current.data()) {
+        saveToken(string(token.text));
+        return;
+    }
+    SavedToken saved;
+    saved.token = token;
+    saved.copied = false;
+    savedTokens.add(saved);
+}
+
+TokenType TokenScanner::getTokenType(string_view token) const {
+    char ch = token[0];
+    unsigned char flags = CHARACTERS.flags[(unsigned char) ch];
+    if (flags & SPACE) return SEPARATOR;
+    if (flags & DIGIT) return (scanNumbersFlag) ? NUMBER : WORD;
+    if (flags & LETTER) return WORD;
+    return OPERATOR;
+}
+
+/*
+ * Private method: scanNumber
+ * Usage: long end = scanNumber(start);
+ * ------------------------------------
+ * Returns the index just past the number that begins at start. The
+ * fraction and the exponent are included only if a digit follows the
+ * period or the letter e, so that 3.x scans as the number 3. Positions
+ * within the number are offsets from start, which stay correct when
+ * peekChar refills a streamed window and moves the number.
+ */
+
+long TokenScanner::scanNumber(long & start) {
+    long end = 0;
+    while (isDigitChar(peekChar(start, end))) {
+        end++;
+    }
+    if (peekChar(start, end) == '.' && isDigitChar(peekChar(start, end + 1))) {
+        end += 2;
+        while (isDigitChar(peekChar(start, end))) {
+            end++;
+        }
+    }
+    char ch = peekChar(start, end);
+    if (ch == 'e' || ch == 'E') {
+        long digits = end + 1;
+        ch = peekChar(start, digits);
+        if (ch == '+' || ch == '-') digits++;
+        if (isDigitChar(peekChar(start, digits))) {
+            end = digits + 1;
+            while (isDigitChar(peekChar(start, end))) {
+                end++;
+            }
+        }
+    }
+    return start + end;
+}
+
+/*
+ * Private method: startStream
+ * Usage: startStream();
+ * ---------------------
+ * Prepares the scanner to read from a stream or a file descriptor. The
+ * window is allocated the first time and reused afterwards.
+ */
+
+void TokenScanner::startStream() {
+    borrowInput("");
+    if (window == NULL) {
+        windowSize = STREAM_WINDOW_SIZE;
+        window = new char[windowSize];
     }
-}
\ No newline at end of file
+    buffer = string_view(window, 0);
+    streamEnded = false;
+}
+
+/*
+ * Private method: atEnd
+ * Usage: if (atEnd()) . . .
+ * -------------------------
+ * Returns true if no characters remain, refilling a streamed window when
+ * the scanner has consumed all of it.
+ */
+
+bool TokenScanner::atEnd() {
+    while (cp >= (long) buffer.length()) {
+        long start = cp;
+        if (!refill(start)) return true;
+    }
+    return false;
+}
+
+/*
+ * Private method: refill
+ * Usage: if (refill(start)) . . .
+ * -------------------------------
+ * Reads more streamed input, keeping the characters from start onward,
+ * which belong to an unfinished token. Those characters move to the start
+ * of the window, and start and cp are adjusted to match. The window is
+ * doubled only if the unfinished token fills it. The method returns false
+ * if the input is exhausted or was not streamed.
+ */
+
+bool TokenScanner::refill(long & start) {
+    if (streamEnded) return false;
+    long keep = buffer.length() - start;
+    if (keep == windowSize) {
+        char *array = new char[2 * windowSize];
+        memcpy(array, window + start, keep);
+        delete[] window;
+        window = array;
+        windowSize *= 2;
+    } else {
+        memmove(window, window + start, keep);
+    }
+    cp -= start;
+    start = 0;
+    long count;
+    if (stream != NULL) {
+        stream->read(window + keep, windowSize - keep);
+        count = stream->gcount();
+    } else {
+        do {
+            count = read(fd, window + keep, windowSize - keep);
+        } while (count < 0 && errno == EINTR);
+        if (count < 0) error("TokenScanner: " + string(strerror(errno)));
+    }
+    buffer = string_view(window, keep + count);
+    if (count == 0) streamEnded = true;
+    return count > 0;
+}
+
+/*
+ * Private method: peekChar
+ * Usage: char ch = peekChar(start, offset);
+ * -----------------------------------------
+ * Returns the character at the specified offset from start, refilling
+ * the window if necessary, or the null character if the input ends
+ * first.
+ */
+
+char TokenScanner::peekChar(long & start, long offset) {
+    while (start + offset >= (long) buffer.length()) {
+        if (!refill(start)) return '\0';
+    }
+    return buffer[start + offset];
+}
+
+/*
+ * Private function: skipRun
+ * Usage: long end = skipRun(str, start, end, mask);
+ * -------------------------------------------------
+ * Returns the index of the first character at or after start whose class
+ * is not in mask, or end if there is none. The mask must be SPACE or
+ * ALNUM, which are the classes that form long runs. A run of a single
+ * character, which is common in formulas, is detected before any vector
+ * is loaded.
+ */
+
+static long skipRun(const char *str, long start, long end,
+                    unsigned char mask) {
+    const unsigned char *flags = CHARACTERS.flags;
+#ifdef VECTOR_SCAN
+    if (start < end && !(flags[(unsigned char) str[start]] & mask)) {
+        return start;
+    }
+    while (end - start >= VECTOR_BYTES) {
+        Bytes v;
+        memcpy(&v, str + start, VECTOR_BYTES);
+        Bytes match;
+        if (mask == SPACE) {
+            match = (Bytes) ((v == ' ') | ((Bytes) (v - '\t') <= '\r' - '\t'));
+        } else {
+            match = (Bytes) (((Bytes) (v - '0') <= 9)
+                           | ((Bytes) ((v | 0x20) - 'a') <= 'z' - 'a'));
+        }
+        uint64_t words[2];
+        memcpy(words, &match, VECTOR_BYTES);
+        if (~words[0] != 0) return start + __builtin_ctzll(~words[0]) / 8;
+        if (~words[1] != 0) return start + 8 + __builtin_ctzll(~words[1]) / 8;
+        start += VECTOR_BYTES;
+    }
+#endif
+    while (start < end && (flags[(unsigned char) str[start]] & mask)) {
+        start++;
+    }
+    return start;
+}
@@ -8,7 +8,37 @@
 #ifndef _tokenscanner_h
 #define _tokenscanner_h
 
+#include <istream>
 #include <string>
+#include <string_view>
+#include "vector.h"
+
+/*
+ * Type: TokenType
+ * ---------------
+ * This enumerated type classifies the tokens returned by the scanner.
+ * A SEPARATOR is a whitespace character, a WORD begins with a letter,
+ * a NUMBER begins with a digit when number scanning is enabled, and
+ * every other single character is an OPERATOR. END_OF_INPUT marks the
+ * empty token that the scanner returns when the input is exhausted.
+ * Characters are classified as ASCII whatever the locale: letters and
+ * digits are the ASCII ones, and each byte outside ASCII is an OPERATOR.
+ */
+
+enum TokenType { SEPARATOR, WORD, NUMBER, OPERATOR, END_OF_INPUT };
+
+/*
+ * Type: Token
+ * -----------
+ * This type combines the text of a token with its type. The text is a
+ * view of the characters in the scanner's input, so creating a token
+ * never allocates memory.
+ */
+
+struct Token {
+    std::string_view text;      // The characters of the token
+    TokenType type;             // The classification of the token
+};
 
 /*
  * Class: TokenScanner
@@ -29,9 +59,28 @@
  *          . . . process the token
  *      }
  * 
- * This version of the TokenScanner class includes the ignoreWhitespace
- * method. The other options available in the library version of the
- * class are included in as exercises in the text.
+ * This version of the TokenScanner class includes the ignoreWhitespace,
+ * scanNumbers, saveToken and getTokenType methods, which are the ones
+ * the expression parser needs. The other options available in the
+ * library version of the class are included in as exercises in the text.
+ *
+ * Each call to nextToken allocates a new string. A client that scans
+ * large inputs can instead lend the scanner its input with borrowInput
+ * and read tokens with readToken, which returns a view of the token's
+ * characters together with its type and never copies anything:
+ *
+ *      scanner.borrowInput(text);
+ *      while (true) {
+ *          Token token = scanner.readToken();
+ *          if (token.type == END_OF_INPUT) break;
+ *          . . . process token.text
+ *      }
+ *
+ * A file that is too large to read into memory can be scanned in three
+ * ways. The scanner can read it from a stream or a file descriptor, in
+ * which case it keeps only a fixed-size window of the input in memory;
+ * or the client can map the file with the MappedFile class and lend the
+ * mapping to the scanner with borrowInput.
  */
 
 class TokenScanner {
@@ -51,6 +100,15 @@ public:
     TokenScanner();
     TokenScanner(std::string str);
 
+/*
+ * Destructor: ~TokenScanner
+ * -------------------------
+ * Frees the window used for streaming input. A stream or file descriptor
+ * is not closed.
+ */
+
+    ~TokenScanner();
+
 /*
  * Method: setInput
  * Usage: scanner.setInput(str);
@@ -61,6 +119,36 @@ public:
 
     void setInput(std::string str);
 
+/*
+ * Method: borrowInput
+ * Usage: scanner.borrowInput(str);
+ * --------------------------------
+ * Sets the input for this scanner to the characters of str without
+ * copying them. The client must keep the characters unchanged for as
+ * long as the scanner or any token it returns is in use.
+ */
+
+    void borrowInput(std::string_view str);
+
+/*
+ * Methods: setInput, setInputDescriptor
+ * Usage: scanner.setInput(infile);
+ *        scanner.setInputDescriptor(fd);
+ * --------------------------------------
+ * Sets the input for this scanner to the characters read from a stream
+ * or from an open file descriptor, such as a pipe. The scanner reads the
+ * input in blocks into a window of fixed size, so its memory use does
+ * not depend on the length of the input; the window grows only if a
+ * single token is longer than the window. A token never straddles two
+ * blocks, since the scanner moves an unfinished token to the start of the
+ * window before it reads the next block. With streaming input, the text
+ * of a token remains valid only until the next call to readToken or
+ * hasMoreTokens, so a client that wants to keep a token must copy it.
+ */
+
+    void setInput(std::istream & infile);
+    void setInputDescriptor(int fd);
+
 /*
  * Method: hasMoreTokens
  * Usage: if (scanner.hasMoreTokens()) . . .
@@ -80,6 +168,20 @@ public:
 
     std::string nextToken();
 
+/*
+ * Method: readToken
+ * Usage: Token token = scanner.readToken();
+ * -----------------------------------------
+ * Returns the next token from this scanner, which is the same token
+ * nextToken would return, as a view of the input and its type. If no
+ * tokens are available, readToken returns an empty token whose type is
+ * END_OF_INPUT. The text remains valid as long as the input does, except
+ * that the text of a token saved as a string is valid only until the
+ * next call to readToken.
+ */
+
+    Token readToken();
+
 /*
  * Method: ignoreWhitespace()
  * Usage: scanner.ignoreWhitespace();
@@ -96,17 +198,95 @@ public:
 
     void ignoreWhitespace();
 
+/*
+ * Method: scanNumbers
+ * Usage: scanner.scanNumbers();
+ * -----------------------------
+ * Tells the scanner to return a number as a single token. A number is
+ * a string of digits, which may be followed by a fraction and by an
+ * exponent, as in 3, 2.5 or 6.02e23. By default, the scanner treats a
+ * digit like a letter, and a period ends the word.
+ */
+
+    void scanNumbers();
+
+/*
+ * Method: saveToken
+ * Usage: scanner.saveToken(token);
+ * --------------------------------
+ * Pushes the specified token back into the token stream, so that it is
+ * returned by the next call to nextToken or readToken. The token may be
+ * a string or a Token returned by readToken; saving a Token copies
+ * nothing.
+ */
+
+    void saveToken(std::string token);
+    void saveToken(Token token);
+
+/*
+ * Method: getTokenType
+ * Usage: TokenType type = scanner.getTokenType(token);
+ * ----------------------------------------------------
+ * Returns the type of the token, which must be a token returned by this
+ * scanner and not the empty string.
+ */
+
+    TokenType getTokenType(std::string_view token) const;
+
+/*
+ * Notes on representation
+ * -----------------------
+ * The scanner reads from the view buffer, which refers to the client's
+ * characters, to the scanner's own copy in input, or, when the input is
+ * streamed, to the filled part of the window. The index cp is a long,
+ * since a mapped file may exceed two gigabytes. Saved tokens are kept as
+ * views in a vector used as a stack. A token saved as a string has its
+ * characters kept in savedStrings until it is read again, when they move
+ * to current so that the view returned to the client stays valid. A
+ * Vector rather than a Stack holds the saved tokens, since it reuses its
+ * storage instead of allocating on each push.
+ */
+
 private:
 
+/* Type definitions */
+
+    struct SavedToken {
+        Token token;            // The token, if it was saved as a view
+        bool copied;            // True if the text is in savedStrings
+    };
+
 /* Instance variables */
 
-    std::string buffer;         // The input string containing the tokens
-    int cp;                     // The current position in the buffer
+    std::string input;          // The copy of the input made by setInput
+    std::string_view buffer;    // The characters containing the tokens
+    long cp;                    // The current position in the buffer
+    std::istream *stream;       // The input stream, or NULL
+    int fd;                     // The input file descriptor, or -1
+    bool streamEnded;           // True if no more input can be read
+    char *window;               // The buffer for streamed input
+    long windowSize;            // The allocated size of window
     bool ignoreWhitespaceFlag;  // Flag set by a call to ignoreWhitespace
+    bool scanNumbersFlag;       // Flag set by a call to scanNumbers
+    Vector<SavedToken> savedTokens;     // Tokens pushed back by saveToken
+    Vector<std::string> savedStrings;   // Text of tokens saved as strings
+    std::string current;        // Text of the last string token read
 
 /* Private methods */
 
     void skipWhitespace();
+    long scanNumber(long & start);
+    void startStream();
+    bool atEnd();
+    bool refill(long & start);
+    char peekChar(long & start, long offset);
+
+/* Make it illegal to copy scanners */
+
+    TokenScanner(const TokenScanner & src) { }
+    TokenScanner & operator=(const TokenScanner & src) {
+        return *this;
+    }
 
 };
 
@@ -0,0 +1,404 @@
+/*
+ * File: topology.cpp
+ * ------------------
+ * This file implements the topology.h interface.
+ */
+
+#include "compactgraph.h"
+#include "topology.h"
+#include "vector.h"
+using namespace std;
+
+/*
+ * Type: Frame
+ * -----------
+ * This type holds one level of a depth-first search: the node being
+ * explored and the next of its arcs to follow. An array of frames takes
+ * the place of the call stack in a recursive search, and since no node
+ * appears in it twice, it never needs more than one frame per node.
+ */
+
+struct Frame {
+    int node;                       // The node being explored
+    int arc;                        // The next arc to follow from node
+};
+
+/* Private function prototypes */
+
+static int kahn(const CompactGraph & g, int *order, int & maxReady);
+static int tarjan(const CompactGraph & g, int *component,
+                  TraversalStats & stats);
+static int kosaraju(const CompactGraph & g, int *component,
+                    TraversalStats & stats);
+static void copyToVector(const int *array, int n, Vector<int> & vec);
+
+/*
+ * Implementation notes: topologicalSort, hasCycle
+ * -----------------------------------------------
+ * Both functions call kahn, which returns the number of nodes it was
+ * able to place in order. The graph has a cycle exactly when that number
+ * is smaller than the number of nodes.
+ */
+
+bool topologicalSort(const CompactGraph & g, Vector<int> & order,
+                     TraversalStats *stats) {
+    int n = g.size();
+    int *sorted = new int[n];
+    int maxReady = 0;
+    int count = kahn(g, sorted, maxReady);
+    copyToVector(sorted, count, order);
+    delete[] sorted;
+    if (stats != NULL) {
+        stats->workspaceBytes = 2L * n * sizeof(int);
+        stats->maxDepth = maxReady;
+    }
+    return count == n;
+}
+
+bool hasCycle(const CompactGraph & g) {
+    int *sorted = new int[g.size()];
+    int maxReady = 0;
+    int count = kahn(g, sorted, maxReady);
+    delete[] sorted;
+    return count < g.size();
+}
+
+/*
+ * Implementation notes: stronglyConnectedComponents
+ * -------------------------------------------------
+ * Tarjan's algorithm completes each component only after every component
+ * it can reach, so it numbers the components in reverse topological
+ * order. This function turns that numbering around. Kosaraju's algorithm
+ * already finds the components in topological order.
+ */
+
+int stronglyConnectedComponents(const CompactGraph & g,
+                                Vector<int> & component,
+                                SCCAlgorithm algorithm,
+                                TraversalStats *stats) {
+    int n = g.size();
+    int *result = new int[n];
+    TraversalStats local;
+    int count;
+    if (algorithm == TARJAN) {
+        count = tarjan(g, result, local);
+        for (int v = 0; v < n; v++) {
+            result[v] = count - 1 - result[v];
+        }
+    } else {
+        count = kosaraju(g, result, local);
+    }
+    copyToVector(result, n, component);
+    delete[] result;
+    if (stats != NULL) {
+        *stats = local;
+        stats->workspaceBytes += (long) n * sizeof(int);
+    }
+    return count;
+}
+
+/*
+ * Implementation notes: findCycle
+ * -------------------------------
+ * The search colors each node white before it is reached, gray while it
+ * is on the stack and black once all its arcs have been explored. An arc
+ * that leads to a gray node closes a cycle, which consists of the nodes
+ * on the stack from that node to the top.
+ */
+
+bool findCycle(const CompactGraph & g, Vector<int> & cycle,
+               TraversalStats *stats) {
+    const char WHITE = 0, GRAY = 1, BLACK = 2;
+    int n = g.size();
+    const int *offsets = g.getOffsets();
+    const int *finishes = g.getFinishes();
+    char *color = new char[n];
+    Frame *stack = new Frame[n];
+    for (int v = 0; v < n; v++) {
+        color[v] = WHITE;
+    }
+    int maxDepth = 0;
+    int closing = -1;
+    int depth = 0;
+    for (int root = 0; root < n && closing < 0; root++) {
+        if (color[root] != WHITE) continue;
+        color[root] = GRAY;
+        stack[0].node = root;
+        stack[0].arc = offsets[root];
+        depth = 1;
+        while (depth > 0) {
+            if (depth > maxDepth) maxDepth = depth;
+            Frame & top = stack[depth - 1];
+            if (top.arc == offsets[top.node + 1]) {
+                color[top.node] = BLACK;
+                depth--;
+                continue;
+            }
+            int w = finishes[top.arc++];
+            if (color[w] == WHITE) {
+                color[w] = GRAY;
+                stack[depth].node = w;
+                stack[depth].arc = offsets[w];
+                depth++;
+            } else if (color[w] == GRAY) {
+                closing = w;
+                break;
+            }
+        }
+    }
+    cycle.clear();
+    if (closing >= 0) {
+        int first = depth - 1;
+        while (stack[first].node != closing) {
+            first--;
+        }
+        for (int i = first; i < depth; i++) {
+            cycle.add(stack[i].node);
+        }
+    }
+    delete[] color;
+    delete[] stack;
+    if (stats != NULL) {
+        stats->workspaceBytes = (long) n * (sizeof(char) + sizeof(Frame));
+        stats->maxDepth = maxDepth;
+    }
+    return closing >= 0;
+}
+
+/*
+ * Private function: kahn
+ * Usage: int count = kahn(g, order, maxReady);
+ * --------------------------------------------
+ * Runs Kahn's algorithm, storing the nodes in topological order in the
+ * array order, which must have room for every node, and returns how many
+ * were placed. The array doubles as the queue of nodes whose remaining
+ * in-degree is zero, with the nodes between head and tail still waiting
+ * to be removed. The largest number waiting at once is stored in
+ * maxReady, since it bounds how many tasks a scheduler could start in
+ * parallel at that point.
+ */
+
+static int kahn(const CompactGraph & g, int *order, int & maxReady) {
+    int n = g.size();
+    int m = g.getArcCount();
+    const int *offsets = g.getOffsets();
+    const int *finishes = g.getFinishes();
+    int *inDegree = new int[n];
+    for (int v = 0; v < n; v++) {
+        inDegree[v] = 0;
+    }
+    for (int a = 0; a < m; a++) {
+        inDegree[finishes[a]]++;
+    }
+    int tail = 0;
+    for (int v = 0; v < n; v++) {
+        if (inDegree[v] == 0) order[tail++] = v;
+    }
+    maxReady = tail;
+    for (int head = 0; head < tail; head++) {
+        int v = order[head];
+        for (int a = offsets[v]; a < offsets[v + 1]; a++) {
+            if (--inDegree[finishes[a]] == 0) order[tail++] = finishes[a];
+        }
+        if (tail - head - 1 > maxReady) maxReady = tail - head - 1;
+    }
+    delete[] inDegree;
+    return tail;
+}
+
+/*
+ * Private function: tarjan
+ * Usage: int count = tarjan(g, component, stats);
+ * -----------------------------------------------
+ * Runs Tarjan's algorithm with an explicit stack of frames. Each node
+ * receives an index in the order the search reaches it, and low records
+ * the smallest index reachable from the node through the part of the
+ * search below it together with one further arc. A node whose low value
+ * equals its own index is the root of a component, which consists of
+ * it and the nodes above it on the component stack. A node is on that
+ * stack exactly when it has an index but no component yet, so no
+ * separate flag is needed.
+ */
+
+static int tarjan(const CompactGraph & g, int *component,
+                  TraversalStats & stats) {
+    int n = g.size();
+    const int *offsets = g.getOffsets();
+    const int *finishes = g.getFinishes();
+    int *index = new int[n];
+    int *low = new int[n];
+    int *pending = new int[n];
+    Frame *stack = new Frame[n];
+    for (int v = 0; v < n; v++) {
+        index[v] = -1;
+        component[v] = -1;
+    }
+    int nextIndex = 0;
+    int nPending = 0;
+    int count = 0;
+    stats.maxDepth = 0;
+    for (int root = 0; root < n; root++) {
+        if (index[root] >= 0) continue;
+        index[root] = low[root] = nextIndex++;
+        pending[nPending++] = root;
+        stack[0].node = root;
+        stack[0].arc = offsets[root];
+        int depth = 1;
+        while (depth > 0) {
+            if (depth > stats.maxDepth) stats.maxDepth = depth;
+            Frame & top = stack[depth - 1];
+            int v = top.node;
+            if (top.arc < offsets[v + 1]) {
+                int w = finishes[top.arc++];
+                if (index[w] < 0) {
+                    index[w] = low[w] = nextIndex++;
+                    pending[nPending++] = w;
+                    stack[depth].node = w;
+                    stack[depth].arc = offsets[w];
+                    depth++;
+                } else if (component[w] < 0 && index[w] < low[v]) {
+                    low[v] = index[w];
+                }
+                continue;
+            }
+            depth--;
+            if (low[v] == index[v]) {
+                int w;
+                do {
+                    w = pending[--nPending];
+                    component[w] = count;
+                } while (w != v);
+                count++;
+            }
+            if (depth > 0) {
+                int parent = stack[depth - 1].node;
+                if (low[v] < low[parent]) low[parent] = low[v];
+            }
+        }
+    }
+    delete[] index;
+    delete[] low;
+    delete[] pending;
+    delete[] stack;
+    stats.workspaceBytes = (long) n * (3 * sizeof(int) + sizeof(Frame));
+    return count;
+}
+
+/*
+ * Private function: kosaraju
+ * Usage: int count = kosaraju(g, component, stats);
+ * -------------------------------------------------
+ * Runs Kosaraju's algorithm. The first search records the nodes in the
+ * order in which it finishes them. The second pass takes the nodes in
+ * the reverse of that order and collects everything that can reach each
+ * unassigned one, which it finds by following the arcs backward. The
+ * reversed arcs are built with a counting sort after the first search
+ * has released its arrays, which keeps the peak memory down.
+ */
+
+static int kosaraju(const CompactGraph & g, int *component,
+                    TraversalStats & stats) {
+    int n = g.size();
+    int m = g.getArcCount();
+    const int *offsets = g.getOffsets();
+    const int *finishes = g.getFinishes();
+    int *finished = new int[n];
+    bool *visited = new bool[n];
+    Frame *stack = new Frame[n];
+    for (int v = 0; v < n; v++) {
+        visited[v] = false;
+    }
+    int nFinished = 0;
+    stats.maxDepth = 0;
+    for (int root = 0; root < n; root++) {
+        if (visited[root]) continue;
+        visited[root] = true;
+        stack[0].node = root;
+        stack[0].arc = offsets[root];
+        int depth = 1;
+        while (depth > 0) {
+            if (depth > stats.maxDepth) stats.maxDepth = depth;
+            Frame & top = stack[depth - 1];
+            if (top.arc < offsets[top.node + 1]) {
+                int w = finishes[top.arc++];
+                if (!visited[w]) {
+                    visited[w] = true;
+                    stack[depth].node = w;
+                    stack[depth].arc = offsets[w];
+                    depth++;
+                }
+            } else {
+                finished[nFinished++] = top.node;
+                depth--;
+            }
+        }
+    }
+    long firstBytes = (long) n * (sizeof(int) + sizeof(bool) + sizeof(Frame));
+    delete[] visited;
+    delete[] stack;
+    int *reverseOffsets = new int[n + 1];
+    int *sources = new int[m];
+    for (int v = 0; v <= n; v++) {
+        reverseOffsets[v] = 0;
+    }
+    for (int a = 0; a < m; a++) {
+        reverseOffsets[finishes[a] + 1]++;
+    }
+    for (int v = 0; v < n; v++) {
+        reverseOffsets[v + 1] += reverseOffsets[v];
+    }
+    int *pending = new int[n];
+    for (int v = 0; v < n; v++) {
+        pending[v] = reverseOffsets[v];
+    }
+    for (int v = 0; v < n; v++) {
+        for (int a = offsets[v]; a < offsets[v + 1]; a++) {
+            sources[pending[finishes[a]]++] = v;
+        }
+    }
+    for (int v = 0; v < n; v++) {
+        component[v] = -1;
+    }
+    int count = 0;
+    for (int i = n - 1; i >= 0; i--) {
+        int root = finished[i];
+        if (component[root] >= 0) continue;
+        component[root] = count;
+        int nPending = 0;
+        pending[nPending++] = root;
+        while (nPending > 0) {
+            int v = pending[--nPending];
+            for (int a = reverseOffsets[v]; a < reverseOffsets[v + 1]; a++) {
+                int w = sources[a];
+                if (component[w] < 0) {
+                    component[w] = count;
+                    pending[nPending++] = w;
+                }
+            }
+        }
+        count++;
+    }
+    delete[] finished;
+    delete[] reverseOffsets;
+    delete[] sources;
+    delete[] pending;
+    long secondBytes = (long) n * (3 * sizeof(int)) + sizeof(int)
+                     + (long) m * sizeof(int);
+    stats.workspaceBytes = (firstBytes > secondBytes) ? firstBytes
+                                                      : secondBytes;
+    return count;
+}
+
+/*
+ * Private function: copyToVector
+ * Usage: copyToVector(array, n, vec);
+ * -----------------------------------
+ * Replaces the contents of vec with the first n elements of array.
+ */
+
+static void copyToVector(const int *array, int n, Vector<int> & vec) {
+    vec.clear();
+    for (int i = 0; i < n; i++) {
+        vec.add(array[i]);
+    }
+}
@@ -0,0 +1,192 @@
+/*
+ * File: topology.h
+ * ----------------
+ * This interface exports functions that analyze the structure of a
+ * directed graph: a topological sort, strongly connected components and
+ * cycle detection. Every function walks the graph with explicit stacks
+ * or queues instead of recursion, so a path millions of nodes long
+ * cannot overflow the call stack, and the running time is proportional
+ * to the number of nodes plus the number of arcs.
+ */
+
+#ifndef _topology_h
+#define _topology_h
+
+#include "compactgraph.h"
+#include "graph.h"
+#include "graphconvert.h"
+#include "set.h"
+#include "vector.h"
+
+/*
+ * Type: TraversalStats
+ * --------------------
+ * This type reports the working storage used by one of the functions in
+ * this interface. The figure for workspaceBytes counts the arrays the
+ * function allocates for itself but not the vectors it fills in for the
+ * client or the graph it reads.
+ */
+
+struct TraversalStats {
+    long workspaceBytes;    // The size of the working arrays
+    int maxDepth;           // The deepest point reached by the search
+};
+
+/*
+ * Type: SCCAlgorithm
+ * ------------------
+ * This enumerated type selects the algorithm that finds the strongly
+ * connected components.
+ */
+
+enum SCCAlgorithm { TARJAN, KOSARAJU };
+
+/*
+ * Function: topologicalSort
+ * Usage: if (topologicalSort(g, order)) . . .
+ *        if (topologicalSort(g, order, &stats)) . . .
+ * -----------------------------------------------------
+ * Stores the nodes of g in order so that every arc leads from a node
+ * to one that appears later, and returns true. The function uses Kahn's
+ * algorithm, which repeatedly removes a node that no remaining arc
+ * enters. If g contains a cycle, no such order exists, and the function
+ * returns false; in that case order holds only the nodes that do not lie
+ * on a cycle or after one. If stats is not NULL, the function stores its
+ * memory use there, and maxDepth is the largest number of nodes that
+ * were ready at the same time.
+ */
+
+bool topologicalSort(const CompactGraph & g, Vector<int> & order,
+                     TraversalStats *stats = NULL);
+
+/*
+ * Function: stronglyConnectedComponents
+ * Usage: int n = stronglyConnectedComponents(g, component);
+ *        int n = stronglyConnectedComponents(g, component, algorithm,
+ *                                            &stats);
+ * ---------------------------------------------------------------------
+ * Divides the nodes of g into strongly connected components, which are
+ * the largest sets of nodes in which every node can reach every other.
+ * The function stores the component number of each node in component
+ * and returns the number of components. The components are numbered in
+ * topological order, so an arc that joins two different components
+ * always leads to the one with the higher number.
+ *
+ * Tarjan's algorithm, the default, finds the components in one search.
+ * Kosaraju's algorithm searches twice, the second time over the reversed
+ * arcs, and needs a copy of the arcs to do so, but its inner loops are
+ * simpler. Both give the same division of the nodes, although the
+ * numbering may differ when the components have more than one
+ * topological order.
+ */
+
+int stronglyConnectedComponents(const CompactGraph & g,
+                                Vector<int> & component,
+                                SCCAlgorithm algorithm = TARJAN,
+                                TraversalStats *stats = NULL);
+
+/*
+ * Function: hasCycle
+ * Usage: if (hasCycle(g)) . . .
+ * -----------------------------
+ * Returns true if g contains a cycle, including an arc from a node to
+ * itself.
+ */
+
+bool hasCycle(const CompactGraph & g);
+
+/*
+ * Function: findCycle
+ * Usage: if (findCycle(g, cycle)) . . .
+ *        if (findCycle(g, cycle, &stats)) . . .
+ * -----------------------------------------------
+ * Searches g for a cycle. If there is one, the function stores its nodes
+ * in cycle, in an order in which each node has an arc to the next and
+ * the last has an arc to the first, and returns true. Otherwise, it
+ * clears cycle and returns false. This function is slower than hasCycle
+ * but identifies the dependencies that make a schedule impossible.
+ */
+
+bool findCycle(const CompactGraph & g, Vector<int> & cycle,
+               TraversalStats *stats = NULL);
+
+/*
+ * Functions: topologicalSort, stronglyConnectedComponents, findCycle
+ * Usage: if (topologicalSort(g, order)) . . .
+ *        int n = stronglyConnectedComponents(g, components);
+ *        if (findCycle(g, cycle)) . . .
+ * ---------------------------------------------------------
+ * These versions work on a Graph<NodeType,ArcType> by copying it into a
+ * CompactGraph and then translating the results back to node pointers.
+ * The components are returned as a vector of node sets indexed by
+ * component number.
+ */
+
+template <typename NodeType,typename ArcType>
+bool topologicalSort(Graph<NodeType,ArcType> & g, Vector<NodeType *> & order);
+
+template <typename NodeType,typename ArcType>
+int stronglyConnectedComponents(Graph<NodeType,ArcType> & g,
+                                Vector< Set<NodeType *> > & components,
+                                SCCAlgorithm algorithm = TARJAN);
+
+template <typename NodeType,typename ArcType>
+bool findCycle(Graph<NodeType,ArcType> & g, Vector<NodeType *> & cycle);
+
+/* Private section */
+
+/**********************************************************************/
+/* Note: Everything below this point in the file is logically part    */
+/* of the implementation and should not be of interest to clients.    */
+/**********************************************************************/
+
+/*
+ * Implementation notes: Graph versions
+ * ------------------------------------
+ * Each template converts the graph with toCompactGraph and maps every
+ * node number back to a node pointer through its name.
+ */
+
+template <typename NodeType,typename ArcType>
+bool topologicalSort(Graph<NodeType,ArcType> & g,
+                     Vector<NodeType *> & order) {
+    CompactGraph compact;
+    toCompactGraph(g, compact);
+    Vector<int> numbers;
+    bool sorted = topologicalSort(compact, numbers);
+    order.clear();
+    for (int i = 0; i < numbers.size(); i++) {
+        order.add(g.getNode(compact.getName(numbers[i])));
+    }
+    return sorted;
+}
+
+template <typename NodeType,typename ArcType>
+int stronglyConnectedComponents(Graph<NodeType,ArcType> & g,
+                                Vector< Set<NodeType *> > & components,
+                                SCCAlgorithm algorithm) {
+    CompactGraph compact;
+    toCompactGraph(g, compact);
+    Vector<int> component;
+    int n = stronglyConnectedComponents(compact, component, algorithm);
+    components = Vector< Set<NodeType *> >(n);
+    for (int v = 0; v < compact.size(); v++) {
+        components[component[v]].add(g.getNode(compact.getName(v)));
+    }
+    return n;
+}
+
+template <typename NodeType,typename ArcType>
+bool findCycle(Graph<NodeType,ArcType> & g, Vector<NodeType *> & cycle) {
+    CompactGraph compact;
+    toCompactGraph(g, compact);
+    Vector<int> numbers;
+    bool found = findCycle(compact, numbers);
+    cycle.clear();
+    for (int i = 0; i < numbers.size(); i++) {
+        cycle.add(g.getNode(compact.getName(numbers[i])));
+    }
+    return found;
+}
+
+#endif
@@ -0,0 +1,613 @@
+/*
+ * File: typedprogram.h
+ * --------------------
+ * This interface exports the TypedProgram template class, which compiles
+ * an expression tree into bytecode for a stack machine whose values have
+ * a type chosen by the client, such as int64_t, double or CheckedInt.
+ */
+
+#ifndef _typedprogram_h
+#define _typedprogram_h
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include "checkedint.h"
+#include "error.h"
+#include "exp.h"
+#include "interner.h"
+
+/*
+ * Class: ValueTraits<ValueType>
+ * -----------------------------
+ * This template supplies the arithmetic that a TypedProgram performs on
+ * its values. The general version applies the built-in operators, which
+ * suits double, where division by zero gives an infinity or a NaN as
+ * IEEE arithmetic specifies, and CheckedInt, whose operators do their
+ * own checking. Since the functions are chosen when the template is
+ * instantiated and are expanded inline, the choice of type costs nothing
+ * when the program runs.
+ */
+
+template <typename ValueType>
+struct ValueTraits {
+    static ValueType add(ValueType x, ValueType y) { return x + y; }
+    static ValueType subtract(ValueType x, ValueType y) { return x - y; }
+    static ValueType multiply(ValueType x, ValueType y) { return x * y; }
+    static ValueType divide(ValueType x, ValueType y) { return x / y; }
+};
+
+/*
+ * Specialization: ValueTraits<int>
+ * --------------------------------
+ * The int version gives the arithmetic of the expression tree, which
+ * BytecodeProgram uses. As in the int64_t version below, the sums and
+ * products wrap around through unsigned arithmetic, and dividing the
+ * most negative int by -1 gives that int back instead of trapping.
+ */
+
+template <>
+struct ValueTraits<int> {
+    static int add(int x, int y) {
+        return int(unsigned(x) + unsigned(y));
+    }
+    static int subtract(int x, int y) {
+        return int(unsigned(x) - unsigned(y));
+    }
+    static int multiply(int x, int y) {
+        return int(unsigned(x) * unsigned(y));
+    }
+    static int divide(int x, int y) {
+        if (y == 0) error("Division by 0");
+        if (y == -1) return int(0 - unsigned(x));
+        return x / y;
+    }
+};
+
+/*
+ * Specialization: ValueTraits<int64_t>
+ * ------------------------------------
+ * Overflow in signed arithmetic is undefined in C++, so the int64_t
+ * version adds, subtracts and multiplies in unsigned arithmetic, which
+ * wraps around exactly as the hardware does and compiles to the same
+ * instructions. Division checks for zero, and for the one quotient that
+ * does not fit, which would otherwise stop the program on most machines.
+ */
+
+template <>
+struct ValueTraits<int64_t> {
+    static int64_t add(int64_t x, int64_t y) {
+        return int64_t(uint64_t(x) + uint64_t(y));
+    }
+    static int64_t subtract(int64_t x, int64_t y) {
+        return int64_t(uint64_t(x) - uint64_t(y));
+    }
+    static int64_t multiply(int64_t x, int64_t y) {
+        return int64_t(uint64_t(x) * uint64_t(y));
+    }
+    static int64_t divide(int64_t x, int64_t y) {
+        if (y == 0) error("Division by 0");
+        if (y == -1) return int64_t(0 - uint64_t(x));
+        return x / y;
+    }
+};
+
+/*
+ * Class: TypedProgram<ValueType>
+ * ------------------------------
+ * This class compiles an expression tree into bytecode for a stack
+ * machine whose values on the stack and in the slots have the specified
+ * type, so that the same parsed expression can be evaluated with the
+ * ints of the tree, with 64-bit integers, with floating-point numbers,
+ * or with integers that report overflow. BytecodeProgram is the int
+ * version. Each instantiation has its own copy of the machine with the
+ * arithmetic for its type compiled in:
+ *
+ *      TypedProgram<double> program(exp);
+ *      int x = program.getSlot("x");
+ *      double *slots = new double[program.getSlotCount()];
+ *      for (int i = 0; i < n; i++) {
+ *          slots[x] = i / 10.0;
+ *          double value = program.execute(slots);
+ *          . . . use the value
+ *      }
+ *
+ * The constants in an expression are integers, since that is all the
+ * parser reads, but they are converted to the value type when the
+ * program is compiled.
+ */
+
+template <typename ValueType>
+class TypedProgram {
+
+public:
+
+/*
+ * Constructor: TypedProgram
+ * Usage: TypedProgram<ValueType> program;
+ *        TypedProgram<ValueType> program(exp);
+ * --------------------------------------------
+ * Initializes a program, compiling the expression exp if it is given.
+ * The program does not keep any pointer to the expression tree.
+ */
+
+    TypedProgram();
+    TypedProgram(Expression *exp);
+
+/*
+ * Destructor: ~TypedProgram
+ * -------------------------
+ * Frees any heap storage associated with this program.
+ */
+
+    ~TypedProgram();
+
+/*
+ * Method: compile
+ * Usage: program.compile(exp);
+ * ----------------------------
+ * Replaces the contents of the program with the translation of exp.
+ * This method signals an error if the left side of an assignment is not
+ * an identifier.
+ */
+
+    void compile(Expression *exp);
+
+/*
+ * Methods: getSlotCount, getSlot, getSlotName
+ * Usage: int n = program.getSlotCount();
+ *        int slot = program.getSlot(name);
+ *        std::string_view name = program.getSlotName(slot);
+ * ---------------------------------------------------------
+ * Return the number of variable slots, which is the number of distinct
+ * identifiers in the expression, the slot of the named variable, or -1
+ * if the expression does not mention it, and the name of the variable
+ * in a slot.
+ */
+
+    int getSlotCount() const;
+    int getSlot(std::string_view name) const;
+    std::string_view getSlotName(int slot) const;
+
+/*
+ * Methods: isInput, isAssigned
+ * Usage: if (program.isInput(slot)) . . .
+ *        if (program.isAssigned(slot)) . . .
+ * ------------------------------------------
+ * Return true if the program may read the slot before assigning it and
+ * if the program stores into the slot.
+ */
+
+    bool isInput(int slot) const;
+    bool isAssigned(int slot) const;
+
+/*
+ * Method: execute
+ * Usage: ValueType value = program.execute(slots);
+ * ------------------------------------------------
+ * Runs the program with the variables in the array slots, which must
+ * have getSlotCount() elements, and returns the value of the expression.
+ * Assignments update the array. Any errors are those of the arithmetic
+ * in ValueTraits<ValueType>. Any number of threads may run the same
+ * program, each with its own slots.
+ */
+
+    ValueType execute(ValueType *slots) const;
+
+/*
+ * Method: toString
+ * Usage: string listing = program.toString();
+ * -------------------------------------------
+ * Returns a listing of the instructions, one per line.
+ */
+
+    std::string toString() const;
+
+/* Private section */
+
+/*
+ * Implementation notes: TypedProgram data structure
+ * -------------------------------------------------
+ * The instructions are stored in an array of integers, with each opcode
+ * followed by its operand, if any. The operand of PUSH is an index into
+ * a separate array of constants, which already have the value type, so
+ * the code array has the same layout for every type. The machine
+ * evaluates the right operand of each operator before the left one, in
+ * the same order as CompoundExp::eval, so the left operand ends up on
+ * top of the stack. The compiler records the greatest depth the stack
+ * reaches, which lets execute use a small array on the call stack for
+ * typical expressions.
+ */
+
+private:
+
+/* Constants */
+
+    static const int LOCAL_STACK_SIZE = 64;
+    static const int INITIAL_CAPACITY = 16;
+    static const char INPUT = 1;        // Usage flag for slots read first
+    static const char ASSIGNED = 2;     // Usage flag for slots stored into
+
+/*
+ * Type for the instructions of the machine. The first three take one
+ * operand: the constant for PUSH and the slot for LOAD and STORE. STORE
+ * leaves its value on the stack, since an assignment is itself an
+ * expression. Each arithmetic instruction pops the left operand from
+ * the top of the stack and the right operand below it, and pushes the
+ * result.
+ */
+
+    enum Opcode { OP_PUSH, OP_LOAD, OP_STORE, OP_ADD, OP_SUB, OP_MUL,
+                  OP_DIV, OP_HALT };
+
+/* Instance variables */
+
+    int *code;              // The instructions and their operands
+    int codeLength;         // The number of integers in code
+    int codeCapacity;       // The allocated size of code
+    ValueType *constants;   // The values pushed by PUSH instructions
+    int nConstants;         // The number of constants
+    int constantCapacity;   // The allocated size of constants
+    int maxDepth;           // The greatest depth of the value stack
+    StringInterner names;   // The name of the variable in each slot
+    char *usage;            // Whether each slot is read and assigned
+    int usageCapacity;      // The allocated size of usage
+
+/* Private methods */
+
+    void init();
+    void compileTree(Expression *exp, int depth);
+    void emit(int word);
+    void markUsage(int slot, char flag);
+    ValueType run(ValueType *slots, ValueType *stack) const;
+    template <typename ElementType>
+    static void grow(ElementType *& array, int & capacity, int needed);
+
+/* Make it illegal to copy programs */
+
+    TypedProgram(const TypedProgram & src) { }
+    TypedProgram & operator=(const TypedProgram & src) {
+        return *this;
+    }
+
+};
+
+/*
+ * Implementation notes: constructor and destructor
+ * ------------------------------------------------
+ * The arrays start out empty and grow by doubling as the compiler fills
+ * them.
+ */
+
+template <typename ValueType>
+TypedProgram<ValueType>::TypedProgram() {
+    init();
+}
+
+template <typename ValueType>
+TypedProgram<ValueType>::TypedProgram(Expression *exp) {
+    init();
+    compile(exp);
+}
+
+template <typename ValueType>
+TypedProgram<ValueType>::~TypedProgram() {
+    delete[] code;
+    delete[] constants;
+    delete[] usage;
+}
+
+/*
+ * Implementation notes: compile
+ * -----------------------------
+ * The compile method resets the program, translates the tree and then
+ * appends a HALT instruction, which lets the machine stop without
+ * comparing the program counter against the length on every step.
+ */
+
+template <typename ValueType>
+void TypedProgram<ValueType>::compile(Expression *exp) {
+    codeLength = 0;
+    nConstants = 0;
+    maxDepth = 0;
+    names.clear();
+    for (int i = 0; i < usageCapacity; i++) {
+        usage[i] = 0;
+    }
+    compileTree(exp, 0);
+    emit(OP_HALT);
+}
+
+template <typename ValueType>
+int TypedProgram<ValueType>::getSlotCount() const {
+    return names.size();
+}
+
+template <typename ValueType>
+int TypedProgram<ValueType>::getSlot(std::string_view name) const {
+    return names.find(name);
+}
+
+template <typename ValueType>
+std::string_view TypedProgram<ValueType>::getSlotName(int slot) const {
+    return names.getName(slot);
+}
+
+template <typename ValueType>
+bool TypedProgram<ValueType>::isInput(int slot) const {
+    return (usage[slot] & INPUT) != 0;
+}
+
+template <typename ValueType>
+bool TypedProgram<ValueType>::isAssigned(int slot) const {
+    return (usage[slot] & ASSIGNED) != 0;
+}
+
+/*
+ * Implementation notes: execute
+ * -----------------------------
+ * The execute method chooses where the value stack lives and then calls
+ * run. Most expressions fit in the local array.
+ */
+
+template <typename ValueType>
+ValueType TypedProgram<ValueType>::execute(ValueType *slots) const {
+    if (maxDepth <= LOCAL_STACK_SIZE) {
+        ValueType stack[LOCAL_STACK_SIZE];
+        return run(slots, stack);
+    }
+    ValueType *stack = new ValueType[maxDepth];
+    try {
+        ValueType value = run(slots, stack);
+        delete[] stack;
+        return value;
+    } catch (...) {
+        delete[] stack;
+        throw;
+    }
+}
+
+/*
+ * Implementation notes: toString
+ * ------------------------------
+ * Each line of the listing shows the offset of the instruction, its name
+ * and its operand. PUSH shows the constant itself, and slot operands are
+ * followed by the variable name.
+ */
+
+template <typename ValueType>
+std::string TypedProgram<ValueType>::toString() const {
+    std::ostringstream listing;
+    int pc = 0;
+    while (pc < codeLength) {
+        listing << pc << ": ";
+        switch (code[pc++]) {
+            case OP_PUSH:
+                listing << "PUSH " << constants[code[pc++]];
+                break;
+            case OP_LOAD: case OP_STORE:
+                listing << ((code[pc - 1] == OP_LOAD) ? "LOAD " : "STORE ")
+                        << code[pc] << " (" << names.getName(code[pc])
+                        << ")";
+                pc++;
+                break;
+            case OP_ADD: listing << "ADD"; break;
+            case OP_SUB: listing << "SUB"; break;
+            case OP_MUL: listing << "MUL"; break;
+            case OP_DIV: listing << "DIV"; break;
+            case OP_HALT: listing << "HALT"; break;
+        }
+        listing << "\n";
+    }
+    return listing.str();
+}
+
+/*
+ * Private method: init
+ * Usage: init();
+ * --------------
+ * Initializes the instance variables of an empty program.
+ */
+
+template <typename ValueType>
+void TypedProgram<ValueType>::init() {
+    code = NULL;
+    codeLength = 0;
+    codeCapacity = 0;
+    constants = NULL;
+    nConstants = 0;
+    constantCapacity = 0;
+    maxDepth = 0;
+    usage = NULL;
+    usageCapacity = 0;
+}
+
+/*
+ * Private method: compileTree
+ * Usage: compileTree(exp, depth);
+ * -------------------------------
+ * Appends the code for exp, given that depth values are already on the
+ * stack. Operands are compiled right first, matching the order in
+ * CompoundExp::eval, so the left operand ends up on top of the stack.
+ */
+
+template <typename ValueType>
+void TypedProgram<ValueType>::compileTree(Expression *exp, int depth) {
+    if (depth + 1 > maxDepth) maxDepth = depth + 1;
+    switch (exp->getType()) {
+        case CONSTANT:
+            grow(constants, constantCapacity, nConstants + 1);
+            constants[nConstants] = ValueType(exp->getConstantValue());
+            emit(OP_PUSH);
+            emit(nConstants++);
+            return;
+        case IDENTIFIER: {
+            int slot = names.intern(exp->getIdentifierName());
+            markUsage(slot, INPUT);
+            emit(OP_LOAD);
+            emit(slot);
+            return;
+        }
+        case COMPOUND:
+            break;
+    }
+    OperatorType op = exp->getOperatorType();
+    compileTree(exp->getRHS(), depth);
+    if (op == ASSIGN) {
+        int slot = names.intern(exp->getLHS()->getIdentifierName());
+        markUsage(slot, ASSIGNED);
+        emit(OP_STORE);
+        emit(slot);
+        return;
+    }
+    compileTree(exp->getLHS(), depth + 1);
+    switch (op) {
+        case ADD: emit(OP_ADD); break;
+        case SUBTRACT: emit(OP_SUB); break;
+        case MULTIPLY: emit(OP_MUL); break;
+        case DIVIDE: emit(OP_DIV); break;
+        default: error("Illegal operator in expression");
+    }
+}
+
+/*
+ * Private method: emit
+ * Usage: emit(word);
+ * ------------------
+ * Appends one integer to the code array.
+ */
+
+template <typename ValueType>
+void TypedProgram<ValueType>::emit(int word) {
+    grow(code, codeCapacity, codeLength + 1);
+    code[codeLength++] = word;
+}
+
+/*
+ * Private method: markUsage
+ * Usage: markUsage(slot, flag);
+ * -----------------------------
+ * Records that the slot is read (INPUT) or assigned (ASSIGNED). A read
+ * counts as an input only if no assignment to the slot precedes it.
+ */
+
+template <typename ValueType>
+void TypedProgram<ValueType>::markUsage(int slot, char flag) {
+    int oldCapacity = usageCapacity;
+    grow(usage, usageCapacity, slot + 1);
+    for (int i = oldCapacity; i < usageCapacity; i++) {
+        usage[i] = 0;
+    }
+    if (flag == INPUT && (usage[slot] & ASSIGNED)) return;
+    usage[slot] |= flag;
+}
+
+/*
+ * Private method: run
+ * Usage: ValueType value = run(slots, stack);
+ * -------------------------------------------
+ * Runs the instructions with the value stack in the array stack. The
+ * stack pointer sp points one past the top value. With GCC or Clang,
+ * the dispatch uses computed goto, which gives each instruction its own
+ * indirect jump and so lets the processor predict the next instruction
+ * from the current one. Other compilers get an ordinary switch. The
+ * arithmetic comes from ValueTraits.
+ */
+
+template <typename ValueType>
+ValueType TypedProgram<ValueType>::run(ValueType *slots,
+                                       ValueType *stack) const {
+    typedef ValueTraits<ValueType> Traits;
+    const int *pc = code;
+    ValueType *sp = stack;
+#if defined(__GNUC__)
+    static void *dispatch[] = {
+        &&do_push, &&do_load, &&do_store, &&do_add, &&do_sub, &&do_mul,
+        &&do_div, &&do_halt
+    };
+#define NEXT goto *dispatch[*pc++]
+    NEXT;
+  do_push:
+    *sp++ = constants[*pc++];
+    NEXT;
+  do_load:
+    *sp++ = slots[*pc++];
+    NEXT;
+  do_store:
+    slots[*pc++] = sp[-1];
+    NEXT;
+  do_add:
+    sp--;
+    sp[-1] = Traits::add(sp[0], sp[-1]);
+    NEXT;
+  do_sub:
+    sp--;
+    sp[-1] = Traits::subtract(sp[0], sp[-1]);
+    NEXT;
+  do_mul:
+    sp--;
+    sp[-1] = Traits::multiply(sp[0], sp[-1]);
+    NEXT;
+  do_div:
+    sp--;
+    sp[-1] = Traits::divide(sp[0], sp[-1]);
+    NEXT;
+  do_halt:
+    return sp[-1];
+#undef NEXT
+#else
+    while (true) {
+        switch (*pc++) {
+            case OP_PUSH: *sp++ = constants[*pc++]; break;
+            case OP_LOAD: *sp++ = slots[*pc++]; break;
+            case OP_STORE: slots[*pc++] = sp[-1]; break;
+            case OP_ADD:
+                sp--;
+                sp[-1] = Traits::add(sp[0], sp[-1]);
+                break;
+            case OP_SUB:
+                sp--;
+                sp[-1] = Traits::subtract(sp[0], sp[-1]);
+                break;
+            case OP_MUL:
+                sp--;
+                sp[-1] = Traits::multiply(sp[0], sp[-1]);
+                break;
+            case OP_DIV:
+                sp--;
+                sp[-1] = Traits::divide(sp[0], sp[-1]);
+                break;
+            case OP_HALT: return sp[-1];
+        }
+    }
+#endif
+}
+
+/*
+ * Private method: grow
+ * Usage: grow(array, capacity, needed);
+ * -------------------------------------
+ * Doubles the capacity of the array until it holds at least needed
+ * elements, copying the existing elements to the new array.
+ */
+
+template <typename ValueType>
+template <typename ElementType>
+void TypedProgram<ValueType>::grow(ElementType *& array, int & capacity,
+                                   int needed) {
+    if (needed <= capacity) return;
+    int newCapacity = (capacity == 0) ? INITIAL_CAPACITY : 2 * capacity;
+    while (newCapacity < needed) {
+        newCapacity *= 2;
+    }
+    ElementType *newArray = new ElementType[newCapacity];
+    for (int i = 0; i < capacity; i++) {
+        newArray[i] = array[i];
+    }
+    delete[] array;
+    array = newArray;
+    capacity = newCapacity;
+}
+
+#endif